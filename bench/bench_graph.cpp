@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <sys/resource.h>
+#include <glog/logging.h>
+#include "data/cpu_isa.hpp"
+#include "data/tensor_util.hpp"
+#include "runtime/runtime_ir.hpp"
+
+// 整个模型的端到端基准测试
+// 读取任意 .pnnx.param / .pnnx.bin，按输入节点声明的形状生成随机输入，
+// 在 batch 大小 × 线程数 的组合上测量延迟分位数和吞吐量
+//
+// ./bench_graph --param=../tmp/test.pnnx.param --bin=../tmp/test.pnnx.bin --batch=1,4 --threads=1,2 --json=result.json
+// 和之前的结果比较，p50 或吞吐量退化超过阈值时返回 1
+// ./bench_graph ... --baseline=result.json --threshold=0.1
+// 半精度或只量化权重的卷积核，先输出和 fp32 权重的误差，再测量性能
+// ./bench_graph ... --weight-type=fp16
+// ./bench_graph ... --weight-type=int4
+// 自动调优选择卷积等算子的实现，结果写到模型旁边的 .ktune 缓存
+// ./bench_graph ... --auto-tune=1
+
+using namespace kuiper_infer;
+
+struct BenchOptions {
+    std::string param_path;
+    std::string bin_path;
+    std::string input_name = "pnnx_input_0";
+    std::string output_name = "pnnx_output_0";
+    uint32_t warmup = 5; // 每个线程的预热次数
+    uint32_t iterations = 50; // 每个线程的计时次数
+    std::vector<uint32_t> batch_sizes{1};
+    std::vector<uint32_t> thread_counts{1};
+    std::string json_path; // 结果输出路径，为空时不输出
+    std::string baseline_path; // 用来比较的历史结果，为空时不比较
+    double threshold = 0.1; // 允许的退化比例
+    RuntimeDataType weight_type = RuntimeDataType::kTypeFloat32; // 权重的存储类型
+    bool auto_tune = false; // 构建时是否自动调优
+};
+
+struct BenchResult {
+    uint32_t batch_size = 0;
+    uint32_t threads = 0;
+    double p50_ms = 0.;
+    double p90_ms = 0.;
+    double p99_ms = 0.;
+    double max_ms = 0.;
+    double mean_ms = 0.;
+    double throughput = 0.; // 每秒处理的样本数
+};
+
+static std::vector<uint32_t> ParseList(const std::string &value) {
+    std::vector<uint32_t> values;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            values.push_back(std::stoul(item));
+        }
+    }
+    return values;
+}
+
+static void PrintUsage() {
+    std::cout << "usage: bench_graph --param=<file> --bin=<file> [options]\n"
+              << "  --input=<name>        input operator, default pnnx_input_0\n"
+              << "  --output=<name>       output operator, default pnnx_output_0\n"
+              << "  --warmup=<n>          warmup iterations per thread, default 5\n"
+              << "  --iterations=<n>      timed iterations per thread, default 50\n"
+              << "  --batch=<n,n,...>     batch sizes, default 1\n"
+              << "  --threads=<n,n,...>   concurrent graphs, default 1\n"
+              << "  --json=<file>         write results as json\n"
+              << "  --baseline=<file>     compare with a previous json result\n"
+              << "  --threshold=<ratio>   allowed regression against baseline, default 0.1\n"
+              << "  --weight-type=<type>  fp32, fp16, bf16, int8 or int4, default fp32\n"
+              << "  --auto-tune=<0|1>     time layer implementations at build, default 0\n";
+}
+
+static bool ParseOptions(int argc, char *argv[], BenchOptions &options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t pos = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || pos == std::string::npos) {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return false;
+        }
+        const std::string key = arg.substr(2, pos - 2);
+        const std::string value = arg.substr(pos + 1);
+        if (key == "param") {
+            options.param_path = value;
+        } else if (key == "bin") {
+            options.bin_path = value;
+        } else if (key == "input") {
+            options.input_name = value;
+        } else if (key == "output") {
+            options.output_name = value;
+        } else if (key == "warmup") {
+            options.warmup = std::stoul(value);
+        } else if (key == "iterations") {
+            options.iterations = std::stoul(value);
+        } else if (key == "batch") {
+            options.batch_sizes = ParseList(value);
+        } else if (key == "threads") {
+            options.thread_counts = ParseList(value);
+        } else if (key == "json") {
+            options.json_path = value;
+        } else if (key == "baseline") {
+            options.baseline_path = value;
+        } else if (key == "threshold") {
+            options.threshold = std::stod(value);
+        } else if (key == "auto-tune") {
+            options.auto_tune = value != "0";
+        } else if (key == "weight-type") {
+            if (value == "fp32") {
+                options.weight_type = RuntimeDataType::kTypeFloat32;
+            } else if (value == "fp16") {
+                options.weight_type = RuntimeDataType::kTypeFloat16;
+            } else if (value == "bf16") {
+                options.weight_type = RuntimeDataType::kTypeBFloat16;
+            } else if (value == "int8") {
+                options.weight_type = RuntimeDataType::kTypeInt8;
+            } else if (value == "int4") {
+                options.weight_type = RuntimeDataType::kTypeInt4;
+            } else {
+                std::cerr << "Unknown weight type: " << value << "\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    return !options.param_path.empty() && !options.bin_path.empty() && options.iterations != 0 &&
+           !options.batch_sizes.empty() && !options.thread_counts.empty();
+}
+
+// 输入节点声明的形状，第一维是 batch，其余维度对应 CHW，不足三维时在前面补 1
+static std::vector<uint32_t> InputShape(const RuntimeGraph &graph, const std::string &input_name) {
+    for (const auto &op : graph.operators()) {
+        if (op->name != input_name) {
+            continue;
+        }
+        CHECK(op->output_operands != nullptr) << "Input operator has no output: " << input_name;
+        const std::vector<int32_t> &shape = op->output_operands->shape;
+        CHECK(shape.size() >= 2 && shape.size() <= 4) << "Unsupported input shape of " << input_name;
+
+        std::vector<uint32_t> chw(4 - shape.size(), 1);
+        for (size_t i = 1; i < shape.size(); ++i) {
+            CHECK(shape.at(i) > 0) << "Input shape of " << input_name << " is dynamic";
+            chw.push_back(shape.at(i));
+        }
+        return chw;
+    }
+    LOG(FATAL) << "Can not find input operator: " << input_name;
+    return {};
+}
+
+// 最近秩方法计算分位数，latencies 已排序
+static double Percentile(const std::vector<double> &latencies, double percent) {
+    CHECK(!latencies.empty());
+    const size_t rank = size_t(std::ceil(percent * latencies.size()));
+    return latencies.at(std::max<size_t>(rank, 1) - 1);
+}
+
+static BenchResult RunBench(const BenchOptions &options, uint32_t batch_size, uint32_t threads) {
+    // 每个线程一个计算图，同一模型的计算图共享只读权重
+    std::vector<std::unique_ptr<RuntimeGraph>> graphs;
+    std::vector<std::vector<sftensor>> inputs(threads);
+    for (uint32_t t = 0; t < threads; ++t) {
+        graphs.push_back(std::make_unique<RuntimeGraph>(options.param_path, options.bin_path));
+        graphs.back()->set_weight_type(options.weight_type);
+        graphs.back()->set_auto_tune(options.auto_tune);
+        graphs.back()->Build(options.input_name, options.output_name);
+
+        const std::vector<uint32_t> &shape = InputShape(*graphs.back(), options.input_name);
+        for (uint32_t b = 0; b < batch_size; ++b) {
+            sftensor input = std::make_shared<ftensor>(shape.at(0), shape.at(1), shape.at(2));
+            input->Rand();
+            inputs.at(t).push_back(input);
+        }
+    }
+
+    std::vector<std::vector<double>> latencies(threads);
+    std::atomic<uint32_t> ready{0};
+    std::atomic<bool> start{false};
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            RuntimeGraph &graph = *graphs.at(t);
+            for (uint32_t i = 0; i < options.warmup; ++i) {
+                graph.Forward(inputs.at(t));
+            }
+
+            // 所有线程预热完成后同时开始计时
+            ready.fetch_add(1);
+            while (!start.load()) {
+                std::this_thread::yield();
+            }
+
+            latencies.at(t).reserve(options.iterations);
+            for (uint32_t i = 0; i < options.iterations; ++i) {
+                const auto begin = std::chrono::steady_clock::now();
+                const std::vector<sftensor> &outputs = graph.Forward(inputs.at(t));
+                const auto end = std::chrono::steady_clock::now();
+                CHECK(outputs.size() == batch_size);
+                latencies.at(t).push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+            }
+        });
+    }
+
+    while (ready.load() != threads) {
+        std::this_thread::yield();
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    start.store(true);
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<double> all_latencies;
+    for (const auto &thread_latencies : latencies) {
+        all_latencies.insert(all_latencies.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    std::sort(all_latencies.begin(), all_latencies.end());
+
+    BenchResult result;
+    result.batch_size = batch_size;
+    result.threads = threads;
+    result.p50_ms = Percentile(all_latencies, 0.50);
+    result.p90_ms = Percentile(all_latencies, 0.90);
+    result.p99_ms = Percentile(all_latencies, 0.99);
+    result.max_ms = all_latencies.back();
+    double total_ms = 0.;
+    for (const double latency : all_latencies) {
+        total_ms += latency;
+    }
+    result.mean_ms = total_ms / all_latencies.size();
+    result.throughput = seconds <= 0. ? 0. : double(threads) * options.iterations * batch_size / seconds;
+    return result;
+}
+
+// 同一输入下半精度权重和 fp32 权重的输出误差
+static void ReportAccuracy(const BenchOptions &options) {
+    RuntimeGraph reference(options.param_path, options.bin_path);
+    reference.Build(options.input_name, options.output_name);
+    RuntimeGraph graph(options.param_path, options.bin_path);
+    graph.set_weight_type(options.weight_type);
+    graph.Build(options.input_name, options.output_name);
+
+    const std::vector<uint32_t> &shape = InputShape(graph, options.input_name);
+    sftensor input = std::make_shared<ftensor>(shape.at(0), shape.at(1), shape.at(2));
+    input->Rand();
+    const std::vector<sftensor> expected = reference.Forward(std::vector<sftensor>{input});
+    const std::vector<sftensor> actual = graph.Forward(std::vector<sftensor>{input});
+    CHECK(expected.size() == actual.size());
+
+    TensorErrorStats stats;
+    for (size_t i = 0; i < actual.size(); ++i) {
+        const TensorErrorStats &item = TensorCompare(actual.at(i), expected.at(i));
+        stats.max_abs = std::max(stats.max_abs, item.max_abs);
+        stats.max_rel = std::max(stats.max_rel, item.max_rel);
+        stats.mean_abs += item.mean_abs / actual.size();
+    }
+    std::cout << "accuracy vs fp32: max abs " << std::scientific << std::setprecision(3) << stats.max_abs
+              << ", mean abs " << stats.mean_abs << ", max rel " << stats.max_rel << "\n"
+              << std::defaultfloat;
+}
+
+// 进程的峰值常驻内存，KB
+static long PeakRssKb() {
+    struct rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// 每个结果单独一行，LoadBaseline 按行读回
+static std::string ResultJson(const BenchResult &result) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(4);
+    ss << "{\"batch\": " << result.batch_size << ", \"threads\": " << result.threads
+       << ", \"p50_ms\": " << result.p50_ms << ", \"p90_ms\": " << result.p90_ms
+       << ", \"p99_ms\": " << result.p99_ms << ", \"max_ms\": " << result.max_ms
+       << ", \"mean_ms\": " << result.mean_ms << ", \"throughput\": " << result.throughput << "}";
+    return ss.str();
+}
+
+static bool SaveJson(const std::string &path, const BenchOptions &options,
+                     const std::vector<BenchResult> &results, long peak_rss_kb) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.good()) {
+        LOG(ERROR) << "Can not open json file: " << path;
+        return false;
+    }
+    out << "{\n"
+        << "  \"param\": \"" << options.param_path << "\",\n"
+        << "  \"bin\": \"" << options.bin_path << "\",\n"
+        << "  \"warmup\": " << options.warmup << ",\n"
+        << "  \"iterations\": " << options.iterations << ",\n"
+        << "  \"peak_rss_kb\": " << peak_rss_kb << ",\n"
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        out << "    " << ResultJson(results.at(i)) << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    out << "  ]\n}\n";
+    return out.good();
+}
+
+static std::vector<BenchResult> LoadBaseline(const std::string &path) {
+    std::vector<BenchResult> results;
+    std::ifstream in(path);
+    CHECK(in.good()) << "Can not open baseline file: " << path;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t pos = line.find("{\"batch\"");
+        if (pos == std::string::npos) {
+            continue;
+        }
+        BenchResult result;
+        const int parsed = std::sscanf(line.c_str() + pos,
+                                       "{\"batch\": %u, \"threads\": %u, \"p50_ms\": %lf, \"p90_ms\": %lf, "
+                                       "\"p99_ms\": %lf, \"max_ms\": %lf, \"mean_ms\": %lf, \"throughput\": %lf}",
+                                       &result.batch_size, &result.threads, &result.p50_ms, &result.p90_ms,
+                                       &result.p99_ms, &result.max_ms, &result.mean_ms, &result.throughput);
+        if (parsed == 8) {
+            results.push_back(result);
+        }
+    }
+    return results;
+}
+
+// p50 延迟变大或吞吐量下降超过阈值时认为退化
+static bool CheckRegression(const std::vector<BenchResult> &results, const std::vector<BenchResult> &baseline,
+                            double threshold) {
+    bool regressed = false;
+    for (const BenchResult &result : results) {
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&](const BenchResult &item) {
+            return item.batch_size == result.batch_size && item.threads == result.threads;
+        });
+        if (base == baseline.end()) {
+            continue;
+        }
+        const double latency_ratio = base->p50_ms <= 0. ? 0. : result.p50_ms / base->p50_ms - 1.;
+        const double throughput_ratio = base->throughput <= 0. ? 0. : 1. - result.throughput / base->throughput;
+        const bool failed = latency_ratio > threshold || throughput_ratio > threshold;
+        std::cout << "batch " << result.batch_size << " threads " << result.threads << std::fixed
+                  << std::setprecision(1) << ": p50 " << latency_ratio * 100 << "%, throughput "
+                  << -throughput_ratio * 100 << "%" << (failed ? "  REGRESSION" : "") << "\n";
+        regressed = regressed || failed;
+    }
+    return regressed;
+}
+
+int main(int argc, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    BenchOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+
+    if (options.weight_type != RuntimeDataType::kTypeFloat32) {
+        ReportAccuracy(options);
+    }
+
+    // 内核按这个指令集选择版本，KUIPER_CPU_ISA 可以指定更低的指令集做对比
+    std::cout << "cpu isa: " << CpuIsaName(ActiveCpuIsa()) << " (detected " << CpuIsaName(DetectCpuIsa()) << ")\n";
+    std::vector<BenchResult> results;
+    std::cout << std::left << std::setw(8) << "batch" << std::setw(10) << "threads" << std::right
+              << std::setw(12) << "p50(ms)" << std::setw(12) << "p90(ms)" << std::setw(12) << "p99(ms)"
+              << std::setw(12) << "max(ms)" << std::setw(16) << "samples/s" << "\n";
+    for (const uint32_t batch_size : options.batch_sizes) {
+        for (const uint32_t threads : options.thread_counts) {
+            const BenchResult &result = RunBench(options, batch_size, threads);
+            results.push_back(result);
+            std::cout << std::left << std::setw(8) << batch_size << std::setw(10) << threads << std::right
+                      << std::fixed << std::setprecision(3) << std::setw(12) << result.p50_ms
+                      << std::setw(12) << result.p90_ms << std::setw(12) << result.p99_ms
+                      << std::setw(12) << result.max_ms << std::setw(16) << std::setprecision(1)
+                      << result.throughput << "\n";
+        }
+    }
+
+    const long peak_rss_kb = PeakRssKb();
+    std::cout << "peak rss: " << peak_rss_kb << " KB\n";
+
+    if (!options.json_path.empty() && !SaveJson(options.json_path, options, results, peak_rss_kb)) {
+        return 2;
+    }
+
+    if (!options.baseline_path.empty()) {
+        const std::vector<BenchResult> &baseline = LoadBaseline(options.baseline_path);
+        if (CheckRegression(results, baseline, options.threshold)) {
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include "bench_util.hpp"
+#include "data/half.hpp"
+#include "data/half_tensor.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/maxpooling_layer.hpp"
+#include "layer/relu_layer.hpp"
+#include "ops/conv_op.hpp"
+#include "ops/maxpooling_op.hpp"
+#include "ops/relu_op.hpp"
+
+using namespace kuiper_infer;
+
+// 参数: 元素个数, 类型(0 = fp16, 1 = bf16)
+static void BM_ConvertToHalf(benchmark::State &state) {
+    const size_t count = state.range(0);
+    const HalfType type = HalfType(state.range(1));
+    std::vector<float> src(count, 1.5f);
+    std::vector<uint16_t> dst(count);
+
+    BenchCounters counters(state, 0, count * (sizeof(float) + sizeof(uint16_t)));
+    for (auto _ : state) {
+        ConvertToHalf(src.data(), dst.data(), count, type);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    counters.Report();
+}
+
+static void BM_ConvertFromHalf(benchmark::State &state) {
+    const size_t count = state.range(0);
+    const HalfType type = HalfType(state.range(1));
+    std::vector<uint16_t> src(count, FloatToFp16(1.5f));
+    std::vector<float> dst(count);
+
+    BenchCounters counters(state, 0, count * (sizeof(float) + sizeof(uint16_t)));
+    for (auto _ : state) {
+        ConvertFromHalf(src.data(), dst.data(), count, type);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_ConvertToHalf)->ArgNames({"count", "type"})->Args({1 << 20, 0})->Args({1 << 20, 1});
+BENCHMARK(BM_ConvertFromHalf)->ArgNames({"count", "type"})->Args({1 << 20, 0})->Args({1 << 20, 1});
+
+// 同一层 fp32 和半精度的前向，半精度读写的字节数减半
+// 参数: 通道, 宽高, 类型(-1 = fp32, 0 = fp16, 1 = bf16)
+static void BM_HalfLayer(benchmark::State &state, const std::shared_ptr<Layer> &layer, uint32_t output_scale) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+    const int type = state.range(2);
+    sftensor input = std::make_shared<ftensor>(channels, size, size);
+    input->Rand();
+
+    const uint64_t elements = uint64_t(channels) * size * size;
+    const uint64_t element_bytes = type < 0 ? sizeof(float) : sizeof(uint16_t);
+    BenchCounters counters(state, 0, (elements + elements / output_scale) * element_bytes);
+    if (type < 0) {
+        std::vector<sftensor> inputs{input};
+        std::vector<sftensor> outputs(1);
+        for (auto _ : state) {
+            layer->Forward(inputs, outputs);
+            benchmark::DoNotOptimize(outputs.front());
+        }
+    } else {
+        std::vector<shtensor> inputs{HalfTensor::FromFloat(*input, HalfType(type))};
+        std::vector<shtensor> outputs(1);
+        for (auto _ : state) {
+            layer->ForwardHalf(inputs, outputs);
+            benchmark::DoNotOptimize(outputs.front());
+        }
+    }
+    counters.Report();
+}
+
+BENCHMARK_CAPTURE(BM_HalfLayer, relu, std::make_shared<ReLULayer>(std::make_shared<ReLUOperator>(0.f)), 1)
+    ->ArgNames({"channels", "size", "type"})->Args({64, 112, -1})->Args({64, 112, 0})->Args({64, 112, 1});
+BENCHMARK_CAPTURE(BM_HalfLayer, maxpool,
+                  std::make_shared<MaxPoolingLayer>(
+                      std::make_shared<MaxPoolingOp>(Shape(2, 2), Shape(2, 2), Shape(0, 0))), 4)
+    ->ArgNames({"channels", "size", "type"})->Args({64, 112, -1})->Args({64, 112, 0})->Args({64, 112, 1});
+
+// 卷积核压缩存储时每次前向多一次权重转换
+// 参数: 输入通道, 输出通道, 宽高, 类型(-1 = fp32, 0 = fp16, 1 = bf16)
+static void BM_ConvHalfWeights(benchmark::State &state) {
+    const uint32_t in_channels = state.range(0);
+    const uint32_t out_channels = state.range(1);
+    const uint32_t size = state.range(2);
+    const int type = state.range(3);
+
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(1, 1), false, 1);
+    std::vector<sftensor> weights;
+    for (uint32_t k = 0; k < out_channels; ++k) {
+        weights.push_back(std::make_shared<ftensor>(in_channels, 3, 3));
+        weights.back()->Rand();
+    }
+    conv_op->set_weights(weights);
+    if (type >= 0) {
+        conv_op->CompressWeights(HalfType(type));
+    }
+    ConvLayer layer(conv_op);
+
+    sftensor input = std::make_shared<ftensor>(in_channels, size, size);
+    input->Rand();
+    std::vector<sftensor> inputs{input};
+    std::vector<sftensor> outputs(1);
+
+    const uint64_t output_elements = uint64_t(out_channels) * size * size;
+    const uint64_t weight_elements = uint64_t(out_channels) * in_channels * 9;
+    const uint64_t flops = 2 * output_elements * in_channels * 9;
+    const uint64_t bytes = (uint64_t(in_channels) * size * size + output_elements) * sizeof(float) +
+                           weight_elements * (type < 0 ? sizeof(float) : sizeof(uint16_t));
+    BenchCounters counters(state, flops, bytes);
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_ConvHalfWeights)->ArgNames({"in", "out", "size", "type"})
+    ->Args({64, 64, 56, -1})->Args({64, 64, 56, 0})->Args({64, 64, 56, 1});
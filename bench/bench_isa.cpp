@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include <vector>
+#include "bench_util.hpp"
+#include "data/cpu_isa.hpp"
+#include "data/vector_kernels.hpp"
+
+using namespace kuiper_infer;
+
+// 同一个内核在各个指令集版本下的速度，CPU 不支持的版本跳过
+// 参数: 元素个数, 指令集(0 = scalar, 1 = avx2, 2 = avx512)
+template <typename Run>
+static void RunWithIsa(benchmark::State &state, CpuIsa isa, uint64_t flops, uint64_t bytes, const Run &run) {
+    if (int(isa) > int(DetectCpuIsa())) {
+        state.SkipWithError("isa is not supported by this cpu");
+        return;
+    }
+    const CpuIsa active = ActiveCpuIsa();
+    SetActiveCpuIsa(isa);
+    state.SetLabel(CpuIsaName(isa));
+    BenchCounters counters(state, flops, bytes);
+    for (auto _ : state) {
+        run();
+    }
+    counters.Report();
+    SetActiveCpuIsa(active);
+}
+
+static void BM_IsaRelu(benchmark::State &state) {
+    const size_t count = state.range(0);
+    std::vector<float> src(count, -0.5f), dst(count);
+    RunWithIsa(state, CpuIsa(state.range(1)), count, count * 2 * sizeof(float), [&]() {
+        ReluValues(src.data(), dst.data(), count, 0.f);
+        benchmark::DoNotOptimize(dst.data());
+    });
+}
+
+static void BM_IsaSigmoid(benchmark::State &state) {
+    const size_t count = state.range(0);
+    std::vector<float> src(count, 0.5f), dst(count);
+    RunWithIsa(state, CpuIsa(state.range(1)), count, count * 2 * sizeof(float), [&]() {
+        SigmoidValues(src.data(), dst.data(), count);
+        benchmark::DoNotOptimize(dst.data());
+    });
+}
+
+static void BM_IsaAdd(benchmark::State &state) {
+    const size_t count = state.range(0);
+    std::vector<float> a(count, 1.f), b(count, 2.f), dst(count);
+    RunWithIsa(state, CpuIsa(state.range(1)), count, count * 3 * sizeof(float), [&]() {
+        AddValues(a.data(), b.data(), dst.data(), count);
+        benchmark::DoNotOptimize(dst.data());
+    });
+}
+
+// 3x3 步长 2 的池化，一个 size x size 的通道
+static void BM_IsaMaxPool(benchmark::State &state) {
+    const uint32_t size = state.range(0);
+    const uint32_t output_size = (size - 3) / 2 + 1;
+    std::vector<float> src(size_t(size) * size, 1.f), dst(size_t(output_size) * output_size);
+    RunWithIsa(state, CpuIsa(state.range(1)), uint64_t(output_size) * output_size * 9,
+               (src.size() + dst.size()) * sizeof(float), [&]() {
+                   MaxPoolPlane(src.data(), size, dst.data(), output_size, output_size, output_size, 3, 3, 2, 2);
+                   benchmark::DoNotOptimize(dst.data());
+               });
+}
+
+static void BM_IsaCopyStrided(benchmark::State &state) {
+    const size_t count = state.range(0);
+    std::vector<float> src(count * 2, 1.f), dst(count);
+    RunWithIsa(state, CpuIsa(state.range(1)), 0, count * 2 * sizeof(float), [&]() {
+        CopyStrided(src.data(), 2, dst.data(), count);
+        benchmark::DoNotOptimize(dst.data());
+    });
+}
+
+BENCHMARK(BM_IsaRelu)->ArgNames({"count", "isa"})->ArgsProduct({{1 << 16}, {0, 1, 2}});
+BENCHMARK(BM_IsaSigmoid)->ArgNames({"count", "isa"})->ArgsProduct({{1 << 16}, {0, 1, 2}});
+BENCHMARK(BM_IsaAdd)->ArgNames({"count", "isa"})->ArgsProduct({{1 << 16}, {0, 1, 2}});
+BENCHMARK(BM_IsaMaxPool)->ArgNames({"size", "isa"})->ArgsProduct({{112}, {0, 1, 2}});
+BENCHMARK(BM_IsaCopyStrided)->ArgNames({"count", "isa"})->ArgsProduct({{1 << 14}, {0, 1, 2}});
@@ -0,0 +1,297 @@
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include "bench_util.hpp"
+#include "data/tensor.hpp"
+#include "factory/layer_factory.hpp"
+#include "layer/batchnorm_layer.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/conv_transpose_layer.hpp"
+#include "layer/expression_layer.hpp"
+#include "layer/linear_layer.hpp"
+#include "layer/maxpooling_layer.hpp"
+#include "layer/relu_layer.hpp"
+#include "layer/sigmoid_layer.hpp"
+#include "ops/batchnorm_op.hpp"
+#include "ops/conv_op.hpp"
+#include "ops/conv_transpose_op.hpp"
+#include "ops/expression_op.hpp"
+#include "ops/linear_op.hpp"
+#include "ops/maxpooling_op.hpp"
+#include "ops/relu_op.hpp"
+#include "ops/sigmoid_op.hpp"
+
+using namespace kuiper_infer;
+
+static sftensor RandTensor(uint32_t channels, uint32_t rows, uint32_t cols) {
+    sftensor tensor = std::make_shared<ftensor>(channels, rows, cols);
+    tensor->Rand();
+    return tensor;
+}
+
+// 参数: 输入通道, 输出通道, 卷积核大小, 步长, 分组, 输入宽高
+static void BM_Conv(benchmark::State &state) {
+    const uint32_t in_channels = state.range(0);
+    const uint32_t out_channels = state.range(1);
+    const uint32_t kernel = state.range(2);
+    const uint32_t stride = state.range(3);
+    const uint32_t groups = state.range(4);
+    const uint32_t size = state.range(5);
+    const uint32_t padding = kernel / 2;
+
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(stride, stride), Shape(padding, padding), true, groups);
+    std::vector<sftensor> weights;
+    std::vector<sftensor> bias;
+    for (uint32_t k = 0; k < out_channels; ++k) {
+        weights.push_back(RandTensor(in_channels / groups, kernel, kernel));
+        bias.push_back(RandTensor(1, 1, 1));
+    }
+    conv_op->set_weights(weights);
+    conv_op->set_bias(bias);
+    ConvLayer layer(conv_op);
+
+    std::vector<sftensor> inputs{RandTensor(in_channels, size, size)};
+    std::vector<sftensor> outputs(1);
+
+    const uint64_t output_size = (size + 2 * padding - kernel) / stride + 1;
+    const uint64_t output_elements = uint64_t(out_channels) * output_size * output_size;
+    const uint64_t flops = 2 * output_elements * (in_channels / groups) * kernel * kernel + output_elements;
+    const uint64_t bytes = (uint64_t(in_channels) * size * size + output_elements +
+                            uint64_t(out_channels) * (in_channels / groups) * kernel * kernel) * sizeof(float);
+
+    BenchCounters counters(state, flops, bytes);
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+static void ConvArguments(benchmark::internal::Benchmark *bench) {
+    bench->ArgNames({"in_c", "out_c", "kernel", "stride", "groups", "size"});
+    // 卷积核大小
+    for (int64_t kernel : {1, 3, 5, 7}) {
+        bench->Args({32, 32, kernel, 1, 1, 56});
+    }
+    // 步长
+    for (int64_t stride : {1, 2}) {
+        bench->Args({64, 64, 3, stride, 1, 56});
+    }
+    // 分组，groups == 1 的情况已经在上面，groups == 通道数时是 depthwise
+    for (int64_t groups : {4, 32}) {
+        bench->Args({32, 32, 3, 1, groups, 56});
+    }
+    // 通道数
+    for (int64_t channels : {3, 16, 64, 128}) {
+        bench->Args({channels, channels, 3, 1, 1, 28});
+    }
+}
+
+BENCHMARK(BM_Conv)->Apply(ConvArguments);
+
+// 同一个卷积的各个注册实现，自动调优在这些实现之间选择
+// 参数: 通道, 分组, 输入宽高，卷积核 3x3 步长 1
+static void BM_ConvImplementation(benchmark::State &state, const std::string &name) {
+    const uint32_t channels = state.range(0);
+    const uint32_t groups = state.range(1);
+    const uint32_t size = state.range(2);
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(1, 1), true, groups);
+    std::vector<sftensor> weights;
+    std::vector<sftensor> bias;
+    for (uint32_t k = 0; k < channels; ++k) {
+        weights.push_back(RandTensor(channels / groups, 3, 3));
+        bias.push_back(RandTensor(1, 1, 1));
+    }
+    conv_op->set_weights(weights);
+    conv_op->set_bias(bias);
+    const std::shared_ptr<Layer> &layer = LayerRegister::CreateLayer(conv_op, name);
+    if (layer == nullptr) {
+        state.SkipWithError("implementation is not applicable");
+        return;
+    }
+
+    std::vector<sftensor> inputs{RandTensor(channels, size, size)};
+    std::vector<sftensor> outputs(1);
+    const uint64_t output_elements = uint64_t(channels) * size * size;
+    BenchCounters counters(state, 2 * output_elements * (channels / groups) * 9,
+                           2 * output_elements * sizeof(float));
+    for (auto _ : state) {
+        layer->Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK_CAPTURE(BM_ConvImplementation, im2col_gemm, "im2col_gemm")
+    ->ArgNames({"channels", "groups", "size"})->Args({32, 32, 56})->Args({128, 128, 28})->Args({16, 4, 56});
+BENCHMARK_CAPTURE(BM_ConvImplementation, direct, "direct")
+    ->ArgNames({"channels", "groups", "size"})->Args({32, 32, 56})->Args({128, 128, 28})->Args({16, 4, 56});
+// 高分辨率输入上 im2col 矩阵有几百 MB，隐式 GEMM 每个线程只用一块 L2 大小的缓冲区
+BENCHMARK_CAPTURE(BM_ConvImplementation, im2col_gemm, "im2col_gemm")
+    ->ArgNames({"channels", "groups", "size"})->Args({64, 1, 56})->Args({32, 1, 512})->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_ConvImplementation, implicit_gemm, "implicit_gemm")
+    ->ArgNames({"channels", "groups", "size"})->Args({64, 1, 56})->Args({32, 1, 512})->Unit(benchmark::kMillisecond);
+
+// 转置卷积，参数: 输入通道, 输出通道, 卷积核大小, 步长, 输入宽高
+// kernel == stride 时(U-Net 的 2x 上采样)输出不重叠，其余情况经过 col2im 累加
+static void BM_ConvTranspose(benchmark::State &state) {
+    const uint32_t in_channels = state.range(0);
+    const uint32_t out_channels = state.range(1);
+    const uint32_t kernel = state.range(2);
+    const uint32_t stride = state.range(3);
+    const uint32_t size = state.range(4);
+    const uint32_t padding = kernel == stride ? 0 : kernel / 2;
+
+    std::shared_ptr<ConvTransposeOp> op =
+        std::make_shared<ConvTransposeOp>(Shape(stride, stride), Shape(padding, padding), true, 1);
+    std::vector<sftensor> weights;
+    std::vector<sftensor> bias;
+    for (uint32_t ic = 0; ic < in_channels; ++ic) {
+        weights.push_back(RandTensor(out_channels, kernel, kernel));
+    }
+    for (uint32_t oc = 0; oc < out_channels; ++oc) {
+        bias.push_back(RandTensor(1, 1, 1));
+    }
+    op->set_weights(weights);
+    op->set_bias(bias);
+    ConvTransposeLayer layer(op);
+
+    std::vector<sftensor> inputs{RandTensor(in_channels, size, size)};
+    std::vector<sftensor> outputs(1);
+    const uint64_t output_size = (size - 1) * stride - 2 * padding + kernel;
+    const uint64_t output_elements = uint64_t(out_channels) * output_size * output_size;
+    const uint64_t flops = 2 * uint64_t(in_channels) * size * size * out_channels * kernel * kernel;
+    const uint64_t bytes = (uint64_t(in_channels) * size * size + output_elements +
+                            uint64_t(in_channels) * out_channels * kernel * kernel) * sizeof(float);
+    BenchCounters counters(state, flops, bytes);
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_ConvTranspose)->ArgNames({"in_c", "out_c", "kernel", "stride", "size"})
+    ->Args({128, 64, 2, 2, 56})->Args({64, 32, 2, 2, 112})->Args({64, 32, 4, 2, 56})->Args({32, 32, 3, 1, 56});
+
+// 全连接层，参数: 输入特征, 输出特征, batch
+// 整个 batch 一次矩阵乘，batch 小时按输出特征分给各个线程
+static void BM_Linear(benchmark::State &state) {
+    const uint32_t in_features = state.range(0);
+    const uint32_t out_features = state.range(1);
+    const uint32_t batch = state.range(2);
+    std::shared_ptr<LinearOp> op = std::make_shared<LinearOp>(in_features, out_features, true);
+    op->set_weights(RandTensor(1, out_features, in_features)->values());
+    op->set_bias(RandTensor(1, 1, out_features)->values());
+    op->set_activation(SgemmActivation::kReLU);
+    LinearLayer layer(op);
+
+    std::vector<sftensor> inputs;
+    for (uint32_t i = 0; i < batch; ++i) {
+        inputs.push_back(RandTensor(1, 1, in_features));
+    }
+    std::vector<sftensor> outputs(batch);
+    const uint64_t weights = uint64_t(in_features) * out_features;
+    BenchCounters counters(state, 2 * weights * batch,
+                           (weights + uint64_t(in_features + out_features) * batch) * sizeof(float));
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_Linear)->ArgNames({"in", "out", "batch"})->Args({512, 1000, 1})->Args({2048, 1000, 1})
+    ->Args({2048, 1000, 32})->Args({768, 3072, 8});
+
+// 参数: 通道, 输入宽高
+static void BM_MaxPooling(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+
+    std::shared_ptr<Operator> op = std::make_shared<MaxPoolingOp>(Shape(2, 2), Shape(2, 2), Shape(0, 0));
+    MaxPoolingLayer layer(op);
+    std::vector<sftensor> inputs{RandTensor(channels, size, size)};
+    std::vector<sftensor> outputs(1);
+
+    const uint64_t output_elements = uint64_t(channels) * (size / 2) * (size / 2);
+    const uint64_t input_elements = uint64_t(channels) * size * size;
+    BenchCounters counters(state, output_elements * 4, (input_elements + output_elements) * sizeof(float));
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_MaxPooling)->ArgNames({"channels", "size"})->Args({16, 112})->Args({64, 56})->Args({256, 14});
+
+// 逐元素算子，参数: 通道, 输入宽高
+template <typename LayerType>
+static void BM_Elementwise(benchmark::State &state, const std::shared_ptr<Operator> &op) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+
+    LayerType layer(op);
+    std::vector<sftensor> inputs{RandTensor(channels, size, size)};
+    std::vector<sftensor> outputs(1);
+
+    const uint64_t elements = uint64_t(channels) * size * size;
+    BenchCounters counters(state, elements, 2 * elements * sizeof(float));
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+static void BM_ReLU(benchmark::State &state) {
+    BM_Elementwise<ReLULayer>(state, std::make_shared<ReLUOperator>(0.f));
+}
+
+BENCHMARK(BM_ReLU)->ArgNames({"channels", "size"})->Args({16, 112})->Args({64, 56});
+
+static void BM_Sigmoid(benchmark::State &state) {
+    BM_Elementwise<SigmoidLayer>(state, std::make_shared<SigmoidOperator>());
+}
+
+BENCHMARK(BM_Sigmoid)->ArgNames({"channels", "size"})->Args({16, 112})->Args({64, 56});
+
+// 不能折叠到卷积里的 BatchNorm 多一遍读写，折叠后这部分开销为 0
+static void BM_BatchNorm(benchmark::State &state) {
+    const std::vector<float> statistics(state.range(0), 0.5f);
+    BM_Elementwise<BatchNormLayer>(state,
+                                   std::make_shared<BatchNormOp>(statistics, statistics, statistics, statistics, 1e-5f));
+}
+
+BENCHMARK(BM_BatchNorm)->ArgNames({"channels", "size"})->Args({16, 112})->Args({64, 56});
+
+// 参数: 通道, 输入宽高, batch
+static void BM_Expression(benchmark::State &state, const std::string &expression, uint32_t operands) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+    const uint32_t batch_size = state.range(2);
+
+    std::shared_ptr<Operator> op = std::make_shared<ExpressionOp>(expression);
+    ExpressionLayer layer(op);
+
+    // 按 @0 的整个 batch、@1 的整个 batch ... 顺序排列
+    std::vector<sftensor> inputs;
+    for (uint32_t i = 0; i < operands * batch_size; ++i) {
+        inputs.push_back(RandTensor(channels, size, size));
+    }
+    std::vector<sftensor> outputs(batch_size);
+
+    const uint64_t elements = uint64_t(channels) * size * size * batch_size;
+    BenchCounters counters(state, elements * (operands - 1), elements * (operands + 1) * sizeof(float));
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK_CAPTURE(BM_Expression, add, "add(@0,@1)", 2)
+    ->ArgNames({"channels", "size", "batch"})->Args({64, 56, 1})->Args({64, 56, 4});
+
+BENCHMARK_CAPTURE(BM_Expression, add_mul, "add(mul(@0,@1),@2)", 3)
+    ->ArgNames({"channels", "size", "batch"})->Args({64, 56, 1})->Args({64, 56, 4});
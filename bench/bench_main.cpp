@@ -0,0 +1,72 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include "bench_util.hpp"
+
+// 统计内存分配次数，替换 glibc 的分配入口后转发到 __libc_ 实现
+// AddressSanitizer 自己接管了分配函数，这时不做统计
+#if defined(__SANITIZE_ADDRESS__)
+#define KUIPER_BENCH_COUNT_ALLOCATIONS 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define KUIPER_BENCH_COUNT_ALLOCATIONS 0
+#endif
+#endif
+
+#ifndef KUIPER_BENCH_COUNT_ALLOCATIONS
+#define KUIPER_BENCH_COUNT_ALLOCATIONS 1
+#endif
+
+static std::atomic<uint64_t> kAllocationCount{0};
+
+#if KUIPER_BENCH_COUNT_ALLOCATIONS
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+void *malloc(size_t size) {
+    kAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    kAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    kAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    void *memory = __libc_memalign(alignment, size);
+    if (memory == nullptr) {
+        return ENOMEM;
+    }
+    *ptr = memory;
+    return 0;
+}
+}
+#endif
+
+namespace kuiper_infer {
+
+uint64_t AllocationCount() {
+    return kAllocationCount.load(std::memory_order_relaxed);
+}
+
+BenchCounters::BenchCounters(benchmark::State &state, uint64_t flops, uint64_t bytes)
+    : state_(state), flops_(flops), bytes_(bytes), start_allocations_(AllocationCount()) {
+}
+
+void BenchCounters::Report() {
+    const uint64_t allocations = AllocationCount() - start_allocations_;
+    const double iterations = double(state_.iterations());
+
+    // kIsRate 会除以总耗时(秒)，输出为 GFLOP/s 和 GB/s
+    state_.counters["GFLOP"] = benchmark::Counter(flops_ * iterations * 1e-9, benchmark::Counter::kIsRate);
+    state_.counters["GB"] = benchmark::Counter(bytes_ * iterations * 1e-9, benchmark::Counter::kIsRate);
+    state_.counters["allocs"] = benchmark::Counter(double(allocations), benchmark::Counter::kAvgIterations);
+}
+
+}
+
+BENCHMARK_MAIN();
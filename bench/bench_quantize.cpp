@@ -0,0 +1,157 @@
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include <cmath>
+#include "bench_util.hpp"
+#include "data/quantize.hpp"
+#include "data/tensor.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+
+using namespace kuiper_infer;
+
+// 参数: 元素个数, 是否为 int8
+static void BM_QuantizeValues(benchmark::State &state) {
+    const size_t count = state.range(0);
+    const bool is_signed = state.range(1);
+    std::vector<float> src(count);
+    for (size_t i = 0; i < count; ++i) {
+        src.at(i) = std::sin(float(i));
+    }
+    std::vector<uint8_t> dst(count);
+
+    BenchCounters counters(state, 0, count * (sizeof(float) + sizeof(uint8_t)));
+    for (auto _ : state) {
+        QuantizeValues(src.data(), dst.data(), count, 1.f / 127, is_signed ? 0 : 128, is_signed);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    counters.Report();
+}
+
+static void BM_DequantizeValues(benchmark::State &state) {
+    const size_t count = state.range(0);
+    const bool is_signed = state.range(1);
+    std::vector<uint8_t> src(count, 100);
+    std::vector<float> dst(count);
+
+    BenchCounters counters(state, 0, count * (sizeof(float) + sizeof(uint8_t)));
+    for (auto _ : state) {
+        DequantizeValues(src.data(), dst.data(), count, 1.f / 127, is_signed ? 0 : 128, is_signed);
+        benchmark::DoNotOptimize(dst.data());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_QuantizeValues)->ArgNames({"count", "signed"})->Args({1 << 20, 0})->Args({1 << 20, 1});
+BENCHMARK(BM_DequantizeValues)->ArgNames({"count", "signed"})->Args({1 << 20, 0})->Args({1 << 20, 1});
+
+// 参数: 通道, 宽高, 是否按通道量化
+static void BM_TensorQuantize(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+    sftensor tensor = std::make_shared<ftensor>(channels, size, size);
+    tensor->Rand();
+    const QuantParams &params = TensorQuantParams(tensor, state.range(2), true, true);
+
+    BenchCounters counters(state, 0, tensor->size() * (sizeof(float) + sizeof(uint8_t)));
+    for (auto _ : state) {
+        sqtensor quantized = qtensor::Quantize(*tensor, params);
+        benchmark::DoNotOptimize(quantized);
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_TensorQuantize)->ArgNames({"channels", "size", "per_channel"})->Args({64, 56, 0})->Args({64, 56, 1});
+
+// 同一个卷积的 fp32 和 int8 计算，参数: 输入通道, 输出通道, 卷积核大小, 输入宽高, 是否 int8
+static void BM_ConvInt8(benchmark::State &state) {
+    const uint32_t in_channels = state.range(0);
+    const uint32_t out_channels = state.range(1);
+    const uint32_t kernel = state.range(2);
+    const uint32_t size = state.range(3);
+    const uint32_t padding = kernel / 2;
+
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(padding, padding), true, 1);
+    std::vector<sftensor> weights;
+    std::vector<sftensor> bias;
+    for (uint32_t k = 0; k < out_channels; ++k) {
+        weights.push_back(std::make_shared<ftensor>(in_channels, kernel, kernel));
+        weights.back()->Rand();
+        bias.push_back(std::make_shared<ftensor>(1, 1, 1));
+        bias.back()->Rand();
+    }
+    conv_op->set_weights(weights);
+    conv_op->set_bias(bias);
+    if (state.range(4)) {
+        // 输入和权重都在 [0, 1) 内
+        auto uint8_params = [](float max) {
+            const auto [scale, zero_point] = ChooseQuantParams(0.f, max, false, false);
+            QuantParams params;
+            params.scales = {scale};
+            params.zero_points = {zero_point};
+            return params;
+        };
+        conv_op->EnableInt8(uint8_params(1.f), QuantParams(), uint8_params(float(in_channels * kernel * kernel)),
+                            false);
+    }
+    ConvLayer layer(conv_op);
+
+    std::vector<sftensor> inputs{std::make_shared<ftensor>(in_channels, size, size)};
+    inputs.front()->Rand();
+    std::vector<sftensor> outputs(1);
+
+    const uint64_t output_elements = uint64_t(out_channels) * size * size;
+    const uint64_t flops = 2 * output_elements * in_channels * kernel * kernel;
+    BenchCounters counters(state, flops, (uint64_t(in_channels) * size * size + output_elements) * sizeof(float));
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_ConvInt8)->ArgNames({"in_c", "out_c", "kernel", "size", "int8"})
+    ->Args({64, 64, 3, 56, 0})->Args({64, 64, 3, 56, 1})
+    ->Args({128, 128, 3, 28, 0})->Args({128, 128, 3, 28, 1})
+    ->Args({256, 256, 1, 14, 0})->Args({256, 256, 1, 14, 1});
+
+// 只量化权重的卷积，卷积核在矩阵乘里逐块反量化，参数: 输入通道, 输出通道, 输入宽高, 权重位数(0 = fp32)
+// weight_bytes 是卷积核常驻的字节数
+static void BM_ConvWeightBits(benchmark::State &state) {
+    const uint32_t in_channels = state.range(0);
+    const uint32_t out_channels = state.range(1);
+    const uint32_t size = state.range(2);
+    const uint32_t bits = state.range(3);
+
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(1, 1), false, 1);
+    conv_op->set_weight_bits(bits);
+    std::vector<sftensor> weights;
+    for (uint32_t k = 0; k < out_channels; ++k) {
+        weights.push_back(std::make_shared<ftensor>(in_channels, 3, 3));
+        weights.back()->Rand();
+    }
+    conv_op->set_weights(weights);
+    weights.clear();
+    ConvLayer layer(conv_op);
+
+    std::vector<sftensor> inputs{std::make_shared<ftensor>(in_channels, size, size)};
+    inputs.front()->Rand();
+    std::vector<sftensor> outputs(1);
+
+    const uint64_t weight_bytes = bits == 0 ? uint64_t(out_channels) * in_channels * 9 * sizeof(float)
+                                            : conv_op->get_quantized_weights()->data.size() +
+                                                  conv_op->get_quantized_weights()->scales.size() * sizeof(float);
+    const uint64_t output_elements = uint64_t(out_channels) * size * size;
+    const uint64_t flops = 2 * output_elements * in_channels * 9;
+    BenchCounters counters(state, flops,
+                           (uint64_t(in_channels) * size * size + output_elements) * sizeof(float) + weight_bytes);
+    for (auto _ : state) {
+        layer.Forward(inputs, outputs);
+        benchmark::DoNotOptimize(outputs.front());
+    }
+    counters.Report();
+    state.counters["weight_bytes"] = double(weight_bytes);
+}
+
+BENCHMARK(BM_ConvWeightBits)->ArgNames({"in_c", "out_c", "size", "bits"})
+    ->Args({64, 64, 56, 0})->Args({64, 64, 56, 8})->Args({64, 64, 56, 4})
+    ->Args({256, 256, 14, 0})->Args({256, 256, 14, 8})->Args({256, 256, 14, 4});
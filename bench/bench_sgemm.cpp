@@ -0,0 +1,81 @@
+#include <armadillo>
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include "bench_util.hpp"
+#include "data/cpu_isa.hpp"
+#include "data/sgemm.hpp"
+
+using namespace kuiper_infer;
+
+// 模型里实际出现的矩阵乘形状，m 是输出位置数(卷积)或 batch(全连接)，n 是输出通道，k 是卷积核元素数
+// resnet18 224x224 的各级 3x3 卷积和第一层 7x7 卷积，yolov5s 640x640 的前几层，以及全连接层
+static const std::vector<std::vector<int64_t>> kModelShapes = {
+    {12544, 64, 147}, {3136, 64, 576}, {784, 128, 1152}, {196, 256, 2304}, {49, 512, 4608},
+    {102400, 32, 27}, {25600, 64, 288}, {6400, 128, 576}, {1, 1000, 512}, {8, 1000, 2048},
+};
+
+static uint64_t GemmFlops(const benchmark::State &state) {
+    return 2 * uint64_t(state.range(0)) * state.range(1) * state.range(2);
+}
+
+static uint64_t GemmBytes(const benchmark::State &state) {
+    const uint64_t m = state.range(0), n = state.range(1), k = state.range(2);
+    return (m * k + k * n + m * n) * sizeof(float);
+}
+
+// 链接的 BLAS(通过 armadillo)
+static void BM_GemmBlas(benchmark::State &state) {
+    const uint32_t m = state.range(0), n = state.range(1), k = state.range(2);
+    arma::fmat a(m, k);
+    arma::fmat b(k, n);
+    a.randu();
+    b.randu();
+    arma::fmat c(m, n);
+    BenchCounters counters(state, GemmFlops(state), GemmBytes(state));
+    for (auto _ : state) {
+        c = a * b;
+        benchmark::DoNotOptimize(c.memptr());
+    }
+    counters.Report();
+}
+
+// 预打包 B 的 Sgemm，和卷积层使用的方式一致
+static void BM_GemmSgemm(benchmark::State &state) {
+    const uint32_t m = state.range(0), n = state.range(1), k = state.range(2);
+    arma::fmat a(m, k);
+    arma::fmat b(k, n);
+    a.randu();
+    b.randu();
+    arma::fmat c(m, n);
+    const PackedSgemmMatrix packed = PackSgemmMatrix(b.memptr(), k, k, n);
+    state.SetLabel(CpuIsaName(ActiveCpuIsa()));
+    BenchCounters counters(state, GemmFlops(state), GemmBytes(state));
+    for (auto _ : state) {
+        Sgemm(m, a.memptr(), m, packed, c.memptr(), m);
+        benchmark::DoNotOptimize(c.memptr());
+    }
+    counters.Report();
+}
+
+// 各个指令集版本的微内核，参数: m, n, k, 指令集(0 = scalar, 1 = avx2, 2 = avx512)
+static void BM_SgemmIsa(benchmark::State &state) {
+    const CpuIsa isa = CpuIsa(state.range(3));
+    if (int(isa) > int(DetectCpuIsa())) {
+        state.SkipWithError("isa is not supported by this cpu");
+        return;
+    }
+    const CpuIsa active = ActiveCpuIsa();
+    SetActiveCpuIsa(isa);
+    BM_GemmSgemm(state);
+    SetActiveCpuIsa(active);
+}
+
+static void ModelShapes(benchmark::internal::Benchmark *bench) {
+    for (const std::vector<int64_t> &shape : kModelShapes) {
+        bench->Args(shape);
+    }
+}
+
+BENCHMARK(BM_GemmBlas)->ArgNames({"m", "n", "k"})->Apply(ModelShapes);
+BENCHMARK(BM_GemmSgemm)->ArgNames({"m", "n", "k"})->Apply(ModelShapes);
+BENCHMARK(BM_SgemmIsa)->ArgNames({"m", "n", "k", "isa"})->ArgsProduct({{3136}, {64}, {576}, {0, 1, 2}});
@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+#include "bench_util.hpp"
+#include "data/tensor.hpp"
+#include "data/tensor_util.hpp"
+
+using namespace kuiper_infer;
+
+// 参数: 通道, 输入宽高, 填充大小
+static void BM_TensorPadding(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+    const uint32_t pad = state.range(2);
+
+    sftensor tensor = std::make_shared<ftensor>(channels, size, size);
+    tensor->Rand();
+
+    const uint64_t input_elements = uint64_t(channels) * size * size;
+    const uint64_t output_elements = uint64_t(channels) * (size + 2 * pad) * (size + 2 * pad);
+    BenchCounters counters(state, 0, (input_elements + output_elements) * sizeof(float));
+    for (auto _ : state) {
+        sftensor output = TensorPadding(tensor, {pad, pad, pad, pad}, 0.f);
+        benchmark::DoNotOptimize(output);
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_TensorPadding)->ArgNames({"channels", "size", "pad"})
+    ->Args({3, 224, 1})->Args({64, 56, 1})->Args({64, 56, 3});
+
+// (channels, size, size) 和 (channels, 1, 1) 广播
+static void BM_TensorBroadcast(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t size = state.range(1);
+
+    sftensor tensor1 = std::make_shared<ftensor>(channels, size, size);
+    sftensor tensor2 = std::make_shared<ftensor>(channels, 1, 1);
+    tensor1->Rand();
+    tensor2->Rand();
+
+    const uint64_t elements = uint64_t(channels) * size * size;
+    BenchCounters counters(state, 0, 2 * elements * sizeof(float));
+    for (auto _ : state) {
+        const auto &[output1, output2] = TensorBroadcast(tensor1, tensor2);
+        benchmark::DoNotOptimize(output1);
+        benchmark::DoNotOptimize(output2);
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_TensorBroadcast)->ArgNames({"channels", "size"})
+    ->Args({64, 56})->Args({256, 14});
+
+// 行主序 reshape，在 (channels, rows, cols) 和 (channels, cols, rows) 之间来回切换
+static void BM_TensorReshapeRowMajor(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t rows = state.range(1);
+    const uint32_t cols = state.range(2);
+
+    Tensor<float> tensor(channels, rows, cols);
+    tensor.Rand();
+
+    const uint64_t elements = uint64_t(channels) * rows * cols;
+    bool transposed = false;
+    BenchCounters counters(state, 0, 2 * elements * sizeof(float));
+    for (auto _ : state) {
+        if (transposed) {
+            tensor.Reshape({channels, rows, cols}, true);
+        } else {
+            tensor.Reshape({channels, cols, rows}, true);
+        }
+        transposed = !transposed;
+        benchmark::DoNotOptimize(tensor.raw_ptr());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_TensorReshapeRowMajor)->ArgNames({"channels", "rows", "cols"})
+    ->Args({3, 224, 224})->Args({64, 56, 28});
+
+// 行主序导入导出，参数: 通道, 行, 列，默认是预处理常见的 3x1080x1920
+static void BM_TensorFillRowMajor(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t rows = state.range(1);
+    const uint32_t cols = state.range(2);
+
+    Tensor<float> tensor(channels, rows, cols);
+    tensor.Rand();
+    const std::vector<float> &values = tensor.values(true);
+
+    const uint64_t elements = uint64_t(channels) * rows * cols;
+    BenchCounters counters(state, 0, 2 * elements * sizeof(float));
+    for (auto _ : state) {
+        tensor.Fill(values, true);
+        benchmark::DoNotOptimize(tensor.raw_ptr());
+    }
+    counters.Report();
+}
+
+static void BM_TensorValuesRowMajor(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t rows = state.range(1);
+    const uint32_t cols = state.range(2);
+
+    Tensor<float> tensor(channels, rows, cols);
+    tensor.Rand();
+
+    const uint64_t elements = uint64_t(channels) * rows * cols;
+    BenchCounters counters(state, 0, 2 * elements * sizeof(float));
+    for (auto _ : state) {
+        const std::vector<float> &values = tensor.values(true);
+        benchmark::DoNotOptimize(values.data());
+    }
+    counters.Report();
+}
+
+// 参照: 逐通道构造 fmat 再 .t()，分块转置之前 Fill(values, true) 的做法
+static void BM_TensorFillRowMajorArma(benchmark::State &state) {
+    const uint32_t channels = state.range(0);
+    const uint32_t rows = state.range(1);
+    const uint32_t cols = state.range(2);
+
+    Tensor<float> tensor(channels, rows, cols);
+    tensor.Rand();
+    const std::vector<float> &values = tensor.values(true);
+
+    const uint64_t elements = uint64_t(channels) * rows * cols;
+    BenchCounters counters(state, 0, 2 * elements * sizeof(float));
+    for (auto _ : state) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            const arma::fmat channel_data(values.data() + size_t(c) * rows * cols, cols, rows);
+            tensor.slice(c) = channel_data.t();
+        }
+        benchmark::DoNotOptimize(tensor.raw_ptr());
+    }
+    counters.Report();
+}
+
+BENCHMARK(BM_TensorFillRowMajor)->ArgNames({"channels", "rows", "cols"})
+    ->Args({3, 1080, 1920})->Args({3, 224, 224})->UseRealTime();
+BENCHMARK(BM_TensorValuesRowMajor)->ArgNames({"channels", "rows", "cols"})
+    ->Args({3, 1080, 1920})->Args({3, 224, 224})->UseRealTime();
+BENCHMARK(BM_TensorFillRowMajorArma)->ArgNames({"channels", "rows", "cols"})
+    ->Args({3, 1080, 1920})->Args({3, 224, 224})->UseRealTime();
@@ -0,0 +1,30 @@
+#ifndef KUIPER_INFER_BENCH_BENCH_UTIL_HPP
+#define KUIPER_INFER_BENCH_BENCH_UTIL_HPP
+
+#include <cstdint>
+#include <benchmark/benchmark.h>
+
+namespace kuiper_infer {
+
+// 进程启动以来 malloc / calloc / posix_memalign 的调用次数
+// armadillo 和 operator new 的分配都会经过这里
+uint64_t AllocationCount();
+
+// 在 state 的循环开始前创建，循环结束后调用 Report
+// 输出 GFLOP/s、GB/s 和每次迭代的内存分配次数
+class BenchCounters {
+public:
+    BenchCounters(benchmark::State &state, uint64_t flops, uint64_t bytes);
+
+    void Report();
+
+private:
+    benchmark::State &state_;
+    uint64_t flops_ = 0; // 一次迭代的浮点运算次数
+    uint64_t bytes_ = 0; // 一次迭代读写的字节数
+    uint64_t start_allocations_ = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef KUIPER_INFER_DATA_BATCH_TENSOR_HPP
+#define KUIPER_INFER_DATA_BATCH_TENSOR_HPP
+
+#include <memory>
+#include <vector>
+#include "data/tensor.hpp"
+#include "data/tensor_view.hpp"
+
+namespace kuiper_infer {
+
+// 连续存储的 NCHW batch 张量，整个 batch 只有一次内存分配
+// 底层是一个 (N * C, H, W) 的 Tensor<float>，第 n 个 batch 元素是第 [n * C, (n + 1) * C) 个通道
+// 每个通道和 Tensor<float> 一样是列主序，层可以把整个 batch 当作一段连续内存做逐元素计算或一次 GEMM
+//
+// 复制 BatchTensor 只复制引用，和 sftensor 一样共享数据
+class BatchTensor {
+
+public:
+    BatchTensor() = default;
+
+    BatchTensor(uint32_t batch, uint32_t channels, uint32_t rows, uint32_t cols);
+
+    // shape 为 NCHW
+    explicit BatchTensor(const std::vector<uint32_t>& shape);
+
+    // 直接使用已有的 (N * C, H, W) 张量，不复制
+    BatchTensor(uint32_t batch, std::shared_ptr<Tensor<float>> data);
+
+    // 旧接口的适配，把多个形状相同的张量复制到一块连续内存
+    static BatchTensor FromVector(const std::vector<std::shared_ptr<Tensor<float>>>& tensors);
+
+    // 旧接口的适配，每个 batch 元素直接使用 batch 的内存，不复制
+    std::vector<std::shared_ptr<Tensor<float>>> ToVector() const;
+
+    uint32_t batch() const;
+
+    uint32_t channels() const;
+
+    uint32_t rows() const;
+
+    uint32_t cols() const;
+
+    // 所有 batch 元素的元素个数
+    uint32_t size() const;
+
+    bool empty() const;
+
+    // 返回形状 - NCHW
+    std::vector<uint32_t> shape() const;
+
+    // 第 index 个 batch 元素，不复制
+    std::shared_ptr<Tensor<float>> Batch(uint32_t index) const;
+
+    // 整个 batch 的视图
+    TensorView view() const;
+
+    // 整个 batch 对应的 (N * C, H, W) 张量
+    const std::shared_ptr<Tensor<float>>& data() const;
+
+    float* raw_ptr() const;
+
+    float& at(uint32_t batch, uint32_t channel, uint32_t row, uint32_t col) const;
+
+private:
+    uint32_t batch_ = 0;
+    uint32_t channels_ = 0;
+    std::shared_ptr<Tensor<float>> data_;
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef KUIPER_INFER_DATA_CPU_ISA_HPP
+#define KUIPER_INFER_DATA_CPU_ISA_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 热点内核的多个指令集版本在同一个编译单元里用函数级别的 target 属性编译，不依赖 -march
+// 运行时按 cpuid 检测的结果选择，一个二进制在老机器上用标量版本，在新机器上用 AVX-512
+#if defined(__x86_64__) || defined(__i386__)
+#define KUIPER_X86 1
+#define KUIPER_TARGET_AVX2 __attribute__((target("avx2,fma,f16c")))
+#define KUIPER_TARGET_AVX512 \
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx2,fma,f16c,prefer-vector-width=512")))
+#define KUIPER_TARGET_AVX512_VNNI \
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx512vnni,avx2,fma,f16c")))
+#define KUIPER_TARGET_AVX512_BF16 \
+    __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx512bf16,avx2,fma,f16c")))
+#endif
+
+// 标量代码的函数体，内联到各个指令集的版本里，由编译器按目标指令集自动向量化
+#define KUIPER_ALWAYS_INLINE inline __attribute__((always_inline))
+
+namespace kuiper_infer {
+
+// 内核使用的指令集，按能力从低到高排列
+enum class CpuIsa {
+    kScalar = 0, // 编译器的基础指令集，x86-64 上是 SSE2
+    kAVX2 = 1, // AVX2 + FMA + F16C
+    kAVX512 = 2, // AVX-512 F/BW/VL/DQ
+};
+
+constexpr uint32_t kCpuIsaCount = 3;
+
+// cpuid 检测到的特性，同时确认了操作系统会保存对应的寄存器状态
+struct CpuFeatures {
+    bool avx2 = false; // 包括 FMA 和 F16C
+    bool avx512 = false; // F/BW/VL/DQ
+    bool avx512_vnni = false;
+    bool avx512_bf16 = false;
+};
+
+const CpuFeatures& GetCpuFeatures();
+
+// cpuid 的处理器品牌字符串，例如 "Intel(R) Xeon(R) Platinum 8375C CPU @ 2.90GHz"，读取失败时为 "unknown"
+const std::string& CpuModelName();
+
+// CPU 支持的最高指令集
+CpuIsa DetectCpuIsa();
+
+// 内核实际使用的指令集，第一次调用时确定，默认为 DetectCpuIsa()
+// 环境变量 KUIPER_CPU_ISA=scalar|avx2|avx512 可以指定更低的指令集，超过 CPU 支持的部分被忽略
+CpuIsa ActiveCpuIsa();
+
+// 修改内核使用的指令集，用于测试和基准测试比较各个版本，超过 CPU 支持的指令集时 CHECK 失败
+void SetActiveCpuIsa(CpuIsa isa);
+
+const char* CpuIsaName(CpuIsa isa);
+
+bool ParseCpuIsa(const std::string& name, CpuIsa& isa);
+
+// 注册表里的一个内核和它的各个版本
+struct KernelInfo {
+    std::string name;
+    std::vector<CpuIsa> variants; // 从低到高
+};
+
+// 所有注册过的内核，按名字排序
+std::vector<KernelInfo> RegisteredKernels();
+
+void RegisterKernelVariant(const std::string& name, CpuIsa isa);
+
+// 一个热点内核的各个指令集版本，按 ActiveCpuIsa() 选择不超过它的最高版本
+// 用法: static const IsaKernel<Fn> kKernel = IsaKernel<Fn>("name", Scalar).Add(CpuIsa::kAVX2, Avx2);
+//      kKernel.get()(args...);
+// 每次调用只是查一次表，调用方按块调用，不在逐个元素的循环里选择
+template <typename Fn>
+class IsaKernel {
+public:
+    IsaKernel(const char* name, Fn scalar) : name_(name) {
+        this->variants_[0] = scalar;
+        RegisterKernelVariant(name, CpuIsa::kScalar);
+    }
+
+    // fn 为空时忽略，用于依赖额外特性(例如 VNNI)的版本
+    IsaKernel& Add(CpuIsa isa, Fn fn) {
+        if (fn != nullptr) {
+            this->variants_[uint32_t(isa)] = fn;
+            RegisterKernelVariant(this->name_, isa);
+        }
+        return *this;
+    }
+
+    Fn Select(CpuIsa isa) const {
+        for (int i = int(isa); i > 0; --i) {
+            if (this->variants_[i] != nullptr) {
+                return this->variants_[i];
+            }
+        }
+        return this->variants_[0];
+    }
+
+    Fn get() const {
+        return Select(ActiveCpuIsa());
+    }
+
+private:
+    const char* name_;
+    Fn variants_[kCpuIsaCount] = {};
+};
+
+}
+
+#endif
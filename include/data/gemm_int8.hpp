@@ -0,0 +1,52 @@
+#ifndef KUIPER_INFER_DATA_GEMM_INT8_HPP
+#define KUIPER_INFER_DATA_GEMM_INT8_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kuiper_infer {
+
+// 预打包的 int8 矩阵 B (k, n)，每一列是一个输出通道
+// 按 u8 x s8 点积指令(vpdpbusd / vpmaddubsw)的布局排列:
+// 输出通道每 kPackN 个一块，块内 K 方向每 4 个一组，一组里每个通道的 4 个 int8 连续存放
+// K 补齐到 4 的倍数，输出通道补齐到 kPackN 的倍数，补齐的位置为 0
+struct PackedInt8Matrix {
+    static constexpr uint32_t kPackN = 16;
+
+    uint32_t k = 0; // 打包前的 K
+    uint32_t k_padded = 0; // 补齐到 4 的倍数
+    uint32_t n = 0; // 输出通道数
+    std::vector<int8_t> data;
+    std::vector<int32_t> column_sums; // 每个输出通道的权重之和，用来扣除输入的零点
+
+    bool empty() const;
+};
+
+// weights 是 (n, k) 的行主序 int8 矩阵，每一行是一个输出通道
+PackedInt8Matrix PackInt8Matrix(const int8_t* weights, uint32_t n, uint32_t k);
+
+// int32 累加结果按输出通道的后处理，在写出之前完成:
+// y = (acc - input_zero_point * column_sum) * scale + bias，relu 之后按输出参数重新量化为 uint8
+struct Int8Epilogue {
+    std::vector<float> scales; // 每个输出通道 input_scale * weight_scale
+    std::vector<float> bias; // 为空时没有 bias
+    int32_t input_zero_point = 0;
+    bool relu = false;
+    float output_scale = 1.f;
+    int32_t output_zero_point = 0;
+};
+
+// C = epilogue(A * B)，A 是 uint8，B 是 int8，累加为 int32
+// A 是 (m, b.k_padded) 的行主序矩阵，每一行是一个输出位置，行距为 lda，补齐的列可以是任意值
+// 第 j 个输出通道的 m 个结果写到 c + j * ldc，即列主序的 (m, n) uint8 矩阵
+// 运行时按 CPU 选择: AVX-512 VNNI 时用 vpdpbusd，AVX2 时用 vpmaddubsw，否则用标量实现，结果完全一致
+void GemmU8S8(const uint8_t* a, size_t lda, uint32_t m, const PackedInt8Matrix& b, const Int8Epilogue& epilogue,
+              uint8_t* c, size_t ldc);
+
+// 只做乘法，int32 结果按列主序写到 c，第 j 列从 c + j * ldc 开始，用于测试和调试
+void GemmU8S8(const uint8_t* a, size_t lda, uint32_t m, const PackedInt8Matrix& b, int32_t* c, size_t ldc);
+
+}
+
+#endif
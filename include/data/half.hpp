@@ -0,0 +1,34 @@
+#ifndef KUIPER_INFER_DATA_HALF_HPP
+#define KUIPER_INFER_DATA_HALF_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kuiper_infer {
+
+// 半精度的存储类型，计算时都转换为 fp32
+enum class HalfType {
+    kFloat16 = 0, // IEEE 754 binary16，精度高，范围小(最大 65504)
+    kBFloat16 = 1, // fp32 的高 16 位，范围和 fp32 相同，尾数只有 7 位
+};
+
+const char* HalfTypeName(HalfType type);
+
+// 单个元素的转换，舍入方式都是就近舍入到偶数
+uint16_t FloatToFp16(float value);
+
+float Fp16ToFloat(uint16_t value);
+
+uint16_t FloatToBf16(float value);
+
+float Bf16ToFloat(uint16_t value);
+
+// 批量转换，按 CPU 选择版本：AVX2(F16C) 时一次转换 8 个，AVX-512 时一次转换 16 个
+// fp32 到 bf16 只在支持 AVX-512 BF16 时向量化，这条指令把 fp32 的非规格化数当作 0
+void ConvertToHalf(const float* src, uint16_t* dst, size_t count, HalfType type);
+
+void ConvertFromHalf(const uint16_t* src, float* dst, size_t count, HalfType type);
+
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef KUIPER_INFER_DATA_HALF_TENSOR_HPP
+#define KUIPER_INFER_DATA_HALF_TENSOR_HPP
+
+#include <memory>
+#include <vector>
+#include "data/half.hpp"
+#include "data/tensor.hpp"
+
+namespace kuiper_infer {
+
+// 半精度(fp16 或 bf16)存储的张量 - CHW
+// 元素排布和 Tensor<float> 一致，每个通道是列主序的，内存来自 TensorAllocator
+// 只负责存储，计算时按块转换为 fp32，内存占用和带宽都是 Tensor<float> 的一半
+//
+// 复制 HalfTensor 只复制引用，和 sftensor 一样共享数据
+class HalfTensor {
+
+public:
+    HalfTensor() = default;
+
+    // 内存不初始化
+    HalfTensor(uint32_t channels, uint32_t rows, uint32_t cols, HalfType type);
+
+    // 从 fp32 张量转换
+    static std::shared_ptr<HalfTensor> FromFloat(const Tensor<float>& tensor, HalfType type);
+
+    // 转换为 fp32 张量
+    std::shared_ptr<Tensor<float>> ToFloat() const;
+
+    // 按元素下标(列主序)转换 [offset, offset + count) 的元素到 dst
+    void Load(size_t offset, size_t count, float* dst) const;
+
+    // 把 src 的 count 个元素转换后写到 [offset, offset + count)
+    void Store(size_t offset, size_t count, const float* src);
+
+    uint32_t channels() const;
+
+    uint32_t rows() const;
+
+    uint32_t cols() const;
+
+    // 元素个数
+    uint32_t size() const;
+
+    bool empty() const;
+
+    // 返回形状 - CHW
+    std::vector<uint32_t> shape() const;
+
+    HalfType type() const;
+
+    uint16_t* raw_ptr() const;
+
+private:
+    std::shared_ptr<uint16_t> data_;
+    uint32_t channels_ = 0;
+    uint32_t rows_ = 0;
+    uint32_t cols_ = 0;
+    HalfType type_ = HalfType::kFloat16;
+};
+
+using shtensor = std::shared_ptr<HalfTensor>;
+
+}
+
+#endif
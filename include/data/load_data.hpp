@@ -11,6 +11,9 @@ public:
 // 从csv文件里读取','隔开的数据并存入fmat
     static arma::fmat LoadData(const std::string &file_path, char split_char = ',');
 
+// 将fmat按行写入csv文件，LoadData可以读回
+    static bool SaveData(const std::string &file_path, const arma::fmat &data, char split_char = ',');
+
 
 private:
 // 文件里fmat的大小
@@ -0,0 +1,55 @@
+#ifndef KUIPER_INFER_DATA_QUANTIZE_HPP
+#define KUIPER_INFER_DATA_QUANTIZE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kuiper_infer {
+
+// 8bit 仿射量化的参数，real = scale * (q - zero_point)
+// scales 只有一个时整个张量共用，否则每个通道一个
+struct QuantParams {
+    std::vector<float> scales;
+    std::vector<int32_t> zero_points; // 和 scales 一一对应
+    bool is_signed = false; // true 时数据按 int8 [-128, 127] 解释，否则是 uint8 [0, 255]
+
+    bool per_channel() const;
+
+    // 第 channel 个通道的参数，按张量量化时所有通道相同
+    float scale(uint32_t channel) const;
+
+    int32_t zero_point(uint32_t channel) const;
+
+    int32_t qmin() const;
+
+    int32_t qmax() const;
+
+    bool operator==(const QuantParams& other) const;
+
+    bool operator!=(const QuantParams& other) const;
+};
+
+// 根据取值范围选择 scale 和 zero_point，范围总会扩展到包含 0，保证 0 能精确表示
+// symmetric 为 true 时 zero_point 固定(int8 为 0，uint8 为 128)，卷积核等权重一般使用对称量化
+std::pair<float, int32_t> ChooseQuantParams(float min, float max, bool is_signed, bool symmetric);
+
+// q = clamp(round(x / scale) + zero_point, qmin, qmax)，舍入方式为就近舍入到偶数
+// 按 CPU 选择 AVX-512 / AVX2 / 标量版本，结果完全一致
+void QuantizeValues(const float* src, uint8_t* dst, size_t count, float scale, int32_t zero_point, bool is_signed);
+
+// x = scale * (q - zero_point)
+void DequantizeValues(const uint8_t* src, float* dst, size_t count, float scale, int32_t zero_point, bool is_signed);
+
+// 对称 int4 量化，q = clamp(round(x / scale), -7, 7)，两个值打包为一个字节，低 4 位在前
+// dst 需要 (count + 1) / 2 个字节，count 为奇数时最后一个字节的高 4 位为 0
+void QuantizeInt4Values(const float* src, uint8_t* dst, size_t count, float scale);
+
+// x = scale * q，从 src 的第 0 个值开始解包 count 个
+// 支持 AVX2 时一次解包 8 个，按 CPU 选择版本
+void DequantizeInt4Values(const uint8_t* src, float* dst, size_t count, float scale);
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef KUIPER_INFER_DATA_SGEMM_HPP
+#define KUIPER_INFER_DATA_SGEMM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// 不依赖 BLAS 的 fp32 矩阵乘，矩阵都是列主序，和 armadillo 的排布一致
+// 按 GotoBLAS 的方式分块: B 按 kKC 行一段、kNR 列一条打包，A 的 kMC 行 x kKC 列一块打包后留在 L2 里，
+// 微内核每次计算 MR x kNR 的结果块，MR 按指令集选择(标量 8，AVX2 16，AVX-512 32)
+// 输出位置(M)多时线程按 M 分块，共享打包好的 B；M 太小(例如全连接层的 batch)时再按 N 切分
+// M 不超过 4 时不补齐到 MR 行，直接流式读取打包好的 B 计算
+namespace kuiper_infer {
+
+// 预打包的 B (k, n)，一般是权重，打包一次后多次使用
+// 先按 K 每 kKC 行分段，段内每 kNR 列一条，条内按行存放 kNR 个元素，列补齐到 kNR 的倍数，补齐的位置为 0
+struct PackedSgemmMatrix {
+    static constexpr uint32_t kNR = 12;
+    static constexpr uint32_t kKC = 256;
+
+    uint32_t k = 0;
+    uint32_t n = 0;
+    uint32_t n_padded = 0; // 补齐到 kNR 的倍数
+    std::vector<float> data;
+
+    bool empty() const;
+};
+
+// b 是列主序的 (k, n) 矩阵，第 j 列从 b + j * ldb 开始
+PackedSgemmMatrix PackSgemmMatrix(const float* b, size_t ldb, uint32_t k, uint32_t n);
+
+// 加上 bias 之后的激活函数
+enum class SgemmActivation {
+    kNone = 0,
+    kReLU = 1,
+    kSigmoid = 2,
+};
+
+// 写回 C 之前的后处理，在结果块还在 L1 里时完成
+struct SgemmEpilogue {
+    const float* bias = nullptr; // 为空时没有 bias，否则第 j 列加上 bias[j]
+    SgemmActivation activation = SgemmActivation::kNone;
+};
+
+// C = A * B (+ bias)，A 是 (m, b.k)，第 p 列从 a + p * lda 开始；C 是 (m, b.n)，第 j 列从 c + j * ldc 开始
+// C 不能和 A、B 重叠
+void Sgemm(uint32_t m, const float* a, size_t lda, const PackedSgemmMatrix& b, float* c, size_t ldc,
+           const SgemmEpilogue& epilogue = SgemmEpilogue());
+
+// B 没有预打包时先打包再计算，打包的开销是矩阵乘的 1 / (2m)
+void Sgemm(uint32_t m, uint32_t n, uint32_t k, const float* a, size_t lda, const float* b, size_t ldb, float* c,
+           size_t ldc, const SgemmEpilogue& epilogue = SgemmEpilogue());
+
+// 隐式 GEMM 的 A 不在内存里，计算时一块一块生成，用于卷积时不展开整个 im2col 矩阵
+// pack(first_row, rows, first_col, cols, mr, packed) 把 A 的 rows 行 x cols 列按 mr 行一条写到 packed:
+// 第 r 行第 p 列写到 packed[(r / mr) * mr * cols + p * mr + r % mr]，最后一条不足 mr 行的部分填 0
+// 一块最多 256 x kKC 个元素，每个线程一块缓冲区，生成的块留在 L2 里直接交给微内核
+using SgemmPackA = std::function<void(uint32_t first_row, uint32_t rows, uint32_t first_col, uint32_t cols,
+                                      uint32_t mr, float* packed)>;
+
+// C = A * B (+ bias)，A 是 (m, b.k)，由 pack_a 生成，可能被多个线程同时调用
+void SgemmImplicit(uint32_t m, const SgemmPackA& pack_a, const PackedSgemmMatrix& b, float* c, size_t ldc,
+                   const SgemmEpilogue& epilogue = SgemmEpilogue());
+
+}
+
+#endif
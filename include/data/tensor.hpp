@@ -4,6 +4,7 @@
 #include <memory>
 #include <vector>
 #include <armadillo>
+#include "data/quantize.hpp"
 
 namespace kuiper_infer {
 
@@ -12,9 +13,60 @@ template <typename T>
 class Tensor {
 };
 
-// 量化 8bit 待实现
+// 8bit 量化张量 - CHW
+// 元素排布和 Tensor<float> 一致，每个通道是列主序的，内存来自 TensorAllocator
+// 量化参数可以是整个张量一个，也可以每个通道一个，params.is_signed 为 true 时数据按 int8 解释
+//
+// 复制只复制引用，和 sftensor 一样共享数据
 template <>
-class Tensor<uint8_t> {    
+class Tensor<uint8_t> {
+public:
+    explicit Tensor() = default;
+
+    // 构造函数 - CHW，内存不初始化
+    explicit Tensor(uint32_t channels, uint32_t rows, uint32_t cols, const QuantParams& params);
+
+    // 按 params 量化 fp32 张量，按通道量化时参数个数必须等于通道数
+    static std::shared_ptr<Tensor<uint8_t>> Quantize(const Tensor<float>& tensor, const QuantParams& params);
+
+    // 反量化为 fp32 张量
+    std::shared_ptr<Tensor<float>> Dequantize() const;
+
+    uint32_t channels() const;
+
+    uint32_t rows() const;
+
+    uint32_t cols() const;
+
+    // 元素个数
+    uint32_t size() const;
+
+    bool empty() const;
+
+    // 返回形状 - CHW
+    std::vector<uint32_t> shape() const;
+
+    const QuantParams& params() const;
+
+    // 按列主序的下标访问原始数据
+    uint8_t& index(uint32_t offset);
+
+    uint8_t index(uint32_t offset) const;
+
+    // 元素的整数值，int8 时带符号
+    int32_t value(uint32_t channel, uint32_t row, uint32_t col) const;
+
+    // 第 channel 个通道的起始地址
+    uint8_t* slice_ptr(uint32_t channel) const;
+
+    uint8_t* raw_ptr() const;
+
+private:
+    std::shared_ptr<uint8_t> data_;
+    uint32_t channels_ = 0;
+    uint32_t rows_ = 0;
+    uint32_t cols_ = 0;
+    QuantParams params_;
 };
 
 
@@ -29,6 +81,10 @@ public:
 
     explicit Tensor(const std::vector<uint32_t>& shape);
 
+    // 构造函数 - CHW，直接使用外部内存，不复制也不释放
+    // 外部内存按列主序排布，调用者保证它比张量活得更久
+    explicit Tensor(float* raw_ptr, uint32_t channels, uint32_t rows, uint32_t cols);
+
     // 构造函数 - 用已知 Tensor 赋值
     Tensor(const Tensor& tensor);
 
@@ -126,6 +182,8 @@ private:
 
 using ftensor = Tensor<float>;
 using sftensor = std::shared_ptr<Tensor<float>>;
+using qtensor = Tensor<uint8_t>;
+using sqtensor = std::shared_ptr<Tensor<uint8_t>>;
 
 } // namespace kuiper_infer
 
@@ -0,0 +1,104 @@
+#ifndef KUIPER_INFER_DATA_TENSOR_ALLOCATOR_HPP
+#define KUIPER_INFER_DATA_TENSOR_ALLOCATOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace kuiper_infer {
+
+// 分配器的统计信息
+struct AllocatorStats {
+    uint64_t hits = 0; // 从缓存中分配的次数
+    uint64_t misses = 0; // 向系统申请内存的次数
+    uint64_t bytes_in_use = 0; // 正在被张量使用的字节数
+    uint64_t bytes_cached = 0; // 缓存中空闲的字节数
+};
+
+// 张量内存的分配器，TensorCreate 创建的张量从当前分配器获取内存
+// 释放时需要传入分配时的大小
+class TensorAllocator {
+
+public:
+    virtual ~TensorAllocator() = default;
+
+    virtual void* Allocate(size_t bytes) = 0;
+
+    virtual void Free(void* ptr, size_t bytes) = 0;
+
+    virtual AllocatorStats stats() const = 0;
+
+    // 带标记的申请和释放，tag 描述释放时内存里仍然有效的内容(例如张量的边框)
+    // 缓存里有相同标记的内存时优先返回它并把 *reused 设为 true，调用方可以跳过初始化
+    // 默认实现不保留标记，*reused 总是 false
+    virtual void* AllocateTagged(size_t bytes, uint64_t tag, bool* reused);
+
+    virtual void FreeTagged(void* ptr, size_t bytes, uint64_t tag);
+
+    // 当前使用的分配器，默认是 PoolAllocator
+    static std::shared_ptr<TensorAllocator> Get();
+
+    // 替换分配器，已经创建的张量仍然归还给原来的分配器
+    static void Set(std::shared_ptr<TensorAllocator> allocator);
+};
+
+// 64 字节对齐的内存池
+// 申请的大小向上取整到尺寸等级(每个 2 的幂之间分 4 级)，释放的内存放回当前线程的空闲链表
+// 同一尺寸再次申请时直接复用，不需要加锁，多个推理线程之间没有竞争
+// 空闲链表里的内存带有释放时的标记，普通的申请会清除标记
+// 大块内存可以开启透明大页 madvise(MADV_HUGEPAGE)
+class PoolAllocator : public TensorAllocator {
+
+public:
+    static constexpr size_t kAlignment = 64;
+
+    static constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+    // 每个线程缓存的空闲内存上限，超过后直接还给系统
+    static constexpr size_t kMaxCachedBytesPerThread = 256 * 1024 * 1024;
+
+    // 进程内只有一个内存池，线程缓存是 thread_local 的
+    static std::shared_ptr<PoolAllocator> Instance();
+
+    void* Allocate(size_t bytes) override;
+
+    void Free(void* ptr, size_t bytes) override;
+
+    void* AllocateTagged(size_t bytes, uint64_t tag, bool* reused) override;
+
+    void FreeTagged(void* ptr, size_t bytes, uint64_t tag) override;
+
+    AllocatorStats stats() const override;
+
+    // 不小于 kHugePageSize 的内存按大页对齐并建议内核使用大页，默认关闭
+    void set_huge_pages(bool huge_pages);
+
+    bool huge_pages() const;
+
+    // 释放当前线程缓存的空闲内存
+    void Trim();
+
+    // 申请大小对应的尺寸等级
+    static size_t SizeClass(size_t bytes);
+
+private:
+    PoolAllocator() = default;
+
+    friend struct PoolThreadCache;
+
+    // 直接向系统申请和释放
+    void* SystemAllocate(size_t bytes);
+
+    void SystemFree(void* ptr);
+
+    std::atomic<bool> huge_pages_{false};
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> bytes_in_use_{0};
+    std::atomic<uint64_t> bytes_cached_{0};
+};
+
+}
+
+#endif
@@ -4,6 +4,22 @@
 
 namespace kuiper_infer {
 
+// 张量四周预留的边框，上下各 h 行，左右各 w 列，边框里都是 value
+// 带边框的张量形状是 (channels, rows + 2h, cols + 2w)，内部才是真正的数据
+struct Halo {
+  uint32_t h = 0;
+  uint32_t w = 0;
+  float value = 0.f;
+
+  bool empty() const { return h == 0 && w == 0; }
+
+  bool operator==(const Halo& other) const {
+    return h == other.h && w == other.w && value == other.value;
+  }
+
+  bool operator!=(const Halo& other) const { return !(*this == other); }
+};
+
 // 对张量进行形状上的扩展
 std::tuple<sftensor, sftensor> TensorBroadcast(const sftensor& tensor1,
                                                const sftensor& tensor2);
@@ -21,6 +37,28 @@ bool TensorIsSame(const std::shared_ptr<Tensor<float>>& a,
                   float threshold = 1e-5f);
 
 
+// 比较量化张量是否相同，量化参数必须一致，每个元素的整数值最多相差 threshold
+bool TensorIsSame(const std::shared_ptr<Tensor<uint8_t>>& a,
+                  const std::shared_ptr<Tensor<uint8_t>>& b,
+                  uint32_t threshold = 0);
+
+
+// 根据张量的取值范围计算量化参数，per_channel 时每个通道一组
+QuantParams TensorQuantParams(const std::shared_ptr<Tensor<float>>& tensor,
+                              bool per_channel, bool is_signed, bool symmetric);
+
+
+// 两个张量的误差统计，用于比较低精度结果和 fp32 参考结果
+struct TensorErrorStats {
+  float max_abs = 0.f;   // 最大绝对误差
+  float mean_abs = 0.f;  // 平均绝对误差
+  float max_rel = 0.f;   // 最大相对误差，分母为 max(|expected|, 1e-3)
+};
+
+TensorErrorStats TensorCompare(const std::shared_ptr<Tensor<float>>& actual,
+                               const std::shared_ptr<Tensor<float>>& expected);
+
+
 // 对张量相加
 std::shared_ptr<Tensor<float>> TensorElementAdd(
     const std::shared_ptr<Tensor<float>>& tensor1,
@@ -38,6 +76,8 @@ std::shared_ptr<Tensor<float>> TensorElementMultiply(
     const std::shared_ptr<Tensor<float>>& tensor1,
     const std::shared_ptr<Tensor<float>>& tensor2);
 
+// 创建张量，内存来自 TensorAllocator，不做初始化
+// 张量的数据不能再被移动到其他 Tensor 对象中，内存随 shared_ptr 一起归还给分配器
 std::shared_ptr<Tensor<float>> TensorCreate(uint32_t channels, uint32_t rows,
                                             uint32_t cols);
 
@@ -46,8 +86,32 @@ std::shared_ptr<Tensor<float>> TensorCreate(
     const std::vector<uint32_t>& shapes);
 
 
+// 创建内部为 (channels, rows, cols) 的带边框张量，内部不初始化
+// 边框只在内存第一次用于这种形状和边框时写入，之后从内存池复用时保持不变，所以使用者不能修改边框
+std::shared_ptr<Tensor<float>> TensorCreate(uint32_t channels, uint32_t rows,
+                                            uint32_t cols, const Halo& halo);
+
+
+// 把带边框张量的边框填为 halo.value，不访问内部
+void TensorFillHalo(const std::shared_ptr<Tensor<float>>& tensor,
+                    const Halo& halo);
+
+
+// 创建量化张量，内存来自 TensorAllocator，不做初始化
+std::shared_ptr<Tensor<uint8_t>> TensorCreate(uint32_t channels, uint32_t rows,
+                                              uint32_t cols,
+                                              const QuantParams& params);
+
+
 std::shared_ptr<Tensor<float>> TensorClone(
     std::shared_ptr<Tensor<float>> tensor);
 
+
+// 逐通道转置 channels 个 (rows, cols) 的行主序矩阵，dst 的每个通道是 (cols, rows) 的行主序矩阵
+// 行主序和列主序之间的转换都可以用它：列主序的 (rows, cols) 看成行主序的 (cols, rows)
+// 分块转置，8x8 的小块在寄存器里完成，通道和行块并行
+void TransposePlanes(const float* src, float* dst, uint32_t channels,
+                     uint32_t rows, uint32_t cols);
+
 }
 #endif
@@ -0,0 +1,98 @@
+#ifndef KUIPER_INFER_DATA_TENSOR_VIEW_HPP
+#define KUIPER_INFER_DATA_TENSOR_VIEW_HPP
+
+#include <memory>
+#include <vector>
+#include "data/tensor.hpp"
+
+namespace kuiper_infer {
+
+// 不持有数据的张量视图 - NCHW
+// 只记录数据指针、形状和每一维的步长(按元素个数)，并共享底层数据的所有权
+// 通道切片、展平、reshape 和取 batch 里的一个元素都只改变指针和步长，不复制数据
+//
+// Tensor<float> 是列主序的 fcube，一个通道内行的步长是 1，列的步长是 rows
+// 视图也可以是行主序的(CHW 连续，列的步长是 1)，例如图像解码器的输出，导入时不需要转置
+// 视图只在底层数据不重新分配时有效，Padding 等会重新分配内存的操作之后需要重新创建
+class TensorView {
+
+public:
+    TensorView() = default;
+
+    // 整个张量的视图，batch 为 1
+    explicit TensorView(const std::shared_ptr<Tensor<float>>& tensor);
+
+    // 任意内存的视图，owner 负责数据的生命周期
+    // shape 和 strides 都是 NCHW
+    TensorView(std::shared_ptr<void> owner, float* data, const std::vector<uint32_t>& shape,
+               const std::vector<uint32_t>& strides);
+
+    // 行主序 (channels, rows, cols) 内存的视图，batch 为 1
+    static TensorView RowMajor(std::shared_ptr<void> owner, float* data, uint32_t channels, uint32_t rows, uint32_t cols);
+
+    uint32_t batch() const;
+
+    uint32_t channels() const;
+
+    uint32_t rows() const;
+
+    uint32_t cols() const;
+
+    // 元素个数
+    uint32_t size() const;
+
+    bool empty() const;
+
+    // 形状 - NCHW
+    const std::vector<uint32_t>& shape() const;
+
+    // 每一维的步长 - NCHW
+    const std::vector<uint32_t>& strides() const;
+
+    float* raw_ptr() const;
+
+    const std::shared_ptr<void>& owner() const;
+
+    float& at(uint32_t batch, uint32_t channel, uint32_t row, uint32_t col) const;
+
+    float& at(uint32_t channel, uint32_t row, uint32_t col) const;
+
+    // 每个 batch 元素内部是否和 Tensor<float> 的列主序排布一致
+    bool is_contiguous() const;
+
+    // 每个 batch 元素内部是否是行主序连续的
+    bool is_row_major() const;
+
+    // 第 index 个 batch 元素
+    TensorView Batch(uint32_t index) const;
+
+    // 从 begin 开始的 count 个通道
+    TensorView Channels(uint32_t begin, uint32_t count) const;
+
+    // 展平，和 Tensor::Flatten(row_major) 一致，每个 batch 元素变为 (1, 1, size)
+    TensorView Flatten(bool row_major = false) const;
+
+    // reshape，和 Tensor::Reshape(shape, row_major) 一致，shape 为 CHW
+    // 要求视图的排布和 row_major 一致，这时只改变步长，不复制数据
+    TensorView Reshape(const std::vector<uint32_t>& shape, bool row_major = false) const;
+
+    // 把每个 batch 元素按 CHW 依次写到 dst，行主序或列主序
+    void CopyTo(float* dst, bool row_major) const;
+
+    // 转换为层可以直接使用的张量，batch 必须为 1
+    // 排布连续时新张量直接使用视图的内存并持有 owner，否则复制一份
+    std::shared_ptr<Tensor<float>> AsTensor() const;
+
+    // 复制出一个独立的张量，batch 必须为 1
+    std::shared_ptr<Tensor<float>> Clone() const;
+
+private:
+    std::shared_ptr<void> owner_; // 底层数据的所有者
+    float* data_ = nullptr;
+    std::vector<uint32_t> shape_; // NCHW
+    std::vector<uint32_t> strides_; // NCHW
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef KUIPER_INFER_DATA_VECTOR_KERNELS_HPP
+#define KUIPER_INFER_DATA_VECTOR_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// 激活、逐元素运算、池化、直接卷积和 im2col 的热点循环，每个函数都有标量 / AVX2 / AVX-512 版本
+// 按 ActiveCpuIsa() 选择，内核名字见 RegisteredKernels()
+// src 和 dst 可以是同一块内存(原地计算)，其他情况下不能重叠
+namespace kuiper_infer {
+
+// dst = src >= threshold ? src : 0，nan 输出 0
+void ReluValues(const float* src, float* dst, size_t count, float threshold);
+
+// dst = 1 / (1 + exp(-src))
+// 向量版本用多项式计算 exp，和标量版本的 std::exp 相差不超过几个 ulp
+void SigmoidValues(const float* src, float* dst, size_t count);
+
+// dst = a + b
+void AddValues(const float* a, const float* b, float* dst, size_t count);
+
+// dst = a * b
+void MulValues(const float* a, const float* b, float* dst, size_t count);
+
+// dst = src * scale + shift，BatchNorm 的一个通道
+void ScaleShiftValues(const float* src, float* dst, size_t count, float scale, float shift);
+
+// 一个列主序通道的最大池化，输入已经 padding，src_ld 和 dst_ld 是列步长(按元素)
+// 输出 (oh, ow) 写到 dst[ow * dst_ld + oh]
+void MaxPoolPlane(const float* src, size_t src_ld, float* dst, size_t dst_ld, uint32_t output_h, uint32_t output_w,
+                  uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w);
+
+// 直接卷积的一个输入通道：
+// dst(oh, ow) += sum kernel(kh, kw) * src(oh * stride_h + kh * dilation_h, ow * stride_w + kw * dilation_w)
+// 输入已经 padding，kernel 是列主序的 (kernel_h, kernel_w)，src_ld 和 dst_ld 是列步长(按元素)
+void ConvPlaneAccumulate(const float* src, size_t src_ld, const float* kernel, uint32_t kernel_h, uint32_t kernel_w,
+                         uint32_t stride_h, uint32_t stride_w, uint32_t dilation_h, uint32_t dilation_w, float* dst,
+                         size_t dst_ld, uint32_t output_h, uint32_t output_w);
+
+// dst[i] = src[i * stride]，im2col 按步长取一列输入
+void CopyStrided(const float* src, size_t stride, float* dst, size_t count);
+
+}
+
+#endif
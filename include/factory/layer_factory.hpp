@@ -3,6 +3,9 @@
 
 #include "ops/op.hpp"
 #include "layer/layer.hpp"
+#include <map>
+#include <string>
+#include <vector>
 
 namespace kuiper_infer {
 
@@ -21,19 +24,40 @@ public:
     // 所以第一次遇到的算子需要加入注册表,之后见到直接查找表并创建layer层
     typedef std::shared_ptr<Layer> (*Creator) (const std::shared_ptr<Operator>& op);
 
-    // 注册表，key是OpType,value是Creator
+    // 实现是否适用于这个 op，例如只支持 fp32 权重、只适合 depthwise 的卷积实现
+    typedef bool (*Predicate) (const std::shared_ptr<Operator>& op);
+
+    // 同一个 op_type 可以有多个实现，例如卷积的 im2col-GEMM 和直接卷积
+    struct Implementation {
+        std::string name; // 实现的名字，调优缓存里按名字记录选择
+        Creator creator = nullptr;
+        Predicate predicate = nullptr; // 为空时总是适用
+        bool is_default = false; // 没有调优时使用的实现，每个 op_type 一个
+    };
+
+    // 注册表，key是OpType,value是这个类型的所有实现，默认实现排在最前面
     // 查找表就可以找到对于算子的一个初始化方法
     // 第一次遇到的算子需要加入注册表,之后见到直接查找表并找到creator创建layer层
-    typedef std::map<OpType, Creator> CreateRegistry;
+    typedef std::map<OpType, std::vector<Implementation>> CreateRegistry;
 
 
-    // 注册算子函数，根据算子的类型以及创建函数，加入注册表里
-    static void RegisterCreator(OpType op_type, const Creator& creator);
+    // 注册算子函数，根据算子的类型以及创建函数，加入注册表里，作为这个类型的默认实现
+    static void RegisterCreator(OpType op_type, const Creator& creator, const std::string& name = "default");
 
+    // 注册一个额外的实现，名字在同一个 op_type 里不能重复
+    static void RegisterImplementation(OpType op_type, const std::string& name, const Creator& creator,
+                                       Predicate predicate);
 
-    // 根据op的类型创建对应的Layer
+
+    // 根据op的类型创建对应的Layer，使用默认实现
     static std::shared_ptr<Layer> CreateLayer(const std::shared_ptr<Operator>& op);
 
+    // 使用指定名字的实现创建 Layer，实现不存在或不适用于 op 时返回空
+    static std::shared_ptr<Layer> CreateLayer(const std::shared_ptr<Operator>& op, const std::string& name);
+
+    // 适用于 op 的所有实现的名字，默认实现在前
+    static std::vector<std::string> Implementations(const std::shared_ptr<Operator>& op);
+
     // 创建一个注册表，并返回引用
     // 全局只需要一个注册表，所以会看到用static生明的注册表变量
     static CreateRegistry& Registry();
@@ -48,8 +72,14 @@ class LayerRegisterWrapper {
 public:
 // 每定义完一个算子，就会加入注册表
 // 根据(op_type, creator)
-    LayerRegisterWrapper(OpType op_type, const LayerRegister::Creator& creator) {
-        LayerRegister::RegisterCreator(op_type, creator);
+    LayerRegisterWrapper(OpType op_type, const LayerRegister::Creator& creator, const std::string& name = "default") {
+        LayerRegister::RegisterCreator(op_type, creator, name);
+    }
+
+    // 额外的实现，predicate 为空时总是适用
+    LayerRegisterWrapper(OpType op_type, const std::string& name, const LayerRegister::Creator& creator,
+                         LayerRegister::Predicate predicate) {
+        LayerRegister::RegisterImplementation(op_type, name, creator, predicate);
     }
 };
 
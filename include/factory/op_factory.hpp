@@ -0,0 +1,47 @@
+#ifndef KUIPER_INFER_FACTORY_OP_FACTORY_HPP
+#define KUIPER_INFER_FACTORY_OP_FACTORY_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include "ops/op.hpp"
+
+namespace kuiper_infer {
+
+struct RuntimeOperator;
+
+// 算子属性的注册表
+// 计算图里的节点是 RuntimeOperator，类型是 pnnx 的字符串，例如 nn.Conv2d
+// 需要先把 RuntimeOperator 的 params 和 attrs 解析成对应的 Operator
+// 再通过 LayerRegister 根据 Operator 创建 Layer
+class OpRegister {
+
+public:
+
+    // 根据 RuntimeOperator 的参数和权重构造 Operator
+    typedef std::shared_ptr<Operator> (*Creator) (const std::shared_ptr<RuntimeOperator>& op);
+
+    // 注册表，key是pnnx的算子类型，value是Creator
+    typedef std::map<std::string, Creator> CreateRegistry;
+
+    // 注册算子的解析函数
+    static void RegisterCreator(const std::string& op_type, const Creator& creator);
+
+    // 根据计算图节点创建对应的 Operator
+    static std::shared_ptr<Operator> CreateOperator(const std::shared_ptr<RuntimeOperator>& op);
+
+    // 是否有该类型的解析函数
+    static bool HasCreator(const std::string& op_type);
+
+    static CreateRegistry& Registry();
+};
+
+class OpRegisterWrapper {
+public:
+    OpRegisterWrapper(const std::string& op_type, const OpRegister::Creator& creator) {
+        OpRegister::RegisterCreator(op_type, creator);
+    }
+};
+
+}
+#endif
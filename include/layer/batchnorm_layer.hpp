@@ -0,0 +1,30 @@
+#ifndef KUIPER_INFER_LAYER_BATCHNORM_LAYER_HPP
+#define KUIPER_INFER_LAYER_BATCHNORM_LAYER_HPP
+
+#include "layer.hpp"
+#include "ops/batchnorm_op.hpp"
+
+namespace kuiper_infer {
+
+// 独立执行的 BatchNorm，每个通道 y = x * scale + shift
+// 前面是卷积时计算图构建时已经把 BatchNorm 折叠到卷积的权重里，只有不能折叠的 BatchNorm 才会执行这一层
+class BatchNormLayer : public Layer {
+public:
+    explicit BatchNormLayer(const std::shared_ptr<Operator> &op);
+
+    void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    // 整个 batch 连续存储，按 (batch, channel) 平面计算
+    void ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) override;
+
+    bool SupportsOutputHalo() const override;
+
+    static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
+
+private:
+    std::shared_ptr<BatchNormOp> op_;
+};
+
+}
+
+#endif
@@ -2,20 +2,100 @@
 #define KUIPER_INFER_LAYER_CONV_LAYER_HPP
 
 #include "layer.hpp"
+#include "data/sgemm.hpp"
 #include "ops/conv_op.hpp"
+#include <functional>
 
 namespace kuiper_infer {
 
 class ConvLayer : public Layer {
 public:
-    ConvLayer(const std::shared_ptr<Operator> &op);
+    // implicit_gemm 时总是用隐式 GEMM，否则只在 im2col 矩阵超过 workspace_limit() 时使用
+    explicit ConvLayer(const std::shared_ptr<Operator> &op, bool implicit_gemm = false);
     void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
 
+    // 整个 batch 的 im2col 拼接在一起，每个 group 只做一次矩阵乘
+    void ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) override;
+
+    // 列主序连续的视图直接使用，其他步长(例如行主序)的视图在 im2col 时按步长读取，不需要先转换排布
+    void ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    bool AcceptsStridedViews() const override;
+
+    Halo InputPadding() const override;
+
+    bool SupportsOutputHalo() const override;
+
     static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
 
+    // 注册为 "implicit_gemm" 的实现，int8 卷积不适用
+    static std::shared_ptr<Layer> CreateImplicitInstance(const std::shared_ptr<Operator> &op);
+
+    static bool ImplicitApplicable(const std::shared_ptr<Operator> &op);
+
+    // 一次卷积展开的 im2col 矩阵(整个 batch 的一个 group)的字节数上限，超过时改用隐式 GEMM:
+    // 计算时按 L2 大小的块生成 im2col 面板直接交给矩阵乘，每个线程只需要一块缓冲区
+    // 默认 64MB，环境变量 KUIPER_CONV_WORKSPACE_MB 可以修改默认值
+    static void set_workspace_limit(size_t bytes);
+
+    static size_t workspace_limit();
+
 private:
 
-    std::unique_ptr<ConvOp> op_;
+    // 对一组形状相同的输入做卷积，第 n 个输出写到 outputs.at(n) 开始的 (output_c, output_h, output_w) 内存
+    // 每个输入视图的 batch 都是 1，inputs_padded 时输入已经带有 padding 大小的边框
+    // output_halo 不为空时输出内存是带边框的 (output_c, output_h + 2h, output_w + 2w)，只写内部
+    void Convolve(const std::vector<TensorView> &inputs, bool inputs_padded, const std::vector<float *> &outputs,
+                  uint32_t output_h, uint32_t output_w, const Halo &output_halo) const;
+
+    // op_ 启用 int8 时 Convolve 的实现，参数相同
+    // 输入量化为带 padding 边框的 uint8，u8 x s8 矩阵乘累加为 int32，后处理里加 bias、relu 并重新量化为 uint8，
+    // 最后反量化为 fp32 写到 outputs
+    void ConvolveInt8(const std::vector<TensorView> &inputs, bool inputs_padded, const std::vector<float *> &outputs,
+                      uint32_t output_h, uint32_t output_w, const Halo &output_halo) const;
+
+    // Forward 和 ForwardViews 的输出，按 output_halo_ 预留边框
+    std::vector<std::shared_ptr<Tensor<float>>> CreateOutputs(uint32_t batch_size, uint32_t output_h, uint32_t output_w,
+                                                              std::vector<float *> &output_ptrs) const;
+
+    // 根据输入尺寸计算输出尺寸
+    std::pair<uint32_t, uint32_t> OutputSize(uint32_t input_h, uint32_t input_w) const;
+
+    // store(src, first_row, rows, channel) 把结果矩阵一列里从 first_row 开始的 rows 行写到输出通道 channel
+    using StoreColumn = std::function<void(const float *, uint32_t, uint32_t, uint32_t)>;
+
+    // group_epilogue(group) 返回一个 group 直接写到输出时的后处理(bias)
+    using GroupEpilogue = std::function<SgemmEpilogue(uint32_t)>;
+
+    // 隐式 GEMM 的 Convolve，im2col 面板在矩阵乘里按块从输入生成，压缩存储的卷积核按段转换
+    // direct_output 时结果直接写到 outputs.front()，否则按行分段算到不超过 workspace_limit() 的缓冲区里交给 store_column
+    void ConvolveImplicit(const std::vector<TensorView> &inputs, bool inputs_padded, const std::vector<float *> &outputs,
+                          uint32_t output_h, uint32_t output_w, bool direct_output, size_t output_plane,
+                          const GroupEpilogue &group_epilogue, const StoreColumn &store_column) const;
+
+    // 卷积核压缩存储时的矩阵乘，不展开整个 fp32 卷积核矩阵
+    // 输入矩阵按行分块，每一块和逐块反量化到小缓冲区里的卷积核相乘，结果交给 store_column
+    void MultiplyCompressed(const arma::fmat &input_matrix, uint32_t group, uint32_t kernels_per_group,
+                            const StoreColumn &store_column) const;
+
+    // 把 padding 之后输入的一个 group 展开到 input_matrix 从 row_offset 开始的 output_h * output_w 行
+    // 每一行是一个输出位置，每一列是卷积核的一个元素，列的顺序和卷积核列主序展开的顺序一致
+    static void Im2Col(const Tensor<float> &input, uint32_t first_channel, uint32_t kernel_c,
+                       uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w,
+                       uint32_t dilation_h, uint32_t dilation_w, uint32_t output_h, uint32_t output_w,
+                       arma::fmat &input_matrix, uint32_t row_offset);
+
+    // 按步长读取任意排布的输入，padding 的位置直接填 0，不需要先 padding 一份输入
+    static void Im2ColStrided(const TensorView &input, uint32_t first_channel, uint32_t kernel_c,
+                              uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w,
+                              uint32_t dilation_h, uint32_t dilation_w, uint32_t padding_h, uint32_t padding_w,
+                              uint32_t output_h, uint32_t output_w, arma::fmat &input_matrix, uint32_t row_offset);
+
+    // 卷积的权重较大，直接引用 Operator 而不是复制一份
+    // 同一模型的多个计算图共享同一个 ConvOp
+    std::shared_ptr<ConvOp> op_;
+
+    bool implicit_gemm_ = false;
 
 
 };
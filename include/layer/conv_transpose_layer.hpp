@@ -0,0 +1,32 @@
+#ifndef KUIPER_INFER_LAYER_CONV_TRANSPOSE_LAYER_HPP
+#define KUIPER_INFER_LAYER_CONV_TRANSPOSE_LAYER_HPP
+
+#include "layer.hpp"
+#include "ops/conv_transpose_op.hpp"
+
+namespace kuiper_infer {
+
+// 转置卷积，按 group 把输入 (H * W, in / groups) 乘上预打包的权重 (in / groups, out / groups * kh * kw)，
+// 得到每个输入像素对每个卷积核元素的贡献，再由 col2im 累加到输出
+// 卷积核和步长相同、没有 padding 和 dilation 时(例如 stride 2、kernel 2 的上采样)输出像素互不重叠，
+// bias 在矩阵乘里加上，结果直接交错写到输出，不需要先填 bias 再累加
+class ConvTransposeLayer : public Layer {
+public:
+    explicit ConvTransposeLayer(const std::shared_ptr<Operator> &op);
+
+    void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    bool SupportsOutputHalo() const override;
+
+    static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
+
+private:
+    // 输出像素互不重叠，可以不经过 col2im 的累加
+    bool NonOverlapping() const;
+
+    std::shared_ptr<ConvTransposeOp> op_;
+};
+
+}
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef KUIPER_INFER_LAYER_DIRECT_CONV_LAYER_HPP
+#define KUIPER_INFER_LAYER_DIRECT_CONV_LAYER_HPP
+
+#include "layer.hpp"
+#include "ops/conv_op.hpp"
+
+namespace kuiper_infer {
+
+// 卷积的直接实现，逐个卷积核元素把一个输入通道乘上权重累加到输出通道，不展开 im2col 矩阵
+// 每个 group 的输入通道很少(例如 depthwise)时 im2col 矩阵乘的 K 维太小，直接计算更快
+// 注册为 kOperatorConv 的 "direct" 实现，由计算图的自动调优选择
+class DirectConvLayer : public Layer {
+public:
+    DirectConvLayer(const std::shared_ptr<Operator> &op);
+
+    void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    Halo InputPadding() const override;
+
+    bool SupportsOutputHalo() const override;
+
+    // fp32 计算且每个 group 的输入通道不超过 kMaxGroupChannels 时适用
+    static bool Applicable(const std::shared_ptr<Operator> &op);
+
+    static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
+
+    static constexpr uint32_t kMaxGroupChannels = 16;
+
+private:
+    std::shared_ptr<ConvOp> op_;
+};
+
+}
+
+#endif
@@ -15,6 +15,15 @@ public:
 
     void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
 
+    // 所有输入形状相同时整个 batch 一次计算，需要广播时使用默认实现
+    void ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) override;
+
+    // 所有输入形状相同时按块对整个表达式求值，不产生中间张量
+    void ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                     std::vector<std::shared_ptr<HalfTensor>> &outputs) override;
+
+    static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
+
 private:
 
     std::unique_ptr<ExpressionOp> op_;
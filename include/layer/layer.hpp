@@ -3,6 +3,10 @@
 
 #include <string>
 #include "data/tensor.hpp"
+#include "data/tensor_view.hpp"
+#include "data/batch_tensor.hpp"
+#include "data/tensor_util.hpp"
+#include "data/half_tensor.hpp"
 
 namespace kuiper_infer {
 
@@ -15,8 +19,46 @@ public:
     // 输入是一个 batch 的 Tensor
     virtual void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs);
 
+    // 输入是张量视图，例如另一个张量的部分通道，视图的每个 batch 元素作为一个输入
+    // 默认转换为张量后调用 Forward，视图排布连续时不复制数据
+    virtual void ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs);
+
+    // ForwardViews 是否能直接读取任意步长(例如行主序)的视图，不需要先转换为列主序的张量
+    // 计算图构建时据此决定输入边使用哪种排布
+    virtual bool AcceptsStridedViews() const;
+
+    // 输入是连续存储的 NCHW batch，有多个输入时按 @0 @1 ... 的顺序排列
+    // 默认通过适配器转换为 vector<sftensor> 后调用 Forward，层可以重写为对整个 batch 做一次计算
+    virtual void ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output);
+
+    // 输入和输出以半精度(fp16/bf16)存储，计算在 fp32 下进行，输出和第一个输入使用相同的半精度类型
+    // 默认把输入转换为 fp32 后调用 Forward 再转换回来，带宽受限的层可以重写为按块转换、计算
+    // 不使用 input_halo 和 output_halo
+    virtual void ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                             std::vector<std::shared_ptr<HalfTensor>> &outputs);
+
+    // 层计算前对输入做的 padding，没有 padding 时为空
+    // 计算图构建时据此给生产者的输出预留边框，消费者直接读取边框，不需要再 padding 一份
+    virtual Halo InputPadding() const;
+
+    // Forward 能否把输出写到预留了边框的张量里
+    virtual bool SupportsOutputHalo() const;
+
+    // 由计算图在构建时设置，只影响 Forward 和 ForwardViews
+    // 输入带边框时输入张量的形状包含边框，输出带边框时输出张量的形状包含边框
+    void set_input_halo(const Halo &halo);
+
+    const Halo &input_halo() const;
+
+    void set_output_halo(const Halo &halo);
+
+    const Halo &output_halo() const;
+
     virtual ~Layer() = default;
 
+protected:
+    Halo input_halo_; // 输入张量已经预留的边框
+    Halo output_halo_; // 输出张量需要预留的边框
 
 private:
     std::string layer_name_; // layer 的名字
@@ -0,0 +1,45 @@
+#ifndef KUIPER_INFER_LAYER_LINEAR_LAYER_HPP
+#define KUIPER_INFER_LAYER_LINEAR_LAYER_HPP
+
+#include "layer.hpp"
+#include "ops/linear_op.hpp"
+
+namespace kuiper_infer {
+
+// 全连接层，整个 batch 作为一次矩阵乘: (batch, in_features) x 预打包的 (in_features, out_features)
+// bias 和融合的激活函数在矩阵乘的 epilogue 里完成
+// 输入元素个数等于 in_features 时按 pytorch 的展平顺序处理，不复制也不转置输入:
+// 行主序的视图直接按内存顺序读取，列主序的张量改用算子加载时按列主序重新排列的权重，
+// 算子没有按这个输入形状打包时只把输入转置为行主序
+// 输入的列数等于 in_features 时对每一行计算(nn.Linear 作用在最后一维)，输出 (channels, rows, out_features)
+class LinearLayer : public Layer {
+public:
+    explicit LinearLayer(const std::shared_ptr<Operator> &op);
+
+    void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    // 行主序或列主序连续的视图直接读取，其他视图转换为张量后计算
+    void ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    bool AcceptsStridedViews() const override;
+
+    static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
+
+private:
+    // 每个 batch 元素从 samples[i] 开始连续的 in_features 个元素，按 weights 的行顺序读取
+    void ForwardFlattened(const std::vector<const float *> &samples, const PackedSgemmMatrix &weights,
+                          std::vector<std::shared_ptr<Tensor<float>>> &outputs) const;
+
+    // 每个 batch 元素是列主序的 (channels, rows, cols)，元素个数等于 in_features
+    void ForwardColumnMajor(const std::vector<const float *> &samples, uint32_t channels, uint32_t rows,
+                            uint32_t cols, std::vector<std::shared_ptr<Tensor<float>>> &outputs) const;
+
+    SgemmEpilogue Epilogue() const;
+
+    // 权重只在算子里打包一次，同一模型的多个计算图共享同一个 LinearOp
+    std::shared_ptr<LinearOp> op_;
+};
+
+}
+
+#endif
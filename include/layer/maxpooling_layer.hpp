@@ -13,6 +13,15 @@ public:
 
     void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
 
+    // 按通道转换为 fp32 计算，带宽是 fp32 的一半
+    void ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                     std::vector<std::shared_ptr<HalfTensor>> &outputs) override;
+
+    // 用 float 的最小值 padding
+    Halo InputPadding() const override;
+
+    bool SupportsOutputHalo() const override;
+
     // static 表示可以在不创建实例的情况下直接通过类调用
     static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
 
@@ -16,6 +16,20 @@ public:
     // override表示覆盖父类虚函数
     void Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
 
+    // 整个 batch 作为一段连续内存计算
+    void ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) override;
+
+    // 逐元素计算和排布无关，任意步长的视图在转换排布时顺便计算
+    void ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) override;
+
+    bool AcceptsStridedViews() const override;
+
+    // 按块转换为 fp32 计算，带宽是 fp32 的一半
+    void ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                     std::vector<std::shared_ptr<HalfTensor>> &outputs) override;
+
+    bool SupportsOutputHalo() const override;
+
     // 相同名字，不同属性，有很多relu算子，每个relu有不同的threshold
     static std::shared_ptr<Layer> CreateInstance(const std::shared_ptr<Operator> &op);
 
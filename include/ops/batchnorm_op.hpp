@@ -0,0 +1,40 @@
+#ifndef KUIPER_INFER_OPS_BATCHNORM_OP_HPP
+#define KUIPER_INFER_OPS_BATCHNORM_OP_HPP
+
+#include "op.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace kuiper_infer {
+
+struct RuntimeOperator;
+
+// 推理时的 BatchNorm2d: y = (x - mean) / sqrt(var + eps) * weight + bias
+// 构造时换算为每个通道的 y = x * scale + shift，计算和折叠到卷积都只用 scale 和 shift
+class BatchNormOp : public Operator {
+
+public:
+
+    // weight 和 bias 为空时(affine=False)分别按 1 和 0 处理
+    BatchNormOp(const std::vector<float> &mean, const std::vector<float> &var, const std::vector<float> &weight,
+                const std::vector<float> &bias, float eps);
+
+    uint32_t channels() const;
+
+    const std::vector<float>& scale() const;
+
+    const std::vector<float>& shift() const;
+
+    // 根据计算图节点 nn.BatchNorm2d 的参数和 running_mean、running_var、weight、bias 构造
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
+private:
+
+    std::vector<float> scale_;
+    std::vector<float> shift_;
+};
+
+}
+
+#endif
@@ -5,11 +5,44 @@
 #include <cstdint>
 #include <vector>
 #include "data/tensor.hpp"
+#include "data/half_tensor.hpp"
+#include "data/gemm_int8.hpp"
+#include "data/quantize.hpp"
+#include "data/sgemm.hpp"
 #include <utility>
+#include <memory>
 
 namespace kuiper_infer {
 
 typedef std::pair<uint32_t, uint32_t> Shape;
+
+struct RuntimeOperator;
+
+// 卷积的 int8 推理参数，卷积核在 EnableInt8 时按 group 量化并预打包
+struct ConvInt8Weights {
+    QuantParams input_params; // 输入的 uint8 参数，整个张量一组
+    QuantParams weight_params; // 卷积核的 int8 对称参数，每个输出通道一组
+    QuantParams output_params; // 输出重新量化的 uint8 参数
+    bool relu = false; // 重新量化之前做 relu，融合后面的 nn.ReLU
+    std::vector<PackedInt8Matrix> packed_weights; // 每个 group 一个 (kernel_elements, kernels_per_group)
+    std::vector<Int8Epilogue> epilogues; // 每个 group 的输出后处理
+};
+
+// 只量化权重时卷积核的存储，每个卷积核(输出通道)一个对称的 scale，激活值仍然是 fp32
+// 8bit 时每个元素一个 int8；4bit 时取值范围 [-7, 7]，两个元素一个字节，每个卷积核从新的字节开始
+struct QuantizedKernels {
+    uint32_t bits = 8;
+    std::vector<uint32_t> shape; // 每个卷积核的形状 (C, H, W)
+    std::vector<float> scales;
+    std::vector<uint8_t> data;
+
+    uint32_t kernel_elements() const;
+
+    size_t kernel_bytes() const;
+
+    // 把第 index 个卷积核反量化为 fp32，按列主序写到 dst
+    void Load(uint32_t index, float* dst) const;
+};
     
 class ConvOp : public Operator {
 
@@ -21,6 +54,10 @@ public:
 
     void set_padding(Shape padding);
 
+    // 卷积核元素之间的间隔 (dilation_h, dilation_w)，默认 (1, 1)
+    // 卷积核覆盖的范围是 dilation * (kernel - 1) + 1
+    void set_dilation(Shape dilation);
+
     void set_has_bias(bool has_bias);
 
     void set_groups(uint32_t groups);
@@ -29,6 +66,8 @@ public:
 
     Shape get_padding() const;
 
+    Shape get_dilation() const;
+
     bool get_has_bias() const;
 
     uint32_t get_groups() const;
@@ -41,14 +80,68 @@ public:
 
     const std::vector<sftensor>& get_bias() const;
 
+    // 把权重压缩为 fp16/bf16 存储并释放 fp32 权重，计算时按卷积核转换回 fp32
+    // 重新 set_weights 后恢复 fp32 存储
+    void CompressWeights(HalfType type);
+
+    // 半精度或者只量化权重的存储
+    bool weights_compressed() const;
+
+    const std::vector<shtensor>& get_half_weights() const;
+
+    // 卷积核只量化权重的位数，8 或 4 时按输出通道对称量化存储并释放 fp32 权重，计算时按块反量化为 fp32
+    // 设置后 set_weights 直接量化传入的卷积核，不保留 fp32 副本；0 时恢复为 fp32 存储，默认 0
+    void set_weight_bits(uint32_t bits);
+
+    uint32_t weight_bits() const;
+
+    const std::shared_ptr<QuantizedKernels>& get_quantized_weights() const;
+
+    // 卷积核个数和每个卷积核的形状 (C, H, W)，各种存储方式下都有效
+    uint32_t kernel_count() const;
+
+    std::vector<uint32_t> kernel_shape() const;
+
+    // 把第 index 个卷积核按列主序写到 dst，压缩存储时转换为 fp32
+    void CopyKernel(uint32_t index, float* dst) const;
+
+    // fp32 存储时每个 group 预打包的卷积核矩阵 (kernel_elements, kernels_per_group)，每一列是一个卷积核
+    // set_weights、set_groups 时打包；压缩存储时为空，计算时按块转换
+    const std::vector<PackedSgemmMatrix>& packed_weights() const;
+
+    // 启用 int8 推理，按 weight_params 把卷积核量化为 int8 并预打包，bias 和 relu 融合到输出的后处理里
+    // weight_params 为空时按输出通道对称量化；fp32 权重保留给不支持 int8 的路径使用
+    // 重新 set_weights 后关闭
+    void EnableInt8(const QuantParams& input_params, const QuantParams& weight_params,
+                    const QuantParams& output_params, bool relu);
+
+    bool int8_enabled() const;
+
+    const std::shared_ptr<ConvInt8Weights>& int8_weights() const;
+
+    // 根据计算图节点 nn.Conv2d 的参数和权重构造
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
 private:
 
+    // 按 weight_bits_ 量化当前的卷积核，释放 fp32 和半精度存储
+    void QuantizeKernels();
+
+    // 按 groups_ 打包 fp32 卷积核到 packed_weights_
+    void PackWeights();
+
     bool has_bias_ = false;
     uint32_t groups_ = 1;
     Shape stride_;
     Shape padding_;
+    Shape dilation_ = Shape(1, 1);
     std::vector<std::shared_ptr<Tensor<float>>> weights_;
     std::vector<std::shared_ptr<Tensor<float>>> bias_;
+    std::vector<PackedSgemmMatrix> packed_weights_; // fp32 卷积核按 group 预打包
+    std::vector<std::shared_ptr<HalfTensor>> half_weights_; // 压缩后的权重
+    std::shared_ptr<ConvInt8Weights> int8_weights_; // int8 推理的预打包权重
+    uint32_t weight_bits_ = 0;
+    std::shared_ptr<QuantizedKernels> quantized_weights_; // 只量化权重时的卷积核
 
 
 };
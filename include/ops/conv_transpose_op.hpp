@@ -0,0 +1,86 @@
+#ifndef KUIPER_INFER_OPS_CONV_TRANSPOSE_HPP
+#define KUIPER_INFER_OPS_CONV_TRANSPOSE_HPP
+
+#include "op.hpp"
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "data/sgemm.hpp"
+#include "data/tensor.hpp"
+
+namespace kuiper_infer {
+
+typedef std::pair<uint32_t, uint32_t> Shape;
+
+struct RuntimeOperator;
+
+// 转置卷积(nn.ConvTranspose2d)，输出尺寸
+// (input - 1) * stride - 2 * padding + dilation * (kernel - 1) + output_padding + 1
+class ConvTransposeOp : public Operator {
+
+public:
+
+    ConvTransposeOp(Shape stride, Shape padding, bool has_bias, uint32_t groups);
+
+    void set_stride(Shape stride);
+
+    void set_padding(Shape padding);
+
+    // 输出右边和下边额外的行列数，只影响输出尺寸，必须小于 stride 或 dilation
+    void set_output_padding(Shape output_padding);
+
+    void set_dilation(Shape dilation);
+
+    Shape get_stride() const;
+
+    Shape get_padding() const;
+
+    Shape get_output_padding() const;
+
+    Shape get_dilation() const;
+
+    bool get_has_bias() const;
+
+    uint32_t get_groups() const;
+
+    // 每个输入通道一个 (out_channels / groups, kernel_h, kernel_w) 的权重，和 pytorch 的 (in, out / groups, kh, kw) 一致
+    // 设置时按 group 预打包为矩阵乘的 B
+    void set_weights(const std::vector<sftensor> &weights);
+
+    void set_bias(const std::vector<sftensor> &bias);
+
+    const std::vector<sftensor>& get_weights() const;
+
+    const std::vector<sftensor>& get_bias() const;
+
+    uint32_t in_channels() const;
+
+    uint32_t out_channels() const;
+
+    // 每个 group 的权重矩阵 (in_channels / groups, out_channels / groups * kernel_h * kernel_w)
+    // 第 ic 行是第 ic 个输入通道的权重按列主序展开
+    const std::vector<PackedSgemmMatrix>& packed_weights() const;
+
+    // 卷积核的 (kernel_h, kernel_w)
+    Shape kernel_size() const;
+
+    // 根据计算图节点 nn.ConvTranspose2d 的参数和权重构造
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
+private:
+
+    bool has_bias_ = false;
+    uint32_t groups_ = 1;
+    Shape stride_;
+    Shape padding_;
+    Shape output_padding_ = Shape(0, 0);
+    Shape dilation_ = Shape(1, 1);
+    std::vector<sftensor> weights_;
+    std::vector<sftensor> bias_;
+    std::vector<PackedSgemmMatrix> packed_weights_;
+};
+
+}
+
+#endif
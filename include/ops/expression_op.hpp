@@ -10,6 +10,8 @@
 
 namespace kuiper_infer {
 
+struct RuntimeOperator;
+
 class ExpressionOp : public Operator {
 
 public:
@@ -19,6 +21,9 @@ public:
     std::vector<std::shared_ptr<TokenNode>> Generate(); // 可以返回计算图
     // expression layer 不是一个运算，而是多个运算
 
+    // 根据计算图节点 pnnx.Expression 的 expr 参数构造
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
 
 private:
     std::string expression_; // 表达式
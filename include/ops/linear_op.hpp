@@ -0,0 +1,66 @@
+#ifndef KUIPER_INFER_OPS_LINEAR_OP_HPP
+#define KUIPER_INFER_OPS_LINEAR_OP_HPP
+
+#include "op.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "data/sgemm.hpp"
+
+namespace kuiper_infer {
+
+struct RuntimeOperator;
+
+// 全连接层(nn.Linear)，y = x * weight^T + bias，之后可以接一个融合的激活函数
+class LinearOp : public Operator {
+
+public:
+
+    LinearOp(uint32_t in_features, uint32_t out_features, bool has_bias);
+
+    // 行主序的 (out_features, in_features)，和 pytorch 一致，设置时预打包为矩阵乘的 B，不保留原始权重
+    // input_shape 是输入张量的 (channels, rows, cols)，rows 和 cols 都大于 1 时再打包一份按列主序读取的权重
+    void set_weights(const std::vector<float> &weights, const std::vector<uint32_t> &input_shape = {});
+
+    void set_bias(const std::vector<float> &bias);
+
+    // 计算图构建时把后面的 ReLU / Sigmoid 融合进来
+    void set_activation(SgemmActivation activation);
+
+    uint32_t in_features() const;
+
+    uint32_t out_features() const;
+
+    bool has_bias() const;
+
+    const std::vector<float>& bias() const;
+
+    SgemmActivation activation() const;
+
+    // 输入按 pytorch 的展平顺序(行主序 CHW)读取时的权重矩阵 (in_features, out_features)
+    const PackedSgemmMatrix& packed_weights() const;
+
+    // 输入是列主序的 input_shape() 张量时直接按内存顺序读取的权重，第 p 行对应内存里的第 p 个元素
+    // set_weights 时没有给出 rows 和 cols 都大于 1 的输入形状时为空
+    const PackedSgemmMatrix& column_major_weights() const;
+
+    const std::vector<uint32_t>& input_shape() const;
+
+    // 根据计算图节点 nn.Linear 的参数和权重构造
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
+private:
+
+    uint32_t in_features_ = 0;
+    uint32_t out_features_ = 0;
+    bool has_bias_ = false;
+    SgemmActivation activation_ = SgemmActivation::kNone;
+    std::vector<float> bias_;
+    std::vector<uint32_t> input_shape_;
+    PackedSgemmMatrix packed_weights_;
+    PackedSgemmMatrix column_major_weights_;
+};
+
+}
+
+#endif
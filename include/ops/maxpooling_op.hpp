@@ -4,11 +4,14 @@
 #include "op.hpp"
 #include <cstdint>
 #include <utility>
+#include <memory>
 
 namespace kuiper_infer {
     
 typedef std::pair<uint32_t, uint32_t> Shape;
 
+struct RuntimeOperator;
+
 class MaxPoolingOp : public Operator {
 
 public:
@@ -27,6 +30,9 @@ public:
 
     Shape get_padding() const;
 
+    // 根据计算图节点 nn.MaxPool2d 的参数构造
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
 
 private:
 
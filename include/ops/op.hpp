@@ -11,6 +11,9 @@ enum class OpType {
     kOperatorMaxPooling = 2,
     kOperatorExpression = 3,
     kOperatorConv = 4,
+    kOperatorConvTranspose = 5,
+    kOperatorBatchNorm = 6,
+    kOperatorLinear = 7,
 };
 
 // 所有算子的父类
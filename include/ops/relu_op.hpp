@@ -1,10 +1,13 @@
 #ifndef KUIPER_INFER_OPS_RELU_OP_H
 #define KUIPER_INFER_OPS_RELU_OP_H
 
+#include <memory>
 #include "./op.hpp"
 
 namespace kuiper_infer {
 
+struct RuntimeOperator;
+
 class ReLUOperator : public Operator {
 // 对于ReLu算子，在存储属性的时候，只需要存储阈值
 // 以及设置阈值和获取阈值的函数
@@ -16,6 +19,8 @@ public:
 
     float get_threshold() const;
 
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
 private:
     float threshold_ = 0.f;
 
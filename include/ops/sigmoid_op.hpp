@@ -1,16 +1,21 @@
 #ifndef KUIPER_INFER_OPS_SIGMOID_OP_H
 #define KUIPER_INFER_OPS_SIGMOID_OP_H
 
+#include <memory>
 #include "ops/op.hpp"
 
 namespace kuiper_infer {
-    
+
+struct RuntimeOperator;
+
 class SigmoidOperator : public Operator {
     
 public:
 
     explicit SigmoidOperator();
 
+    static std::shared_ptr<Operator> CreateInstance(const std::shared_ptr<RuntimeOperator> &op);
+
 };
 
 }
@@ -0,0 +1,121 @@
+#ifndef KUIPER_INFER_RUNTIME_CALIBRATOR_HPP
+#define KUIPER_INFER_RUNTIME_CALIBRATOR_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "data/tensor.hpp"
+#include "data/tensor_util.hpp"
+#include "runtime/quant_table.hpp"
+#include "runtime/runtime_ir.hpp"
+
+namespace kuiper_infer {
+
+// 激活值量化范围的选取方法
+enum class CalibrationMethod {
+    kMinMax = 0, // 观察到的最小最大值
+    kPercentile = 1, // |x| 的分位数，截断少量离群值
+    kEntropy = 2, // 最小化截断前后分布的 KL 散度(TensorRT 的方法)
+};
+
+const char* CalibrationMethodName(CalibrationMethod method);
+
+// 按名字解析，名字无效时返回 false
+bool ParseCalibrationMethod(const std::string& name, CalibrationMethod& method);
+
+// 一个操作数激活值的统计，只需要一遍前向
+// |x| 的直方图在 [0, range) 上等分为 kBins 个桶，遇到更大的值时范围翻倍并合并相邻的桶
+class ActivationHistogram {
+
+public:
+    static constexpr uint32_t kBins = 2048;
+
+    ActivationHistogram();
+
+    void Add(const float* values, size_t count);
+
+    float min() const;
+
+    float max() const;
+
+    uint64_t count() const;
+
+    // |x| 的分位数，percentile 在 (0, 1] 之间
+    float Percentile(float percentile) const;
+
+    // 截断到 [0, threshold) 再量化为 num_levels 级时 KL 散度最小的 threshold
+    float EntropyThreshold(uint32_t num_levels) const;
+
+    // 按方法选取的量化范围，总是包含在 [min, max] 内
+    std::pair<float, float> Range(CalibrationMethod method, float percentile) const;
+
+private:
+    std::vector<uint64_t> bins_;
+    float range_ = 0.f;
+    float min_ = 0.f;
+    float max_ = 0.f;
+    uint64_t count_ = 0;
+};
+
+// 一层量化后的误差
+struct LayerDrift {
+    std::string name; // 算子名
+    std::string type; // 算子类型
+    TensorErrorStats isolated; // 输入是准确值，只有这一层量化时输出的误差
+    TensorErrorStats cumulative; // 所有层都量化时输出的误差
+    float magnitude = 0.f; // fp32 输出的平均绝对值，用来衡量误差的相对大小
+};
+
+// 训练后量化的校准
+// 在样本上运行 fp32 计算图，统计每个操作数的激活值范围，生成量化表
+// 卷积核按输出通道做 int8 对称量化，激活值按张量做 uint8 非对称量化
+class Calibrator {
+
+public:
+    Calibrator(const std::string& param_path, const std::string& bin_path, const std::string& input_name,
+               const std::string& output_name);
+
+    // 读取目录里按文件名排序的样本，每个文件一个 (channels, rows, cols) 的样本
+    // .csv 用 CSVDataLoader 读取，通道的矩阵按行依次排列，和 RuntimeGraph 调试模式的输出格式一致
+    // .bin 是行主序 CHW 的 float32
+    static std::vector<sftensor> LoadSamples(const std::string& dir, uint32_t channels, uint32_t rows,
+                                             uint32_t cols);
+
+    // 输入节点声明的形状 - CHW
+    std::vector<uint32_t> input_shape() const;
+
+    // 前向一个 batch 并更新每个操作数的统计
+    void Observe(const std::vector<sftensor>& inputs);
+
+    // 操作数名 -> 统计
+    const std::map<std::string, ActivationHistogram>& histograms() const;
+
+    // 根据统计生成量化表，percentile 只用于 kPercentile
+    QuantTable Compute(CalibrationMethod method, float percentile = 0.9999f) const;
+
+    // 保存量化后的模型，卷积核替换为按表量化再反量化的值，用 pnnx::Graph::save 保存
+    // 结果仍然是 fp32 的 pnnx 模型，int8 卷积用量化表里的 scale 可以无损地恢复 int8 卷积核
+    // 量化表保存到 table_path
+    bool SaveQuantizedModel(const QuantTable& table, const std::string& param_path, const std::string& bin_path,
+                            const std::string& table_path) const;
+
+    // 在样本上比较量化模型和 fp32 模型每一层的输出，按拓扑顺序返回
+    // 量化模型由 SaveQuantizedModel 保存，激活值按表模拟量化
+    // float_layers 里的算子不量化，它的输出以及只被它们使用的操作数也保持 fp32
+    std::vector<LayerDrift> MeasureDrift(const QuantTable& table, const std::string& quantized_param_path,
+                                         const std::string& quantized_bin_path,
+                                         const std::vector<sftensor>& samples);
+
+private:
+    std::string param_path_;
+    std::string bin_path_;
+    std::string input_name_;
+    std::string output_name_;
+    RuntimeGraph graph_; // fp32 计算图
+    std::map<std::string, ActivationHistogram> histograms_;
+};
+
+}
+
+#endif
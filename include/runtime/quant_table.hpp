@@ -0,0 +1,49 @@
+#ifndef KUIPER_INFER_RUNTIME_QUANT_TABLE_HPP
+#define KUIPER_INFER_RUNTIME_QUANT_TABLE_HPP
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include "data/quantize.hpp"
+
+namespace kuiper_infer {
+
+// int8 量化表，训练后量化校准的结果，保存为模型旁边的文本文件
+// 激活值按操作数名记录，卷积核按算子名记录，每个输出通道一组参数
+//
+// kuiper_quant_table 1
+// activation <操作数名> <is_signed> <个数> <scale> <zero_point> ...
+// weight <算子名> <is_signed> <个数> <scale> <zero_point> ...
+// float <算子名>
+struct QuantTable {
+    std::map<std::string, QuantParams> activations; // 操作数名 -> uint8 非对称参数，整个张量一组
+    std::map<std::string, QuantParams> weights; // 卷积算子名 -> int8 对称参数，每个输出通道一组
+    std::set<std::string> float_layers; // 误差太大需要保持 fp32 计算的算子
+
+    // 格式版本号，格式变化时需要递增
+    static constexpr uint32_t kTableVersion = 1;
+
+    // 根据 param 文件路径得到量化表路径
+    // xxx.pnnx.param -> xxx.pnnx.qtable
+    static std::string TablePath(const std::string& param_path);
+
+    // 保存成功返回 true
+    bool Save(const std::string& path) const;
+
+    // 文件不存在、版本不一致或内容损坏时返回 false，这时表的内容不变
+    bool Load(const std::string& path);
+
+    bool empty() const;
+
+    // 表内容的哈希，用来区分使用不同量化表的共享权重
+    uint64_t Hash() const;
+
+private:
+    void Write(std::ostream& out) const;
+};
+
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include <glog/logging.h>
 #include "status_code.hpp"
 #include "runtime_datatype.hpp"
+#include "data/half.hpp"
 
 namespace kuiper_infer {
     
@@ -45,6 +46,19 @@ std::vector<T> RuntimeAttribute::get() {
             break;
         }
 
+        // 半精度存储的权重转换为 fp32 返回
+        case RuntimeDataType::kTypeFloat16:
+        case RuntimeDataType::kTypeBFloat16: {
+            const bool is_float = std::is_same<T, float>::value;
+            CHECK_EQ(is_float, true);
+            CHECK_EQ(weight_data.size() % sizeof(uint16_t), 0);
+            weights.resize(weight_data.size() / sizeof(uint16_t));
+            const HalfType half_type =
+                type == RuntimeDataType::kTypeFloat16 ? HalfType::kFloat16 : HalfType::kBFloat16;
+            ConvertFromHalf((const uint16_t*)weight_data.data(), (float*)weights.data(), weights.size(), half_type);
+            break;
+        }
+
         default: {
             LOG(FATAL) << "Unknown weight data type";
         }
@@ -12,6 +12,8 @@ enum class RuntimeDataType {
   kTypeInt16 = 6,
   kTypeInt8 = 7,
   kTypeUInt8 = 8,
+  kTypeBFloat16 = 9, // pnnx 里没有，只用于压缩存储的权重
+  kTypeInt4 = 10, // pnnx 里没有，只用于只量化权重的卷积核
 };
 
 
@@ -1,18 +1,29 @@
+#ifndef KUIPER_INFER_RUNTIME_RUNTIME_IR_HPP
+#define KUIPER_INFER_RUNTIME_RUNTIME_IR_HPP
+
 #include <vector>
 #include <string>
 #include <glog/logging.h>
 #include <memory>
 #include <map>
 #include <queue>
+#include <set>
+#include <functional>
 
 #include "ir.h"
 #include "factory/layer_factory.hpp"
 #include "runtime/runtime_operand.hpp"
 #include "runtime_operator.hpp"
+#include "runtime/weight_store.hpp"
+#include "runtime/runtime_profiler.hpp"
+#include "runtime/quant_table.hpp"
+#include "runtime/runtime_tuner.hpp"
 
 
 
 namespace kuiper_infer {
+
+class ConvOp;
     
 // 定义的计算图结构
 class RuntimeGraph {
@@ -30,7 +41,22 @@ public:
 @param input_name 输入名字
 @param output_name 输出名字
 */
-    // void Build(const std::string& input_name, const std::string& output_name);
+    void Build(const std::string& input_name, const std::string& output_name);
+
+/*
+计算图的前向推理
+@param inputs 输入节点的一个 batch
+@return 输出节点的一个 batch
+*/
+    std::vector<std::shared_ptr<Tensor<float>>> Forward(const std::vector<std::shared_ptr<Tensor<float>>>& inputs);
+
+/*
+以视图作为输入的前向推理，视图可以是行主序的(例如图像解码器的输出)
+能直接读取任意步长视图的消费者读取原始视图，其他消费者需要时才统一转换一次列主序张量
+@param inputs 输入节点的视图，batch 为所有视图 batch 之和
+@return 输出节点的一个 batch
+*/
+    std::vector<std::shared_ptr<Tensor<float>>> Forward(const std::vector<TensorView>& inputs);
 
 
 /*
@@ -52,6 +78,77 @@ public:
 // 返回算子列表
     const std::vector<std::shared_ptr<RuntimeOperator>> operators() const;
 
+// 返回拓扑排序后的算子列表，Build 之后有效
+    const std::vector<std::shared_ptr<RuntimeOperator>>& topo_operators() const;
+
+// 是否使用执行计划缓存，开启后 Init 优先从 .kplan 文件恢复，没有缓存或缓存失效时重新解析并写入
+    void set_plan_cache(bool plan_cache);
+
+    bool plan_cache() const;
+
+// Init 是否从执行计划缓存恢复
+    bool loaded_from_plan() const;
+
+// 是否和同一模型的其他计算图共享只读权重，默认开启
+    void set_share_weights(bool share_weights);
+
+    bool share_weights() const;
+
+// Build 时是否给生产者的输出预留消费者需要的 padding 边框，默认开启
+    void set_reserve_halo(bool reserve_halo);
+
+    bool reserve_halo() const;
+
+// Init 时是否把紧跟在卷积后面的 BatchNorm 折叠到卷积的权重和 bias 里，默认开启
+// 只折叠卷积输出只给这一个 BatchNorm 的情况，折叠后 BatchNorm 节点从计算图里移除，其他 BatchNorm 由 BatchNormLayer 执行
+    void set_fold_batchnorm(bool fold_batchnorm);
+
+    bool fold_batchnorm() const;
+
+// 权重的存储类型，kTypeFloat16 或 kTypeBFloat16 时 Init 把 fp32 权重压缩为半精度存储
+// kTypeInt8 或 kTypeInt4 时卷积核按输出通道对称量化存储(只量化权重)，释放 fp32 权重
+// 卷积核在计算时按块转换回 fp32，激活值仍然是 fp32，默认 kTypeFloat32
+    void set_weight_type(RuntimeDataType weight_type);
+
+    RuntimeDataType weight_type() const;
+
+// int8 量化表(calibrate 工具生成的 .qtable)路径，为空时关闭，默认关闭
+// 设置后 Init 读取量化表，Build 时表里有输入和输出参数的卷积使用 int8 计算，其他层和表里标记为 float 的层仍然是 fp32
+// 量化表读取失败时整个计算图回退到 fp32
+    void set_quant_table(const std::string& table_path);
+
+    const std::string& quant_table() const;
+
+// 是否自动调优，默认关闭
+// 开启后 Build 时有多个适用实现的算子(例如卷积的 im2col-GEMM 和直接卷积)在实际形状上逐个计时，使用最快的实现
+// 结果记录在调优缓存里，之后的启动命中缓存时不再计时
+    void set_auto_tune(bool auto_tune);
+
+    bool auto_tune() const;
+
+// 调优缓存的路径，为空时使用 param 文件旁边的 .ktune 文件，默认为空
+    void set_tuning_cache(const std::string& cache_path);
+
+    std::string tuning_cache() const;
+
+// 设置性能分析器，为空时关闭
+    void set_profiler(std::shared_ptr<RuntimeProfiler> profiler);
+
+    const std::shared_ptr<RuntimeProfiler>& profiler() const;
+
+// 每个算子执行后调用，可以读取或原地修改算子的输出，例如量化校准时统计和模拟量化激活值
+// 开启 reserve_halo 时输出可能带有边框，为空时关闭
+    using OutputHook = std::function<void(const std::shared_ptr<RuntimeOperator>& op)>;
+
+    void set_output_hook(OutputHook hook);
+
+// 调试模式，设置目录后每个算子的输出都会写到 <dir>/<算子名>_<batch序号>.csv
+// 每个通道的矩阵按行依次排列，可以用 CSVDataLoader::LoadData 读回
+// 为空时关闭，默认读取环境变量 KUIPER_DUMP_DIR
+    void set_dump_dir(const std::string& dump_dir);
+
+    const std::string& dump_dir() const;
+
 
 //  所有的static函数只能通过类public函数访问
 private:
@@ -72,6 +169,44 @@ private:
     static void InitGraphAttrs(const std::map<std::string, pnnx::Attribute>& attrs,
                                const std::shared_ptr<RuntimeOperator>& runtime_operator);
 
+    // 解析 pnnx 计算图得到算子列表
+    bool InitFromPnnx();
+
+    // 对算子进行拓扑排序
+    void TopoSort();
+
+    // 用共享存储里的权重替换本计算图解析出的权重
+    void ShareAttrs();
+
+    // 把 fp32 权重转换为 weight_type_ 对应的半精度存储
+    void CompressAttrs();
+
+    // 把卷积后面的 BatchNorm 折叠到卷积的属性里，并把 BatchNorm 的消费者改为连接到卷积
+    void FoldBatchNorm();
+
+    // 把全连接层后面的 ReLU / Sigmoid 融合到全连接层里，激活函数在矩阵乘的 epilogue 里计算
+    void FuseActivations();
+
+    // 给生产者的输出预留消费者需要的 padding 边框
+    void PlanHalos();
+
+    // 依次执行拓扑排序后的算子，input_views 不为空时 view_consumers_ 里的算子直接读取视图
+    void Run(uint32_t batch_size, const std::vector<TensorView>* input_views);
+
+    // 调试模式下保存算子的输出
+    void DumpOutputs(const std::shared_ptr<RuntimeOperator>& op) const;
+
+    // 创建算子对应的 Operator，开启权重共享时从共享存储获取
+    std::shared_ptr<Operator> CreateOperator(const std::shared_ptr<RuntimeOperator>& op);
+
+    // 创建算子的 Layer，开启自动调优且有多个适用实现时从缓存或计时结果里选择，cache_changed 记录是否新增了结果
+    std::shared_ptr<Layer> CreateLayer(const std::shared_ptr<RuntimeOperator>& op,
+                                       const std::shared_ptr<Operator>& layer_op, TuningCache& cache,
+                                       bool& cache_changed) const;
+
+    // 量化表里有卷积的输入和输出参数时启用 int8 计算，否则保持 fp32
+    void QuantizeConv(const std::shared_ptr<RuntimeOperator>& op, ConvOp& conv_op) const;
+
 
 private:
 
@@ -86,12 +221,35 @@ private:
     std::string output_name_;
     std::string param_path_;
     std::string bin_path_;
+    bool plan_cache_ = false;
+    bool loaded_from_plan_ = false;
+    bool share_weights_ = true;
+    bool reserve_halo_ = true;
+    bool fold_batchnorm_ = true;
+    RuntimeDataType weight_type_ = RuntimeDataType::kTypeFloat32;
+    uint64_t model_key_ = 0; // param/bin 文件的哈希
+    std::shared_ptr<WeightStore::ModelWeights> weights_; // 共享的只读权重
+    std::shared_ptr<RuntimeProfiler> profiler_; // 算子级别的性能分析
+    std::string dump_dir_; // 调试模式下算子输出的保存目录
+    OutputHook output_hook_; // 算子执行后的回调
+    std::string quant_table_path_; // int8 量化表的路径
+    std::shared_ptr<QuantTable> quant_table_; // Init 读取的量化表，没有时为空
+    std::set<std::string> folded_convs_; // 折叠了 BatchNorm 的卷积
+    bool auto_tune_ = false;
+    std::string tuning_cache_path_; // 调优缓存的路径，为空时使用默认路径
 
     std::map<std::string, std::shared_ptr<RuntimeOperator>> input_operators_map_; // 输入节点 - 生产者
     std::map<std::string, std::shared_ptr<RuntimeOperator>> output_operators_map_; // 输出节点 - 消费者
     std::vector<std::shared_ptr<RuntimeOperator>> operators_; // 算子集合
+    std::vector<std::shared_ptr<RuntimeOperator>> topo_operators_; // 拓扑排序后的算子
     std::unique_ptr<pnnx::Graph> graph_; // PNNX 计算图
 
+    // 构建时确定的输入边排布
+    std::set<const RuntimeOperator*> view_consumers_; // 直接读取输入视图的算子
+    bool input_needs_tensor_ = false; // 是否有消费者需要列主序的输入张量
+
 };
 
-}
\ No newline at end of file
+}
+
+#endif
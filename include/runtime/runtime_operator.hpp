@@ -28,6 +28,8 @@ struct RuntimeOperator {
     std::string name; // 算子名 - conv1
     std::string type; // 算子类型
     std::shared_ptr<Layer> layer; // 算子计算的层 - 实际计算的算子
+    std::string layer_impl; // layer 使用的实现名，Build 之后有效
+    std::shared_ptr<Operator> layer_op; // 创建 layer 的 Operator，Build 之后有效，卷积核只保存在这里
 
     // 输入节点可能有多个，输入操作数有多个
     std::map<std::string, std::shared_ptr<RuntimeOperand>> input_operands; // 输入操作数,名字是前一个算子节点的名字
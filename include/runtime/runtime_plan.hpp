@@ -0,0 +1,44 @@
+#ifndef KUIPER_INFER_RUNTIME_PLAN_HPP
+#define KUIPER_INFER_RUNTIME_PLAN_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "runtime_operator.hpp"
+
+namespace kuiper_infer {
+
+// 计算图的二进制执行计划缓存
+// 第一次加载时把解析好的算子(拓扑、操作数形状、参数和权重)写到 .pnnx.param 旁边的 .kplan 文件
+// 之后的启动直接 mmap 这个文件恢复 RuntimeOperator，跳过 pnnx 的文本解析和连接
+// 缓存的 key 是 param/bin 文件内容的哈希加上 CPU 指令集，任何一个变化缓存都会被拒绝并重建
+class RuntimePlan {
+
+public:
+
+    // 缓存格式的版本号，格式变化时需要递增
+    static constexpr uint32_t kPlanVersion = 1;
+
+    // 根据 param 文件路径得到缓存文件路径
+    // xxx.pnnx.param -> xxx.pnnx.kplan
+    static std::string PlanPath(const std::string& param_path);
+
+    // 计算缓存 key，读取失败时返回 0
+    static uint64_t PlanKey(const std::string& param_path, const std::string& bin_path);
+
+    // 当前机器支持的指令集，例如 "avx2,fma"
+    static const std::string& IsaSignature();
+
+    // 保存执行计划，成功返回 true
+    static bool Save(const std::string& plan_path, uint64_t key,
+                     const std::vector<std::shared_ptr<RuntimeOperator>>& operators);
+
+    // 加载执行计划，文件不存在、版本或 key 不一致、内容损坏时返回 false
+    static bool Load(const std::string& plan_path, uint64_t key,
+                     std::vector<std::shared_ptr<RuntimeOperator>>& operators);
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef KUIPER_INFER_RUNTIME_PROFILER_HPP
+#define KUIPER_INFER_RUNTIME_PROFILER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "data/tensor.hpp"
+#include "data/tensor_util.hpp"
+#include "runtime_operator.hpp"
+
+namespace kuiper_infer {
+
+// 一次 Layer::Forward 的记录
+struct ProfileRecord {
+    std::string name; // 算子名 - conv1
+    std::string type; // 算子类型 - nn.Conv2d
+    uint64_t start_ns = 0; // 开始时间
+    uint64_t end_ns = 0; // 结束时间
+    uint64_t thread_id = 0; // 执行线程
+    std::vector<std::vector<uint32_t>> input_shapes; // 每个输入张量的形状 CHW，不含边框
+    std::vector<std::vector<uint32_t>> output_shapes; // 每个输出张量的形状 CHW，不含边框
+    uint64_t bytes = 0; // 输出张量内部的字节数
+    uint64_t flops = 0; // 估算的浮点运算次数
+};
+
+// 算子级别的性能分析
+// 计算图设置了 profiler 之后，每个 Layer::Forward 都会被记录
+// 没有设置时执行器里只有一次指针判断
+// 支持多个线程的计算图共用一个 profiler
+class RuntimeProfiler {
+
+public:
+
+    // 单调时钟，纳秒
+    static uint64_t NowNs();
+
+    // 记录一次算子的执行
+    void Record(const std::shared_ptr<RuntimeOperator>& op,
+                const std::vector<std::shared_ptr<Tensor<float>>>& inputs,
+                const std::vector<std::shared_ptr<Tensor<float>>>& outputs,
+                uint64_t start_ns, uint64_t end_ns);
+
+    // 根据算子参数估算浮点运算次数，卷积按乘加各算一次
+    // 输出预留了 output_halo 大小的边框时只统计内部
+    static uint64_t EstimateFlops(const std::shared_ptr<RuntimeOperator>& op,
+                                  const std::vector<std::shared_ptr<Tensor<float>>>& inputs,
+                                  const std::vector<std::shared_ptr<Tensor<float>>>& outputs,
+                                  const Halo& output_halo = Halo());
+
+    void Clear();
+
+    std::vector<ProfileRecord> records() const;
+
+    // 按算子名汇总，按总耗时从大到小排序的表格
+    std::string Summary() const;
+
+    // chrome://tracing 和 Perfetto 可以打开的 trace_event 格式
+    std::string ChromeTrace() const;
+
+    bool DumpChromeTrace(const std::string& path) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<ProfileRecord> records_;
+};
+
+}
+
+#endif
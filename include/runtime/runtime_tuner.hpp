@@ -0,0 +1,49 @@
+#ifndef KUIPER_INFER_RUNTIME_RUNTIME_TUNER_HPP
+#define KUIPER_INFER_RUNTIME_RUNTIME_TUNER_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "runtime_operator.hpp"
+
+namespace kuiper_infer {
+
+// 自动调优的结果，保存为模型旁边的文本文件，之后的启动直接使用记录的实现，不再计时
+// key 包含 CPU 型号和指令集，换一台机器时重新调优
+//
+// kuiper_tuning_cache 1
+// <key> <实现名>
+struct TuningCache {
+    std::map<std::string, std::string> entries; // key -> 最快的实现名
+
+    // 格式版本号，格式变化时需要递增
+    static constexpr uint32_t kCacheVersion = 1;
+
+    // 根据 param 文件路径得到缓存路径
+    // xxx.pnnx.param -> xxx.pnnx.ktune
+    static std::string CachePath(const std::string& param_path);
+
+    // 保存成功返回 true
+    bool Save(const std::string& path) const;
+
+    // 文件不存在、版本不一致或内容损坏时返回 false，这时缓存的内容不变
+    bool Load(const std::string& path);
+};
+
+// 在算子的实际形状上给同一个 op 的多个实现计时，选出最快的一个
+class LayerTuner {
+public:
+    // 调优缓存的 key：CPU 型号、指令集、算子类型、输入输出形状、参数和权重形状，不含空白字符
+    static std::string TuningKey(const RuntimeOperator& op);
+
+    // 按操作数形状(batch 取 1)构造随机输入，每个实现预热一次后执行 repeats 次，取最短的一次比较
+    // 操作数形状未知(不是 4 维或有非正的维度)时不计时，返回空
+    static std::string SelectFastest(const RuntimeOperator& op, const std::shared_ptr<Operator>& layer_op,
+                                     const std::vector<std::string>& candidates, uint32_t repeats = 3);
+};
+
+}
+
+#endif
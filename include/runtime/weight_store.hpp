@@ -0,0 +1,49 @@
+#ifndef KUIPER_INFER_RUNTIME_WEIGHT_STORE_HPP
+#define KUIPER_INFER_RUNTIME_WEIGHT_STORE_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "ops/op.hpp"
+#include "runtime_attr.hpp"
+
+namespace kuiper_infer {
+
+// 只读权重的共享存储
+// 同一个模型(按 param/bin 的哈希区分)创建多个 RuntimeGraph 时，
+// 原始权重 RuntimeAttribute 和解析打包好权重的 Operator 只保存一份，
+// 每个计算图只持有引用，最后一个计算图析构后权重才释放
+class WeightStore {
+
+public:
+
+    // 一个模型的全部只读权重，创建后不再修改
+    struct ModelWeights {
+        // 算子名 -> 属性名 -> 权重
+        std::map<std::string, std::map<std::string, std::shared_ptr<RuntimeAttribute>>> attrs;
+
+        // 算子名 -> 已经打包好权重的 Operator，例如 ConvOp 里的卷积核
+        std::map<std::string, std::shared_ptr<Operator>> operators;
+
+        // 多个线程同时构建计算图时保护上面两个表
+        std::mutex mutex;
+    };
+
+    // 获取模型的共享权重，不存在时新建
+    static std::shared_ptr<ModelWeights> Acquire(uint64_t model_key);
+
+    // 当前还有计算图引用的模型个数
+    static uint32_t model_count();
+
+private:
+
+    static std::map<uint64_t, std::weak_ptr<ModelWeights>>& Registry();
+
+    static std::mutex& Mutex();
+};
+
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef KUIPER_INFER_TRACE_HPP
+#define KUIPER_INFER_TRACE_HPP
+
+#include <glog/logging.h>
+
+// 热路径上的日志，例如卷积里打印 im2col 矩阵和每个卷积核
+// 默认编译为空语句，参数不会被求值，也不会格式化
+// cmake -DKUIPER_ENABLE_TRACE=ON 时展开为 glog 的 LOG
+// 只在调试算子实现时打开，不要用来输出错误信息
+#ifdef KUIPER_ENABLE_TRACE
+#define KUIPER_TRACE(severity) LOG(severity)
+#define KUIPER_TRACE_IF(severity, condition) LOG_IF(severity, condition)
+#else
+#define KUIPER_TRACE(severity) \
+    while (false) LOG(severity)
+#define KUIPER_TRACE_IF(severity, condition) \
+    while (false) LOG_IF(severity, condition)
+#endif
+
+#endif
@@ -0,0 +1,110 @@
+#include "data/batch_tensor.hpp"
+#include <glog/logging.h>
+#include <cstring>
+#include "data/tensor_util.hpp"
+
+namespace kuiper_infer {
+
+BatchTensor::BatchTensor(uint32_t batch, uint32_t channels, uint32_t rows, uint32_t cols)
+    : batch_(batch), channels_(channels) {
+    CHECK(batch != 0 && channels != 0 && rows != 0 && cols != 0);
+    this->data_ = TensorCreate(batch * channels, rows, cols);
+}
+
+BatchTensor::BatchTensor(const std::vector<uint32_t>& shape)
+    : BatchTensor(shape.at(0), shape.at(1), shape.at(2), shape.at(3)) {
+    CHECK_EQ(shape.size(), 4);
+}
+
+BatchTensor::BatchTensor(uint32_t batch, std::shared_ptr<Tensor<float>> data) : batch_(batch), data_(std::move(data)) {
+    CHECK(batch != 0);
+    CHECK(this->data_ != nullptr && !this->data_->empty());
+    CHECK_EQ(this->data_->channels() % batch, 0) << "Channels can not be split into " << batch << " batch elements";
+    this->channels_ = this->data_->channels() / batch;
+}
+
+BatchTensor BatchTensor::FromVector(const std::vector<std::shared_ptr<Tensor<float>>>& tensors) {
+    CHECK(!tensors.empty());
+    const std::shared_ptr<Tensor<float>>& first = tensors.front();
+    CHECK(first != nullptr && !first->empty());
+
+    BatchTensor batch_tensor(tensors.size(), first->channels(), first->rows(), first->cols());
+    const uint32_t element_size = first->size();
+    for (uint32_t i = 0; i < tensors.size(); ++i) {
+        const std::shared_ptr<Tensor<float>>& tensor = tensors.at(i);
+        CHECK(tensor != nullptr && tensor->shape() == first->shape()) << "Batch elements have different shapes";
+        memcpy(batch_tensor.raw_ptr() + size_t(i) * element_size, tensor->raw_ptr(), element_size * sizeof(float));
+    }
+    return batch_tensor;
+}
+
+std::vector<std::shared_ptr<Tensor<float>>> BatchTensor::ToVector() const {
+    std::vector<std::shared_ptr<Tensor<float>>> tensors;
+    tensors.reserve(this->batch());
+    for (uint32_t i = 0; i < this->batch(); ++i) {
+        tensors.push_back(this->Batch(i));
+    }
+    return tensors;
+}
+
+uint32_t BatchTensor::batch() const {
+    CHECK(!this->empty());
+    return this->batch_;
+}
+
+uint32_t BatchTensor::channels() const {
+    CHECK(!this->empty());
+    return this->channels_;
+}
+
+uint32_t BatchTensor::rows() const {
+    CHECK(!this->empty());
+    return this->data_->rows();
+}
+
+uint32_t BatchTensor::cols() const {
+    CHECK(!this->empty());
+    return this->data_->cols();
+}
+
+uint32_t BatchTensor::size() const {
+    CHECK(!this->empty());
+    return this->data_->size();
+}
+
+bool BatchTensor::empty() const {
+    return this->data_ == nullptr || this->data_->empty();
+}
+
+std::vector<uint32_t> BatchTensor::shape() const {
+    return {this->batch(), this->channels(), this->rows(), this->cols()};
+}
+
+std::shared_ptr<Tensor<float>> BatchTensor::Batch(uint32_t index) const {
+    return this->view().Batch(index).AsTensor();
+}
+
+TensorView BatchTensor::view() const {
+    CHECK(!this->empty());
+    const uint32_t rows = this->rows();
+    const uint32_t cols = this->cols();
+    const uint32_t plane = rows * cols;
+    return TensorView(this->data_, this->raw_ptr(), this->shape(), {this->channels_ * plane, plane, 1, rows});
+}
+
+const std::shared_ptr<Tensor<float>>& BatchTensor::data() const {
+    return this->data_;
+}
+
+float* BatchTensor::raw_ptr() const {
+    CHECK(!this->empty());
+    return this->data_->data().memptr();
+}
+
+float& BatchTensor::at(uint32_t batch, uint32_t channel, uint32_t row, uint32_t col) const {
+    CHECK_LT(batch, this->batch());
+    CHECK_LT(channel, this->channels());
+    return this->data_->at(batch * this->channels_ + channel, row, col);
+}
+
+}
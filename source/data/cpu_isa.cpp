@@ -0,0 +1,146 @@
+#include "data/cpu_isa.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <glog/logging.h>
+#if defined(KUIPER_X86)
+#include <cpuid.h>
+#endif
+
+namespace kuiper_infer {
+
+const CpuFeatures& GetCpuFeatures() {
+    // libgcc 的 __builtin_cpu_supports 在 cpuid 之外还用 xgetbv 确认了操作系统支持 AVX/AVX-512 的寄存器状态
+    static const CpuFeatures features = []() {
+        CpuFeatures result;
+#if defined(KUIPER_X86)
+        __builtin_cpu_init();
+        result.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+                      __builtin_cpu_supports("f16c");
+        result.avx512 = result.avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                        __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq");
+        result.avx512_vnni = result.avx512 && __builtin_cpu_supports("avx512vnni");
+        result.avx512_bf16 = result.avx512 && __builtin_cpu_supports("avx512bf16");
+#endif
+        return result;
+    }();
+    return features;
+}
+
+const std::string& CpuModelName() {
+    static const std::string name = []() {
+        std::string result;
+#if defined(KUIPER_X86)
+        // 扩展功能 0x80000002 ~ 0x80000004 各返回 16 个字符
+        uint32_t regs[4] = {};
+        if (__get_cpuid(0x80000000, &regs[0], &regs[1], &regs[2], &regs[3]) && regs[0] >= 0x80000004) {
+            char brand[49] = {};
+            for (uint32_t i = 0; i < 3; ++i) {
+                __get_cpuid(0x80000002 + i, &regs[0], &regs[1], &regs[2], &regs[3]);
+                memcpy(brand + i * 16, regs, sizeof(regs));
+            }
+            result = brand;
+        }
+#endif
+        const size_t begin = result.find_first_not_of(' ');
+        const size_t end = result.find_last_not_of(' ');
+        return begin == std::string::npos ? std::string("unknown") : result.substr(begin, end - begin + 1);
+    }();
+    return name;
+}
+
+CpuIsa DetectCpuIsa() {
+    const CpuFeatures& features = GetCpuFeatures();
+    if (features.avx512) {
+        return CpuIsa::kAVX512;
+    }
+    return features.avx2 ? CpuIsa::kAVX2 : CpuIsa::kScalar;
+}
+
+static std::atomic<int>& ActiveIsaValue() {
+    static std::atomic<int> value([]() {
+        CpuIsa isa = DetectCpuIsa();
+        const char* env = std::getenv("KUIPER_CPU_ISA");
+        CpuIsa requested = isa;
+        if (env != nullptr && *env != '\0') {
+            if (!ParseCpuIsa(env, requested)) {
+                LOG(WARNING) << "Unknown KUIPER_CPU_ISA: " << env;
+            } else if (int(requested) > int(isa)) {
+                LOG(WARNING) << "KUIPER_CPU_ISA=" << env << " is not supported by this cpu, use "
+                             << CpuIsaName(isa);
+            } else {
+                isa = requested;
+            }
+        }
+        return int(isa);
+    }());
+    return value;
+}
+
+CpuIsa ActiveCpuIsa() {
+    return CpuIsa(ActiveIsaValue().load(std::memory_order_relaxed));
+}
+
+void SetActiveCpuIsa(CpuIsa isa) {
+    CHECK_LE(int(isa), int(DetectCpuIsa())) << CpuIsaName(isa) << " is not supported by this cpu";
+    ActiveIsaValue().store(int(isa), std::memory_order_relaxed);
+}
+
+const char* CpuIsaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::kScalar:
+            return "scalar";
+        case CpuIsa::kAVX2:
+            return "avx2";
+        case CpuIsa::kAVX512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+bool ParseCpuIsa(const std::string& name, CpuIsa& isa) {
+    for (uint32_t i = 0; i < kCpuIsaCount; ++i) {
+        if (name == CpuIsaName(CpuIsa(i))) {
+            isa = CpuIsa(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 内核在静态初始化时注册，注册表用函数内的静态变量，不依赖编译单元的初始化顺序
+struct KernelTable {
+    std::mutex mutex;
+    std::map<std::string, std::set<int>> variants;
+};
+
+static KernelTable& GetKernelTable() {
+    static KernelTable table;
+    return table;
+}
+
+void RegisterKernelVariant(const std::string& name, CpuIsa isa) {
+    KernelTable& table = GetKernelTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.variants[name].insert(int(isa));
+}
+
+std::vector<KernelInfo> RegisteredKernels() {
+    KernelTable& table = GetKernelTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    std::vector<KernelInfo> kernels;
+    for (const auto& [name, variants] : table.variants) {
+        KernelInfo info;
+        info.name = name;
+        for (const int isa : variants) {
+            info.variants.push_back(CpuIsa(isa));
+        }
+        kernels.push_back(std::move(info));
+    }
+    return kernels;
+}
+
+}
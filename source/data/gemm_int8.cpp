@@ -0,0 +1,222 @@
+#include "data/gemm_int8.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glog/logging.h>
+#include "data/cpu_isa.hpp"
+#if defined(KUIPER_X86)
+#include <immintrin.h>
+#endif
+
+namespace kuiper_infer {
+
+static constexpr uint32_t kPackN = PackedInt8Matrix::kPackN;
+
+// 每个线程一次处理的输出位置数，A 的这些行在处理所有输出通道块时留在 L1/L2 里
+static constexpr uint32_t kBlockM = 64;
+
+// 微内核一次计算的输出位置数，每一行对应 kPackN 个 int32 累加器
+static constexpr uint32_t kTileM = 8;
+
+bool PackedInt8Matrix::empty() const {
+    return this->data.empty();
+}
+
+PackedInt8Matrix PackInt8Matrix(const int8_t* weights, uint32_t n, uint32_t k) {
+    CHECK(weights != nullptr && n > 0 && k > 0);
+    PackedInt8Matrix packed;
+    packed.k = k;
+    packed.k_padded = (k + 3) / 4 * 4;
+    packed.n = n;
+    const uint32_t n_blocks = (n + kPackN - 1) / kPackN;
+    packed.data.assign(size_t(n_blocks) * kPackN * packed.k_padded, 0);
+    packed.column_sums.assign(n, 0);
+    for (uint32_t j = 0; j < n; ++j) {
+        int8_t* block = packed.data.data() + size_t(j / kPackN) * kPackN * packed.k_padded;
+        const uint32_t lane = j % kPackN;
+        for (uint32_t p = 0; p < k; ++p) {
+            const int8_t value = weights[size_t(j) * k + p];
+            block[size_t(p / 4) * kPackN * 4 + lane * 4 + p % 4] = value;
+            packed.column_sums.at(j) += value;
+        }
+    }
+    return packed;
+}
+
+// 微内核计算 rows(<= kTileM) 行 A 和一个输出通道块的乘积，写到 tile[row * kPackN + lane]
+// 不足 kTileM 行时多出的行重复计算最后一行，结果丢弃
+using MicroKernelFn = void (*)(const uint8_t* a, size_t lda, uint32_t rows, const int8_t* b, uint32_t k_groups,
+                               int32_t* tile);
+
+static void MicroKernelScalar(const uint8_t* a, size_t lda, uint32_t rows, const int8_t* b, uint32_t k_groups,
+                              int32_t* tile) {
+    for (uint32_t r = 0; r < kTileM; ++r) {
+        const uint8_t* row_ptr = a + std::min(r, rows - 1) * lda;
+        int32_t* tile_row = tile + r * kPackN;
+        std::fill(tile_row, tile_row + kPackN, 0);
+        for (uint32_t g = 0; g < k_groups; ++g) {
+            const int8_t* b_ptr = b + size_t(g) * kPackN * 4;
+            const uint8_t* a_ptr = row_ptr + g * 4;
+            for (uint32_t lane = 0; lane < kPackN; ++lane) {
+                for (uint32_t i = 0; i < 4; ++i) {
+                    tile_row[lane] += int32_t(a_ptr[i]) * int32_t(b_ptr[lane * 4 + i]);
+                }
+            }
+        }
+    }
+}
+
+#if defined(KUIPER_X86)
+// vpmaddubsw 把相邻两对 u8 x s8 的和饱和到 int16，255 * 127 * 2 会溢出
+// 把 A 拆成低 7 位和最高位两部分分别相乘，每部分的和都不超过 int16 的范围，结果是精确的
+// 16 个累加器放不下 8 行，分两次各算 4 行
+KUIPER_TARGET_AVX2 static void MicroKernelAvx2(const uint8_t* a, size_t lda, uint32_t rows, const int8_t* b,
+                                               uint32_t k_groups, int32_t* tile) {
+    constexpr uint32_t kHalfM = kTileM / 2;
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i low_mask = _mm256_set1_epi8(0x7f);
+    const __m256i high_mask = _mm256_set1_epi8(char(0x80));
+    for (uint32_t half = 0; half < kTileM; half += kHalfM) {
+        const uint8_t* row_ptrs[kHalfM];
+        for (uint32_t r = 0; r < kHalfM; ++r) {
+            row_ptrs[r] = a + std::min(half + r, rows - 1) * lda;
+        }
+        __m256i acc[kHalfM][2];
+        for (uint32_t r = 0; r < kHalfM; ++r) {
+            acc[r][0] = _mm256_setzero_si256();
+            acc[r][1] = _mm256_setzero_si256();
+        }
+        for (uint32_t g = 0; g < k_groups; ++g) {
+            const int8_t* b_ptr = b + size_t(g) * kPackN * 4;
+            const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_ptr));
+            const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b_ptr + 32));
+            for (uint32_t r = 0; r < kHalfM; ++r) {
+                int32_t a_value;
+                memcpy(&a_value, row_ptrs[r] + g * 4, sizeof(int32_t));
+                const __m256i a_vec = _mm256_set1_epi32(a_value);
+                const __m256i a_low = _mm256_and_si256(a_vec, low_mask);
+                const __m256i a_high = _mm256_and_si256(a_vec, high_mask);
+                const __m256i sum0 = _mm256_add_epi32(_mm256_madd_epi16(_mm256_maddubs_epi16(a_low, b0), ones),
+                                                      _mm256_madd_epi16(_mm256_maddubs_epi16(a_high, b0), ones));
+                const __m256i sum1 = _mm256_add_epi32(_mm256_madd_epi16(_mm256_maddubs_epi16(a_low, b1), ones),
+                                                      _mm256_madd_epi16(_mm256_maddubs_epi16(a_high, b1), ones));
+                acc[r][0] = _mm256_add_epi32(acc[r][0], sum0);
+                acc[r][1] = _mm256_add_epi32(acc[r][1], sum1);
+            }
+        }
+        for (uint32_t r = 0; r < kHalfM; ++r) {
+            int32_t* tile_row = tile + (half + r) * kPackN;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile_row), acc[r][0]);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(tile_row + 8), acc[r][1]);
+        }
+    }
+}
+
+KUIPER_TARGET_AVX512_VNNI static void MicroKernelVnni(const uint8_t* a, size_t lda, uint32_t rows, const int8_t* b,
+                                                      uint32_t k_groups, int32_t* tile) {
+    const uint8_t* row_ptrs[kTileM];
+    for (uint32_t r = 0; r < kTileM; ++r) {
+        row_ptrs[r] = a + std::min(r, rows - 1) * lda;
+    }
+    __m512i acc[kTileM];
+    for (uint32_t r = 0; r < kTileM; ++r) {
+        acc[r] = _mm512_setzero_si512();
+    }
+    for (uint32_t g = 0; g < k_groups; ++g) {
+        const __m512i b_vec = _mm512_loadu_si512(b + size_t(g) * kPackN * 4);
+        for (uint32_t r = 0; r < kTileM; ++r) {
+            int32_t a_value;
+            memcpy(&a_value, row_ptrs[r] + g * 4, sizeof(int32_t));
+            acc[r] = _mm512_dpbusd_epi32(acc[r], _mm512_set1_epi32(a_value), b_vec);
+        }
+    }
+    for (uint32_t r = 0; r < kTileM; ++r) {
+        _mm512_storeu_si512(tile + r * kPackN, acc[r]);
+    }
+}
+#endif
+
+// 没有 VNNI 的 AVX-512 CPU 使用 AVX2 版本
+static const IsaKernel<MicroKernelFn> kMicroKernel = IsaKernel<MicroKernelFn>("gemm_u8s8", MicroKernelScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, MicroKernelAvx2)
+    .Add(CpuIsa::kAVX512, GetCpuFeatures().avx512_vnni ? MicroKernelVnni : nullptr)
+#endif
+    ;
+
+// 按 kBlockM 行分给各个线程，store(row, rows, first_column, columns, tile) 处理一个结果块
+template <typename Store>
+static void GemmDriver(const uint8_t* a, size_t lda, uint32_t m, const PackedInt8Matrix& b, const Store& store) {
+    CHECK(a != nullptr && !b.empty());
+    CHECK_GE(lda, b.k_padded);
+    const uint32_t n_blocks = (b.n + kPackN - 1) / kPackN;
+    const uint32_t m_blocks = (m + kBlockM - 1) / kBlockM;
+    const uint32_t k_groups = b.k_padded / 4;
+    const MicroKernelFn micro_kernel = kMicroKernel.get();
+#pragma omp parallel for schedule(static) if (size_t(m) * b.n * b.k_padded >= (1 << 20))
+    for (uint32_t mb = 0; mb < m_blocks; ++mb) {
+        alignas(64) int32_t tile[kTileM * kPackN];
+        const uint32_t m_begin = mb * kBlockM;
+        const uint32_t m_end = std::min(m, m_begin + kBlockM);
+        for (uint32_t nb = 0; nb < n_blocks; ++nb) {
+            const int8_t* b_block = b.data.data() + size_t(nb) * kPackN * b.k_padded;
+            const uint32_t columns = std::min(kPackN, b.n - nb * kPackN);
+            for (uint32_t row = m_begin; row < m_end; row += kTileM) {
+                const uint32_t rows = std::min(kTileM, m_end - row);
+                micro_kernel(a + size_t(row) * lda, lda, rows, b_block, k_groups, tile);
+                store(row, rows, nb * kPackN, columns, tile);
+            }
+        }
+    }
+}
+
+void GemmU8S8(const uint8_t* a, size_t lda, uint32_t m, const PackedInt8Matrix& b, const Int8Epilogue& epilogue,
+              uint8_t* c, size_t ldc) {
+    CHECK(c != nullptr);
+    CHECK_EQ(epilogue.scales.size(), b.n);
+    CHECK(epilogue.bias.empty() || epilogue.bias.size() == b.n);
+    CHECK(epilogue.output_scale > 0.f);
+    CHECK_GE(ldc, m);
+
+    // 重新量化的舍入和截断方式和 QuantizeValues 一致
+    const float inv_output_scale = 1.f / epilogue.output_scale;
+    const float low = float(0 - epilogue.output_zero_point);
+    const float high = float(255 - epilogue.output_zero_point);
+    const bool has_bias = !epilogue.bias.empty();
+    GemmDriver(a, lda, m, b, [&](uint32_t row, uint32_t rows, uint32_t first_column, uint32_t columns,
+                                 const int32_t* tile) {
+        for (uint32_t lane = 0; lane < columns; ++lane) {
+            const uint32_t j = first_column + lane;
+            const int32_t offset = epilogue.input_zero_point * b.column_sums[j];
+            const float scale = epilogue.scales[j];
+            const float bias = has_bias ? epilogue.bias[j] : 0.f;
+            uint8_t* c_col = c + size_t(j) * ldc + row;
+            for (uint32_t r = 0; r < rows; ++r) {
+                float value = float(tile[r * kPackN + lane] - offset) * scale + bias;
+                if (epilogue.relu) {
+                    value = std::max(value, 0.f);
+                }
+                float scaled = value * inv_output_scale;
+                scaled = scaled > low ? scaled : low;
+                scaled = scaled < high ? scaled : high;
+                c_col[r] = uint8_t(int32_t(std::nearbyint(scaled)) + epilogue.output_zero_point);
+            }
+        }
+    });
+}
+
+void GemmU8S8(const uint8_t* a, size_t lda, uint32_t m, const PackedInt8Matrix& b, int32_t* c, size_t ldc) {
+    CHECK(c != nullptr);
+    CHECK_GE(ldc, m);
+    GemmDriver(a, lda, m, b, [&](uint32_t row, uint32_t rows, uint32_t first_column, uint32_t columns,
+                                 const int32_t* tile) {
+        for (uint32_t lane = 0; lane < columns; ++lane) {
+            int32_t* c_col = c + size_t(first_column + lane) * ldc + row;
+            for (uint32_t r = 0; r < rows; ++r) {
+                c_col[r] = tile[r * kPackN + lane];
+            }
+        }
+    });
+}
+
+}
@@ -0,0 +1,244 @@
+#include "data/half.hpp"
+#include <cstring>
+#include <glog/logging.h>
+#include "data/cpu_isa.hpp"
+#if defined(KUIPER_X86)
+#include <immintrin.h>
+#endif
+
+namespace kuiper_infer {
+
+static inline uint32_t FloatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float BitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+const char* HalfTypeName(HalfType type) {
+    switch (type) {
+        case HalfType::kFloat16:
+            return "fp16";
+        case HalfType::kBFloat16:
+            return "bf16";
+    }
+    return "unknown";
+}
+
+uint16_t FloatToFp16(float value) {
+    const uint32_t bits = FloatBits(value);
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t abs = bits & 0x7fffffff;
+
+    // inf 和 nan，nan 保留尾数的高位并置为 quiet nan
+    if (abs >= 0x7f800000) {
+        return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 | ((abs >> 13) & 0x3ff) : 0);
+    }
+    // 大于 fp16 的范围
+    if (abs >= 0x47800000) {
+        return sign | 0x7c00;
+    }
+    // 小于 fp16 非规格化数的一半，舍入为 0
+    if (abs < 0x33000000) {
+        return sign;
+    }
+
+    uint32_t result;
+    uint32_t remainder;
+    uint32_t half_point;
+    if (abs < 0x38800000) {
+        // fp16 的非规格化数，单位是 2^-24
+        const uint32_t shift = 126 - (abs >> 23);
+        const uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+        result = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        half_point = 1u << (shift - 1);
+    } else {
+        // 指数偏移从 127 改为 15，尾数保留高 10 位
+        result = (abs - 0x38000000) >> 13;
+        remainder = abs & 0x1fff;
+        half_point = 0x1000;
+    }
+    // 进位到指数时结果仍然正确，超过 65504 时进位为 inf
+    if (remainder > half_point || (remainder == half_point && (result & 1))) {
+        result += 1;
+    }
+    return sign | result;
+}
+
+float Fp16ToFloat(uint16_t value) {
+    const uint32_t sign = uint32_t(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            return BitsFloat(sign);
+        }
+        // 非规格化数在 fp32 里是规格化数
+        uint32_t float_exponent = 113;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            float_exponent -= 1;
+        }
+        mantissa &= 0x3ff;
+        return BitsFloat(sign | (float_exponent << 23) | (mantissa << 13));
+    }
+    if (exponent == 0x1f) {
+        return BitsFloat(sign | 0x7f800000 | (mantissa << 13));
+    }
+    return BitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+uint16_t FloatToBf16(float value) {
+    const uint32_t bits = FloatBits(value);
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+        return (bits >> 16) | 0x40;
+    }
+    return (bits + 0x7fff + ((bits >> 16) & 1)) >> 16;
+}
+
+float Bf16ToFloat(uint16_t value) {
+    return BitsFloat(uint32_t(value) << 16);
+}
+
+// 各个版本转换能整块向量化的部分，返回转换到的位置，剩下的元素逐个转换
+using ToHalfFn = size_t (*)(const float* src, uint16_t* dst, size_t count);
+using FromHalfFn = size_t (*)(const uint16_t* src, float* dst, size_t count);
+
+static size_t ToHalfScalar(const float*, uint16_t*, size_t) {
+    return 0;
+}
+
+static size_t FromHalfScalar(const uint16_t*, float*, size_t) {
+    return 0;
+}
+
+#if defined(KUIPER_X86)
+KUIPER_TARGET_AVX2 static size_t ToFp16Avx2(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i half = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), half);
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX512 static size_t ToFp16Avx512(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i half = _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), half);
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX2 static size_t FromFp16Avx2(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(half));
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX512 static size_t FromFp16Avx512(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i half = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(half));
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX512_BF16 static size_t ToBf16Avx512(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256bh half = _mm512_cvtneps_pbh(_mm512_loadu_ps(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), reinterpret_cast<const __m256i&>(half));
+    }
+    return i;
+}
+
+// bf16 左移 16 位就是 fp32
+KUIPER_TARGET_AVX2 static size_t FromBf16Avx2(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m256i bits = _mm256_slli_epi32(_mm256_cvtepu16_epi32(half), 16);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(bits));
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX512 static size_t FromBf16Avx512(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i half = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        const __m512i bits = _mm512_slli_epi32(_mm512_cvtepu16_epi32(half), 16);
+        _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(bits));
+    }
+    return i;
+}
+#endif
+
+static const IsaKernel<ToHalfFn> kToFp16Kernel = IsaKernel<ToHalfFn>("to_fp16", ToHalfScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, ToFp16Avx2)
+    .Add(CpuIsa::kAVX512, ToFp16Avx512)
+#endif
+    ;
+
+// 没有 BF16 扩展时按标量转换，结果和标量版本一致
+static const IsaKernel<ToHalfFn> kToBf16Kernel = IsaKernel<ToHalfFn>("to_bf16", ToHalfScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX512, GetCpuFeatures().avx512_bf16 ? ToBf16Avx512 : nullptr)
+#endif
+    ;
+
+static const IsaKernel<FromHalfFn> kFromFp16Kernel = IsaKernel<FromHalfFn>("from_fp16", FromHalfScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, FromFp16Avx2)
+    .Add(CpuIsa::kAVX512, FromFp16Avx512)
+#endif
+    ;
+
+static const IsaKernel<FromHalfFn> kFromBf16Kernel = IsaKernel<FromHalfFn>("from_bf16", FromHalfScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, FromBf16Avx2)
+    .Add(CpuIsa::kAVX512, FromBf16Avx512)
+#endif
+    ;
+
+void ConvertToHalf(const float* src, uint16_t* dst, size_t count, HalfType type) {
+    CHECK(count == 0 || (src != nullptr && dst != nullptr));
+    if (type == HalfType::kFloat16) {
+        for (size_t i = kToFp16Kernel.get()(src, dst, count); i < count; ++i) {
+            dst[i] = FloatToFp16(src[i]);
+        }
+    } else {
+        for (size_t i = kToBf16Kernel.get()(src, dst, count); i < count; ++i) {
+            dst[i] = FloatToBf16(src[i]);
+        }
+    }
+}
+
+void ConvertFromHalf(const uint16_t* src, float* dst, size_t count, HalfType type) {
+    CHECK(count == 0 || (src != nullptr && dst != nullptr));
+    if (type == HalfType::kFloat16) {
+        for (size_t i = kFromFp16Kernel.get()(src, dst, count); i < count; ++i) {
+            dst[i] = Fp16ToFloat(src[i]);
+        }
+    } else {
+        for (size_t i = kFromBf16Kernel.get()(src, dst, count); i < count; ++i) {
+            dst[i] = Bf16ToFloat(src[i]);
+        }
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+#include "data/half_tensor.hpp"
+#include "data/tensor_allocator.hpp"
+#include "data/tensor_util.hpp"
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+HalfTensor::HalfTensor(uint32_t channels, uint32_t rows, uint32_t cols, HalfType type)
+    : channels_(channels), rows_(rows), cols_(cols), type_(type) {
+    CHECK(channels != 0 && rows != 0 && cols != 0);
+    const std::shared_ptr<TensorAllocator>& allocator = TensorAllocator::Get();
+    const size_t bytes = size_t(channels) * rows * cols * sizeof(uint16_t);
+    uint16_t* buffer = static_cast<uint16_t*>(allocator->Allocate(bytes));
+    this->data_ = std::shared_ptr<uint16_t>(buffer, [allocator, bytes](uint16_t* ptr) {
+        allocator->Free(ptr, bytes);
+    });
+}
+
+std::shared_ptr<HalfTensor> HalfTensor::FromFloat(const Tensor<float>& tensor, HalfType type) {
+    CHECK(!tensor.empty());
+    std::shared_ptr<HalfTensor> half_tensor =
+        std::make_shared<HalfTensor>(tensor.channels(), tensor.rows(), tensor.cols(), type);
+    half_tensor->Store(0, tensor.size(), tensor.raw_ptr());
+    return half_tensor;
+}
+
+std::shared_ptr<Tensor<float>> HalfTensor::ToFloat() const {
+    CHECK(!this->empty());
+    std::shared_ptr<Tensor<float>> tensor = TensorCreate(this->channels_, this->rows_, this->cols_);
+    this->Load(0, this->size(), tensor->data().memptr());
+    return tensor;
+}
+
+void HalfTensor::Load(size_t offset, size_t count, float* dst) const {
+    CHECK(!this->empty());
+    CHECK_LE(offset + count, this->size()) << "HalfTensor index out of bound!";
+    ConvertFromHalf(this->data_.get() + offset, dst, count, this->type_);
+}
+
+void HalfTensor::Store(size_t offset, size_t count, const float* src) {
+    CHECK(!this->empty());
+    CHECK_LE(offset + count, this->size()) << "HalfTensor index out of bound!";
+    ConvertToHalf(src, this->data_.get() + offset, count, this->type_);
+}
+
+uint32_t HalfTensor::channels() const {
+    CHECK(!this->empty());
+    return this->channels_;
+}
+
+uint32_t HalfTensor::rows() const {
+    CHECK(!this->empty());
+    return this->rows_;
+}
+
+uint32_t HalfTensor::cols() const {
+    CHECK(!this->empty());
+    return this->cols_;
+}
+
+uint32_t HalfTensor::size() const {
+    CHECK(!this->empty());
+    return this->channels_ * this->rows_ * this->cols_;
+}
+
+bool HalfTensor::empty() const {
+    return this->data_ == nullptr;
+}
+
+std::vector<uint32_t> HalfTensor::shape() const {
+    CHECK(!this->empty());
+    return {this->channels_, this->rows_, this->cols_};
+}
+
+HalfType HalfTensor::type() const {
+    return this->type_;
+}
+
+uint16_t* HalfTensor::raw_ptr() const {
+    return this->data_.get();
+}
+
+}
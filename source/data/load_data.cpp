@@ -93,4 +93,25 @@ std::pair<size_t, size_t> CSVDataLoader::GetMatrixSize(std::ifstream &file, cons
     return {rows, cols};
 }
 
+bool CSVDataLoader::SaveData(const std::string &file_path, const arma::fmat &data, const char split_char) {
+    std::ofstream outfile(file_path, std::ios::out | std::ios::trunc);
+    if (!outfile.good()) {
+        LOG(ERROR) << "File open failed: " << file_path;
+        return false;
+    }
+
+    // 保留足够的有效位数，读回后数值不变
+    outfile.precision(9);
+    for (size_t row = 0; row < data.n_rows; ++row) {
+        for (size_t col = 0; col < data.n_cols; ++col) {
+            if (col != 0) {
+                outfile << split_char;
+            }
+            outfile << data.at(row, col);
+        }
+        outfile << '\n';
+    }
+    return outfile.good();
+}
+
 }
@@ -0,0 +1,250 @@
+#include "data/quantize.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <glog/logging.h>
+#include "data/cpu_isa.hpp"
+#if defined(KUIPER_X86)
+#include <immintrin.h>
+#endif
+
+namespace kuiper_infer {
+
+bool QuantParams::per_channel() const {
+    return this->scales.size() > 1;
+}
+
+float QuantParams::scale(uint32_t channel) const {
+    CHECK(!this->scales.empty());
+    return this->per_channel() ? this->scales.at(channel) : this->scales.front();
+}
+
+int32_t QuantParams::zero_point(uint32_t channel) const {
+    CHECK(!this->zero_points.empty());
+    return this->per_channel() ? this->zero_points.at(channel) : this->zero_points.front();
+}
+
+int32_t QuantParams::qmin() const {
+    return this->is_signed ? -128 : 0;
+}
+
+int32_t QuantParams::qmax() const {
+    return this->is_signed ? 127 : 255;
+}
+
+bool QuantParams::operator==(const QuantParams& other) const {
+    return this->scales == other.scales && this->zero_points == other.zero_points &&
+           this->is_signed == other.is_signed;
+}
+
+bool QuantParams::operator!=(const QuantParams& other) const {
+    return !(*this == other);
+}
+
+std::pair<float, int32_t> ChooseQuantParams(float min, float max, bool is_signed, bool symmetric) {
+    CHECK(min <= max) << "Invalid quantization range " << min << " " << max;
+    min = std::min(min, 0.f);
+    max = std::max(max, 0.f);
+    const int32_t qmin = is_signed ? -128 : 0;
+    const int32_t qmax = is_signed ? 127 : 255;
+
+    if (symmetric) {
+        // int8 对称量化只用 [-127, 127]，正负范围相同
+        const float abs_max = std::max(-min, max);
+        const int32_t zero_point = is_signed ? 0 : 128;
+        const float scale = abs_max == 0.f ? 1.f : abs_max / 127.f;
+        return {scale, zero_point};
+    }
+
+    if (max == min) {
+        return {1.f, qmin};
+    }
+    const float scale = (max - min) / float(qmax - qmin);
+    const int32_t zero_point = std::clamp(int32_t(std::nearbyint(qmin - min / scale)), qmin, qmax);
+    return {scale, zero_point};
+}
+
+// 先在浮点域里截断再舍入，超出 int32 范围的值和 nan 都不会溢出，nan 量化为 qmin
+static inline int32_t QuantizeValue(float value, float inv_scale, float low, float high) {
+    float scaled = value * inv_scale;
+    scaled = scaled > low ? scaled : low;
+    scaled = scaled < high ? scaled : high;
+    return int32_t(std::nearbyint(scaled));
+}
+
+// 各个版本处理能整块向量化的部分，返回处理到的位置，剩下的元素由调用方按标量计算
+using QuantizeFn = size_t (*)(const float* src, uint8_t* dst, size_t count, float inv_scale, float low, float high,
+                              int32_t zero_point, bool is_signed);
+using DequantizeFn = size_t (*)(const uint8_t* src, float* dst, size_t count, float scale, int32_t zero_point,
+                                bool is_signed);
+using DequantizeInt4Fn = size_t (*)(const uint8_t* src, float* dst, size_t count, float scale);
+
+static size_t QuantizeScalar(const float*, uint8_t*, size_t, float, float, float, int32_t, bool) {
+    return 0;
+}
+
+static size_t DequantizeScalar(const uint8_t*, float*, size_t, float, int32_t, bool) {
+    return 0;
+}
+
+static size_t DequantizeInt4Scalar(const uint8_t*, float*, size_t, float) {
+    return 0;
+}
+
+#if defined(KUIPER_X86)
+KUIPER_TARGET_AVX2 static inline __m256i Quantize8(const float* ptr, __m256 inv_scale, __m256 low, __m256 high,
+                                                   __m256i zero_point) {
+    __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(ptr), inv_scale);
+    scaled = _mm256_min_ps(_mm256_max_ps(scaled, low), high);
+    return _mm256_add_epi32(_mm256_cvtps_epi32(scaled), zero_point);
+}
+
+KUIPER_TARGET_AVX2 static size_t QuantizeAvx2(const float* src, uint8_t* dst, size_t count, float inv_scale,
+                                              float low, float high, int32_t zero_point, bool is_signed) {
+    const __m256 inv_scale_vec = _mm256_set1_ps(inv_scale);
+    const __m256 low_vec = _mm256_set1_ps(low);
+    const __m256 high_vec = _mm256_set1_ps(high);
+    const __m256i zero_point_vec = _mm256_set1_epi32(zero_point);
+    // packs 在两个 128 位通道内交错，最后按 32 位重新排列
+    const __m256i permute = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i q0 = Quantize8(src + i, inv_scale_vec, low_vec, high_vec, zero_point_vec);
+        const __m256i q1 = Quantize8(src + i + 8, inv_scale_vec, low_vec, high_vec, zero_point_vec);
+        const __m256i q2 = Quantize8(src + i + 16, inv_scale_vec, low_vec, high_vec, zero_point_vec);
+        const __m256i q3 = Quantize8(src + i + 24, inv_scale_vec, low_vec, high_vec, zero_point_vec);
+        // 值已经在 [qmin, qmax] 内，饱和打包不会改变结果
+        const __m256i q01 = _mm256_packs_epi32(q0, q1);
+        const __m256i q23 = _mm256_packs_epi32(q2, q3);
+        const __m256i packed = is_signed ? _mm256_packs_epi16(q01, q23) : _mm256_packus_epi16(q01, q23);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permutevar8x32_epi32(packed, permute));
+    }
+    return i;
+}
+
+// AVX-512 的 vpmovsdb / vpmovusdb 直接把 16 个 int32 饱和截断为字节，不需要重新排列
+KUIPER_TARGET_AVX512 static size_t QuantizeAvx512(const float* src, uint8_t* dst, size_t count, float inv_scale,
+                                                  float low, float high, int32_t zero_point, bool is_signed) {
+    const __m512 inv_scale_vec = _mm512_set1_ps(inv_scale);
+    const __m512 low_vec = _mm512_set1_ps(low);
+    const __m512 high_vec = _mm512_set1_ps(high);
+    const __m512i zero_point_vec = _mm512_set1_epi32(zero_point);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 scaled = _mm512_mul_ps(_mm512_loadu_ps(src + i), inv_scale_vec);
+        scaled = _mm512_min_ps(_mm512_max_ps(scaled, low_vec), high_vec);
+        const __m512i values = _mm512_add_epi32(_mm512_cvtps_epi32(scaled), zero_point_vec);
+        const __m128i bytes = is_signed ? _mm512_cvtsepi32_epi8(values) : _mm512_cvtusepi32_epi8(values);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), bytes);
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX2 static size_t DequantizeAvx2(const uint8_t* src, float* dst, size_t count, float scale,
+                                                int32_t zero_point, bool is_signed) {
+    const __m256 scale_vec = _mm256_set1_ps(scale);
+    const __m256i zero_point_vec = _mm256_set1_epi32(zero_point);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        const __m256i values = is_signed ? _mm256_cvtepi8_epi32(bytes) : _mm256_cvtepu8_epi32(bytes);
+        const __m256 real = _mm256_cvtepi32_ps(_mm256_sub_epi32(values, zero_point_vec));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(real, scale_vec));
+    }
+    return i;
+}
+
+KUIPER_TARGET_AVX512 static size_t DequantizeAvx512(const uint8_t* src, float* dst, size_t count, float scale,
+                                                    int32_t zero_point, bool is_signed) {
+    const __m512 scale_vec = _mm512_set1_ps(scale);
+    const __m512i zero_point_vec = _mm512_set1_epi32(zero_point);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m512i values = is_signed ? _mm512_cvtepi8_epi32(bytes) : _mm512_cvtepu8_epi32(bytes);
+        const __m512 real = _mm512_cvtepi32_ps(_mm512_sub_epi32(values, zero_point_vec));
+        _mm512_storeu_ps(dst + i, _mm512_mul_ps(real, scale_vec));
+    }
+    return i;
+}
+
+// 4 个字节广播到 8 个通道，第 j 个通道右移 4j 位取出一个 4 位值，再符号扩展
+KUIPER_TARGET_AVX2 static size_t DequantizeInt4Avx2(const uint8_t* src, float* dst, size_t count, float scale) {
+    const __m256 scale_vec = _mm256_set1_ps(scale);
+    const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+    const __m256i mask = _mm256_set1_epi32(0xf);
+    const __m256i sign = _mm256_set1_epi32(8);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int32_t packed;
+        memcpy(&packed, src + i / 2, sizeof(int32_t));
+        __m256i values = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(packed), shifts), mask);
+        values = _mm256_sub_epi32(_mm256_xor_si256(values, sign), sign);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(values), scale_vec));
+    }
+    return i;
+}
+#endif
+
+static const IsaKernel<QuantizeFn> kQuantizeKernel = IsaKernel<QuantizeFn>("quantize", QuantizeScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, QuantizeAvx2)
+    .Add(CpuIsa::kAVX512, QuantizeAvx512)
+#endif
+    ;
+
+static const IsaKernel<DequantizeFn> kDequantizeKernel = IsaKernel<DequantizeFn>("dequantize", DequantizeScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, DequantizeAvx2)
+    .Add(CpuIsa::kAVX512, DequantizeAvx512)
+#endif
+    ;
+
+static const IsaKernel<DequantizeInt4Fn> kDequantizeInt4Kernel =
+    IsaKernel<DequantizeInt4Fn>("dequantize_int4", DequantizeInt4Scalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, DequantizeInt4Avx2)
+#endif
+    ;
+
+void QuantizeValues(const float* src, uint8_t* dst, size_t count, float scale, int32_t zero_point, bool is_signed) {
+    CHECK(scale > 0.f) << "Quantization scale must be positive";
+    const int32_t qmin = is_signed ? -128 : 0;
+    const int32_t qmax = is_signed ? 127 : 255;
+    const float inv_scale = 1.f / scale;
+    const float low = float(qmin - zero_point);
+    const float high = float(qmax - zero_point);
+
+    size_t i = kQuantizeKernel.get()(src, dst, count, inv_scale, low, high, zero_point, is_signed);
+    for (; i < count; ++i) {
+        dst[i] = uint8_t(QuantizeValue(src[i], inv_scale, low, high) + zero_point);
+    }
+}
+
+void DequantizeValues(const uint8_t* src, float* dst, size_t count, float scale, int32_t zero_point, bool is_signed) {
+    size_t i = kDequantizeKernel.get()(src, dst, count, scale, zero_point, is_signed);
+    for (; i < count; ++i) {
+        const int32_t value = is_signed ? int32_t(int8_t(src[i])) : int32_t(src[i]);
+        dst[i] = float(value - zero_point) * scale;
+    }
+}
+
+void QuantizeInt4Values(const float* src, uint8_t* dst, size_t count, float scale) {
+    CHECK(scale > 0.f) << "Quantization scale must be positive";
+    const float inv_scale = 1.f / scale;
+    std::fill(dst, dst + (count + 1) / 2, uint8_t(0));
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t value = QuantizeValue(src[i], inv_scale, -7.f, 7.f);
+        dst[i / 2] |= uint8_t((value & 0xf) << (i % 2 * 4));
+    }
+}
+
+void DequantizeInt4Values(const uint8_t* src, float* dst, size_t count, float scale) {
+    size_t i = kDequantizeInt4Kernel.get()(src, dst, count, scale);
+    for (; i < count; ++i) {
+        const int32_t nibble = (src[i / 2] >> (i % 2 * 4)) & 0xf;
+        dst[i] = float((nibble ^ 8) - 8) * scale;
+    }
+}
+
+}
@@ -0,0 +1,398 @@
+#include "data/sgemm.hpp"
+#include <algorithm>
+#include <cstring>
+#include <glog/logging.h>
+#include <omp.h>
+#include "data/cpu_isa.hpp"
+#include "data/vector_kernels.hpp"
+#if defined(KUIPER_X86)
+#include <immintrin.h>
+#endif
+
+namespace kuiper_infer {
+
+static constexpr uint32_t kNR = PackedSgemmMatrix::kNR;
+static constexpr uint32_t kKC = PackedSgemmMatrix::kKC;
+
+// 一个任务处理的 A 的行数，kMC x kKC 的 A 块(256KB)留在 L2 里
+static constexpr uint32_t kMC = 256;
+
+// 一次处理的 B 的列数，kKC x kNC 的 B 段(3MB)留在 L3 里
+static constexpr uint32_t kNC = 256 * kNR;
+
+// 微内核里最大的 MR，用于边缘结果块的缓冲区
+static constexpr uint32_t kMaxMR = 32;
+
+// M 不超过 kSmallM 时(全连接层的小 batch)不经过微内核，直接按 B 条计算
+static constexpr uint32_t kSmallM = 4;
+
+bool PackedSgemmMatrix::empty() const {
+    return this->data.empty();
+}
+
+PackedSgemmMatrix PackSgemmMatrix(const float* b, size_t ldb, uint32_t k, uint32_t n) {
+    CHECK(b != nullptr && k > 0 && n > 0);
+    CHECK_GE(ldb, k);
+    PackedSgemmMatrix packed;
+    packed.k = k;
+    packed.n = n;
+    packed.n_padded = (n + kNR - 1) / kNR * kNR;
+    packed.data.assign(size_t(k) * packed.n_padded, 0.f);
+    for (uint32_t pc = 0; pc < k; pc += kKC) {
+        const uint32_t kc = std::min(kKC, k - pc);
+        float* panel = packed.data.data() + size_t(pc) * packed.n_padded;
+        for (uint32_t j = 0; j < n; ++j) {
+            const float* column = b + size_t(j) * ldb + pc;
+            float* sliver = panel + size_t(j / kNR) * kc * kNR + j % kNR;
+            for (uint32_t p = 0; p < kc; ++p) {
+                sliver[size_t(p) * kNR] = column[p];
+            }
+        }
+    }
+    return packed;
+}
+
+// 微内核计算打包好的 A 条 (mr, k) 和 B 条 (k, kNR) 的乘积，写到 c 开始的 mr x kNR 列主序块
+// accumulate 时加到 c 原来的值上，结果块总是完整的，边缘由调用方借助缓冲区处理
+using MicroKernelFn = void (*)(uint32_t k, const float* a, const float* b, float* c, size_t ldc, bool accumulate);
+
+struct SgemmMicroKernel {
+    uint32_t mr;
+    MicroKernelFn run;
+};
+
+static void MicroKernelScalar(uint32_t k, const float* a, const float* b, float* c, size_t ldc, bool accumulate) {
+    constexpr uint32_t kMR = 8;
+    float acc[kNR][kMR] = {};
+    for (uint32_t p = 0; p < k; ++p) {
+        const float* a_ptr = a + size_t(p) * kMR;
+        const float* b_ptr = b + size_t(p) * kNR;
+        for (uint32_t j = 0; j < kNR; ++j) {
+            for (uint32_t r = 0; r < kMR; ++r) {
+                acc[j][r] += a_ptr[r] * b_ptr[j];
+            }
+        }
+    }
+    for (uint32_t j = 0; j < kNR; ++j) {
+        float* c_col = c + j * ldc;
+        for (uint32_t r = 0; r < kMR; ++r) {
+            c_col[r] = accumulate ? c_col[r] + acc[j][r] : acc[j][r];
+        }
+    }
+}
+
+#if defined(KUIPER_X86)
+// 16 x 12 的结果块分两次各算 6 列，12 个累加器加 2 个 A 寄存器，每个 k 读 2 次 A、广播 6 次 B
+KUIPER_TARGET_AVX2 static void MicroKernelAvx2(uint32_t k, const float* a, const float* b, float* c, size_t ldc,
+                                               bool accumulate) {
+    constexpr uint32_t kMR = 16;
+    constexpr uint32_t kHalfN = kNR / 2;
+    for (uint32_t half = 0; half < kNR; half += kHalfN) {
+        __m256 acc[kHalfN][2];
+        for (uint32_t j = 0; j < kHalfN; ++j) {
+            acc[j][0] = _mm256_setzero_ps();
+            acc[j][1] = _mm256_setzero_ps();
+        }
+        const float* a_ptr = a;
+        const float* b_ptr = b + half;
+        for (uint32_t p = 0; p < k; ++p) {
+            const __m256 a0 = _mm256_loadu_ps(a_ptr);
+            const __m256 a1 = _mm256_loadu_ps(a_ptr + 8);
+            for (uint32_t j = 0; j < kHalfN; ++j) {
+                const __m256 b_value = _mm256_broadcast_ss(b_ptr + j);
+                acc[j][0] = _mm256_fmadd_ps(a0, b_value, acc[j][0]);
+                acc[j][1] = _mm256_fmadd_ps(a1, b_value, acc[j][1]);
+            }
+            a_ptr += kMR;
+            b_ptr += kNR;
+        }
+        for (uint32_t j = 0; j < kHalfN; ++j) {
+            float* c_col = c + (half + j) * ldc;
+            if (accumulate) {
+                acc[j][0] = _mm256_add_ps(acc[j][0], _mm256_loadu_ps(c_col));
+                acc[j][1] = _mm256_add_ps(acc[j][1], _mm256_loadu_ps(c_col + 8));
+            }
+            _mm256_storeu_ps(c_col, acc[j][0]);
+            _mm256_storeu_ps(c_col + 8, acc[j][1]);
+        }
+    }
+}
+
+// 32 x 12 的结果块，24 个累加器，每个 k 读 2 次 A、广播 12 次 B，FMA 和读取的比例约 2 : 1
+KUIPER_TARGET_AVX512 static void MicroKernelAvx512(uint32_t k, const float* a, const float* b, float* c, size_t ldc,
+                                                   bool accumulate) {
+    constexpr uint32_t kMR = 32;
+    __m512 acc[kNR][2];
+    for (uint32_t j = 0; j < kNR; ++j) {
+        acc[j][0] = _mm512_setzero_ps();
+        acc[j][1] = _mm512_setzero_ps();
+    }
+    const float* a_ptr = a;
+    const float* b_ptr = b;
+    for (uint32_t p = 0; p < k; ++p) {
+        const __m512 a0 = _mm512_loadu_ps(a_ptr);
+        const __m512 a1 = _mm512_loadu_ps(a_ptr + 16);
+        for (uint32_t j = 0; j < kNR; ++j) {
+            const __m512 b_value = _mm512_set1_ps(b_ptr[j]);
+            acc[j][0] = _mm512_fmadd_ps(a0, b_value, acc[j][0]);
+            acc[j][1] = _mm512_fmadd_ps(a1, b_value, acc[j][1]);
+        }
+        a_ptr += kMR;
+        b_ptr += kNR;
+    }
+    for (uint32_t j = 0; j < kNR; ++j) {
+        float* c_col = c + j * ldc;
+        if (accumulate) {
+            acc[j][0] = _mm512_add_ps(acc[j][0], _mm512_loadu_ps(c_col));
+            acc[j][1] = _mm512_add_ps(acc[j][1], _mm512_loadu_ps(c_col + 16));
+        }
+        _mm512_storeu_ps(c_col, acc[j][0]);
+        _mm512_storeu_ps(c_col + 16, acc[j][1]);
+    }
+}
+
+static const SgemmMicroKernel kAvx2MicroKernel = {16, MicroKernelAvx2};
+static const SgemmMicroKernel kAvx512MicroKernel = {32, MicroKernelAvx512};
+#endif
+
+static const SgemmMicroKernel kScalarMicroKernel = {8, MicroKernelScalar};
+
+static const IsaKernel<const SgemmMicroKernel*> kMicroKernel =
+    IsaKernel<const SgemmMicroKernel*>("sgemm", &kScalarMicroKernel)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, &kAvx2MicroKernel)
+    .Add(CpuIsa::kAVX512, &kAvx512MicroKernel)
+#endif
+    ;
+
+// 微内核的 A 要补齐到 MR 行，m = 1 时只有 1 / MR 的计算有效，小 M 改为流式读取 B 条，带宽受限
+// a 是 [p * M + r] 排布的 (M, k)，b 是 (k, kNR) 的 B 条，结果累加到行主序的 acc[M][kNR]
+// M 是模板参数，累加器可以留在寄存器里，没有手写向量版本，各个 target 的包装函数由编译器向量化
+template <uint32_t M>
+KUIPER_ALWAYS_INLINE void SmallMBody(uint32_t k, const float* a, const float* b, float* acc) {
+    float sum[M][kNR];
+    for (uint32_t r = 0; r < M; ++r) {
+        for (uint32_t j = 0; j < kNR; ++j) {
+            sum[r][j] = acc[r * kNR + j];
+        }
+    }
+    for (uint32_t p = 0; p < k; ++p) {
+        const float* b_ptr = b + size_t(p) * kNR;
+        for (uint32_t r = 0; r < M; ++r) {
+            const float a_value = a[size_t(p) * M + r];
+            for (uint32_t j = 0; j < kNR; ++j) {
+                sum[r][j] += a_value * b_ptr[j];
+            }
+        }
+    }
+    for (uint32_t r = 0; r < M; ++r) {
+        for (uint32_t j = 0; j < kNR; ++j) {
+            acc[r * kNR + j] = sum[r][j];
+        }
+    }
+}
+
+KUIPER_ALWAYS_INLINE void SmallMDispatch(uint32_t m, uint32_t k, const float* a, const float* b, float* acc) {
+    switch (m) {
+        case 1: SmallMBody<1>(k, a, b, acc); break;
+        case 2: SmallMBody<2>(k, a, b, acc); break;
+        case 3: SmallMBody<3>(k, a, b, acc); break;
+        default: SmallMBody<4>(k, a, b, acc); break;
+    }
+}
+
+using SmallMFn = void (*)(uint32_t m, uint32_t k, const float* a, const float* b, float* acc);
+
+static void SmallMScalar(uint32_t m, uint32_t k, const float* a, const float* b, float* acc) {
+    SmallMDispatch(m, k, a, b, acc);
+}
+
+#if defined(KUIPER_X86)
+KUIPER_TARGET_AVX2 static void SmallMAvx2(uint32_t m, uint32_t k, const float* a, const float* b, float* acc) {
+    SmallMDispatch(m, k, a, b, acc);
+}
+
+KUIPER_TARGET_AVX512 static void SmallMAvx512(uint32_t m, uint32_t k, const float* a, const float* b, float* acc) {
+    SmallMDispatch(m, k, a, b, acc);
+}
+#endif
+
+static const IsaKernel<SmallMFn> kSmallMKernel = IsaKernel<SmallMFn>("sgemm_small_m", SmallMScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, SmallMAvx2)
+    .Add(CpuIsa::kAVX512, SmallMAvx512)
+#endif
+    ;
+
+// 把 A 的 rows 行 x kc 列(从 a 开始)按 mr 行一条打包，条内按列存放 mr 个元素，不足 mr 行补 0
+static void PackA(const float* a, size_t lda, uint32_t rows, uint32_t kc, uint32_t mr, float* packed) {
+    for (uint32_t ir = 0; ir < rows; ir += mr) {
+        const uint32_t valid = std::min(mr, rows - ir);
+        float* sliver = packed + size_t(ir) * kc;
+        for (uint32_t p = 0; p < kc; ++p) {
+            const float* column = a + size_t(p) * lda + ir;
+            float* dst = sliver + size_t(p) * mr;
+            memcpy(dst, column, valid * sizeof(float));
+            std::fill(dst + valid, dst + mr, 0.f);
+        }
+    }
+}
+
+// 结果块的后处理，最后一段 K 算完之后调用
+static void ApplyEpilogue(const SgemmEpilogue& epilogue, uint32_t first_column, uint32_t rows, uint32_t columns,
+                          float* c, size_t ldc) {
+    if (epilogue.bias == nullptr && epilogue.activation == SgemmActivation::kNone) {
+        return;
+    }
+    for (uint32_t j = 0; j < columns; ++j) {
+        float* c_col = c + j * ldc;
+        if (epilogue.bias != nullptr) {
+            const float bias = epilogue.bias[first_column + j];
+            for (uint32_t r = 0; r < rows; ++r) {
+                c_col[r] += bias;
+            }
+        }
+        if (epilogue.activation == SgemmActivation::kReLU) {
+            ReluValues(c_col, c_col, rows, 0.f);
+        } else if (epilogue.activation == SgemmActivation::kSigmoid) {
+            SigmoidValues(c_col, c_col, rows);
+        }
+    }
+}
+
+// M 不超过 kSmallM 时的计算，线程按 B 条划分，每条的所有 K 段算完后写回并做后处理
+template <typename PackBlock>
+static void SgemmSmallM(uint32_t m, const PackBlock& pack_a, const PackedSgemmMatrix& b, float* c, size_t ldc,
+                        const SgemmEpilogue& epilogue) {
+    const SmallMFn kernel = kSmallMKernel.get();
+    const uint32_t k = b.k;
+    const uint32_t n = b.n;
+    const uint32_t slivers = b.n_padded / kNR;
+    // 整个 A 只有 m x k，按 [p * m + r] 打包一次
+    std::vector<float> a_packed(size_t(k) * m);
+    for (uint32_t pc = 0; pc < k; pc += kKC) {
+        pack_a(0, m, pc, std::min(kKC, k - pc), m, a_packed.data() + size_t(pc) * m);
+    }
+
+#pragma omp parallel for schedule(static) if (uint64_t(m) * n * k >= (1 << 18))
+    for (uint32_t jr = 0; jr < slivers; ++jr) {
+        float acc[kSmallM * kNR] = {};
+        for (uint32_t pc = 0; pc < k; pc += kKC) {
+            const uint32_t kc = std::min(kKC, k - pc);
+            const float* b_sliver = b.data.data() + size_t(pc) * b.n_padded + size_t(jr) * kc * kNR;
+            kernel(m, kc, a_packed.data() + size_t(pc) * m, b_sliver, acc);
+        }
+        const uint32_t first_column = jr * kNR;
+        const uint32_t columns = std::min(kNR, n - first_column);
+        float* c_tile = c + size_t(first_column) * ldc;
+        for (uint32_t j = 0; j < columns; ++j) {
+            for (uint32_t r = 0; r < m; ++r) {
+                c_tile[j * ldc + r] = acc[r * kNR + j];
+            }
+        }
+        ApplyEpilogue(epilogue, first_column, m, columns, c_tile, ldc);
+    }
+}
+
+// 分块计算的主体，pack_a(first_row, rows, first_col, cols, mr, packed) 按 PackA 的布局生成 A 的一块
+template <typename PackBlock>
+static void SgemmDriver(uint32_t m, const PackBlock& pack_a, const PackedSgemmMatrix& b, float* c, size_t ldc,
+                        const SgemmEpilogue& epilogue) {
+    CHECK(c != nullptr && !b.empty());
+    CHECK_GE(ldc, m);
+    if (m == 0) {
+        return;
+    }
+    if (m <= kSmallM) {
+        SgemmSmallM(m, pack_a, b, c, ldc, epilogue);
+        return;
+    }
+    const SgemmMicroKernel& micro_kernel = *kMicroKernel.get();
+    const uint32_t mr = micro_kernel.mr;
+    const uint32_t k = b.k;
+    const uint32_t n = b.n;
+    const uint32_t m_blocks = (m + kMC - 1) / kMC;
+    const uint32_t slivers = b.n_padded / kNR;
+
+    // M 方向的块不够每个线程一块时把 N 切成几段，每段的任务各自打包同一块 A
+    const bool parallel = uint64_t(m) * n * k >= (1 << 18);
+    const uint32_t threads = parallel ? uint32_t(omp_get_max_threads()) : 1;
+    const uint32_t n_chunks = std::min(slivers, std::max(1u, (threads + m_blocks - 1) / m_blocks));
+    const uint32_t slivers_per_chunk = (slivers + n_chunks - 1) / n_chunks;
+    const int32_t tasks = int32_t(m_blocks * n_chunks);
+
+#pragma omp parallel if (parallel && tasks > 1)
+    {
+        std::vector<float> a_packed(size_t(kMC) * kKC);
+        alignas(64) float edge[kMaxMR * kNR];
+#pragma omp for schedule(static)
+        for (int32_t task = 0; task < tasks; ++task) {
+            const uint32_t m_begin = uint32_t(task) / n_chunks * kMC;
+            const uint32_t mc = std::min(kMC, m - m_begin);
+            const uint32_t sliver_begin = uint32_t(task) % n_chunks * slivers_per_chunk;
+            const uint32_t sliver_end = std::min(slivers, sliver_begin + slivers_per_chunk);
+            for (uint32_t jc = sliver_begin; jc < sliver_end; jc += kNC / kNR) {
+                const uint32_t jc_end = std::min(sliver_end, jc + kNC / kNR);
+                for (uint32_t pc = 0; pc < k; pc += kKC) {
+                    const uint32_t kc = std::min(kKC, k - pc);
+                    const bool accumulate = pc > 0;
+                    const bool last = pc + kc == k;
+                    pack_a(m_begin, mc, pc, kc, mr, a_packed.data());
+                    const float* panel = b.data.data() + size_t(pc) * b.n_padded;
+                    for (uint32_t jr = jc; jr < jc_end; ++jr) {
+                        const float* b_sliver = panel + size_t(jr) * kc * kNR;
+                        const uint32_t first_column = jr * kNR;
+                        const uint32_t columns = std::min(kNR, n - first_column);
+                        for (uint32_t ir = 0; ir < mc; ir += mr) {
+                            const float* a_sliver = a_packed.data() + size_t(ir) * kc;
+                            const uint32_t rows = std::min(mr, mc - ir);
+                            float* c_tile = c + size_t(first_column) * ldc + m_begin + ir;
+                            if (rows == mr && columns == kNR) {
+                                micro_kernel.run(kc, a_sliver, b_sliver, c_tile, ldc, accumulate);
+                            } else {
+                                // 边缘的结果块先写到缓冲区，只把有效的部分写回
+                                micro_kernel.run(kc, a_sliver, b_sliver, edge, mr, false);
+                                for (uint32_t j = 0; j < columns; ++j) {
+                                    float* c_col = c_tile + j * ldc;
+                                    const float* edge_col = edge + j * mr;
+                                    for (uint32_t r = 0; r < rows; ++r) {
+                                        c_col[r] = accumulate ? c_col[r] + edge_col[r] : edge_col[r];
+                                    }
+                                }
+                            }
+                            if (last) {
+                                ApplyEpilogue(epilogue, first_column, rows, columns, c_tile, ldc);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void Sgemm(uint32_t m, const float* a, size_t lda, const PackedSgemmMatrix& b, float* c, size_t ldc,
+           const SgemmEpilogue& epilogue) {
+    CHECK(a != nullptr);
+    CHECK_GE(lda, m);
+    SgemmDriver(m, [&](uint32_t first_row, uint32_t rows, uint32_t first_col, uint32_t cols, uint32_t mr,
+                       float* packed) {
+        PackA(a + size_t(first_col) * lda + first_row, lda, rows, cols, mr, packed);
+    }, b, c, ldc, epilogue);
+}
+
+void SgemmImplicit(uint32_t m, const SgemmPackA& pack_a, const PackedSgemmMatrix& b, float* c, size_t ldc,
+                   const SgemmEpilogue& epilogue) {
+    CHECK(pack_a != nullptr);
+    SgemmDriver(m, pack_a, b, c, ldc, epilogue);
+}
+
+void Sgemm(uint32_t m, uint32_t n, uint32_t k, const float* a, size_t lda, const float* b, size_t ldb, float* c,
+           size_t ldc, const SgemmEpilogue& epilogue) {
+    if (m == 0) {
+        return;
+    }
+    Sgemm(m, a, lda, PackSgemmMatrix(b, ldb, k, n), c, ldc, epilogue);
+}
+
+}
@@ -1,4 +1,5 @@
 #include "data/tensor.hpp"
+#include "data/tensor_util.hpp"
 #include <glog/logging.h>
 #include <memory>
 #include <numeric>
@@ -37,6 +38,20 @@ Tensor<float>::Tensor(const std::vector<uint32_t>& shape) {
     }
 }
 
+Tensor<float>::Tensor(float* raw_ptr, uint32_t channels, uint32_t rows, uint32_t cols)
+    : data_(raw_ptr, rows, cols, channels, false, false) {
+    // copy_aux_mem = false 时 fcube 直接使用这块内存
+    // 必须在初始化列表里构造，赋值会复制一份数据
+    CHECK(raw_ptr != nullptr);
+    if (channels == 1 && rows == 1) {
+        this->raw_shape_ = std::vector<uint32_t>{cols};
+    } else if (channels == 1) {
+        this->raw_shape_ = std::vector<uint32_t>{rows, cols};
+    } else {
+        this->raw_shape_ = std::vector<uint32_t>{rows, cols, channels};
+    }
+}
+
 Tensor<float>::Tensor(const Tensor<float>& tensor) {
     // 传入 tensor 引用，&tensor 实际 tensor 地址
     if (this != &tensor) {
@@ -188,16 +203,9 @@ void Tensor<float>::Fill(const std::vector<float>& values, bool row_major) {
     CHECK_EQ(values.size(), total_elems);
 
     if (row_major) {
-        const uint32_t rows = this->data_.n_rows;
-        const uint32_t cols = this->data_.n_cols;
-        const uint32_t channels = this->data_.n_slices;
-        const uint32_t planes = rows * cols;
-
-        for (uint32_t i = 0; i < channels; ++i) {
-            auto& channel_data = this->data_.slice(i);
-            const arma::fmat& channel_data_t = arma::fmat(values.data() + i * planes, this->cols(), this->rows());
-            channel_data = channel_data_t.t(); // fmat默认是列主序的
-        }
+        // 每个通道是行主序的 (rows, cols)，直接转置写入列主序的内存
+        TransposePlanes(values.data(), this->data_.memptr(), this->data_.n_slices, this->data_.n_rows,
+                        this->data_.n_cols);
     } else {
         std::copy(values.begin(), values.end(), this->data_.memptr());
     }
@@ -280,13 +288,9 @@ std::vector<float> Tensor<float>::values(bool row_major) {
         std::copy(this->data_.mem, this->data_.mem + this->data_.size(),
               values.begin());
   } else {
-        uint32_t index = 0;
-        for (uint32_t c = 0; c < this->data_.n_slices; ++c) {
-            const arma::fmat& channel_data = this->data_.slice(c).t();
-            std::copy(channel_data.begin(), channel_data.end(), values.begin() + index);
-            index += channel_data.size();
-        }
-        CHECK_EQ(index, values.size());
+        // 列主序的 (rows, cols) 就是行主序的 (cols, rows)，转置后得到行主序
+        TransposePlanes(this->data_.memptr(), values.data(), this->data_.n_slices, this->data_.n_cols,
+                        this->data_.n_rows);
   }
   return values;
 }
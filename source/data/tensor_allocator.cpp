@@ -0,0 +1,199 @@
+#include "data/tensor_allocator.hpp"
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <sys/mman.h>
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+namespace {
+
+std::mutex& AllocatorMutex() {
+    static auto *kMutex = new std::mutex();
+    return *kMutex;
+}
+
+std::shared_ptr<TensorAllocator>& CurrentAllocator() {
+    static auto *kAllocator = new std::shared_ptr<TensorAllocator>(PoolAllocator::Instance());
+    return *kAllocator;
+}
+
+}  // namespace
+
+std::shared_ptr<TensorAllocator> TensorAllocator::Get() {
+    std::lock_guard<std::mutex> lock(AllocatorMutex());
+    return CurrentAllocator();
+}
+
+void TensorAllocator::Set(std::shared_ptr<TensorAllocator> allocator) {
+    CHECK(allocator != nullptr);
+    std::lock_guard<std::mutex> lock(AllocatorMutex());
+    CurrentAllocator() = std::move(allocator);
+}
+
+void* TensorAllocator::AllocateTagged(size_t bytes, uint64_t /*tag*/, bool* reused) {
+    CHECK(reused != nullptr);
+    *reused = false;
+    return this->Allocate(bytes);
+}
+
+void TensorAllocator::FreeTagged(void* ptr, size_t bytes, uint64_t /*tag*/) {
+    this->Free(ptr, bytes);
+}
+
+// 空闲的内存和释放时的标记，0 表示没有标记
+struct PoolBlock {
+    void* ptr = nullptr;
+    uint64_t tag = 0;
+};
+
+// 一个线程的空闲链表，尺寸等级 -> 空闲内存
+// 线程退出时把缓存的内存还给系统
+struct PoolThreadCache {
+    std::unordered_map<size_t, std::vector<PoolBlock>> free_lists;
+    size_t cached_bytes = 0;
+
+    ~PoolThreadCache() {
+        Release();
+    }
+
+    void Release() {
+        PoolAllocator& allocator = *PoolAllocator::Instance();
+        for (auto& [size_class, buffers] : free_lists) {
+            for (const PoolBlock& buffer : buffers) {
+                allocator.SystemFree(buffer.ptr);
+            }
+            allocator.bytes_cached_.fetch_sub(size_class * buffers.size());
+        }
+        free_lists.clear();
+        cached_bytes = 0;
+    }
+};
+
+static PoolThreadCache& ThreadCache() {
+    static thread_local PoolThreadCache kCache;
+    return kCache;
+}
+
+std::shared_ptr<PoolAllocator> PoolAllocator::Instance() {
+    // 线程缓存析构时还会用到，不释放
+    static auto *kInstance = new std::shared_ptr<PoolAllocator>(new PoolAllocator());
+    return *kInstance;
+}
+
+size_t PoolAllocator::SizeClass(size_t bytes) {
+    if (bytes <= kAlignment) {
+        return kAlignment;
+    }
+    // 最高位之下再分 4 级，浪费最多 25%
+    size_t power = kAlignment;
+    while (power * 2 < bytes) {
+        power *= 2;
+    }
+    const size_t step = power / 4;
+    return (bytes + step - 1) / step * step;
+}
+
+void* PoolAllocator::SystemAllocate(size_t bytes) {
+    const bool huge = this->huge_pages_.load(std::memory_order_relaxed) && bytes >= kHugePageSize;
+    const size_t alignment = huge ? kHugePageSize : kAlignment;
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, bytes) != 0) {
+        LOG(FATAL) << "Can not allocate " << bytes << " bytes";
+    }
+#ifdef MADV_HUGEPAGE
+    if (huge) {
+        madvise(ptr, bytes, MADV_HUGEPAGE);
+    }
+#endif
+    return ptr;
+}
+
+void PoolAllocator::SystemFree(void* ptr) {
+    free(ptr);
+}
+
+void* PoolAllocator::Allocate(size_t bytes) {
+    bool reused = false;
+    return this->AllocateTagged(bytes, 0, &reused);
+}
+
+void* PoolAllocator::AllocateTagged(size_t bytes, uint64_t tag, bool* reused) {
+    CHECK(reused != nullptr);
+    *reused = false;
+    const size_t size_class = SizeClass(bytes);
+    this->bytes_in_use_.fetch_add(size_class, std::memory_order_relaxed);
+
+    PoolThreadCache& cache = ThreadCache();
+    auto iter = cache.free_lists.find(size_class);
+    if (iter != cache.free_lists.end() && !iter->second.empty()) {
+        // 优先取标记相同的内存，否则取最近释放的
+        std::vector<PoolBlock>& blocks = iter->second;
+        size_t index = blocks.size() - 1;
+        if (tag != 0) {
+            for (size_t i = blocks.size(); i > 0; --i) {
+                if (blocks.at(i - 1).tag == tag) {
+                    index = i - 1;
+                    *reused = true;
+                    break;
+                }
+            }
+        }
+        void* ptr = blocks.at(index).ptr;
+        blocks.erase(blocks.begin() + index);
+        cache.cached_bytes -= size_class;
+        this->bytes_cached_.fetch_sub(size_class, std::memory_order_relaxed);
+        this->hits_.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+
+    this->misses_.fetch_add(1, std::memory_order_relaxed);
+    return SystemAllocate(size_class);
+}
+
+void PoolAllocator::Free(void* ptr, size_t bytes) {
+    this->FreeTagged(ptr, bytes, 0);
+}
+
+void PoolAllocator::FreeTagged(void* ptr, size_t bytes, uint64_t tag) {
+    if (ptr == nullptr) {
+        return;
+    }
+    const size_t size_class = SizeClass(bytes);
+    this->bytes_in_use_.fetch_sub(size_class, std::memory_order_relaxed);
+
+    // 内存可能在其他线程申请，放回当前线程的缓存
+    PoolThreadCache& cache = ThreadCache();
+    if (cache.cached_bytes + size_class > kMaxCachedBytesPerThread) {
+        SystemFree(ptr);
+        return;
+    }
+    cache.free_lists[size_class].push_back({ptr, tag});
+    cache.cached_bytes += size_class;
+    this->bytes_cached_.fetch_add(size_class, std::memory_order_relaxed);
+}
+
+AllocatorStats PoolAllocator::stats() const {
+    AllocatorStats stats;
+    stats.hits = this->hits_.load(std::memory_order_relaxed);
+    stats.misses = this->misses_.load(std::memory_order_relaxed);
+    stats.bytes_in_use = this->bytes_in_use_.load(std::memory_order_relaxed);
+    stats.bytes_cached = this->bytes_cached_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PoolAllocator::set_huge_pages(bool huge_pages) {
+    this->huge_pages_.store(huge_pages);
+}
+
+bool PoolAllocator::huge_pages() const {
+    return this->huge_pages_.load();
+}
+
+void PoolAllocator::Trim() {
+    ThreadCache().Release();
+}
+
+}
@@ -0,0 +1,112 @@
+#include "data/tensor.hpp"
+#include "data/tensor_allocator.hpp"
+#include "data/tensor_util.hpp"
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+Tensor<uint8_t>::Tensor(uint32_t channels, uint32_t rows, uint32_t cols, const QuantParams& params)
+    : channels_(channels), rows_(rows), cols_(cols), params_(params) {
+    CHECK(channels != 0 && rows != 0 && cols != 0);
+    CHECK(!params.scales.empty() && params.scales.size() == params.zero_points.size())
+        << "Invalid quantization params";
+    CHECK(!params.per_channel() || params.scales.size() == channels)
+        << "Per-channel params do not match the channel count";
+    for (uint32_t i = 0; i < params.scales.size(); ++i) {
+        CHECK(params.scales.at(i) > 0.f) << "Quantization scale must be positive";
+        CHECK(params.zero_points.at(i) >= params.qmin() && params.zero_points.at(i) <= params.qmax())
+            << "Zero point out of range";
+    }
+
+    const std::shared_ptr<TensorAllocator>& allocator = TensorAllocator::Get();
+    const size_t bytes = size_t(channels) * rows * cols;
+    uint8_t* buffer = static_cast<uint8_t*>(allocator->Allocate(bytes));
+    this->data_ = std::shared_ptr<uint8_t>(buffer, [allocator, bytes](uint8_t* ptr) {
+        allocator->Free(ptr, bytes);
+    });
+}
+
+std::shared_ptr<Tensor<uint8_t>> Tensor<uint8_t>::Quantize(const Tensor<float>& tensor, const QuantParams& params) {
+    CHECK(!tensor.empty());
+    std::shared_ptr<Tensor<uint8_t>> quantized =
+        std::make_shared<Tensor<uint8_t>>(tensor.channels(), tensor.rows(), tensor.cols(), params);
+    const uint32_t plane_size = tensor.rows() * tensor.cols();
+    for (uint32_t c = 0; c < tensor.channels(); ++c) {
+        QuantizeValues(tensor.raw_ptr() + size_t(c) * plane_size, quantized->slice_ptr(c), plane_size,
+                       params.scale(c), params.zero_point(c), params.is_signed);
+    }
+    return quantized;
+}
+
+std::shared_ptr<Tensor<float>> Tensor<uint8_t>::Dequantize() const {
+    CHECK(!this->empty());
+    std::shared_ptr<Tensor<float>> tensor = TensorCreate(this->channels_, this->rows_, this->cols_);
+    const uint32_t plane_size = this->rows_ * this->cols_;
+    for (uint32_t c = 0; c < this->channels_; ++c) {
+        DequantizeValues(this->slice_ptr(c), tensor->slice(c).memptr(), plane_size, this->params_.scale(c),
+                         this->params_.zero_point(c), this->params_.is_signed);
+    }
+    return tensor;
+}
+
+uint32_t Tensor<uint8_t>::channels() const {
+    CHECK(!this->empty());
+    return this->channels_;
+}
+
+uint32_t Tensor<uint8_t>::rows() const {
+    CHECK(!this->empty());
+    return this->rows_;
+}
+
+uint32_t Tensor<uint8_t>::cols() const {
+    CHECK(!this->empty());
+    return this->cols_;
+}
+
+uint32_t Tensor<uint8_t>::size() const {
+    CHECK(!this->empty());
+    return this->channels_ * this->rows_ * this->cols_;
+}
+
+bool Tensor<uint8_t>::empty() const {
+    return this->data_ == nullptr;
+}
+
+std::vector<uint32_t> Tensor<uint8_t>::shape() const {
+    CHECK(!this->empty());
+    return {this->channels_, this->rows_, this->cols_};
+}
+
+const QuantParams& Tensor<uint8_t>::params() const {
+    return this->params_;
+}
+
+uint8_t& Tensor<uint8_t>::index(uint32_t offset) {
+    CHECK_LT(offset, this->size()) << "Tensor index out of bound!";
+    return this->data_.get()[offset];
+}
+
+uint8_t Tensor<uint8_t>::index(uint32_t offset) const {
+    CHECK_LT(offset, this->size()) << "Tensor index out of bound!";
+    return this->data_.get()[offset];
+}
+
+int32_t Tensor<uint8_t>::value(uint32_t channel, uint32_t row, uint32_t col) const {
+    CHECK_LT(channel, this->channels());
+    CHECK_LT(row, this->rows_);
+    CHECK_LT(col, this->cols_);
+    const uint8_t raw = this->slice_ptr(channel)[col * this->rows_ + row];
+    return this->params_.is_signed ? int32_t(int8_t(raw)) : int32_t(raw);
+}
+
+uint8_t* Tensor<uint8_t>::slice_ptr(uint32_t channel) const {
+    CHECK_LT(channel, this->channels());
+    return this->data_.get() + size_t(channel) * this->rows_ * this->cols_;
+}
+
+uint8_t* Tensor<uint8_t>::raw_ptr() const {
+    return this->data_.get();
+}
+
+}
@@ -1,6 +1,15 @@
 #include <glog/logging.h>
 #include "data/tensor.hpp"
 #include "data/tensor_util.hpp"
+#include "data/tensor_allocator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "data/cpu_isa.hpp"
+#include "data/vector_kernels.hpp"
+#if defined(KUIPER_X86)
+#include <immintrin.h>
+#endif
 
 namespace kuiper_infer {
 bool TensorIsSame(const std::shared_ptr<Tensor<float>>& a,
@@ -14,13 +23,89 @@ bool TensorIsSame(const std::shared_ptr<Tensor<float>>& a,
   return is_same;
 }
 
+bool TensorIsSame(const std::shared_ptr<Tensor<uint8_t>>& a,
+                  const std::shared_ptr<Tensor<uint8_t>>& b, uint32_t threshold) {
+  CHECK(a != nullptr);
+  CHECK(b != nullptr);
+  if (a->shape() != b->shape() || a->params() != b->params()) {
+    return false;
+  }
+  const bool is_signed = a->params().is_signed;
+  const uint8_t* a_ptr = a->raw_ptr();
+  const uint8_t* b_ptr = b->raw_ptr();
+  for (uint32_t i = 0; i < a->size(); ++i) {
+    const int32_t a_value = is_signed ? int32_t(int8_t(a_ptr[i])) : int32_t(a_ptr[i]);
+    const int32_t b_value = is_signed ? int32_t(int8_t(b_ptr[i])) : int32_t(b_ptr[i]);
+    if (uint32_t(std::abs(a_value - b_value)) > threshold) {
+      return false;
+    }
+  }
+  return true;
+}
+
+QuantParams TensorQuantParams(const std::shared_ptr<Tensor<float>>& tensor,
+                              bool per_channel, bool is_signed, bool symmetric) {
+  CHECK(tensor != nullptr && !tensor->empty());
+  QuantParams params;
+  params.is_signed = is_signed;
+  const uint32_t groups = per_channel ? tensor->channels() : 1;
+  const uint32_t group_size = tensor->size() / groups;
+  for (uint32_t g = 0; g < groups; ++g) {
+    const float* ptr = tensor->raw_ptr() + size_t(g) * group_size;
+    const auto [min, max] = std::minmax_element(ptr, ptr + group_size);
+    const auto [scale, zero_point] = ChooseQuantParams(*min, *max, is_signed, symmetric);
+    params.scales.push_back(scale);
+    params.zero_points.push_back(zero_point);
+  }
+  return params;
+}
+
+TensorErrorStats TensorCompare(const std::shared_ptr<Tensor<float>>& actual,
+                               const std::shared_ptr<Tensor<float>>& expected) {
+  CHECK(actual != nullptr && expected != nullptr);
+  CHECK(actual->shape() == expected->shape());
+  TensorErrorStats stats;
+  const uint32_t size = actual->size();
+  if (size == 0) {
+    return stats;
+  }
+  const float* actual_ptr = actual->raw_ptr();
+  const float* expected_ptr = expected->raw_ptr();
+  double sum_abs = 0.;
+  for (uint32_t i = 0; i < size; ++i) {
+    const float abs_error = std::fabs(actual_ptr[i] - expected_ptr[i]);
+    const float rel_error = abs_error / std::max(std::fabs(expected_ptr[i]), 1e-3f);
+    stats.max_abs = std::max(stats.max_abs, abs_error);
+    stats.max_rel = std::max(stats.max_rel, rel_error);
+    sum_abs += abs_error;
+  }
+  stats.mean_abs = float(sum_abs / size);
+  return stats;
+}
+
+// 形状相同的两个张量逐元素计算，结果写到 output 的内存里
+static void ElementwiseInto(const sftensor& tensor1, const sftensor& tensor2,
+                            const sftensor& output, bool add) {
+  const arma::fcube& data1 = tensor1->data();
+  const arma::fcube& data2 = tensor2->data();
+  CHECK_EQ(data1.n_elem, data2.n_elem);
+  CHECK_EQ(data1.n_elem, output->data().n_elem);
+  if (add) {
+    AddValues(data1.memptr(), data2.memptr(), output->data().memptr(),
+              data1.n_elem);
+  } else {
+    MulValues(data1.memptr(), data2.memptr(), output->data().memptr(),
+              data1.n_elem);
+  }
+}
+
 void TensorElementAdd(const std::shared_ptr<Tensor<float>>& tensor1,
                       const std::shared_ptr<Tensor<float>>& tensor2,
                       const std::shared_ptr<Tensor<float>>& output_tensor) {
   CHECK(tensor1 != nullptr && tensor2 != nullptr && output_tensor != nullptr);
   if (tensor1->shape() == tensor2->shape()) {
     CHECK(tensor1->shape() == output_tensor->shape());
-    output_tensor->set_data(tensor1->data() + tensor2->data());
+    ElementwiseInto(tensor1, tensor2, output_tensor, true);
   } else {
     CHECK(tensor1->channels() == tensor2->channels())
         << "Tensors shape are not adapting";
@@ -28,7 +113,7 @@ void TensorElementAdd(const std::shared_ptr<Tensor<float>>& tensor1,
         TensorBroadcast(tensor1, tensor2);
     CHECK(output_tensor->shape() == input_tensor1->shape() &&
           output_tensor->shape() == input_tensor2->shape());
-    output_tensor->set_data(input_tensor1->data() + input_tensor2->data());
+    ElementwiseInto(input_tensor1, input_tensor2, output_tensor, true);
   }
 }
 
@@ -39,7 +124,7 @@ void TensorElementMultiply(
   CHECK(tensor1 != nullptr && tensor2 != nullptr && output_tensor != nullptr);
   if (tensor1->shape() == tensor2->shape()) {
     CHECK(tensor1->shape() == output_tensor->shape());
-    output_tensor->set_data(tensor1->data() % tensor2->data());
+    ElementwiseInto(tensor1, tensor2, output_tensor, false);
   } else {
     CHECK(tensor1->channels() == tensor2->channels())
         << "Tensors shape are not adapting";
@@ -47,7 +132,7 @@ void TensorElementMultiply(
         TensorBroadcast(tensor1, tensor2);
     CHECK(output_tensor->shape() == input_tensor1->shape() &&
           output_tensor->shape() == input_tensor2->shape());
-    output_tensor->set_data(input_tensor1->data() % input_tensor2->data());
+    ElementwiseInto(input_tensor1, input_tensor2, output_tensor, false);
   }
 }
 
@@ -57,7 +142,7 @@ std::shared_ptr<Tensor<float>> TensorElementAdd(
   CHECK(tensor1 != nullptr && tensor2 != nullptr);
   if (tensor1->shape() == tensor2->shape()) {
     sftensor output_tensor = TensorCreate(tensor1->shape());
-    output_tensor->set_data(tensor1->data() + tensor2->data());
+    ElementwiseInto(tensor1, tensor2, output_tensor, true);
     return output_tensor;
   } else {
     // broadcast
@@ -67,7 +152,7 @@ std::shared_ptr<Tensor<float>> TensorElementAdd(
         TensorBroadcast(tensor1, tensor2);
     CHECK(input_tensor1->shape() == input_tensor2->shape());
     sftensor output_tensor = TensorCreate(input_tensor1->shape());
-    output_tensor->set_data(input_tensor1->data() + input_tensor2->data());
+    ElementwiseInto(input_tensor1, input_tensor2, output_tensor, true);
     return output_tensor;
   }
 }
@@ -78,7 +163,7 @@ std::shared_ptr<Tensor<float>> TensorElementMultiply(
   CHECK(tensor1 != nullptr && tensor2 != nullptr);
   if (tensor1->shape() == tensor2->shape()) {
     sftensor output_tensor = TensorCreate(tensor1->shape());
-    output_tensor->set_data(tensor1->data() % tensor2->data());
+    ElementwiseInto(tensor1, tensor2, output_tensor, false);
     return output_tensor;
   } else {
     // broadcast
@@ -88,14 +173,24 @@ std::shared_ptr<Tensor<float>> TensorElementMultiply(
         TensorBroadcast(tensor1, tensor2);
     CHECK(input_tensor1->shape() == input_tensor2->shape());
     sftensor output_tensor = TensorCreate(input_tensor1->shape());
-    output_tensor->set_data(input_tensor1->data() % input_tensor2->data());
+    ElementwiseInto(input_tensor1, input_tensor2, output_tensor, false);
     return output_tensor;
   }
 }
 
 std::shared_ptr<Tensor<float>> TensorCreate(uint32_t channels, uint32_t rows,
                                             uint32_t cols) {
-  return std::make_shared<Tensor<float>>(channels, rows, cols);
+  CHECK(channels != 0 && rows != 0 && cols != 0);
+  // 张量使用分配器的内存，析构时先释放张量再归还内存
+  const std::shared_ptr<TensorAllocator>& allocator = TensorAllocator::Get();
+  const size_t bytes = size_t(channels) * rows * cols * sizeof(float);
+  float* buffer = static_cast<float*>(allocator->Allocate(bytes));
+  return std::shared_ptr<Tensor<float>>(
+      new Tensor<float>(buffer, channels, rows, cols),
+      [allocator, buffer, bytes](Tensor<float>* tensor) {
+        delete tensor;
+        allocator->Free(buffer, bytes);
+      });
 }
 
 std::shared_ptr<Tensor<float>> TensorCreate(
@@ -104,6 +199,77 @@ std::shared_ptr<Tensor<float>> TensorCreate(
   return TensorCreate(shape.at(0), shape.at(1), shape.at(2));
 }
 
+std::shared_ptr<Tensor<uint8_t>> TensorCreate(uint32_t channels, uint32_t rows,
+                                              uint32_t cols,
+                                              const QuantParams& params) {
+  return std::make_shared<Tensor<uint8_t>>(channels, rows, cols, params);
+}
+
+// 带边框张量的内存标记，由形状和边框决定，0 留给没有标记的内存
+static uint64_t HaloTag(uint32_t channels, uint32_t rows, uint32_t cols,
+                        const Halo& halo) {
+  uint32_t value_bits = 0;
+  std::memcpy(&value_bits, &halo.value, sizeof(value_bits));
+  uint64_t tag = 14695981039346656037ull;
+  for (const uint32_t field : {channels, rows, cols, halo.h, halo.w, value_bits}) {
+    tag = (tag ^ field) * 1099511628211ull;
+  }
+  return tag == 0 ? 1 : tag;
+}
+
+std::shared_ptr<Tensor<float>> TensorCreate(uint32_t channels, uint32_t rows,
+                                            uint32_t cols, const Halo& halo) {
+  if (halo.empty()) {
+    return TensorCreate(channels, rows, cols);
+  }
+  const uint32_t padded_rows = rows + 2 * halo.h;
+  const uint32_t padded_cols = cols + 2 * halo.w;
+  CHECK(channels != 0 && padded_rows != 0 && padded_cols != 0);
+
+  // 生产者只写内部，释放时边框仍然有效，内存带着标记回到内存池
+  // 之后同样形状和边框的张量拿到这块内存时不需要再写边框，稳定运行时没有填充的开销
+  const std::shared_ptr<TensorAllocator>& allocator = TensorAllocator::Get();
+  const size_t bytes = size_t(channels) * padded_rows * padded_cols * sizeof(float);
+  const uint64_t tag = HaloTag(channels, padded_rows, padded_cols, halo);
+  bool reused = false;
+  float* buffer = static_cast<float*>(allocator->AllocateTagged(bytes, tag, &reused));
+  std::shared_ptr<Tensor<float>> tensor(
+      new Tensor<float>(buffer, channels, padded_rows, padded_cols),
+      [allocator, buffer, bytes, tag](Tensor<float>* tensor) {
+        delete tensor;
+        allocator->FreeTagged(buffer, bytes, tag);
+      });
+  if (!reused) {
+    TensorFillHalo(tensor, halo);
+  }
+  return tensor;
+}
+
+void TensorFillHalo(const std::shared_ptr<Tensor<float>>& tensor,
+                    const Halo& halo) {
+  CHECK(tensor != nullptr && !tensor->empty());
+  const uint32_t rows = tensor->rows();
+  const uint32_t cols = tensor->cols();
+  CHECK(rows >= 2 * halo.h && cols >= 2 * halo.w);
+
+  // 列主序: 左右的边框是整列，中间的列只写上下 h 个元素
+  for (uint32_t c = 0; c < tensor->channels(); ++c) {
+    arma::fmat& channel = tensor->slice(c);
+    for (uint32_t col = 0; col < halo.w; ++col) {
+      std::fill_n(channel.colptr(col), rows, halo.value);
+      std::fill_n(channel.colptr(cols - 1 - col), rows, halo.value);
+    }
+    if (halo.h == 0) {
+      continue;
+    }
+    for (uint32_t col = halo.w; col < cols - halo.w; ++col) {
+      float* col_ptr = channel.colptr(col);
+      std::fill_n(col_ptr, halo.h, halo.value);
+      std::fill_n(col_ptr + rows - halo.h, halo.h, halo.value);
+    }
+  }
+}
+
 std::shared_ptr<Tensor<float>> TensorPadding(
     const std::shared_ptr<Tensor<float>>& tensor,
     const std::vector<uint32_t>& pads, float padding_value) {
@@ -114,7 +280,7 @@ std::shared_ptr<Tensor<float>> TensorPadding(
   uint32_t pad_cols1 = pads.at(2);  // left
   uint32_t pad_cols2 = pads.at(3);  // right
 
-  std::shared_ptr<ftensor> output = std::make_shared<ftensor>(
+  std::shared_ptr<ftensor> output = TensorCreate(
       tensor->channels(), tensor->rows() + pad_rows1 + pad_rows2,
       tensor->cols() + pad_cols1 + pad_cols2);
 
@@ -194,6 +360,133 @@ std::tuple<sftensor, sftensor> TensorBroadcast(const sftensor& tensor1,
 
 std::shared_ptr<Tensor<float>> TensorClone(
     std::shared_ptr<Tensor<float>> tensor) {
-  return std::make_shared<Tensor<float>>(*tensor);
+  CHECK(tensor != nullptr && !tensor->empty());
+  sftensor output = TensorCreate(tensor->shape());
+  memcpy(output->data().memptr(), tensor->raw_ptr(), tensor->size() * sizeof(float));
+  return output;
+}
+
+// 缓存分块的大小，一个块的输入和输出都能放进 L1
+static constexpr uint32_t kTransposeBlock = 32;
+
+// 转置一个通道里 [row_begin, row_end) x [col_begin, col_end) 的块
+using TransposeBlockFn = void (*)(const float* src, float* dst, uint32_t rows,
+                                  uint32_t cols, uint32_t row_begin,
+                                  uint32_t row_end, uint32_t col_begin,
+                                  uint32_t col_end);
+
+static void TransposeBlockScalar(const float* src, float* dst, uint32_t rows,
+                                 uint32_t cols, uint32_t row_begin,
+                                 uint32_t row_end, uint32_t col_begin,
+                                 uint32_t col_end) {
+  for (uint32_t r = row_begin; r < row_end; ++r) {
+    for (uint32_t c = col_begin; c < col_end; ++c) {
+      dst[size_t(c) * rows + r] = src[size_t(r) * cols + c];
+    }
+  }
+}
+
+#if defined(KUIPER_X86)
+// 8x8 小块的转置，src 和 dst 的行步长分别是 src_stride 和 dst_stride
+KUIPER_TARGET_AVX2 static inline void Transpose8x8(const float* src,
+                                                   size_t src_stride,
+                                                   float* dst,
+                                                   size_t dst_stride) {
+  __m256 r0 = _mm256_loadu_ps(src + 0 * src_stride);
+  __m256 r1 = _mm256_loadu_ps(src + 1 * src_stride);
+  __m256 r2 = _mm256_loadu_ps(src + 2 * src_stride);
+  __m256 r3 = _mm256_loadu_ps(src + 3 * src_stride);
+  __m256 r4 = _mm256_loadu_ps(src + 4 * src_stride);
+  __m256 r5 = _mm256_loadu_ps(src + 5 * src_stride);
+  __m256 r6 = _mm256_loadu_ps(src + 6 * src_stride);
+  __m256 r7 = _mm256_loadu_ps(src + 7 * src_stride);
+
+  const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+  const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+  const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+  const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+  const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+  const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+  const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+  const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  _mm256_storeu_ps(dst + 0 * dst_stride, _mm256_permute2f128_ps(s0, s4, 0x20));
+  _mm256_storeu_ps(dst + 1 * dst_stride, _mm256_permute2f128_ps(s1, s5, 0x20));
+  _mm256_storeu_ps(dst + 2 * dst_stride, _mm256_permute2f128_ps(s2, s6, 0x20));
+  _mm256_storeu_ps(dst + 3 * dst_stride, _mm256_permute2f128_ps(s3, s7, 0x20));
+  _mm256_storeu_ps(dst + 4 * dst_stride, _mm256_permute2f128_ps(s0, s4, 0x31));
+  _mm256_storeu_ps(dst + 5 * dst_stride, _mm256_permute2f128_ps(s1, s5, 0x31));
+  _mm256_storeu_ps(dst + 6 * dst_stride, _mm256_permute2f128_ps(s2, s6, 0x31));
+  _mm256_storeu_ps(dst + 7 * dst_stride, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+// 按 8x8 小块转置，不足 8 的边角逐个复制
+KUIPER_TARGET_AVX2 static void TransposeBlockAvx2(const float* src, float* dst,
+                                                  uint32_t rows, uint32_t cols,
+                                                  uint32_t row_begin,
+                                                  uint32_t row_end,
+                                                  uint32_t col_begin,
+                                                  uint32_t col_end) {
+  uint32_t r = row_begin;
+  for (; r + 8 <= row_end; r += 8) {
+    uint32_t c = col_begin;
+    for (; c + 8 <= col_end; c += 8) {
+      Transpose8x8(src + size_t(r) * cols + c, cols, dst + size_t(c) * rows + r,
+                   rows);
+    }
+    for (; c < col_end; ++c) {
+      for (uint32_t i = r; i < r + 8; ++i) {
+        dst[size_t(c) * rows + i] = src[size_t(i) * cols + c];
+      }
+    }
+  }
+  for (; r < row_end; ++r) {
+    for (uint32_t c = col_begin; c < col_end; ++c) {
+      dst[size_t(c) * rows + r] = src[size_t(r) * cols + c];
+    }
+  }
+}
+#endif
+
+static const IsaKernel<TransposeBlockFn> kTransposeBlockKernel =
+    IsaKernel<TransposeBlockFn>("transpose", TransposeBlockScalar)
+#if defined(KUIPER_X86)
+        .Add(CpuIsa::kAVX2, TransposeBlockAvx2)
+#endif
+    ;
+
+void TransposePlanes(const float* src, float* dst, uint32_t channels,
+                     uint32_t rows, uint32_t cols) {
+  CHECK(src != nullptr && dst != nullptr);
+  CHECK(src != dst) << "TransposePlanes can not work in place";
+  const size_t planes = size_t(rows) * cols;
+  const int64_t row_blocks = (rows + kTransposeBlock - 1) / kTransposeBlock;
+  const int64_t tasks = int64_t(channels) * row_blocks;
+  const TransposeBlockFn transpose_block = kTransposeBlockKernel.get();
+
+  // 每个任务是一个通道里的一条行块，按列块依次转置
+  // 小张量并行的开销比转置本身大，只在元素较多时并行
+#pragma omp parallel for schedule(static) if (planes * channels >= (1 << 16))
+  for (int64_t task = 0; task < tasks; ++task) {
+    const size_t channel = task / row_blocks;
+    const uint32_t row_begin = (task % row_blocks) * kTransposeBlock;
+    const uint32_t row_end = std::min(rows, row_begin + kTransposeBlock);
+    const float* channel_src = src + channel * planes;
+    float* channel_dst = dst + channel * planes;
+    for (uint32_t col_begin = 0; col_begin < cols; col_begin += kTransposeBlock) {
+      const uint32_t col_end = std::min(cols, col_begin + kTransposeBlock);
+      transpose_block(channel_src, channel_dst, rows, cols, row_begin,
+                      row_end, col_begin, col_end);
+    }
+  }
 }
-}  // namespace kuiper_infer
\ No newline at end of file
+}  // namespace kuiper_infer
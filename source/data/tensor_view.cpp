@@ -0,0 +1,225 @@
+#include "data/tensor_view.hpp"
+#include "data/tensor_util.hpp"
+#include <glog/logging.h>
+#include <cstring>
+#include <numeric>
+
+namespace kuiper_infer {
+
+TensorView::TensorView(const std::shared_ptr<Tensor<float>>& tensor) {
+    CHECK(tensor != nullptr && !tensor->empty());
+    const uint32_t channels = tensor->channels();
+    const uint32_t rows = tensor->rows();
+    const uint32_t cols = tensor->cols();
+
+    this->owner_ = tensor;
+    this->data_ = tensor->data().memptr();
+    this->shape_ = {1, channels, rows, cols};
+    // 列主序 - 通道内先行后列
+    this->strides_ = {channels * rows * cols, rows * cols, 1, rows};
+}
+
+TensorView::TensorView(std::shared_ptr<void> owner, float* data, const std::vector<uint32_t>& shape,
+                       const std::vector<uint32_t>& strides)
+    : owner_(std::move(owner)), data_(data), shape_(shape), strides_(strides) {
+    CHECK(this->data_ != nullptr);
+    CHECK_EQ(this->shape_.size(), 4);
+    CHECK_EQ(this->strides_.size(), 4);
+}
+
+TensorView TensorView::RowMajor(std::shared_ptr<void> owner, float* data, uint32_t channels, uint32_t rows,
+                                uint32_t cols) {
+    return TensorView(std::move(owner), data, {1, channels, rows, cols},
+                      {channels * rows * cols, rows * cols, cols, 1});
+}
+
+uint32_t TensorView::batch() const {
+    CHECK(!this->empty());
+    return this->shape_.at(0);
+}
+
+uint32_t TensorView::channels() const {
+    CHECK(!this->empty());
+    return this->shape_.at(1);
+}
+
+uint32_t TensorView::rows() const {
+    CHECK(!this->empty());
+    return this->shape_.at(2);
+}
+
+uint32_t TensorView::cols() const {
+    CHECK(!this->empty());
+    return this->shape_.at(3);
+}
+
+uint32_t TensorView::size() const {
+    CHECK(!this->empty());
+    return std::accumulate(this->shape_.begin(), this->shape_.end(), 1u, std::multiplies<uint32_t>());
+}
+
+bool TensorView::empty() const {
+    return this->data_ == nullptr;
+}
+
+const std::vector<uint32_t>& TensorView::shape() const {
+    return this->shape_;
+}
+
+const std::vector<uint32_t>& TensorView::strides() const {
+    return this->strides_;
+}
+
+float* TensorView::raw_ptr() const {
+    return this->data_;
+}
+
+const std::shared_ptr<void>& TensorView::owner() const {
+    return this->owner_;
+}
+
+float& TensorView::at(uint32_t batch, uint32_t channel, uint32_t row, uint32_t col) const {
+    CHECK_LT(batch, this->batch());
+    CHECK_LT(channel, this->channels());
+    CHECK_LT(row, this->rows());
+    CHECK_LT(col, this->cols());
+    return this->data_[size_t(batch) * strides_.at(0) + size_t(channel) * strides_.at(1) +
+                       size_t(row) * strides_.at(2) + size_t(col) * strides_.at(3)];
+}
+
+float& TensorView::at(uint32_t channel, uint32_t row, uint32_t col) const {
+    return this->at(0, channel, row, col);
+}
+
+bool TensorView::is_contiguous() const {
+    CHECK(!this->empty());
+    const uint32_t rows = this->rows();
+    const uint32_t cols = this->cols();
+    // 只有一行或一列时对应的步长不影响排布
+    const bool row_ok = rows == 1 || strides_.at(2) == 1;
+    const bool col_ok = cols == 1 || strides_.at(3) == rows;
+    const bool channel_ok = this->channels() == 1 || strides_.at(1) == rows * cols;
+    return row_ok && col_ok && channel_ok;
+}
+
+bool TensorView::is_row_major() const {
+    CHECK(!this->empty());
+    const uint32_t rows = this->rows();
+    const uint32_t cols = this->cols();
+    const bool col_ok = cols == 1 || strides_.at(3) == 1;
+    const bool row_ok = rows == 1 || strides_.at(2) == cols;
+    const bool channel_ok = this->channels() == 1 || strides_.at(1) == rows * cols;
+    return row_ok && col_ok && channel_ok;
+}
+
+TensorView TensorView::Batch(uint32_t index) const {
+    CHECK_LT(index, this->batch());
+    TensorView view(*this);
+    view.data_ += size_t(index) * strides_.at(0);
+    view.shape_.at(0) = 1;
+    return view;
+}
+
+TensorView TensorView::Channels(uint32_t begin, uint32_t count) const {
+    CHECK_GT(count, 0);
+    CHECK_LE(begin + count, this->channels()) << "Channel range out of bound!";
+    TensorView view(*this);
+    view.data_ += size_t(begin) * strides_.at(1);
+    view.shape_.at(1) = count;
+    return view;
+}
+
+TensorView TensorView::Flatten(bool row_major) const {
+    const uint32_t element_size = this->size() / this->batch();
+    return this->Reshape({1, 1, element_size}, row_major);
+}
+
+TensorView TensorView::Reshape(const std::vector<uint32_t>& shape, bool row_major) const {
+    CHECK_EQ(shape.size(), 3);
+    const uint32_t channels = shape.at(0);
+    const uint32_t rows = shape.at(1);
+    const uint32_t cols = shape.at(2);
+    CHECK_EQ(channels * rows * cols, this->size() / this->batch());
+
+    TensorView view(*this);
+    view.shape_ = {this->batch(), channels, rows, cols};
+    if (row_major) {
+        CHECK(this->is_row_major()) << "Only row-major views can be reshaped in row-major order without copy";
+        view.strides_ = {this->strides_.at(0), rows * cols, cols, 1};
+    } else {
+        CHECK(this->is_contiguous()) << "Only contiguous views can be reshaped without copy";
+        view.strides_ = {this->strides_.at(0), rows * cols, 1, rows};
+    }
+    return view;
+}
+
+void TensorView::CopyTo(float* dst, bool row_major) const {
+    CHECK(dst != nullptr);
+    const uint32_t channels = this->channels();
+    const uint32_t rows = this->rows();
+    const uint32_t cols = this->cols();
+    const size_t element_size = size_t(channels) * rows * cols;
+
+    for (uint32_t n = 0; n < this->batch(); ++n) {
+        const TensorView& element = this->Batch(n);
+        float* element_dst = dst + n * element_size;
+        // 排布一致时整块复制，行主序和列主序之间分块转置
+        if ((row_major && element.is_row_major()) || (!row_major && element.is_contiguous())) {
+            memcpy(element_dst, element.raw_ptr(), element_size * sizeof(float));
+            continue;
+        }
+        if (row_major && element.is_contiguous()) {
+            TransposePlanes(element.raw_ptr(), element_dst, channels, cols, rows);
+            continue;
+        }
+        if (!row_major && element.is_row_major()) {
+            TransposePlanes(element.raw_ptr(), element_dst, channels, rows, cols);
+            continue;
+        }
+
+        const size_t channel_stride = strides_.at(1);
+        const size_t row_stride = strides_.at(2);
+        const size_t col_stride = strides_.at(3);
+        for (uint32_t c = 0; c < channels; ++c) {
+            const float* channel_ptr = element.raw_ptr() + c * channel_stride;
+            float* channel_dst = element_dst + size_t(c) * rows * cols;
+            if (row_major) {
+                for (uint32_t r = 0; r < rows; ++r) {
+                    for (uint32_t col = 0; col < cols; ++col) {
+                        *(channel_dst++) = channel_ptr[r * row_stride + col * col_stride];
+                    }
+                }
+            } else {
+                for (uint32_t col = 0; col < cols; ++col) {
+                    for (uint32_t r = 0; r < rows; ++r) {
+                        *(channel_dst++) = channel_ptr[r * row_stride + col * col_stride];
+                    }
+                }
+            }
+        }
+    }
+}
+
+std::shared_ptr<Tensor<float>> TensorView::AsTensor() const {
+    CHECK_EQ(this->batch(), 1);
+    if (!this->is_contiguous()) {
+        return this->Clone();
+    }
+
+    // 新张量直接使用视图的内存，删除器里持有 owner，保证底层数据不会先释放
+    std::shared_ptr<void> owner = this->owner_;
+    return std::shared_ptr<Tensor<float>>(new Tensor<float>(this->data_, this->channels(), this->rows(), this->cols()),
+                                          [owner](Tensor<float>* tensor) { delete tensor; });
+}
+
+std::shared_ptr<Tensor<float>> TensorView::Clone() const {
+    CHECK_EQ(this->batch(), 1);
+    const uint32_t channels = this->channels();
+    const uint32_t rows = this->rows();
+    const uint32_t cols = this->cols();
+    std::shared_ptr<Tensor<float>> tensor = TensorCreate(channels, rows, cols);
+    this->CopyTo(tensor->data().memptr(), false);
+    return tensor;
+}
+
+}
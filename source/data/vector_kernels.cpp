@@ -0,0 +1,420 @@
+#include "data/vector_kernels.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <glog/logging.h>
+#include "data/cpu_isa.hpp"
+#if defined(KUIPER_X86)
+#include <immintrin.h>
+#endif
+
+namespace kuiper_infer {
+
+// 没有手写向量版本的内核，同一个函数体内联到各个 target 的包装函数里，由编译器按目标指令集向量化
+KUIPER_ALWAYS_INLINE void ReluBody(const float* src, float* dst, size_t count, float threshold) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = src[i] >= threshold ? src[i] : 0.f;
+    }
+}
+
+KUIPER_ALWAYS_INLINE void AddBody(const float* a, const float* b, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = a[i] + b[i];
+    }
+}
+
+KUIPER_ALWAYS_INLINE void MulBody(const float* a, const float* b, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = a[i] * b[i];
+    }
+}
+
+KUIPER_ALWAYS_INLINE void ScaleShiftBody(const float* src, float* dst, size_t count, float scale, float shift) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = src[i] * scale + shift;
+    }
+}
+
+// 按输出列计算，步长为 1 时内层循环是连续的，可以整块向量化
+KUIPER_ALWAYS_INLINE void MaxPoolBody(const float* src, size_t src_ld, float* dst, size_t dst_ld, uint32_t output_h,
+                                      uint32_t output_w, uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h,
+                                      uint32_t stride_w) {
+    for (uint32_t ow = 0; ow < output_w; ++ow) {
+        float* output_ptr = dst + ow * dst_ld;
+        std::fill(output_ptr, output_ptr + output_h, std::numeric_limits<float>::lowest());
+        for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+            const float* col_ptr = src + (ow * stride_w + kw) * src_ld;
+            for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                const float* input_ptr = col_ptr + kh;
+                if (stride_h == 1) {
+                    for (uint32_t oh = 0; oh < output_h; ++oh) {
+                        output_ptr[oh] = input_ptr[oh] > output_ptr[oh] ? input_ptr[oh] : output_ptr[oh];
+                    }
+                } else {
+                    for (uint32_t oh = 0; oh < output_h; ++oh) {
+                        const float value = input_ptr[oh * stride_h];
+                        output_ptr[oh] = value > output_ptr[oh] ? value : output_ptr[oh];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 和 MaxPoolBody 的循环顺序相同，卷积核的一个元素乘一列输入累加到一列输出
+KUIPER_ALWAYS_INLINE void ConvPlaneBody(const float* src, size_t src_ld, const float* kernel, uint32_t kernel_h,
+                                        uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w, uint32_t dilation_h,
+                                        uint32_t dilation_w, float* dst, size_t dst_ld, uint32_t output_h,
+                                        uint32_t output_w) {
+    for (uint32_t ow = 0; ow < output_w; ++ow) {
+        float* output_ptr = dst + ow * dst_ld;
+        for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+            const float* col_ptr = src + (ow * stride_w + kw * dilation_w) * src_ld;
+            for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                const float weight = kernel[kw * kernel_h + kh];
+                const float* input_ptr = col_ptr + kh * dilation_h;
+                if (stride_h == 1) {
+                    for (uint32_t oh = 0; oh < output_h; ++oh) {
+                        output_ptr[oh] += weight * input_ptr[oh];
+                    }
+                } else {
+                    for (uint32_t oh = 0; oh < output_h; ++oh) {
+                        output_ptr[oh] += weight * input_ptr[oh * stride_h];
+                    }
+                }
+            }
+        }
+    }
+}
+
+KUIPER_ALWAYS_INLINE void CopyStridedBody(const float* src, size_t stride, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = src[i * stride];
+    }
+}
+
+using ReluFn = void (*)(const float* src, float* dst, size_t count, float threshold);
+using SigmoidFn = void (*)(const float* src, float* dst, size_t count);
+using BinaryFn = void (*)(const float* a, const float* b, float* dst, size_t count);
+using ScaleShiftFn = void (*)(const float* src, float* dst, size_t count, float scale, float shift);
+using MaxPoolFn = void (*)(const float* src, size_t src_ld, float* dst, size_t dst_ld, uint32_t output_h,
+                           uint32_t output_w, uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h,
+                           uint32_t stride_w);
+using ConvPlaneFn = void (*)(const float* src, size_t src_ld, const float* kernel, uint32_t kernel_h,
+                             uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w, uint32_t dilation_h,
+                             uint32_t dilation_w, float* dst, size_t dst_ld, uint32_t output_h, uint32_t output_w);
+using CopyStridedFn = void (*)(const float* src, size_t stride, float* dst, size_t count);
+
+static void ReluScalar(const float* src, float* dst, size_t count, float threshold) {
+    ReluBody(src, dst, count, threshold);
+}
+
+static void SigmoidScalar(const float* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = 1.0f / (1.0f + std::exp(-src[i]));
+    }
+}
+
+static void AddScalar(const float* a, const float* b, float* dst, size_t count) {
+    AddBody(a, b, dst, count);
+}
+
+static void MulScalar(const float* a, const float* b, float* dst, size_t count) {
+    MulBody(a, b, dst, count);
+}
+
+static void ScaleShiftScalar(const float* src, float* dst, size_t count, float scale, float shift) {
+    ScaleShiftBody(src, dst, count, scale, shift);
+}
+
+static void MaxPoolScalar(const float* src, size_t src_ld, float* dst, size_t dst_ld, uint32_t output_h,
+                          uint32_t output_w, uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h,
+                          uint32_t stride_w) {
+    MaxPoolBody(src, src_ld, dst, dst_ld, output_h, output_w, kernel_h, kernel_w, stride_h, stride_w);
+}
+
+static void ConvPlaneScalar(const float* src, size_t src_ld, const float* kernel, uint32_t kernel_h,
+                            uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w, uint32_t dilation_h,
+                            uint32_t dilation_w, float* dst, size_t dst_ld, uint32_t output_h, uint32_t output_w) {
+    ConvPlaneBody(src, src_ld, kernel, kernel_h, kernel_w, stride_h, stride_w, dilation_h, dilation_w, dst, dst_ld,
+                  output_h, output_w);
+}
+
+static void CopyStridedScalar(const float* src, size_t stride, float* dst, size_t count) {
+    CopyStridedBody(src, stride, dst, count);
+}
+
+#if defined(KUIPER_X86)
+// exp 使用 Cephes 的做法：x = n * ln2 + r，exp(r) 用 5 阶多项式近似，2^n 直接拼到指数位上
+// ln2 拆成 C1 + C2 两部分，n * C1 是精确的，减少 r 的舍入误差
+static constexpr float kExpHigh = 88.3762626647949f;
+static constexpr float kExpLow = -88.3762626647949f;
+static constexpr float kLog2e = 1.44269504088896341f;
+static constexpr float kExpC1 = 0.693359375f;
+static constexpr float kExpC2 = -2.12194440e-4f;
+static constexpr float kExpP0 = 1.9875691500e-4f;
+static constexpr float kExpP1 = 1.3981999507e-3f;
+static constexpr float kExpP2 = 8.3334519073e-3f;
+static constexpr float kExpP3 = 4.1665795894e-2f;
+static constexpr float kExpP4 = 1.6666665459e-1f;
+static constexpr float kExpP5 = 5.0000001201e-1f;
+
+KUIPER_TARGET_AVX2 static inline __m256 Exp8(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(kExpLow)), _mm256_set1_ps(kExpHigh));
+    const __m256 n = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(kLog2e), _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(n, _mm256_set1_ps(kExpC1), x);
+    x = _mm256_fnmadd_ps(n, _mm256_set1_ps(kExpC2), x);
+    const __m256 z = _mm256_mul_ps(x, x);
+    __m256 y = _mm256_set1_ps(kExpP0);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP1));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP2));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP3));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP4));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(kExpP5));
+    y = _mm256_add_ps(_mm256_fmadd_ps(y, z, x), _mm256_set1_ps(1.f));
+    const __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(exponent));
+}
+
+KUIPER_TARGET_AVX2 static inline __m256 Sigmoid8(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.f);
+    return _mm256_div_ps(one, _mm256_add_ps(one, Exp8(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+}
+
+// 不足一个向量的尾部复制到栈上计算，所有元素都用同一种近似
+KUIPER_TARGET_AVX2 static void SigmoidAvx2(const float* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, Sigmoid8(_mm256_loadu_ps(src + i)));
+    }
+    if (i < count) {
+        alignas(32) float buffer[8] = {};
+        std::copy(src + i, src + count, buffer);
+        _mm256_store_ps(buffer, Sigmoid8(_mm256_load_ps(buffer)));
+        std::copy(buffer, buffer + (count - i), dst + i);
+    }
+}
+
+KUIPER_TARGET_AVX512 static inline __m512 Exp16(__m512 x) {
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(kExpLow)), _mm512_set1_ps(kExpHigh));
+    const __m512 n = _mm512_roundscale_ps(_mm512_fmadd_ps(x, _mm512_set1_ps(kLog2e), _mm512_set1_ps(0.5f)),
+                                          _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    x = _mm512_fnmadd_ps(n, _mm512_set1_ps(kExpC1), x);
+    x = _mm512_fnmadd_ps(n, _mm512_set1_ps(kExpC2), x);
+    const __m512 z = _mm512_mul_ps(x, x);
+    __m512 y = _mm512_set1_ps(kExpP0);
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP1));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP2));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP3));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP4));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(kExpP5));
+    y = _mm512_add_ps(_mm512_fmadd_ps(y, z, x), _mm512_set1_ps(1.f));
+    const __m512i exponent = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+    return _mm512_mul_ps(y, _mm512_castsi512_ps(exponent));
+}
+
+// AVX-512 的尾部用掩码读写
+KUIPER_TARGET_AVX512 static void SigmoidAvx512(const float* src, float* dst, size_t count) {
+    const __m512 one = _mm512_set1_ps(1.f);
+    for (size_t i = 0; i < count; i += 16) {
+        const __mmask16 mask = count - i >= 16 ? __mmask16(0xffff) : __mmask16((1u << (count - i)) - 1);
+        const __m512 x = _mm512_maskz_loadu_ps(mask, src + i);
+        const __m512 y = _mm512_div_ps(one, _mm512_add_ps(one, Exp16(_mm512_sub_ps(_mm512_setzero_ps(), x))));
+        _mm512_mask_storeu_ps(dst + i, mask, y);
+    }
+}
+
+// gather 比逐个读取还慢，只对最常见的步长 2 用两次连续读取再取偶数位置
+// 读取的第二个向量会越过最后一个需要的元素一个位置，所以最后一块留给标量循环
+KUIPER_TARGET_AVX2 static void CopyStridedAvx2(const float* src, size_t stride, float* dst, size_t count) {
+    size_t i = 0;
+    if (stride == 2) {
+        for (; i + 9 <= count; i += 8) {
+            const __m256 v0 = _mm256_loadu_ps(src + 2 * i);
+            const __m256 v1 = _mm256_loadu_ps(src + 2 * i + 8);
+            // 每个 128 位通道里取偶数位置，再按 64 位重新排列
+            const __m256 even = _mm256_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+            _mm256_storeu_ps(dst + i,
+                             _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(even), _MM_SHUFFLE(3, 1, 2, 0))));
+        }
+    }
+    CopyStridedBody(src + i * stride, stride, dst + i, count - i);
+}
+
+KUIPER_TARGET_AVX512 static void CopyStridedAvx512(const float* src, size_t stride, float* dst, size_t count) {
+    size_t i = 0;
+    if (stride == 2) {
+        const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+        for (; i + 17 <= count; i += 16) {
+            const __m512 v0 = _mm512_loadu_ps(src + 2 * i);
+            const __m512 v1 = _mm512_loadu_ps(src + 2 * i + 16);
+            _mm512_storeu_ps(dst + i, _mm512_permutex2var_ps(v0, even, v1));
+        }
+    }
+    CopyStridedBody(src + i * stride, stride, dst + i, count - i);
+}
+
+KUIPER_TARGET_AVX2 static void ReluAvx2(const float* src, float* dst, size_t count, float threshold) {
+    ReluBody(src, dst, count, threshold);
+}
+
+KUIPER_TARGET_AVX512 static void ReluAvx512(const float* src, float* dst, size_t count, float threshold) {
+    ReluBody(src, dst, count, threshold);
+}
+
+KUIPER_TARGET_AVX2 static void AddAvx2(const float* a, const float* b, float* dst, size_t count) {
+    AddBody(a, b, dst, count);
+}
+
+KUIPER_TARGET_AVX512 static void AddAvx512(const float* a, const float* b, float* dst, size_t count) {
+    AddBody(a, b, dst, count);
+}
+
+KUIPER_TARGET_AVX2 static void MulAvx2(const float* a, const float* b, float* dst, size_t count) {
+    MulBody(a, b, dst, count);
+}
+
+KUIPER_TARGET_AVX512 static void MulAvx512(const float* a, const float* b, float* dst, size_t count) {
+    MulBody(a, b, dst, count);
+}
+
+KUIPER_TARGET_AVX2 static void ScaleShiftAvx2(const float* src, float* dst, size_t count, float scale, float shift) {
+    ScaleShiftBody(src, dst, count, scale, shift);
+}
+
+KUIPER_TARGET_AVX512 static void ScaleShiftAvx512(const float* src, float* dst, size_t count, float scale,
+                                                  float shift) {
+    ScaleShiftBody(src, dst, count, scale, shift);
+}
+
+KUIPER_TARGET_AVX2 static void MaxPoolAvx2(const float* src, size_t src_ld, float* dst, size_t dst_ld,
+                                           uint32_t output_h, uint32_t output_w, uint32_t kernel_h,
+                                           uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w) {
+    MaxPoolBody(src, src_ld, dst, dst_ld, output_h, output_w, kernel_h, kernel_w, stride_h, stride_w);
+}
+
+KUIPER_TARGET_AVX512 static void MaxPoolAvx512(const float* src, size_t src_ld, float* dst, size_t dst_ld,
+                                               uint32_t output_h, uint32_t output_w, uint32_t kernel_h,
+                                               uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w) {
+    MaxPoolBody(src, src_ld, dst, dst_ld, output_h, output_w, kernel_h, kernel_w, stride_h, stride_w);
+}
+
+KUIPER_TARGET_AVX2 static void ConvPlaneAvx2(const float* src, size_t src_ld, const float* kernel, uint32_t kernel_h,
+                                             uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w,
+                                             uint32_t dilation_h, uint32_t dilation_w, float* dst, size_t dst_ld,
+                                             uint32_t output_h, uint32_t output_w) {
+    ConvPlaneBody(src, src_ld, kernel, kernel_h, kernel_w, stride_h, stride_w, dilation_h, dilation_w, dst, dst_ld,
+                  output_h, output_w);
+}
+
+KUIPER_TARGET_AVX512 static void ConvPlaneAvx512(const float* src, size_t src_ld, const float* kernel,
+                                                 uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h,
+                                                 uint32_t stride_w, uint32_t dilation_h, uint32_t dilation_w,
+                                                 float* dst, size_t dst_ld, uint32_t output_h, uint32_t output_w) {
+    ConvPlaneBody(src, src_ld, kernel, kernel_h, kernel_w, stride_h, stride_w, dilation_h, dilation_w, dst, dst_ld,
+                  output_h, output_w);
+}
+#endif
+
+static const IsaKernel<ReluFn> kReluKernel = IsaKernel<ReluFn>("relu", ReluScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, ReluAvx2)
+    .Add(CpuIsa::kAVX512, ReluAvx512)
+#endif
+    ;
+
+static const IsaKernel<SigmoidFn> kSigmoidKernel = IsaKernel<SigmoidFn>("sigmoid", SigmoidScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, SigmoidAvx2)
+    .Add(CpuIsa::kAVX512, SigmoidAvx512)
+#endif
+    ;
+
+static const IsaKernel<BinaryFn> kAddKernel = IsaKernel<BinaryFn>("add", AddScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, AddAvx2)
+    .Add(CpuIsa::kAVX512, AddAvx512)
+#endif
+    ;
+
+static const IsaKernel<BinaryFn> kMulKernel = IsaKernel<BinaryFn>("mul", MulScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, MulAvx2)
+    .Add(CpuIsa::kAVX512, MulAvx512)
+#endif
+    ;
+
+static const IsaKernel<ScaleShiftFn> kScaleShiftKernel = IsaKernel<ScaleShiftFn>("scale_shift", ScaleShiftScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, ScaleShiftAvx2)
+    .Add(CpuIsa::kAVX512, ScaleShiftAvx512)
+#endif
+    ;
+
+static const IsaKernel<MaxPoolFn> kMaxPoolKernel = IsaKernel<MaxPoolFn>("maxpool", MaxPoolScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, MaxPoolAvx2)
+    .Add(CpuIsa::kAVX512, MaxPoolAvx512)
+#endif
+    ;
+
+static const IsaKernel<ConvPlaneFn> kConvPlaneKernel = IsaKernel<ConvPlaneFn>("conv_plane", ConvPlaneScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, ConvPlaneAvx2)
+    .Add(CpuIsa::kAVX512, ConvPlaneAvx512)
+#endif
+    ;
+
+static const IsaKernel<CopyStridedFn> kCopyStridedKernel = IsaKernel<CopyStridedFn>("copy_strided", CopyStridedScalar)
+#if defined(KUIPER_X86)
+    .Add(CpuIsa::kAVX2, CopyStridedAvx2)
+    .Add(CpuIsa::kAVX512, CopyStridedAvx512)
+#endif
+    ;
+
+void ReluValues(const float* src, float* dst, size_t count, float threshold) {
+    kReluKernel.get()(src, dst, count, threshold);
+}
+
+void SigmoidValues(const float* src, float* dst, size_t count) {
+    kSigmoidKernel.get()(src, dst, count);
+}
+
+void AddValues(const float* a, const float* b, float* dst, size_t count) {
+    kAddKernel.get()(a, b, dst, count);
+}
+
+void MulValues(const float* a, const float* b, float* dst, size_t count) {
+    kMulKernel.get()(a, b, dst, count);
+}
+
+void ScaleShiftValues(const float* src, float* dst, size_t count, float scale, float shift) {
+    kScaleShiftKernel.get()(src, dst, count, scale, shift);
+}
+
+void MaxPoolPlane(const float* src, size_t src_ld, float* dst, size_t dst_ld, uint32_t output_h, uint32_t output_w,
+                  uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w) {
+    CHECK(src != nullptr && dst != nullptr);
+    CHECK(stride_h > 0 && stride_w > 0);
+    kMaxPoolKernel.get()(src, src_ld, dst, dst_ld, output_h, output_w, kernel_h, kernel_w, stride_h, stride_w);
+}
+
+void ConvPlaneAccumulate(const float* src, size_t src_ld, const float* kernel, uint32_t kernel_h, uint32_t kernel_w,
+                         uint32_t stride_h, uint32_t stride_w, uint32_t dilation_h, uint32_t dilation_w, float* dst,
+                         size_t dst_ld, uint32_t output_h, uint32_t output_w) {
+    CHECK(src != nullptr && kernel != nullptr && dst != nullptr);
+    CHECK(stride_h > 0 && stride_w > 0 && dilation_h > 0 && dilation_w > 0);
+    kConvPlaneKernel.get()(src, src_ld, kernel, kernel_h, kernel_w, stride_h, stride_w, dilation_h, dilation_w, dst,
+                           dst_ld, output_h, output_w);
+}
+
+void CopyStrided(const float* src, size_t stride, float* dst, size_t count) {
+    if (stride == 1) {
+        memcpy(dst, src, count * sizeof(float));
+    } else {
+        kCopyStridedKernel.get()(src, stride, dst, count);
+    }
+}
+
+}
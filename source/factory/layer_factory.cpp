@@ -3,18 +3,41 @@
 
 namespace kuiper_infer {
 
-void LayerRegister::RegisterCreator(OpType op_type, const Creator& creator) {
+void LayerRegister::RegisterCreator(OpType op_type, const Creator& creator, const std::string& name) {
     CHECK(creator != nullptr);
     // 初始化注册表，如果第一次创建，则新建注册表并初始化
     // 如果已经初始化了注册表，则不初始化，直接返回 static 实例
     CreateRegistry &registry = Registry();
+    std::vector<Implementation> &implementations = registry[op_type];
 
     // 因为算子在定义时就被注册，只会注册一次
-    CHECK_EQ(registry.count(op_type), 0) << "Layer type: " << int(op_type)
+    CHECK(implementations.empty() || !implementations.front().is_default) << "Layer type: " << int(op_type)
     << " has already been registered.";
 
-    // 每个op_type都指向一个layer的creator
-    registry.insert({op_type, creator});
+    // 默认实现放在最前面，额外的实现可能在它之前注册
+    Implementation implementation;
+    implementation.name = name;
+    implementation.creator = creator;
+    implementation.is_default = true;
+    for (const Implementation &other : implementations) {
+        CHECK_NE(other.name, name) << "Layer implementation " << name << " has already been registered";
+    }
+    implementations.insert(implementations.begin(), implementation);
+}
+
+void LayerRegister::RegisterImplementation(OpType op_type, const std::string& name, const Creator& creator,
+                                           Predicate predicate) {
+    CHECK(creator != nullptr);
+    CHECK(!name.empty());
+    std::vector<Implementation> &implementations = Registry()[op_type];
+    for (const Implementation &other : implementations) {
+        CHECK_NE(other.name, name) << "Layer implementation " << name << " has already been registered";
+    }
+    Implementation implementation;
+    implementation.name = name;
+    implementation.creator = creator;
+    implementation.predicate = predicate;
+    implementations.push_back(implementation);
 }
 
 
@@ -32,10 +55,12 @@ std::shared_ptr<Layer> LayerRegister::CreateLayer(
     CreateRegistry &registry = Registry();
     const OpType op_type = op->op_type_;
 
-    LOG_IF(FATAL, registry.count(op_type) <= 0) << "Can not find the layer type: " << int(op_type);        
+    auto iter = registry.find(op_type);
+    LOG_IF(FATAL, iter == registry.end() || iter->second.empty() || !iter->second.front().is_default)
+        << "Can not find the layer type: " << int(op_type);
 
     // 根据op_type获取对应的creator
-    const auto& creator = registry.find(op_type)->second;
+    const auto& creator = iter->second.front().creator;
 
     LOG_IF(FATAL, !creator) << "Layer creator is empty!";
 
@@ -44,4 +69,41 @@ std::shared_ptr<Layer> LayerRegister::CreateLayer(
     return layer;
 }
 
-}
\ No newline at end of file
+std::shared_ptr<Layer> LayerRegister::CreateLayer(const std::shared_ptr<Operator>& op, const std::string& name) {
+    CHECK(op != nullptr);
+    const CreateRegistry &registry = Registry();
+    auto iter = registry.find(op->op_type_);
+    if (iter == registry.end()) {
+        return nullptr;
+    }
+    for (const Implementation &implementation : iter->second) {
+        if (implementation.name != name) {
+            continue;
+        }
+        if (implementation.predicate != nullptr && !implementation.predicate(op)) {
+            return nullptr;
+        }
+        std::shared_ptr<Layer> layer = implementation.creator(op);
+        LOG_IF(FATAL, !layer) << "Layer init failed!";
+        return layer;
+    }
+    return nullptr;
+}
+
+std::vector<std::string> LayerRegister::Implementations(const std::shared_ptr<Operator>& op) {
+    CHECK(op != nullptr);
+    std::vector<std::string> names;
+    const CreateRegistry &registry = Registry();
+    auto iter = registry.find(op->op_type_);
+    if (iter == registry.end()) {
+        return names;
+    }
+    for (const Implementation &implementation : iter->second) {
+        if (implementation.predicate == nullptr || implementation.predicate(op)) {
+            names.push_back(implementation.name);
+        }
+    }
+    return names;
+}
+
+}
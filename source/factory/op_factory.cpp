@@ -0,0 +1,42 @@
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+void OpRegister::RegisterCreator(const std::string& op_type, const Creator& creator) {
+    CHECK(creator != nullptr);
+    CreateRegistry &registry = Registry();
+
+    CHECK_EQ(registry.count(op_type), 0) << "Operator type: " << op_type
+    << " has already been registered.";
+
+    registry.insert({op_type, creator});
+}
+
+OpRegister::CreateRegistry& OpRegister::Registry() {
+    static CreateRegistry *kRegistry = new CreateRegistry();
+    CHECK(kRegistry != nullptr);
+    return *kRegistry;
+}
+
+bool OpRegister::HasCreator(const std::string& op_type) {
+    return Registry().count(op_type) > 0;
+}
+
+std::shared_ptr<Operator> OpRegister::CreateOperator(
+    const std::shared_ptr<RuntimeOperator>& op) {
+    CHECK(op != nullptr);
+    CreateRegistry &registry = Registry();
+
+    LOG_IF(FATAL, registry.count(op->type) <= 0) << "Can not find the operator type: " << op->type;
+
+    const auto& creator = registry.find(op->type)->second;
+    LOG_IF(FATAL, !creator) << "Operator creator is empty!";
+
+    std::shared_ptr<Operator> new_op = creator(op);
+    LOG_IF(FATAL, !new_op) << "Operator " << op->name << " init failed!";
+    return new_op;
+}
+
+}
@@ -0,0 +1,90 @@
+#include "layer/batchnorm_layer.hpp"
+#include <glog/logging.h>
+#include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
+#include "factory/layer_factory.hpp"
+
+namespace kuiper_infer {
+
+BatchNormLayer::BatchNormLayer(const std::shared_ptr<Operator> &op) : Layer("BatchNorm") {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorBatchNorm);
+    this->op_ = std::dynamic_pointer_cast<BatchNormOp>(op);
+    CHECK(this->op_ != nullptr) << "BatchNorm op is empty!";
+}
+
+void BatchNormLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs,
+                             std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    const std::vector<float> &scale = this->op_->scale();
+    const std::vector<float> &shift = this->op_->shift();
+    const Halo &halo = this->output_halo_;
+
+    const uint32_t batch_size = inputs.size();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        const std::shared_ptr<Tensor<float>> &input = inputs.at(i);
+        CHECK(input != nullptr && !input->empty());
+        const uint32_t channels = input->channels();
+        CHECK_EQ(channels, this->op_->channels()) << "BatchNorm channels do not match the input";
+        const uint32_t rows = input->rows();
+        const uint32_t cols = input->cols();
+        std::shared_ptr<Tensor<float>> output = TensorCreate(channels, rows, cols, halo);
+
+#pragma omp parallel for schedule(static) if (size_t(channels) * rows * cols >= (1 << 16))
+        for (uint32_t c = 0; c < channels; ++c) {
+            if (halo.empty()) {
+                ScaleShiftValues(input->slice(c).memptr(), output->slice(c).memptr(), size_t(rows) * cols,
+                                 scale.at(c), shift.at(c));
+                continue;
+            }
+            // 输出预留边框，按列写到内部
+            for (uint32_t col = 0; col < cols; ++col) {
+                ScaleShiftValues(input->slice(c).colptr(col), output->slice(c).colptr(col + halo.w) + halo.h, rows,
+                                 scale.at(c), shift.at(c));
+            }
+        }
+
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
+        }
+    }
+}
+
+void BatchNormLayer::ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) {
+    CHECK(this->op_ != nullptr);
+    CHECK_EQ(inputs.size(), 1);
+    const BatchTensor &input = inputs.front();
+    CHECK(!input.empty());
+    CHECK_EQ(input.channels(), this->op_->channels()) << "BatchNorm channels do not match the input";
+    if (output.empty() || output.shape() != input.shape()) {
+        output = BatchTensor(input.shape());
+    }
+
+    const std::vector<float> &scale = this->op_->scale();
+    const std::vector<float> &shift = this->op_->shift();
+    const uint32_t channels = input.channels();
+    const uint32_t planes = input.batch() * channels;
+    const size_t plane_size = size_t(input.rows()) * input.cols();
+    const float *input_ptr = input.raw_ptr();
+    float *output_ptr = output.raw_ptr();
+#pragma omp parallel for schedule(static) if (planes * plane_size >= (1 << 16))
+    for (uint32_t p = 0; p < planes; ++p) {
+        ScaleShiftValues(input_ptr + p * plane_size, output_ptr + p * plane_size, plane_size, scale.at(p % channels),
+                         shift.at(p % channels));
+    }
+}
+
+bool BatchNormLayer::SupportsOutputHalo() const {
+    return true;
+}
+
+std::shared_ptr<Layer> BatchNormLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorBatchNorm);
+    return std::make_shared<BatchNormLayer>(op);
+}
+
+LayerRegisterWrapper kBatchNormLayer(OpType::kOperatorBatchNorm, BatchNormLayer::CreateInstance);
+
+}
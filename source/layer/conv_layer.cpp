@@ -1,175 +1,682 @@
 #include "layer/conv_layer.hpp"
 #include "ops/conv_op.hpp"
+#include "data/sgemm.hpp"
 #include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
 #include "factory/layer_factory.hpp"
+#include "trace.hpp"
 #include <glog/logging.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 
 
 namespace kuiper_infer {
 
-ConvLayer::ConvLayer(const std::shared_ptr<Operator> &op) : Layer("ConvLayer") {
+ConvLayer::ConvLayer(const std::shared_ptr<Operator> &op, bool implicit_gemm)
+    : Layer("ConvLayer"), implicit_gemm_(implicit_gemm) {
     CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConv);
-    ConvOp* conv_op = dynamic_cast<ConvOp*>(op.get());
+    std::shared_ptr<ConvOp> conv_op = std::dynamic_pointer_cast<ConvOp>(op);
 
     CHECK(conv_op != nullptr) << "Conv op is empty!";
-    this->op_ = std::make_unique<ConvOp>(*conv_op);
+    this->op_ = conv_op;
 }    
 
 void ConvLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
     CHECK(this->op_ != nullptr);
     CHECK(this->op_->op_type_ == OpType::kOperatorConv);
     CHECK(!inputs.empty());
-
-    auto stride = this->op_->get_stride();
-    auto padding = this->op_->get_padding();
+    CHECK(inputs.front() != nullptr && !inputs.front()->empty());
 
     const uint32_t batch_size = inputs.size();
+    CHECK(this->op_->kernel_count() > 0);
 
-    const uint32_t padding_h = padding.first;
-    const uint32_t padding_w = padding.second;
-    const uint32_t stride_h = stride.first;
-    const uint32_t stride_w = stride.second;
-    const uint32_t groups = this->op_->get_groups();
+    // 生产者已经预留边框时输入的形状包含边框
+    const bool inputs_padded = !this->input_halo_.empty();
+    if (inputs_padded) {
+        CHECK(this->input_halo_ == this->InputPadding()) << "Input halo does not match the padding";
+    }
+    const uint32_t input_h = inputs.front()->rows() - 2 * this->input_halo_.h;
+    const uint32_t input_w = inputs.front()->cols() - 2 * this->input_halo_.w;
+
+    // outputs - (batch_size, output_channels, output_h, output_w)
+    const auto [output_h, output_w] = OutputSize(input_h, input_w);
+    std::vector<TensorView> input_views;
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        input_views.emplace_back(inputs.at(i));
+    }
+    std::vector<float *> output_ptrs;
+    outputs = CreateOutputs(batch_size, output_h, output_w, output_ptrs);
+    Convolve(input_views, inputs_padded, output_ptrs, output_h, output_w, this->output_halo_);
+}
 
-    const std::vector<sftensor>& weights = this->op_->get_weights();
-    CHECK(!weights.empty());
+std::vector<std::shared_ptr<Tensor<float>>> ConvLayer::CreateOutputs(uint32_t batch_size, uint32_t output_h,
+                                                                     uint32_t output_w,
+                                                                     std::vector<float *> &output_ptrs) const {
+    const uint32_t output_c = this->op_->kernel_count();
+    std::vector<std::shared_ptr<Tensor<float>>> outputs(batch_size);
+    output_ptrs.resize(batch_size);
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        outputs.at(i) = TensorCreate(output_c, output_h, output_w, this->output_halo_);
+        output_ptrs.at(i) = outputs.at(i)->data().memptr();
+    }
+    return outputs;
+}
 
+void ConvLayer::ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) {
+    CHECK(this->op_ != nullptr);
+    CHECK_EQ(inputs.size(), 1);
+    const BatchTensor &input = inputs.front();
+    CHECK(this->op_->kernel_count() > 0);
+
+    const uint32_t batch_size = input.batch();
+    const uint32_t output_c = this->op_->kernel_count();
+    const auto [output_h, output_w] = OutputSize(input.rows(), input.cols());
+    if (output.empty() || output.shape() != std::vector<uint32_t>{batch_size, output_c, output_h, output_w}) {
+        output = BatchTensor(batch_size, output_c, output_h, output_w);
+    }
 
+    // 每个 batch 元素直接使用 batch 的内存
+    std::vector<TensorView> input_views;
+    std::vector<float *> output_ptrs(batch_size);
     for (uint32_t i = 0; i < batch_size; ++i) {
-        const std::shared_ptr<Tensor<float>> &input_data = TensorClone(inputs.at(i));
-
-        CHECK(input_data != nullptr);
-
-        if (padding_w != 0 || padding_h != 0)
-            input_data->Padding({padding_w, padding_w, padding_h, padding_h} ,0);
-
-        // batch里的一个输入
-
-        const uint32_t input_h = inputs.at(0)->rows();
-        const uint32_t input_w = inputs.at(0)->cols();
-        const uint32_t input_c = inputs.at(0)->channels();
-        
-        const uint32_t output_c = weights.size(); // 卷积核个数
-        const uint32_t kernel_h = weights.at(0)->rows();
-        const uint32_t kernel_w = weights.at(0)->cols();
-        const uint32_t kernel_c = weights.at(0)->channels();
-        const uint32_t output_h = std::uint32_t(std::floor((input_h  - kernel_h) / stride_h)) + 1;
-        const uint32_t output_w = std::uint32_t(std::floor((input_w  - kernel_w) / stride_w)) + 1;
-
-        if (groups != 1) {
-            CHECK(input_c % groups == 0);
-            CHECK(output_c % groups == 0);
-            CHECK(input_c / groups == kernel_c);
-        }
-
-        // im2col
-        // 将输入转换为一个列为kernel大小，行为输出大小的张量
-        const uint32_t kernel_size = kernel_h * kernel_w; // 一个通道的kernel大小
-        // 一个卷积操作的输出大小
-        const uint32_t output_size = output_h * output_w;
-
-        // outputs - (batch_size, output_channels, output_h, output_w)
-        
-        // 当前batch的输出
-        std::shared_ptr<ftensor> output_data = std::make_shared<ftensor>(output_c, output_h, output_w);
-
-        uint32_t kernels_per_group = output_c / groups;
-        for (uint32_t g = 0; g < groups; ++g) {
-            // 拼接一个group的kernel和一个group的输入
-            // 存放展开后的kernel，大小为一个group的kernels
-            std::vector<arma::fmat> kernel_matrix(kernels_per_group);
-            arma::fmat kernel_flatten(1, kernel_size * kernel_c);
-            // 一个展开的kernel大小，kernel的channels是一个group的输入channels
+        input_views.push_back(input.view().Batch(i));
+        output_ptrs.at(i) = output.raw_ptr() + size_t(i) * output_c * output_h * output_w;
+    }
+    Convolve(input_views, false, output_ptrs, output_h, output_w, Halo());
+}
 
-            for (uint32_t k = 0; k < kernels_per_group; ++k) {
-                // 展开一个group的kernel
-                // 拿到当前的kernel
-                const std::shared_ptr<Tensor<float>> &kernel = weights.at(k + kernels_per_group * g);
-                
-                // 按通道展开
-                for (uint32_t ic = 0; ic < kernel_c; ++ic) {
-                    memcpy(kernel_flatten.memptr() + ic * kernel_size, kernel->slice(ic).memptr(), kernel_size * sizeof(float));
-                }
+void ConvLayer::ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    CHECK(this->op_->kernel_count() > 0);
+
+    std::vector<TensorView> input_views;
+    for (const TensorView &input : inputs) {
+        CHECK(!input.empty());
+        for (uint32_t i = 0; i < input.batch(); ++i) {
+            input_views.push_back(input.Batch(i));
+        }
+    }
+
+    const bool inputs_padded = !this->input_halo_.empty();
+    const uint32_t input_h = input_views.front().rows() - 2 * this->input_halo_.h;
+    const uint32_t input_w = input_views.front().cols() - 2 * this->input_halo_.w;
+
+    const uint32_t batch_size = input_views.size();
+    const auto [output_h, output_w] = OutputSize(input_h, input_w);
+    std::vector<float *> output_ptrs;
+    const std::vector<std::shared_ptr<Tensor<float>>> &results = CreateOutputs(batch_size, output_h, output_w, output_ptrs);
+    Convolve(input_views, inputs_padded, output_ptrs, output_h, output_w, this->output_halo_);
+
+    if (outputs.size() == results.size()) {
+        outputs = results;
+    } else {
+        outputs.insert(outputs.end(), results.begin(), results.end());
+    }
+}
+
+bool ConvLayer::AcceptsStridedViews() const {
+    return true;
+}
+
+Halo ConvLayer::InputPadding() const {
+    CHECK(this->op_ != nullptr);
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    Halo halo;
+    halo.h = padding_h;
+    halo.w = padding_w;
+    return halo;
+}
+
+bool ConvLayer::SupportsOutputHalo() const {
+    return true;
+}
+
+std::pair<uint32_t, uint32_t> ConvLayer::OutputSize(uint32_t input_h, uint32_t input_w) const {
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    CHECK(this->op_->kernel_count() > 0);
+
+    // 带 dilation 的卷积核覆盖 dilation * (kernel - 1) + 1 个输入
+    const std::vector<uint32_t> &kernel_shape = this->op_->kernel_shape();
+    const uint32_t extent_h = dilation_h * (kernel_shape.at(1) - 1) + 1;
+    const uint32_t extent_w = dilation_w * (kernel_shape.at(2) - 1) + 1;
+    CHECK(input_h + 2 * padding_h >= extent_h && input_w + 2 * padding_w >= extent_w)
+        << "Input is smaller than the kernel";
+    const uint32_t output_h = (input_h + 2 * padding_h - extent_h) / stride_h + 1;
+    const uint32_t output_w = (input_w + 2 * padding_w - extent_w) / stride_w + 1;
+    return {output_h, output_w};
+}
+
+// 压缩存储的卷积核一次转换 kTileBytes 左右，至少 kMinTileKernels 个
+static uint32_t CompressedTileKernels(uint32_t kernels_per_group, uint32_t kernel_elements) {
+    constexpr size_t kTileBytes = 32 * 1024;
+    constexpr uint32_t kMinTileKernels = 16;
+    return std::min<uint32_t>(
+        kernels_per_group,
+        std::max<uint32_t>(kMinTileKernels, kTileBytes / (size_t(kernel_elements) * sizeof(float))));
+}
 
-                kernel_matrix.at(k) = kernel_flatten;
-                // 一个group的展开kernel_matrix
-                // (kernel_per_group, kernel_size * kernel_c)
+void ConvLayer::Im2Col(const Tensor<float> &input, uint32_t first_channel, uint32_t kernel_c,
+                       uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w,
+                       uint32_t dilation_h, uint32_t dilation_w, uint32_t output_h, uint32_t output_w,
+                       arma::fmat &input_matrix, uint32_t row_offset) {
+    // 第 (ic, kw, kh) 列对应卷积核的这个元素，和卷积核列主序展开的顺序一致
+    // 一列里的输出位置按列主序排布，reshape 成 (output_h, output_w) 时位置才对应
+    for (uint32_t ic = 0; ic < kernel_c; ++ic) {
+        const arma::fmat &input_channel = input.slice(first_channel + ic);
+        for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+            for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                const uint32_t column = ic * kernel_h * kernel_w + kw * kernel_h + kh;
+                float *matrix_ptr = input_matrix.colptr(column) + row_offset;
+                for (uint32_t ow = 0; ow < output_w; ++ow) {
+                    const float *region_ptr = input_channel.colptr(ow * stride_w + kw * dilation_w) + kh * dilation_h;
+                    CopyStrided(region_ptr, stride_h, matrix_ptr, output_h);
+                    matrix_ptr += output_h;
+                }
             }
+        }
+    }
+}
 
-            // im2col输入矩阵 - (kernel_size * kernel_c, output_size)
-            // 最终输出 kernel_matrix @ input_matrix - (kernel_per_group, output_size) - 每一个卷积得到一个output_channel
-            arma::fmat input_matrix(kernel_size * kernel_c, output_size);
-            
-            // kernel_c == input_channels_per_group
-            
-            for (uint32_t ic = 0; ic < kernel_c; ++ic) {
-                const arma::fmat &input_channel = input_data->slice(g * kernel_c + ic);
-                // 取一个通道的输入
-                uint32_t cur_col = 0; // 遍历到的input_matrix的列
-                for (uint32_t irow = 0; irow < input_h - kernel_h + 1; irow += stride_h)
-                    for (uint32_t jcol = 0; jcol < input_w - kernel_w + 1; jcol += stride_w) {
-                        // 当前channel应该放在input_matrix的cur_col的具体位置
-                        float* input_matrix_c_colptr = input_matrix.colptr(cur_col) + ic * kernel_size;
-                        cur_col += 1;
-
-                        // 列优先处理窗口数据
-                        for (uint32_t kw = 0; kw < kernel_w; ++kw) {
-                            const float *region_ptr = input_channel.colptr(jcol + kw) + irow;
-                            // 当前区域左上角地址
-                            memcpy(input_matrix_c_colptr, region_ptr, kernel_h * sizeof(float));
-
-                            input_matrix_c_colptr += kernel_h;
-                        }
-                    }
+// 一个输入通道里第 col 列(已经减去 padding)、从 row_begin 行开始每 stride_h 行一个的值里，
+// 第 oh_first 个开始的 count 个写到 dst，落在输入外面(padding)的位置填 0
+static void Im2ColSegment(const float *channel_ptr, size_t row_stride, size_t col_stride, int input_h, int input_w,
+                          int col, int row_begin, uint32_t stride_h, uint32_t oh_first, uint32_t count, float *dst) {
+    if (col < 0 || col >= input_w) {
+        std::fill(dst, dst + count, 0.f);
+        return;
+    }
+    // 落在输入里的是连续的一段输出行 [oh_begin, oh_end)，两边补 0
+    const uint32_t oh_last = oh_first + count;
+    const uint32_t oh_begin = row_begin >= 0 ? oh_first : std::min(oh_last, std::max(oh_first,
+        uint32_t(-row_begin + int(stride_h) - 1) / stride_h));
+    const uint32_t oh_end = input_h > row_begin
+        ? std::max(oh_begin, std::min(oh_last, uint32_t(input_h - row_begin + int(stride_h) - 1) / stride_h))
+        : oh_begin;
+    std::fill(dst, dst + (oh_begin - oh_first), 0.f);
+    if (oh_end > oh_begin) {
+        CopyStrided(channel_ptr + col * col_stride + (int(oh_begin * stride_h) + row_begin) * row_stride,
+                    stride_h * row_stride, dst + (oh_begin - oh_first), oh_end - oh_begin);
+    }
+    std::fill(dst + (oh_end - oh_first), dst + count, 0.f);
+}
+
+void ConvLayer::Im2ColStrided(const TensorView &input, uint32_t first_channel, uint32_t kernel_c,
+                              uint32_t kernel_h, uint32_t kernel_w, uint32_t stride_h, uint32_t stride_w,
+                              uint32_t dilation_h, uint32_t dilation_w, uint32_t padding_h, uint32_t padding_w,
+                              uint32_t output_h, uint32_t output_w, arma::fmat &input_matrix, uint32_t row_offset) {
+    const int input_h = int(input.rows());
+    const int input_w = int(input.cols());
+    const size_t channel_stride = input.strides().at(1);
+    const size_t row_stride = input.strides().at(2);
+    const size_t col_stride = input.strides().at(3);
+
+    // 列和位置的顺序和 Im2Col 一致
+    for (uint32_t ic = 0; ic < kernel_c; ++ic) {
+        const float *channel_ptr = input.raw_ptr() + (first_channel + ic) * channel_stride;
+        for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+            for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                const uint32_t column = ic * kernel_h * kernel_w + kw * kernel_h + kh;
+                float *matrix_ptr = input_matrix.colptr(column) + row_offset;
+                for (uint32_t ow = 0; ow < output_w; ++ow) {
+                    Im2ColSegment(channel_ptr, row_stride, col_stride, input_h, input_w,
+                                  int(ow * stride_w + kw * dilation_w) - int(padding_w),
+                                  int(kh * dilation_h) - int(padding_h), stride_h, 0, output_h, matrix_ptr);
+                    matrix_ptr += output_h;
+                }
             }
+        }
+    }
+}
 
-            // 还是在一个group里
-            LOG(INFO) << "input展开后: " << "\n" << input_matrix;
+void ConvLayer::Convolve(const std::vector<TensorView> &inputs, bool inputs_padded, const std::vector<float *> &outputs,
+                         uint32_t output_h, uint32_t output_w, const Halo &output_halo) const {
+    CHECK_EQ(inputs.size(), outputs.size());
+    if (this->op_->int8_enabled()) {
+        ConvolveInt8(inputs, inputs_padded, outputs, output_h, output_w, output_halo);
+        return;
+    }
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    const uint32_t groups = this->op_->get_groups();
+    const std::vector<uint32_t> &kernel_shape = this->op_->kernel_shape();
 
-            // std::shared_ptr<ftensor> output_data = outputs.at(i);
-            // // 初始化当前batch的输出
-            // // 因为是在group里，只需要初始化一次
-            // if (output_data == nullptr || output_data->empty()) {
-            //     output_data = std::make_shared<ftensor>(output_c, output_h, output_w);
-            //     outputs.at(i) = output_data;
-            // }
+    const uint32_t batch_size = inputs.size();
+    const uint32_t input_c = inputs.front().channels();
+    const uint32_t output_c = this->op_->kernel_count(); // 卷积核个数
+    const uint32_t kernel_c = kernel_shape.at(0);
+    const uint32_t kernel_h = kernel_shape.at(1);
+    const uint32_t kernel_w = kernel_shape.at(2);
+    const uint32_t kernel_elements = kernel_c * kernel_h * kernel_w;
+    const uint32_t output_size = output_h * output_w;
+    // 带边框的输出里一列和一个通道的大小
+    const uint32_t output_rows = output_h + 2 * output_halo.h;
+    const size_t output_plane = size_t(output_rows) * (output_w + 2 * output_halo.w);
+
+    CHECK(input_c % groups == 0);
+    CHECK(output_c % groups == 0);
+    CHECK(input_c / groups == kernel_c);
+
+    // im2col 矩阵 - (batch_size * output_size, kernel_elements)，超过上限时不展开
+    const uint32_t rows = batch_size * output_size;
+    const bool implicit = this->implicit_gemm_ || size_t(rows) * kernel_elements * sizeof(float) > workspace_limit();
+
+    // 输入只读，列主序连续时直接使用(需要时 padding)，分组卷积按通道读取也不复制
+    // 其他排布的输入不转换，im2col 时按步长读取；输入已经带边框时直接读取边框
+    // 隐式 GEMM 总是按步长读取，不 padding
+    std::vector<std::shared_ptr<Tensor<float>>> padded_inputs(batch_size);
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        const TensorView &input = inputs.at(i);
+        CHECK(!input.empty() && input.batch() == 1);
+        CHECK(input.shape() == inputs.front().shape()) << "Batch elements have different shapes";
+        if (!input.is_contiguous()) {
+            CHECK(!inputs_padded) << "Padded inputs must be contiguous";
+            continue;
+        }
+        if (implicit) {
+            continue;
+        }
+        if (!inputs_padded && (padding_h != 0 || padding_w != 0)) {
+            padded_inputs.at(i) = TensorPadding(input.AsTensor(), {padding_h, padding_h, padding_w, padding_w}, 0);
+        } else {
+            padded_inputs.at(i) = input.AsTensor();
+        }
+    }
 
-            // std::vector<arma::fmat> outputs_matrix(kernels_per_group);
+    const bool has_bias = this->op_->get_has_bias();
+    const std::vector<std::shared_ptr<Tensor<float>>>& bias = this->op_->get_bias();
+    const uint32_t kernels_per_group = output_c / groups;
+
+    // 把结果矩阵的一列(一个输出通道)从第 first_row 行开始的 rows 行加上 bias 写到输出
+    // 输出没有边框时一个通道是连续的，有边框时按列写到内部
+    const uint32_t segments = output_halo.empty() ? 1 : output_w;
+    const uint32_t segment_size = output_size / segments;
+    auto store_column = [&](const float *src, uint32_t first_row, uint32_t rows, uint32_t channel) {
+        const float bias_value = has_bias ? bias.at(channel)->index(0) : 0.f;
+        const uint32_t end_row = first_row + rows;
+        for (uint32_t row = first_row; row < end_row;) {
+            const uint32_t i = row / output_size;
+            const uint32_t s = row % output_size / segment_size;
+            const uint32_t offset = row % output_size % segment_size;
+            const uint32_t count = std::min(segment_size - offset, end_row - row);
+            float *dst = outputs.at(i) + size_t(channel) * output_plane + size_t(s + output_halo.w) * output_rows +
+                         output_halo.h + offset;
+            if (has_bias) {
+                for (uint32_t j = 0; j < count; ++j) {
+                    dst[j] = src[j] + bias_value;
+                }
+            } else {
+                memcpy(dst, src, count * sizeof(float));
+            }
+            src += count;
+            row += count;
+        }
+    };
 
-            for (uint32_t k = 0; k < kernels_per_group; k ++) {
-                LOG(INFO) << "这是第" << k << "个卷积\n" << kernel_matrix.at(k); // 拿出第一个展开后的卷积核
-                LOG(INFO) << "\n" << input_matrix; // 拿出展开后的输入特征图
+    // 一个 group 的 bias，结果直接写到输出时在矩阵乘的后处理里加上
+    std::vector<float> group_bias(kernels_per_group);
+    auto group_epilogue = [&](uint32_t group) {
+        SgemmEpilogue epilogue;
+        if (has_bias) {
+            for (uint32_t k = 0; k < kernels_per_group; ++k) {
+                group_bias.at(k) = bias.at(group * kernels_per_group + k)->index(0);
+            }
+            epilogue.bias = group_bias.data();
+        }
+        return epilogue;
+    };
+    // 只有一个输入并且输出没有边框时，输出的一个通道就是结果矩阵的一列
+    const bool direct_output = batch_size == 1 && output_halo.empty();
+
+    if (implicit) {
+        ConvolveImplicit(inputs, inputs_padded, outputs, output_h, output_w, direct_output, output_plane,
+                         group_epilogue, store_column);
+        return;
+    }
+
+    // im2col 输入矩阵，batch 里的输入依次向下拼接
+    arma::fmat input_matrix(rows, kernel_elements);
+    for (uint32_t g = 0; g < groups; ++g) {
+        for (uint32_t i = 0; i < batch_size; ++i) {
+            if (padded_inputs.at(i) != nullptr) {
+                Im2Col(*padded_inputs.at(i), g * kernel_c, kernel_c, kernel_h, kernel_w, stride_h, stride_w,
+                       dilation_h, dilation_w, output_h, output_w, input_matrix, i * output_size);
+            } else {
+                Im2ColStrided(inputs.at(i), g * kernel_c, kernel_c, kernel_h, kernel_w, stride_h, stride_w,
+                              dilation_h, dilation_w, padding_h, padding_w, output_h, output_w, input_matrix,
+                              i * output_size);
+            }
+        }
+        KUIPER_TRACE(INFO) << "input展开后: " << "\n" << input_matrix;
 
-                const arma::fmat& output = kernel_matrix.at(k) * input_matrix;
+        if (this->op_->weights_compressed()) {
+            MultiplyCompressed(input_matrix, g, kernels_per_group, store_column);
+            continue;
+        }
 
-                LOG(INFO) << "当前卷积结果：\n" << output; // 当前卷积算子的输出
+        // (batch_size * output_size, kernels_per_group)，每一列是一个输出通道
+        const PackedSgemmMatrix &packed_kernels = this->op_->packed_weights().at(g);
+        if (direct_output) {
+            Sgemm(rows, input_matrix.memptr(), rows, packed_kernels,
+                  outputs.front() + size_t(g) * kernels_per_group * output_plane, output_plane, group_epilogue(g));
+            continue;
+        }
+        arma::fmat output(rows, kernels_per_group);
+        Sgemm(rows, input_matrix.memptr(), rows, packed_kernels, output.memptr(), rows);
+        KUIPER_TRACE(INFO) << "当前卷积结果：\n" << output;
+        for (uint32_t k = 0; k < kernels_per_group; ++k) {
+            store_column(output.colptr(k), 0, rows, g * kernels_per_group + k);
+        }
+    }
+}
 
-                // outputs_matrix.at(k) = output;
+void ConvLayer::ConvolveImplicit(const std::vector<TensorView> &inputs, bool inputs_padded,
+                                 const std::vector<float *> &outputs, uint32_t output_h, uint32_t output_w,
+                                 bool direct_output, size_t output_plane, const GroupEpilogue &group_epilogue,
+                                 const StoreColumn &store_column) const {
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    const uint32_t groups = this->op_->get_groups();
+    const std::vector<uint32_t> &kernel_shape = this->op_->kernel_shape();
+    const uint32_t kernel_c = kernel_shape.at(0);
+    const uint32_t kernel_h = kernel_shape.at(1);
+    const uint32_t kernel_w = kernel_shape.at(2);
+    const uint32_t kernel_elements = kernel_c * kernel_h * kernel_w;
+    const uint32_t kernels_per_group = this->op_->kernel_count() / groups;
+    const uint32_t output_size = output_h * output_w;
+    const uint32_t rows = inputs.size() * output_size;
+
+    // 输入不 padding，按步长读取，padding 的位置在生成面板时填 0；输入带边框时直接读边框
+    const int border_h = inputs_padded ? 0 : int(padding_h);
+    const int border_w = inputs_padded ? 0 : int(padding_w);
+    const int input_h = int(inputs.front().rows());
+    const int input_w = int(inputs.front().cols());
+    struct InputPlanes {
+        const float *data;
+        size_t channel_stride;
+        size_t row_stride;
+        size_t col_stride;
+    };
+    std::vector<InputPlanes> planes;
+    for (const TensorView &input : inputs) {
+        const std::vector<uint32_t> &strides = input.strides();
+        planes.push_back({input.raw_ptr(), strides.at(1), strides.at(2), strides.at(3)});
+    }
 
-                arma::fmat& output_slice = output_data->slice(g * kernels_per_group + k);
+    // 结果不能直接写到输出时按行分段，每段的结果矩阵不超过 workspace_limit()
+    const uint32_t chunk_rows = direct_output ? rows : uint32_t(std::min<size_t>(
+        rows, std::max<size_t>(1024, workspace_limit() / (size_t(kernels_per_group) * sizeof(float)))));
+    std::vector<float> chunk_output(direct_output ? 0 : size_t(chunk_rows) * kernels_per_group);
+
+    // fp32 卷积核在 ConvOp 里已经预打包
+    // 压缩存储时和 MultiplyCompressed 一样，每次只把一段卷积核转换到小缓冲区里再打包，不展开整个 fp32 卷积核矩阵
+    // 每一段都要重新生成 A 的面板，开销是矩阵乘的 1 / tile_kernels
+    const bool compressed = this->op_->weights_compressed();
+    const uint32_t tile_kernels =
+        compressed ? CompressedTileKernels(kernels_per_group, kernel_elements) : kernels_per_group;
+    std::vector<float> tile_buffer(compressed ? size_t(kernel_elements) * tile_kernels : 0);
+    PackedSgemmMatrix compressed_kernels;
+    for (uint32_t g = 0; g < groups; ++g) {
+        for (uint32_t first_kernel = 0; first_kernel < kernels_per_group; first_kernel += tile_kernels) {
+            const uint32_t tile_size = std::min(tile_kernels, kernels_per_group - first_kernel);
+            const uint32_t first_channel = g * kernels_per_group + first_kernel;
+            if (compressed) {
+                for (uint32_t k = 0; k < tile_size; ++k) {
+                    this->op_->CopyKernel(first_channel + k, tile_buffer.data() + size_t(k) * kernel_elements);
+                }
+                compressed_kernels = PackSgemmMatrix(tile_buffer.data(), kernel_elements, kernel_elements, tile_size);
+            }
+            const PackedSgemmMatrix &packed_kernels =
+                compressed ? compressed_kernels : this->op_->packed_weights().at(g);
+            for (uint32_t first_row = 0; first_row < rows; first_row += chunk_rows) {
+                const uint32_t chunk_size = std::min(chunk_rows, rows - first_row);
+                // 面板的一列是卷积核的一个元素 (ic, kw, kh)，行按输出位置(batch, ow, oh)排列，
+                // 同一个 batch 元素和 ow 的一段连续输出行对应输入一列里按步长的一段
+                auto pack_a = [&](uint32_t block_row, uint32_t block_rows, uint32_t first_col, uint32_t cols,
+                                  uint32_t mr, float *packed) {
+                    for (uint32_t p = 0; p < cols; ++p) {
+                        const uint32_t column = first_col + p;
+                        const uint32_t ic = column / (kernel_h * kernel_w);
+                        const uint32_t kw = column % (kernel_h * kernel_w) / kernel_h;
+                        const uint32_t kh = column % kernel_h;
+                        for (uint32_t r = 0; r < block_rows;) {
+                            const uint32_t row = first_row + block_row + r;
+                            const uint32_t position = row % output_size;
+                            const uint32_t ow = position / output_h;
+                            const uint32_t oh = position % output_h;
+                            const uint32_t count = std::min({output_h - oh, block_rows - r, mr - r % mr});
+                            const InputPlanes &plane = planes.at(row / output_size);
+                            Im2ColSegment(plane.data + (g * kernel_c + ic) * plane.channel_stride,
+                                          plane.row_stride, plane.col_stride, input_h, input_w,
+                                          int(ow * stride_w + kw * dilation_w) - border_w,
+                                          int(kh * dilation_h) - border_h, stride_h, oh, count,
+                                          packed + size_t(r / mr) * mr * cols + size_t(p) * mr + r % mr);
+                            r += count;
+                        }
+                        if (block_rows % mr != 0) {
+                            float *tail = packed + size_t(block_rows / mr) * mr * cols + size_t(p) * mr;
+                            std::fill(tail + block_rows % mr, tail + mr, 0.f);
+                        }
+                    }
+                };
+                if (direct_output) {
+                    // bias 从这一段的第一个卷积核开始
+                    SgemmEpilogue epilogue = group_epilogue(g);
+                    if (epilogue.bias != nullptr) {
+                        epilogue.bias += first_kernel;
+                    }
+                    SgemmImplicit(chunk_size, pack_a, packed_kernels,
+                                  outputs.front() + size_t(first_channel) * output_plane, output_plane, epilogue);
+                    continue;
+                }
+                SgemmImplicit(chunk_size, pack_a, packed_kernels, chunk_output.data(), chunk_size);
+                for (uint32_t k = 0; k < tile_size; ++k) {
+                    store_column(chunk_output.data() + size_t(k) * chunk_size, first_row, chunk_size,
+                                 first_channel + k);
+                }
+            }
+        }
+    }
+}
 
-                arma::fmat output_biased = output;
-                output_biased.reshape(output_h, output_w);
+void ConvLayer::MultiplyCompressed(const arma::fmat &input_matrix, uint32_t group, uint32_t kernels_per_group,
+                                   const StoreColumn &store_column) const {
+    const uint32_t rows = input_matrix.n_rows;
+    const uint32_t kernel_elements = input_matrix.n_cols;
+
+    // 输入矩阵按行分块，一块约 kBlockBytes 留在 L2 里，依次和每一块转换好的卷积核相乘
+    // 转换卷积核的开销是矩阵乘的 1 / block_rows
+    constexpr size_t kBlockBytes = 512 * 1024;
+    const uint32_t block_rows = std::min<uint32_t>(
+        rows, std::max<uint32_t>(256, kBlockBytes / (size_t(kernel_elements) * sizeof(float)) / 16 * 16));
+    const uint32_t tile_kernels = CompressedTileKernels(kernels_per_group, kernel_elements);
+
+    std::vector<float> tile_buffer(size_t(kernel_elements) * tile_kernels);
+    std::vector<float> output(size_t(block_rows) * tile_kernels);
+    for (uint32_t first_row = 0; first_row < rows; first_row += block_rows) {
+        // 输入矩阵的行块按列距 rows 直接读取，不复制
+        const uint32_t block_size = std::min(block_rows, rows - first_row);
+        const float *block = input_matrix.memptr() + first_row;
+        for (uint32_t first_kernel = 0; first_kernel < kernels_per_group; first_kernel += tile_kernels) {
+            const uint32_t tile_size = std::min(tile_kernels, kernels_per_group - first_kernel);
+            const uint32_t first_channel = group * kernels_per_group + first_kernel;
+            for (uint32_t k = 0; k < tile_size; ++k) {
+                this->op_->CopyKernel(first_channel + k, tile_buffer.data() + size_t(k) * kernel_elements);
+            }
+            Sgemm(block_size, tile_size, kernel_elements, block, rows, tile_buffer.data(), kernel_elements,
+                  output.data(), block_size);
+            for (uint32_t k = 0; k < tile_size; ++k) {
+                store_column(output.data() + size_t(k) * block_size, first_row, block_size, first_channel + k);
+            }
+        }
+    }
+}
 
-                if (this->op_->get_has_bias()) {
-                    LOG(INFO) << "当前有bias：\n";
-                    std::vector<std::shared_ptr<Tensor<float>>> bias = this->op_->get_bias();
-                    
-                    LOG(INFO) << "reshape后的输出：\n" << output;
-                    LOG(INFO) << "需要加到output上的bias：\n" << bias.at(k + kernels_per_group * g);
-                    
-                    output_biased += bias.at(k + kernels_per_group * g)->index(0);
-                } 
-                
-                output_slice = output_biased;
+void ConvLayer::ConvolveInt8(const std::vector<TensorView> &inputs, bool inputs_padded,
+                             const std::vector<float *> &outputs, uint32_t output_h, uint32_t output_w,
+                             const Halo &output_halo) const {
+    const ConvInt8Weights &int8_weights = *this->op_->int8_weights();
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    const uint32_t groups = this->op_->get_groups();
+    const std::vector<uint32_t> &kernel_shape = this->op_->kernel_shape();
 
-                // output_data->slice(g * kernels_per_group + k) = std::move(output);
-                
+    const uint32_t batch_size = inputs.size();
+    const uint32_t input_c = inputs.front().channels();
+    const uint32_t output_c = this->op_->kernel_count();
+    const uint32_t kernel_c = kernel_shape.at(0);
+    const uint32_t kernel_h = kernel_shape.at(1);
+    const uint32_t kernel_w = kernel_shape.at(2);
+    const uint32_t output_size = output_h * output_w;
+    const uint32_t output_rows = output_h + 2 * output_halo.h;
+    const size_t output_plane = size_t(output_rows) * (output_w + 2 * output_halo.w);
+    CHECK(input_c % groups == 0);
+    CHECK(input_c / groups == kernel_c);
+
+    // 输入量化为带 padding 边框的 uint8 平面，列主序，边框填零点，也就是实数 0
+    // 输入已经带边框时边框里是 0，整体量化即可
+    const float input_scale = int8_weights.input_params.scale(0);
+    const int32_t input_zero_point = int8_weights.input_params.zero_point(0);
+    const uint32_t border_h = inputs_padded ? 0 : padding_h;
+    const uint32_t border_w = inputs_padded ? 0 : padding_w;
+    const uint32_t padded_h = inputs.front().rows() + 2 * border_h;
+    const uint32_t padded_w = inputs.front().cols() + 2 * border_w;
+    const size_t padded_plane = size_t(padded_h) * padded_w;
+    std::unique_ptr<uint8_t[]> quantized_inputs(new uint8_t[size_t(batch_size) * input_c * padded_plane]);
+#pragma omp parallel for schedule(static) if (size_t(batch_size) * input_c * padded_plane >= (1 << 16))
+    for (uint32_t plane = 0; plane < batch_size * input_c; ++plane) {
+        const TensorView &input = inputs.at(plane / input_c);
+        const uint32_t channel = plane % input_c;
+        CHECK(!input.empty() && input.batch() == 1);
+        CHECK(input.shape() == inputs.front().shape()) << "Batch elements have different shapes";
+        const size_t row_stride = input.strides().at(2);
+        const size_t col_stride = input.strides().at(3);
+        const float *channel_ptr = input.raw_ptr() + channel * input.strides().at(1);
+        uint8_t *dst = quantized_inputs.get() + plane * padded_plane;
+        if (border_h != 0 || border_w != 0) {
+            std::fill(dst, dst + padded_plane, uint8_t(input_zero_point));
+        }
+        std::vector<float> column(row_stride == 1 ? 0 : input.rows());
+        for (uint32_t col = 0; col < input.cols(); ++col) {
+            const float *src = channel_ptr + col * col_stride;
+            if (row_stride != 1) {
+                for (uint32_t row = 0; row < input.rows(); ++row) {
+                    column.at(row) = src[row * row_stride];
+                }
+                src = column.data();
             }
+            QuantizeValues(src, dst + size_t(col + border_w) * padded_h + border_h, input.rows(), input_scale,
+                           input_zero_point, false);
+        }
+    }
 
+    // im2col - (batch_size * output_size, k_padded) 的行主序矩阵，每一行是一个输出位置
+    // 列主序的输入里卷积核的一列(kernel_h 个元素)没有 dilation 时是连续的，整段复制
+    const uint32_t rows = batch_size * output_size;
+    const uint32_t kernels_per_group = output_c / groups;
+    const uint32_t lda = int8_weights.packed_weights.front().k_padded;
+    const uint32_t kernel_elements = kernel_c * kernel_h * kernel_w;
+    std::unique_ptr<uint8_t[]> input_matrix(new uint8_t[size_t(rows) * lda]);
+    std::unique_ptr<uint8_t[]> output_matrix(new uint8_t[size_t(rows) * kernels_per_group]);
+    const float output_scale = int8_weights.output_params.scale(0);
+    const int32_t output_zero_point = int8_weights.output_params.zero_point(0);
+    for (uint32_t g = 0; g < groups; ++g) {
+#pragma omp parallel for schedule(static) if (size_t(rows) * lda >= (1 << 16))
+        for (uint32_t position = 0; position < rows; ++position) {
+            const uint32_t i = position / output_size;
+            const uint32_t ow = position % output_size / output_h;
+            const uint32_t oh = position % output_size % output_h;
+            uint8_t *row_ptr = input_matrix.get() + size_t(position) * lda;
+            for (uint32_t ic = 0; ic < kernel_c; ++ic) {
+                const uint8_t *plane = quantized_inputs.get() + (size_t(i) * input_c + g * kernel_c + ic) * padded_plane;
+                for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+                    const uint8_t *src = plane + size_t(ow * stride_w + kw * dilation_w) * padded_h + oh * stride_h;
+                    uint8_t *dst = row_ptr + (ic * kernel_w + kw) * kernel_h;
+                    if (dilation_h == 1) {
+                        memcpy(dst, src, kernel_h);
+                    } else {
+                        for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                            dst[kh] = src[kh * dilation_h];
+                        }
+                    }
+                }
+            }
+            std::fill(row_ptr + kernel_elements, row_ptr + lda, uint8_t(0));
         }
-        outputs.at(i) = std::move(output_data);
 
+        // (rows, kernels_per_group) 的 uint8 结果，每一列是一个输出通道
+        GemmU8S8(input_matrix.get(), lda, rows, int8_weights.packed_weights.at(g), int8_weights.epilogues.at(g),
+                 output_matrix.get(), rows);
+
+        const uint32_t segments = output_halo.empty() ? 1 : output_w;
+        const uint32_t segment_size = output_size / segments;
+        for (uint32_t k = 0; k < kernels_per_group; ++k) {
+            const uint32_t channel = g * kernels_per_group + k;
+            for (uint32_t i = 0; i < batch_size; ++i) {
+                const uint8_t *output_col = output_matrix.get() + size_t(k) * rows + i * output_size;
+                float *output_channel = outputs.at(i) + size_t(channel) * output_plane;
+                for (uint32_t s = 0; s < segments; ++s) {
+                    DequantizeValues(output_col + s * segment_size,
+                                     output_channel + size_t(s + output_halo.w) * output_rows + output_halo.h,
+                                     segment_size, output_scale, output_zero_point, false);
+                }
+            }
+        }
     }
 }
-}
\ No newline at end of file
+
+std::shared_ptr<Layer> ConvLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConv);
+    return std::make_shared<ConvLayer>(op);
+}
+
+std::shared_ptr<Layer> ConvLayer::CreateImplicitInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConv);
+    return std::make_shared<ConvLayer>(op, true);
+}
+
+bool ConvLayer::ImplicitApplicable(const std::shared_ptr<Operator> &op) {
+    std::shared_ptr<ConvOp> conv_op = std::dynamic_pointer_cast<ConvOp>(op);
+    return conv_op != nullptr && !conv_op->int8_enabled();
+}
+
+// 第一次读取时从环境变量初始化
+static std::atomic<size_t> &WorkspaceLimit() {
+    static std::atomic<size_t> kLimit([]() {
+        size_t megabytes = 64;
+        const char *env = std::getenv("KUIPER_CONV_WORKSPACE_MB");
+        if (env != nullptr && *env != '\0') {
+            char *end = nullptr;
+            const unsigned long long value = std::strtoull(env, &end, 10);
+            if (end != env && *end == '\0') {
+                megabytes = size_t(value);
+            } else {
+                LOG(WARNING) << "Invalid KUIPER_CONV_WORKSPACE_MB: " << env;
+            }
+        }
+        return megabytes * 1024 * 1024;
+    }());
+    return kLimit;
+}
+
+void ConvLayer::set_workspace_limit(size_t bytes) {
+    WorkspaceLimit() = bytes;
+}
+
+size_t ConvLayer::workspace_limit() {
+    return WorkspaceLimit();
+}
+
+LayerRegisterWrapper kConvLayer(OpType::kOperatorConv, ConvLayer::CreateInstance, "im2col_gemm");
+LayerRegisterWrapper kImplicitConvLayer(OpType::kOperatorConv, "implicit_gemm", ConvLayer::CreateImplicitInstance,
+                                        ConvLayer::ImplicitApplicable);
+
+}
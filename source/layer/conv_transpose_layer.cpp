@@ -0,0 +1,174 @@
+#include "layer/conv_transpose_layer.hpp"
+#include <algorithm>
+#include <glog/logging.h>
+#include "data/sgemm.hpp"
+#include "data/tensor_util.hpp"
+#include "factory/layer_factory.hpp"
+#include "layer/conv_layer.hpp"
+
+namespace kuiper_infer {
+
+ConvTransposeLayer::ConvTransposeLayer(const std::shared_ptr<Operator> &op) : Layer("ConvTransposeLayer") {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConvTranspose);
+    this->op_ = std::dynamic_pointer_cast<ConvTransposeOp>(op);
+    CHECK(this->op_ != nullptr) << "ConvTranspose op is empty!";
+    CHECK(!this->op_->get_weights().empty()) << "ConvTranspose op has no weights";
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    const auto [output_padding_h, output_padding_w] = this->op_->get_output_padding();
+    CHECK(output_padding_h < std::max(stride_h, dilation_h) && output_padding_w < std::max(stride_w, dilation_w))
+        << "Output padding must be smaller than either stride or dilation";
+}
+
+bool ConvTransposeLayer::NonOverlapping() const {
+    const auto [kernel_h, kernel_w] = this->op_->kernel_size();
+    return this->op_->get_stride() == Shape(kernel_h, kernel_w) && this->op_->get_padding() == Shape(0, 0) &&
+           this->op_->get_dilation() == Shape(1, 1) && this->op_->get_output_padding() == Shape(0, 0);
+}
+
+void ConvTransposeLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs,
+                                 std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    CHECK(this->input_halo_.empty()) << "ConvTranspose does not read input halos";
+    const uint32_t in_channels = this->op_->in_channels();
+    const uint32_t out_channels = this->op_->out_channels();
+    const uint32_t groups = this->op_->get_groups();
+    const uint32_t in_per_group = in_channels / groups;
+    const uint32_t out_per_group = out_channels / groups;
+    const auto [kernel_h, kernel_w] = this->op_->kernel_size();
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    const auto [output_padding_h, output_padding_w] = this->op_->get_output_padding();
+    const uint32_t kernel_elements = kernel_h * kernel_w;
+    const uint32_t columns = out_per_group * kernel_elements;
+    const std::vector<PackedSgemmMatrix> &packed_weights = this->op_->packed_weights();
+    CHECK_EQ(packed_weights.size(), groups);
+
+    std::vector<float> bias(out_channels, 0.f);
+    if (this->op_->get_has_bias()) {
+        const std::vector<sftensor> &bias_tensors = this->op_->get_bias();
+        CHECK_EQ(bias_tensors.size(), out_channels);
+        for (uint32_t oc = 0; oc < out_channels; ++oc) {
+            bias.at(oc) = bias_tensors.at(oc)->index(0);
+        }
+    }
+    // 不重叠时 bias 在矩阵乘的 epilogue 里加上，每个输出通道的 bias 重复 kernel_h * kernel_w 列
+    const bool non_overlapping = this->NonOverlapping();
+    std::vector<float> column_bias;
+    if (non_overlapping) {
+        column_bias.resize(size_t(out_channels) * kernel_elements);
+        for (uint32_t oc = 0; oc < out_channels; ++oc) {
+            std::fill(column_bias.begin() + size_t(oc) * kernel_elements,
+                      column_bias.begin() + size_t(oc + 1) * kernel_elements, bias.at(oc));
+        }
+    }
+
+    const Halo &halo = this->output_halo_;
+    const uint32_t batch_size = inputs.size();
+    std::vector<float> workspace;
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        const std::shared_ptr<Tensor<float>> &input = inputs.at(i);
+        CHECK(input != nullptr && !input->empty());
+        CHECK_EQ(input->channels(), in_channels);
+        const uint32_t input_h = input->rows();
+        const uint32_t input_w = input->cols();
+        const int64_t full_h = int64_t(input_h - 1) * stride_h + int64_t(dilation_h) * (kernel_h - 1) +
+                               output_padding_h + 1;
+        const int64_t full_w = int64_t(input_w - 1) * stride_w + int64_t(dilation_w) * (kernel_w - 1) +
+                               output_padding_w + 1;
+        CHECK(full_h > 2 * int64_t(padding_h) && full_w > 2 * int64_t(padding_w)) << "Padding is larger than the output";
+        const uint32_t output_h = uint32_t(full_h - 2 * padding_h);
+        const uint32_t output_w = uint32_t(full_w - 2 * padding_w);
+        std::shared_ptr<Tensor<float>> output = TensorCreate(out_channels, output_h, output_w, halo);
+        const size_t output_ld = output_h + 2 * halo.h;
+
+        // 结果矩阵按输入列分段，每段 (段内像素数, columns) 不超过卷积的 workspace 上限
+        const size_t column_bytes = size_t(input_h) * columns * sizeof(float);
+        const uint32_t chunk_w = uint32_t(std::clamp<size_t>(ConvLayer::workspace_limit() / column_bytes, 1, input_w));
+        workspace.resize(size_t(chunk_w) * input_h * columns);
+        for (uint32_t g = 0; g < groups; ++g) {
+            const float *group_input = input->raw_ptr() + size_t(g) * in_per_group * input_h * input_w;
+            for (uint32_t w_begin = 0; w_begin < input_w; w_begin += chunk_w) {
+                const uint32_t w_count = std::min(chunk_w, input_w - w_begin);
+                const uint32_t m = w_count * input_h;
+                SgemmEpilogue epilogue;
+                if (non_overlapping) {
+                    epilogue.bias = column_bias.data() + size_t(g) * columns;
+                }
+                Sgemm(m, group_input + size_t(w_begin) * input_h, size_t(input_h) * input_w, packed_weights.at(g),
+                      workspace.data(), m, epilogue);
+
+#pragma omp parallel for schedule(static) if (size_t(m) * columns >= (1 << 15))
+                for (uint32_t k = 0; k < out_per_group; ++k) {
+                    const uint32_t oc = g * out_per_group + k;
+                    float *output_ptr = output->slice(oc).colptr(halo.w) + halo.h;
+                    if (!non_overlapping && w_begin == 0) {
+                        for (uint32_t ow = 0; ow < output_w; ++ow) {
+                            std::fill(output_ptr + ow * output_ld, output_ptr + ow * output_ld + output_h, bias.at(oc));
+                        }
+                    }
+                    for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+                        for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                            const float *column = workspace.data() + (size_t(k) * kernel_elements + kw * kernel_h + kh) * m;
+                            if (non_overlapping) {
+                                // 输出的第 h * kernel_h + kh 行只来自输入第 h 行
+                                for (uint32_t w = 0; w < w_count; ++w) {
+                                    float *dst = output_ptr + size_t((w_begin + w) * kernel_w + kw) * output_ld + kh;
+                                    const float *src = column + size_t(w) * input_h;
+                                    for (uint32_t h = 0; h < input_h; ++h) {
+                                        dst[size_t(h) * kernel_h] = src[h];
+                                    }
+                                }
+                                continue;
+                            }
+                            // 输入 (h, w) 落在输出 (h * stride_h - padding_h + kh * dilation_h, ...)，只累加落在输出内的行
+                            // 输入很小时 kh 对应的第一行可能已经超出输出，除法要在分子非负时才是向下取整
+                            const int64_t row_offset = int64_t(kh) * dilation_h - padding_h;
+                            if (row_offset > int64_t(output_h) - 1) {
+                                continue;
+                            }
+                            const int64_t h_first = row_offset >= 0 ? 0 : (-row_offset + stride_h - 1) / stride_h;
+                            const int64_t h_last = std::min<int64_t>(
+                                input_h, (int64_t(output_h) - 1 - row_offset) / stride_h + 1);
+                            if (h_first >= h_last) {
+                                continue;
+                            }
+                            for (uint32_t w = 0; w < w_count; ++w) {
+                                const int64_t ow = int64_t(w_begin + w) * stride_w - padding_w + int64_t(kw) * dilation_w;
+                                if (ow < 0 || ow >= output_w) {
+                                    continue;
+                                }
+                                float *dst = output_ptr + size_t(ow) * output_ld;
+                                const float *src = column + size_t(w) * input_h;
+                                for (int64_t h = h_first; h < h_last; ++h) {
+                                    dst[h * stride_h + row_offset] += src[h];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
+        }
+    }
+}
+
+bool ConvTransposeLayer::SupportsOutputHalo() const {
+    return true;
+}
+
+std::shared_ptr<Layer> ConvTransposeLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConvTranspose);
+    return std::make_shared<ConvTransposeLayer>(op);
+}
+
+LayerRegisterWrapper kConvTransposeLayer(OpType::kOperatorConvTranspose, ConvTransposeLayer::CreateInstance);
+
+}
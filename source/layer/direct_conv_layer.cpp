@@ -0,0 +1,125 @@
+#include "layer/direct_conv_layer.hpp"
+#include <algorithm>
+#include <glog/logging.h>
+#include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
+#include "factory/layer_factory.hpp"
+
+namespace kuiper_infer {
+
+DirectConvLayer::DirectConvLayer(const std::shared_ptr<Operator> &op) : Layer("DirectConvLayer") {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConv);
+    this->op_ = std::dynamic_pointer_cast<ConvOp>(op);
+    CHECK(this->op_ != nullptr) << "Conv op is empty!";
+    CHECK(!this->op_->int8_enabled()) << "Direct convolution only supports fp32";
+}
+
+void DirectConvLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs,
+                              std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    const uint32_t kernel_count = this->op_->kernel_count();
+    CHECK(kernel_count > 0);
+    const std::vector<uint32_t> &kernel_shape = this->op_->kernel_shape();
+    const uint32_t kernel_c = kernel_shape.at(0);
+    const uint32_t kernel_h = kernel_shape.at(1);
+    const uint32_t kernel_w = kernel_shape.at(2);
+    const uint32_t groups = this->op_->get_groups();
+    const uint32_t kernels_per_group = kernel_count / groups;
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    const auto [dilation_h, dilation_w] = this->op_->get_dilation();
+    const uint32_t extent_h = dilation_h * (kernel_h - 1) + 1;
+    const uint32_t extent_w = dilation_w * (kernel_w - 1) + 1;
+    const bool has_bias = this->op_->get_has_bias();
+    const std::vector<std::shared_ptr<Tensor<float>>> &bias = this->op_->get_bias();
+    if (!this->input_halo_.empty()) {
+        CHECK(this->input_halo_ == this->InputPadding()) << "Input halo does not match the padding";
+    }
+
+    const uint32_t kernel_elements = kernel_c * kernel_h * kernel_w;
+    const bool compressed = this->op_->weights_compressed();
+    const std::vector<std::shared_ptr<Tensor<float>>> &weights = this->op_->get_weights();
+
+    const Halo &halo = this->output_halo_;
+    const uint32_t batch_size = inputs.size();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        // 生产者已经预留边框时直接读取，否则 padding 一份输入
+        std::shared_ptr<Tensor<float>> input = inputs.at(i);
+        CHECK(input != nullptr && !input->empty());
+        if (this->input_halo_.empty() && (padding_h != 0 || padding_w != 0)) {
+            input = TensorPadding(input, {padding_h, padding_h, padding_w, padding_w}, 0.f);
+        }
+        CHECK_EQ(input->channels(), kernel_c * groups);
+        const uint32_t input_h = input->rows();
+        const uint32_t input_w = input->cols();
+        CHECK(input_h >= extent_h && input_w >= extent_w) << "Input is smaller than the kernel";
+        const uint32_t output_h = (input_h - extent_h) / stride_h + 1;
+        const uint32_t output_w = (input_w - extent_w) / stride_w + 1;
+        std::shared_ptr<Tensor<float>> output = TensorCreate(kernel_count, output_h, output_w, halo);
+
+        // fp32 卷积核直接读取，压缩存储时每个线程一次只把一个卷积核转换到自己的缓冲区里
+#pragma omp parallel if (size_t(kernel_count) * kernel_elements * output_h * output_w >= (1 << 16))
+        {
+            std::vector<float> kernel_buffer(compressed ? kernel_elements : 0);
+#pragma omp for schedule(static)
+            for (uint32_t k = 0; k < kernel_count; ++k) {
+                const uint32_t group = k / kernels_per_group;
+                arma::fmat &output_channel = output->slice(k);
+                const size_t output_ld = output_channel.n_rows;
+                float *output_ptr = output_channel.colptr(halo.w) + halo.h;
+                const float bias_value = has_bias ? bias.at(k)->index(0) : 0.f;
+                for (uint32_t ow = 0; ow < output_w; ++ow) {
+                    std::fill(output_ptr + ow * output_ld, output_ptr + ow * output_ld + output_h, bias_value);
+                }
+                const float *kernel = kernel_buffer.data();
+                if (compressed) {
+                    this->op_->CopyKernel(k, kernel_buffer.data());
+                } else {
+                    kernel = weights.at(k)->raw_ptr();
+                }
+                for (uint32_t ic = 0; ic < kernel_c; ++ic) {
+                    const arma::fmat &input_channel = input->slice(group * kernel_c + ic);
+                    ConvPlaneAccumulate(input_channel.memptr(), input_channel.n_rows,
+                                        kernel + ic * kernel_h * kernel_w, kernel_h, kernel_w, stride_h, stride_w,
+                                        dilation_h, dilation_w, output_ptr, output_ld, output_h, output_w);
+                }
+            }
+        }
+
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
+        }
+    }
+}
+
+Halo DirectConvLayer::InputPadding() const {
+    CHECK(this->op_ != nullptr);
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    Halo halo;
+    halo.h = padding_h;
+    halo.w = padding_w;
+    return halo;
+}
+
+bool DirectConvLayer::SupportsOutputHalo() const {
+    return true;
+}
+
+bool DirectConvLayer::Applicable(const std::shared_ptr<Operator> &op) {
+    const ConvOp *conv_op = dynamic_cast<const ConvOp *>(op.get());
+    return conv_op != nullptr && !conv_op->int8_enabled() && conv_op->kernel_count() > 0 &&
+           conv_op->kernel_shape().at(0) <= kMaxGroupChannels;
+}
+
+std::shared_ptr<Layer> DirectConvLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorConv);
+    return std::make_shared<DirectConvLayer>(op);
+}
+
+LayerRegisterWrapper kDirectConvLayer(OpType::kOperatorConv, "direct", DirectConvLayer::CreateInstance,
+                                      DirectConvLayer::Applicable);
+
+}
@@ -1,8 +1,11 @@
 #include <glog/logging.h>
 #include "layer/expression_layer.hpp"
+#include <algorithm>
 #include <stack>
 #include "data/tensor.hpp"
 #include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
+#include "factory/layer_factory.hpp"
 
 namespace kuiper_infer {
     
@@ -29,11 +32,7 @@ void ExpressionLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>>
     const uint32_t batch_size = outputs.size();
     CHECK(batch_size != 0);
 
-    for (uint32_t i = 0; i < batch_size; ++i) {
-        // 初始化输出
-        CHECK(outputs.at(i) != nullptr && !outputs.at(i)->empty());
-        outputs.at(i)->Fill(0.f);
-    }
+    // 输出会被表达式的计算结果替换，这里不需要预先分配
 
     CHECK(this->op_ != nullptr && this->op_->op_type_ == OpType::kOperatorExpression);
     // 栈存储的是一个一个batch的输入
@@ -92,4 +91,107 @@ void ExpressionLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>>
 }
 
 
+void ExpressionLayer::ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) {
+    CHECK(!inputs.empty());
+    CHECK(this->op_ != nullptr && this->op_->op_type_ == OpType::kOperatorExpression);
+
+    const std::vector<uint32_t> &shape = inputs.front().shape();
+    for (const BatchTensor &input : inputs) {
+        if (input.shape() != shape) {
+            Layer::ForwardBatch(inputs, output);
+            return;
+        }
+    }
+
+    // 每个操作数是整个 batch 对应的 (N * C, H, W) 张量
+    std::stack<std::shared_ptr<Tensor<float>>> oprand_stack;
+    const std::vector<std::shared_ptr<TokenNode>>& nodes = this->op_->Generate();
+    for (const auto& node : nodes) {
+        if (node->num_index >= 0) {
+            CHECK(node->num_index < int(inputs.size()));
+            oprand_stack.push(inputs.at(node->num_index).data());
+        } else {
+            CHECK(oprand_stack.size() >= 2) << "oprand_stack.size() < 2";
+            std::shared_ptr<Tensor<float>> input_node1 = oprand_stack.top();
+            oprand_stack.pop();
+            std::shared_ptr<Tensor<float>> input_node2 = oprand_stack.top();
+            oprand_stack.pop();
+
+            if (node->num_index == -int(TokenType::TokenAdd)) {
+                oprand_stack.push(TensorElementAdd(input_node1, input_node2));
+            } else if (node->num_index == -int(TokenType::TokenMul)) {
+                oprand_stack.push(TensorElementMultiply(input_node1, input_node2));
+            } else {
+                LOG(FATAL) << "Unknwon operator";
+            }
+        }
+    }
+    CHECK(oprand_stack.size() == 1);
+
+    output = BatchTensor(shape.at(0), oprand_stack.top());
+}
+
+void ExpressionLayer::ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                                  std::vector<std::shared_ptr<HalfTensor>> &outputs) {
+    CHECK(!inputs.empty());
+    CHECK(this->op_ != nullptr && this->op_->op_type_ == OpType::kOperatorExpression);
+    const uint32_t batch_size = outputs.size();
+    CHECK(batch_size != 0);
+
+    // 需要广播时使用默认实现
+    const std::vector<uint32_t> &shape = inputs.front()->shape();
+    for (const auto &input : inputs) {
+        CHECK(input != nullptr && !input->empty());
+        if (input->shape() != shape) {
+            Layer::ForwardHalf(inputs, outputs);
+            return;
+        }
+    }
+
+    // 按块对整个表达式求值，栈里每个操作数是一块 fp32 缓冲
+    constexpr uint32_t kChunk = 1024;
+    const std::vector<std::shared_ptr<TokenNode>> &nodes = this->op_->Generate();
+    std::vector<float> buffers(nodes.size() * kChunk);
+    const uint32_t size = inputs.front()->size();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        std::shared_ptr<HalfTensor> output = std::make_shared<HalfTensor>(
+            shape.at(0), shape.at(1), shape.at(2), inputs.front()->type());
+        for (uint32_t offset = 0; offset < size; offset += kChunk) {
+            const uint32_t count = std::min(kChunk, size - offset);
+            uint32_t depth = 0;
+            for (const auto &node : nodes) {
+                if (node->num_index >= 0) {
+                    const uint32_t input_index = node->num_index * batch_size + i;
+                    CHECK(input_index < inputs.size());
+                    inputs.at(input_index)->Load(offset, count, buffers.data() + depth * kChunk);
+                    depth += 1;
+                    continue;
+                }
+
+                CHECK(depth >= 2) << "oprand_stack.size() < 2";
+                const float *input1 = buffers.data() + (depth - 1) * kChunk;
+                float *input2 = buffers.data() + (depth - 2) * kChunk;
+                if (node->num_index == -int(TokenType::TokenAdd)) {
+                    AddValues(input2, input1, input2, count);
+                } else if (node->num_index == -int(TokenType::TokenMul)) {
+                    MulValues(input2, input1, input2, count);
+                } else {
+                    LOG(FATAL) << "Unknwon operator";
+                }
+                depth -= 1;
+            }
+            CHECK(depth == 1);
+            output->Store(offset, count, buffers.data());
+        }
+        outputs.at(i) = output;
+    }
+}
+
+std::shared_ptr<Layer> ExpressionLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorExpression);
+    return std::make_shared<ExpressionLayer>(op);
+}
+
+LayerRegisterWrapper kExpressionLayer(OpType::kOperatorExpression, ExpressionLayer::CreateInstance);
+
 }
\ No newline at end of file
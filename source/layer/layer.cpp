@@ -11,4 +11,88 @@ void Layer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs, s
     LOG(FATAL) << "The layer" << this->layer_name_ << "is not implemented yet!";
 }
 
+void Layer::ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    std::vector<std::shared_ptr<Tensor<float>>> tensors;
+    for (const TensorView &input : inputs) {
+        CHECK(!input.empty());
+        for (uint32_t i = 0; i < input.batch(); ++i) {
+            tensors.push_back(input.Batch(i).AsTensor());
+        }
+    }
+    this->Forward(tensors, outputs);
+}
+
+void Layer::ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                        std::vector<std::shared_ptr<HalfTensor>> &outputs) {
+    CHECK(!inputs.empty());
+    CHECK(this->input_halo_.empty() && this->output_halo_.empty()) << "ForwardHalf does not support halo tensors";
+    const HalfType type = inputs.front()->type();
+
+    std::vector<std::shared_ptr<Tensor<float>>> tensors;
+    for (const auto &input : inputs) {
+        CHECK(input != nullptr && !input->empty());
+        tensors.push_back(input->ToFloat());
+    }
+    // 输出的约定和调用者一致: 已经按 batch 分配好位置或者追加
+    std::vector<std::shared_ptr<Tensor<float>>> float_outputs(outputs.size());
+    this->Forward(tensors, float_outputs);
+
+    std::vector<std::shared_ptr<HalfTensor>> results;
+    for (const auto &output : float_outputs) {
+        CHECK(output != nullptr);
+        results.push_back(HalfTensor::FromFloat(*output, type));
+    }
+    if (outputs.size() == results.size()) {
+        outputs = results;
+    } else {
+        outputs.insert(outputs.end(), results.begin(), results.end());
+    }
+}
+
+bool Layer::AcceptsStridedViews() const {
+    return false;
+}
+
+Halo Layer::InputPadding() const {
+    return Halo();
+}
+
+bool Layer::SupportsOutputHalo() const {
+    return false;
+}
+
+void Layer::set_input_halo(const Halo &halo) {
+    this->input_halo_ = halo;
+}
+
+const Halo &Layer::input_halo() const {
+    return this->input_halo_;
+}
+
+void Layer::set_output_halo(const Halo &halo) {
+    this->output_halo_ = halo;
+}
+
+const Halo &Layer::output_halo() const {
+    return this->output_halo_;
+}
+
+void Layer::ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) {
+    CHECK(!inputs.empty());
+    CHECK(this->input_halo_.empty() && this->output_halo_.empty()) << "ForwardBatch does not support halo tensors";
+    const uint32_t batch_size = inputs.front().batch();
+
+    // 多个输入依次排列，和 ExpressionLayer 的 num_index * batch_size 约定一致
+    std::vector<std::shared_ptr<Tensor<float>>> tensors;
+    for (const BatchTensor &input : inputs) {
+        CHECK_EQ(input.batch(), batch_size);
+        const std::vector<std::shared_ptr<Tensor<float>>> &elements = input.ToVector();
+        tensors.insert(tensors.end(), elements.begin(), elements.end());
+    }
+
+    std::vector<std::shared_ptr<Tensor<float>>> outputs(batch_size);
+    this->Forward(tensors, outputs);
+    output = BatchTensor::FromVector(outputs);
+}
+
 }
\ No newline at end of file
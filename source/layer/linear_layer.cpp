@@ -0,0 +1,185 @@
+#include "layer/linear_layer.hpp"
+#include <algorithm>
+#include <glog/logging.h>
+#include "data/tensor_util.hpp"
+#include "factory/layer_factory.hpp"
+
+namespace kuiper_infer {
+
+LinearLayer::LinearLayer(const std::shared_ptr<Operator> &op) : Layer("Linear") {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorLinear);
+    this->op_ = std::dynamic_pointer_cast<LinearOp>(op);
+    CHECK(this->op_ != nullptr) << "Linear op is empty!";
+    CHECK(!this->op_->packed_weights().empty()) << "Linear op has no weights";
+}
+
+SgemmEpilogue LinearLayer::Epilogue() const {
+    SgemmEpilogue epilogue;
+    if (this->op_->has_bias()) {
+        epilogue.bias = this->op_->bias().data();
+    }
+    epilogue.activation = this->op_->activation();
+    return epilogue;
+}
+
+void LinearLayer::ForwardColumnMajor(const std::vector<const float *> &samples, uint32_t channels, uint32_t rows,
+                                     uint32_t cols, std::vector<std::shared_ptr<Tensor<float>>> &outputs) const {
+    // 只有一行或一列时列主序和行主序的内存顺序相同
+    if (rows == 1 || cols == 1) {
+        this->ForwardFlattened(samples, this->op_->packed_weights(), outputs);
+        return;
+    }
+    if (this->op_->input_shape() == std::vector<uint32_t>{channels, rows, cols}) {
+        this->ForwardFlattened(samples, this->op_->column_major_weights(), outputs);
+        return;
+    }
+
+    // 算子没有按这个形状打包权重，输入比权重小得多，转置输入而不是重新排列权重
+    const uint32_t in_features = this->op_->in_features();
+    std::vector<float> row_major(samples.size() * in_features);
+    std::vector<const float *> row_major_samples;
+    for (uint32_t i = 0; i < samples.size(); ++i) {
+        float *dst = row_major.data() + size_t(i) * in_features;
+        // 列主序的 (rows, cols) 就是行主序的 (cols, rows)
+        TransposePlanes(samples.at(i), dst, channels, cols, rows);
+        row_major_samples.push_back(dst);
+    }
+    this->ForwardFlattened(row_major_samples, this->op_->packed_weights(), outputs);
+}
+
+void LinearLayer::ForwardFlattened(const std::vector<const float *> &samples, const PackedSgemmMatrix &weights,
+                                   std::vector<std::shared_ptr<Tensor<float>>> &outputs) const {
+    const uint32_t batch_size = samples.size();
+    const uint32_t out_features = this->op_->out_features();
+    // A 的第 r 行是第 r 个 batch 元素，打包时从各自的内存读取，不需要先拼成一个矩阵
+    auto pack_a = [&samples](uint32_t first_row, uint32_t rows, uint32_t first_col, uint32_t cols, uint32_t mr,
+                             float *packed) {
+        const uint32_t padded_rows = (rows + mr - 1) / mr * mr;
+        for (uint32_t r = 0; r < padded_rows; ++r) {
+            float *dst = packed + size_t(r / mr) * mr * cols + r % mr;
+            if (r >= rows) {
+                for (uint32_t p = 0; p < cols; ++p) {
+                    dst[size_t(p) * mr] = 0.f;
+                }
+                continue;
+            }
+            const float *src = samples.at(first_row + r) + first_col;
+            for (uint32_t p = 0; p < cols; ++p) {
+                dst[size_t(p) * mr] = src[p];
+            }
+        }
+    };
+
+    std::vector<std::shared_ptr<Tensor<float>>> results(batch_size);
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        results.at(i) = TensorCreate(1, 1, out_features);
+    }
+    if (batch_size == 1) {
+        // 结果 (1, out_features) 的列步长是 1，直接写到输出
+        SgemmImplicit(1, pack_a, weights, results.front()->data().memptr(), 1, this->Epilogue());
+    } else {
+        // 结果是列主序的 (batch, out_features)，再按 batch 元素分开
+        std::vector<float> result(size_t(batch_size) * out_features);
+        SgemmImplicit(batch_size, pack_a, weights, result.data(), batch_size, this->Epilogue());
+        for (uint32_t i = 0; i < batch_size; ++i) {
+            float *output = results.at(i)->data().memptr();
+            for (uint32_t j = 0; j < out_features; ++j) {
+                output[j] = result[size_t(j) * batch_size + i];
+            }
+        }
+    }
+
+    if (outputs.size() == batch_size) {
+        outputs = results;
+    } else {
+        outputs.insert(outputs.end(), results.begin(), results.end());
+    }
+}
+
+void LinearLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &inputs,
+                          std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    CHECK(this->input_halo_.empty() && this->output_halo_.empty()) << "Linear does not support halo tensors";
+    const uint32_t in_features = this->op_->in_features();
+    const std::shared_ptr<Tensor<float>> &first = inputs.front();
+    CHECK(first != nullptr && !first->empty());
+    const uint32_t channels = first->channels();
+    const uint32_t rows = first->rows();
+    const uint32_t cols = first->cols();
+    for (const auto &input : inputs) {
+        CHECK(input != nullptr && input->channels() == channels && input->rows() == rows && input->cols() == cols)
+            << "Linear inputs have different shapes";
+    }
+
+    if (first->size() == in_features) {
+        std::vector<const float *> samples;
+        for (const auto &input : inputs) {
+            samples.push_back(input->raw_ptr());
+        }
+        this->ForwardColumnMajor(samples, channels, rows, cols, outputs);
+        return;
+    }
+
+    // 作用在最后一维: 每个通道是列主序的 (rows, in_features)，正好是矩阵乘的 A，结果直接写到输出的通道
+    CHECK_EQ(cols, in_features) << "Linear input does not match in_features";
+    const uint32_t out_features = this->op_->out_features();
+    const uint32_t batch_size = inputs.size();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        const std::shared_ptr<Tensor<float>> &input = inputs.at(i);
+        std::shared_ptr<Tensor<float>> output = TensorCreate(channels, rows, out_features);
+        for (uint32_t c = 0; c < channels; ++c) {
+            Sgemm(rows, input->slice(c).memptr(), rows, this->op_->packed_weights(), output->slice(c).memptr(), rows,
+                  this->Epilogue());
+        }
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
+        }
+    }
+}
+
+void LinearLayer::ForwardViews(const std::vector<TensorView> &inputs,
+                               std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    // 所有 batch 元素都是同一种连续排布时直接读取视图的内存
+    std::vector<const float *> samples;
+    bool row_major = true;
+    bool column_major = true;
+    for (const TensorView &input : inputs) {
+        CHECK(input.channels() == inputs.front().channels() && input.rows() == inputs.front().rows() &&
+              input.cols() == inputs.front().cols())
+            << "Linear inputs have different shapes";
+        row_major = row_major && input.is_row_major();
+        column_major = column_major && input.is_contiguous();
+        for (uint32_t i = 0; i < input.batch(); ++i) {
+            samples.push_back(input.Batch(i).raw_ptr());
+        }
+    }
+    const TensorView &first = inputs.front();
+    if (first.size() / first.batch() != this->op_->in_features() || !this->output_halo_.empty() ||
+        (!row_major && !column_major)) {
+        Layer::ForwardViews(inputs, outputs);
+        return;
+    }
+    if (row_major) {
+        this->ForwardFlattened(samples, this->op_->packed_weights(), outputs);
+    } else {
+        this->ForwardColumnMajor(samples, first.channels(), first.rows(), first.cols(), outputs);
+    }
+}
+
+bool LinearLayer::AcceptsStridedViews() const {
+    return true;
+}
+
+std::shared_ptr<Layer> LinearLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
+    CHECK(op != nullptr && op->op_type_ == OpType::kOperatorLinear);
+    return std::make_shared<LinearLayer>(op);
+}
+
+LayerRegisterWrapper kLinearLayer(OpType::kOperatorLinear, LinearLayer::CreateInstance);
+
+}
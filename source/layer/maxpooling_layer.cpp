@@ -1,7 +1,10 @@
 #include <glog/logging.h>
+#include <algorithm>
+#include <limits>
 #include "ops/maxpooling_op.hpp"
 #include "layer/maxpooling_layer.hpp"
 #include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
 #include "factory/layer_factory.hpp"
 
 namespace kuiper_infer {
@@ -38,12 +41,14 @@ void MaxPoolingLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>>
 
     for (uint32_t i = 0; i < batch_size; ++i) {
         
-        const std::shared_ptr<Tensor<float>> &input_data = TensorClone(inputs.at(i));
-
-        //(padding_left,padding_right,padding_top,padding_bottom)
-        // padding_h - padding_top,padding_bottom
-        // padding_w - padding_left,padding_right
-        input_data->Padding({padding_w, padding_w, padding_h, padding_h} ,std::numeric_limits<float>::lowest());
+        // 输入只读，需要 padding 时才创建新的张量，生产者已经预留边框时直接读取
+        // TensorPadding - (padding_top,padding_bottom,padding_left,padding_right)
+        std::shared_ptr<Tensor<float>> input_data = inputs.at(i);
+        if (!this->input_halo_.empty()) {
+            CHECK(this->input_halo_ == this->InputPadding()) << "Input halo does not match the padding";
+        } else if (padding_h != 0 || padding_w != 0) {
+            input_data = TensorPadding(inputs.at(i), {padding_h, padding_h, padding_w, padding_w}, std::numeric_limits<float>::lowest());
+        }
 
         const uint32_t input_h = input_data->rows();
         const uint32_t input_w = input_data->cols();
@@ -54,23 +59,96 @@ void MaxPoolingLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>>
         const uint32_t output_h = (input_h - kernel_h) / stride_h + 1;
         const uint32_t output_w = (input_w - kernel_w) / stride_w + 1;
 
-        std::shared_ptr<Tensor<float>> output = std::make_shared<Tensor<float>>(output_c, output_h, output_w);
+        // 输出需要预留边框时写到内部
+        const Halo &halo = this->output_halo_;
+        std::shared_ptr<Tensor<float>> output = TensorCreate(output_c, output_h, output_w, halo);
 
 
         for (uint32_t c = 0; c < input_c; ++c) {
-            const arma::fmat& input_channel = input_data->slice(c); 
+            const arma::fmat& input_channel = input_data->slice(c);
             arma::fmat& output_channel = output->slice(c);
+            MaxPoolPlane(input_channel.memptr(), input_channel.n_rows, output_channel.colptr(halo.w) + halo.h,
+                         output_channel.n_rows, output_h, output_w, kernel_h, kernel_w, stride_h, stride_w);
+        }
+        // 计算图里输出已经按batch分配好位置，单独调用时追加
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
+        }
+    }
+
+}
+
+void MaxPoolingLayer::ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                                  std::vector<std::shared_ptr<HalfTensor>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+    const auto [kernel_h, kernel_w] = this->op_->get_kernel_size();
+    const auto [stride_h, stride_w] = this->op_->get_stride();
+    const auto [padding_h, padding_w] = this->op_->get_padding();
 
-            for (uint32_t h = 0; h + kernel_h <= input_h; h += stride_h) {
-                for (uint32_t w = 0; w + kernel_w <= input_w; w += stride_w) {
-                    const arma::fmat& sub = input_channel.submat(h, w, h + kernel_h - 1, w + kernel_w - 1);
-                    output_channel.at(int(h / stride_h), int(w / stride_w)) = sub.max();
+    // 一次转换一个通道，padding 的位置直接跳过，不需要先 padding 一份输入
+    std::vector<float> input_plane;
+    std::vector<float> output_plane;
+    const uint32_t batch_size = inputs.size();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        const std::shared_ptr<HalfTensor> &input = inputs.at(i);
+        CHECK(input != nullptr && !input->empty());
+        const uint32_t input_h = input->rows();
+        const uint32_t input_w = input->cols();
+        CHECK(input_h + 2 * padding_h >= kernel_h && input_w + 2 * padding_w >= kernel_w);
+        const uint32_t output_h = (input_h + 2 * padding_h - kernel_h) / stride_h + 1;
+        const uint32_t output_w = (input_w + 2 * padding_w - kernel_w) / stride_w + 1;
+        std::shared_ptr<HalfTensor> output =
+            std::make_shared<HalfTensor>(input->channels(), output_h, output_w, input->type());
+
+        input_plane.resize(input_h * input_w);
+        output_plane.resize(output_h * output_w);
+        for (uint32_t c = 0; c < input->channels(); ++c) {
+            input->Load(size_t(c) * input_plane.size(), input_plane.size(), input_plane.data());
+            for (uint32_t ow = 0; ow < output_w; ++ow) {
+                for (uint32_t oh = 0; oh < output_h; ++oh) {
+                    float max_value = std::numeric_limits<float>::lowest();
+                    for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+                        const int col = int(ow * stride_w + kw) - int(padding_w);
+                        if (col < 0 || col >= int(input_w)) {
+                            continue;
+                        }
+                        const float *col_ptr = input_plane.data() + col * input_h;
+                        for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+                            const int row = int(oh * stride_h + kh) - int(padding_h);
+                            if (row >= 0 && row < int(input_h)) {
+                                max_value = std::max(max_value, col_ptr[row]);
+                            }
+                        }
+                    }
+                    output_plane[ow * output_h + oh] = max_value;
                 }
             }
+            output->Store(size_t(c) * output_plane.size(), output_plane.size(), output_plane.data());
+        }
+
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
         }
-        outputs.push_back(output);
     }
+}
+
+Halo MaxPoolingLayer::InputPadding() const {
+    CHECK(this->op_ != nullptr);
+    const auto [padding_h, padding_w] = this->op_->get_padding();
+    Halo halo;
+    halo.h = padding_h;
+    halo.w = padding_w;
+    halo.value = std::numeric_limits<float>::lowest();
+    return halo;
+}
 
+bool MaxPoolingLayer::SupportsOutputHalo() const {
+    return true;
 }
 
 std::shared_ptr<Layer> MaxPoolingLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
@@ -1,7 +1,9 @@
 #include <glog/logging.h>
+#include <algorithm>
 #include "ops/sigmoid_op.hpp"
 #include "layer/sigmoid_layer.hpp"
 #include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
 #include "factory/layer_factory.hpp"
 
 
@@ -27,16 +29,113 @@ void SigmoidLayer::Forward(const std::vector<std::shared_ptr<Tensor<float>>> &in
 
     for (uint32_t i = 0; i < batch_size; ++i) {
         const std::shared_ptr<Tensor<float>> &input_data = inputs.at(i);
-        std::shared_ptr<Tensor<float>> output_data = TensorClone(input_data);
+        std::shared_ptr<Tensor<float>> output_data;
+        if (this->output_halo_.empty()) {
+            output_data = TensorClone(input_data);
+            float *output_ptr = output_data->data().memptr();
+            SigmoidValues(output_ptr, output_ptr, output_data->data().n_elem);
+        } else {
+            // 输出预留边框，结果直接写到内部
+            const Halo &halo = this->output_halo_;
+            output_data = TensorCreate(input_data->channels(), input_data->rows(), input_data->cols(), halo);
+            for (uint32_t c = 0; c < input_data->channels(); ++c) {
+                for (uint32_t col = 0; col < input_data->cols(); ++col) {
+                    const float *input_ptr = input_data->slice(c).colptr(col);
+                    float *output_ptr = output_data->slice(c).colptr(col + halo.w) + halo.h;
+                    SigmoidValues(input_ptr, output_ptr, input_data->rows());
+                }
+            }
+        }
+
+        // 计算图里输出已经按batch分配好位置，单独调用时追加
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output_data;
+        } else {
+            outputs.push_back(output_data);
+        }
+    }
+}
+
+void SigmoidLayer::ForwardBatch(const std::vector<BatchTensor> &inputs, BatchTensor &output) {
+    CHECK(this->op_ != nullptr);
+    CHECK(this->op_->op_type_ == OpType::kOperatorSigmoid);
+    CHECK_EQ(inputs.size(), 1);
+
+    const BatchTensor &input = inputs.front();
+    if (output.empty() || output.shape() != input.shape()) {
+        output = BatchTensor(input.shape());
+    }
 
-        output_data->data().transform([&](float x) {
-            return 1.0f / (1.0f + std::exp(-x));
-        });
+    const float *input_ptr = input.raw_ptr();
+    float *output_ptr = output.raw_ptr();
+    SigmoidValues(input_ptr, output_ptr, input.size());
+}
+
+void SigmoidLayer::ForwardViews(const std::vector<TensorView> &inputs, std::vector<std::shared_ptr<Tensor<float>>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    if (!this->output_halo_.empty()) {
+        // 输出需要预留边框时走 Forward
+        Layer::ForwardViews(inputs, outputs);
+        return;
+    }
+
+    std::vector<std::shared_ptr<Tensor<float>>> results;
+    for (const TensorView &input : inputs) {
+        for (uint32_t i = 0; i < input.batch(); ++i) {
+            // 复制到列主序的输出后原地计算，不需要中间张量
+            const TensorView &element = input.Batch(i);
+            std::shared_ptr<Tensor<float>> output_data = TensorCreate(element.channels(), element.rows(), element.cols());
+            element.CopyTo(output_data->data().memptr(), false);
+            float *output_ptr = output_data->data().memptr();
+            SigmoidValues(output_ptr, output_ptr, output_data->size());
+            results.push_back(output_data);
+        }
+    }
 
-        outputs.push_back(output_data);
+    if (outputs.size() == results.size()) {
+        outputs = results;
+    } else {
+        outputs.insert(outputs.end(), results.begin(), results.end());
     }
 }
 
+void SigmoidLayer::ForwardHalf(const std::vector<std::shared_ptr<HalfTensor>> &inputs,
+                            std::vector<std::shared_ptr<HalfTensor>> &outputs) {
+    CHECK(this->op_ != nullptr);
+    CHECK(!inputs.empty());
+
+    // 按块转换为 fp32 计算后写回，中间结果只占一块栈上的缓冲
+    constexpr uint32_t kChunk = 1024;
+    float buffer[kChunk];
+    const uint32_t batch_size = inputs.size();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+        const std::shared_ptr<HalfTensor> &input = inputs.at(i);
+        CHECK(input != nullptr && !input->empty());
+        std::shared_ptr<HalfTensor> output =
+            std::make_shared<HalfTensor>(input->channels(), input->rows(), input->cols(), input->type());
+        for (uint32_t offset = 0; offset < input->size(); offset += kChunk) {
+            const uint32_t count = std::min(kChunk, input->size() - offset);
+            input->Load(offset, count, buffer);
+            SigmoidValues(buffer, buffer, count);
+            output->Store(offset, count, buffer);
+        }
+
+        if (outputs.size() == batch_size) {
+            outputs.at(i) = output;
+        } else {
+            outputs.push_back(output);
+        }
+    }
+}
+
+bool SigmoidLayer::AcceptsStridedViews() const {
+    return true;
+}
+
+bool SigmoidLayer::SupportsOutputHalo() const {
+    return true;
+}
+
 std::shared_ptr<Layer> SigmoidLayer::CreateInstance(const std::shared_ptr<Operator> &op) {
     CHECK(op != nullptr);
     CHECK(op->op_type_ == OpType::kOperatorSigmoid);
@@ -0,0 +1,72 @@
+#include "ops/batchnorm_op.hpp"
+#include <cmath>
+#include <glog/logging.h>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
+
+namespace kuiper_infer {
+
+BatchNormOp::BatchNormOp(const std::vector<float> &mean, const std::vector<float> &var,
+                         const std::vector<float> &weight, const std::vector<float> &bias, float eps)
+    : Operator(OpType::kOperatorBatchNorm) {
+    const uint32_t channels = mean.size();
+    CHECK(channels > 0) << "BatchNorm has no channels";
+    CHECK_EQ(var.size(), channels);
+    CHECK(weight.empty() || weight.size() == channels);
+    CHECK(bias.empty() || bias.size() == channels);
+    CHECK(eps >= 0.f);
+
+    this->scale_.resize(channels);
+    this->shift_.resize(channels);
+    for (uint32_t c = 0; c < channels; ++c) {
+        const float gamma = weight.empty() ? 1.f : weight.at(c);
+        const float beta = bias.empty() ? 0.f : bias.at(c);
+        this->scale_.at(c) = gamma / std::sqrt(var.at(c) + eps);
+        this->shift_.at(c) = beta - mean.at(c) * this->scale_.at(c);
+    }
+}
+
+uint32_t BatchNormOp::channels() const {
+    return this->scale_.size();
+}
+
+const std::vector<float>& BatchNormOp::scale() const {
+    return this->scale_;
+}
+
+const std::vector<float>& BatchNormOp::shift() const {
+    return this->shift_;
+}
+
+// nn.BatchNorm2d 的参数
+// affine=True eps=1.000000e-05 num_features=16
+// @running_mean=(16) @running_var=(16) @weight=(16) @bias=(16)，affine=False 时没有 weight 和 bias
+std::shared_ptr<Operator> BatchNormOp::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    const auto& params = op->params;
+    float eps = 1e-5f;
+    if (params.count("eps")) {
+        auto eps_param = dynamic_cast<RuntimeParameterFloat*>(params.at("eps"));
+        CHECK(eps_param != nullptr) << "BatchNorm operator " << op->name << " has a wrong eps";
+        eps = eps_param->value;
+    }
+
+    const auto& attrs = op->attrs;
+    CHECK(attrs.count("running_mean") && attrs.count("running_var"))
+        << "BatchNorm operator " << op->name << " is missing running statistics";
+    const std::vector<float>& mean = attrs.at("running_mean")->get<float>();
+    const std::vector<float>& var = attrs.at("running_var")->get<float>();
+    std::vector<float> weight;
+    std::vector<float> bias;
+    if (attrs.count("weight")) {
+        weight = attrs.at("weight")->get<float>();
+    }
+    if (attrs.count("bias")) {
+        bias = attrs.at("bias")->get<float>();
+    }
+    return std::make_shared<BatchNormOp>(mean, var, weight, bias, eps);
+}
+
+OpRegisterWrapper kBatchNormOp("nn.BatchNorm2d", BatchNormOp::CreateInstance);
+
+}
@@ -1,4 +1,10 @@
 #include "ops/conv_op.hpp"
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
 
 
 namespace kuiper_infer {
@@ -19,6 +25,10 @@ Shape ConvOp::get_padding() const {
     return this->padding_;
 }
 
+Shape ConvOp::get_dilation() const {
+    return this->dilation_;
+}
+
 void ConvOp::set_stride(Shape stride) {
     this->stride_ = stride;
 }
@@ -27,16 +37,59 @@ void ConvOp::set_padding(Shape padding) {
     this->padding_ = padding;
 }
 
+void ConvOp::set_dilation(Shape dilation) {
+    CHECK(dilation.first > 0 && dilation.second > 0) << "Dilation must be positive";
+    this->dilation_ = dilation;
+}
+
 void ConvOp::set_has_bias(bool has_bias) {
     this->has_bias_ = has_bias;
 }
 
 void ConvOp::set_groups(uint32_t groups) {
     this->groups_ = groups;
+    if (!this->weights_.empty()) {
+        PackWeights();
+    }
 }
 
 void ConvOp::set_weights(std::vector<sftensor> &weights) {
     this->weights_ = weights;
+    this->half_weights_.clear();
+    this->quantized_weights_.reset();
+    this->int8_weights_.reset();
+    this->packed_weights_.clear();
+    if (this->weights_.empty()) {
+        return;
+    }
+    if (this->weight_bits_ != 0) {
+        QuantizeKernels();
+    } else {
+        PackWeights();
+    }
+}
+
+void ConvOp::PackWeights() {
+    const uint32_t kernel_count = this->weights_.size();
+    CHECK(this->groups_ > 0 && kernel_count % this->groups_ == 0)
+        << "Kernel count " << kernel_count << " is not divisible by groups " << this->groups_;
+    const uint32_t kernels_per_group = kernel_count / this->groups_;
+    const uint32_t kernel_elements = this->weights_.front()->size();
+
+    // 卷积核是列主序的 (kernel_c, kernel_h, kernel_w)，按内存顺序展开为一列
+    std::vector<float> kernel_matrix(size_t(kernel_elements) * kernels_per_group);
+    this->packed_weights_.clear();
+    for (uint32_t g = 0; g < this->groups_; ++g) {
+        for (uint32_t k = 0; k < kernels_per_group; ++k) {
+            this->CopyKernel(g * kernels_per_group + k, kernel_matrix.data() + size_t(k) * kernel_elements);
+        }
+        this->packed_weights_.push_back(
+            PackSgemmMatrix(kernel_matrix.data(), kernel_elements, kernel_elements, kernels_per_group));
+    }
+}
+
+const std::vector<PackedSgemmMatrix>& ConvOp::packed_weights() const {
+    return this->packed_weights_;
 }
 
 void ConvOp::set_bias(std::vector<sftensor> &bias) {
@@ -51,4 +104,290 @@ const std::vector<sftensor>& ConvOp::get_bias() const {
     return this->bias_;
 }
 
+void ConvOp::CompressWeights(HalfType type) {
+    CHECK(this->quantized_weights_ == nullptr) << "Weights are already quantized";
+    if (this->weights_compressed()) {
+        CHECK(this->half_weights_.front()->type() == type) << "Weights are already compressed to another type";
+        return;
+    }
+    CHECK(!this->weights_.empty());
+    std::vector<shtensor> half_weights;
+    for (const sftensor &kernel : this->weights_) {
+        CHECK(kernel != nullptr);
+        half_weights.push_back(HalfTensor::FromFloat(*kernel, type));
+    }
+    this->half_weights_ = std::move(half_weights);
+    this->weights_.clear();
+    this->packed_weights_.clear();
+}
+
+bool ConvOp::weights_compressed() const {
+    return !this->half_weights_.empty() || this->quantized_weights_ != nullptr;
+}
+
+const std::vector<shtensor>& ConvOp::get_half_weights() const {
+    return this->half_weights_;
+}
+
+uint32_t QuantizedKernels::kernel_elements() const {
+    CHECK_EQ(this->shape.size(), 3);
+    return this->shape.at(0) * this->shape.at(1) * this->shape.at(2);
+}
+
+size_t QuantizedKernels::kernel_bytes() const {
+    return this->bits == 8 ? this->kernel_elements() : (this->kernel_elements() + 1) / 2;
+}
+
+void QuantizedKernels::Load(uint32_t index, float* dst) const {
+    CHECK_LT(index, this->scales.size());
+    const uint8_t* src = this->data.data() + index * this->kernel_bytes();
+    if (this->bits == 8) {
+        DequantizeValues(src, dst, this->kernel_elements(), this->scales.at(index), 0, true);
+    } else {
+        DequantizeInt4Values(src, dst, this->kernel_elements(), this->scales.at(index));
+    }
+}
+
+void ConvOp::set_weight_bits(uint32_t bits) {
+    CHECK(bits == 0 || bits == 4 || bits == 8) << "Unsupported weight bits " << bits;
+    if (bits == this->weight_bits_) {
+        return;
+    }
+    this->weight_bits_ = bits;
+    if (this->kernel_count() == 0) {
+        return;
+    }
+    if (bits != 0) {
+        CHECK(this->half_weights_.empty()) << "Weights are already compressed to half";
+        QuantizeKernels();
+        return;
+    }
+
+    // 恢复 fp32 存储，权重是反量化后的值
+    const std::vector<uint32_t>& kernel_shape = this->kernel_shape();
+    std::vector<sftensor> weights(this->kernel_count());
+    for (uint32_t k = 0; k < weights.size(); ++k) {
+        weights.at(k) = std::make_shared<ftensor>(kernel_shape.at(0), kernel_shape.at(1), kernel_shape.at(2));
+        this->CopyKernel(k, weights.at(k)->data().memptr());
+    }
+    this->weights_ = std::move(weights);
+    this->quantized_weights_.reset();
+    PackWeights();
+}
+
+uint32_t ConvOp::weight_bits() const {
+    return this->weight_bits_;
+}
+
+const std::shared_ptr<QuantizedKernels>& ConvOp::get_quantized_weights() const {
+    return this->quantized_weights_;
+}
+
+void ConvOp::QuantizeKernels() {
+    const uint32_t kernel_count = this->kernel_count();
+    std::shared_ptr<QuantizedKernels> quantized = std::make_shared<QuantizedKernels>();
+    quantized->bits = this->weight_bits_;
+    quantized->shape = this->kernel_shape();
+    const uint32_t kernel_elements = quantized->kernel_elements();
+    const size_t kernel_bytes = quantized->kernel_bytes();
+    quantized->data.resize(kernel_bytes * kernel_count);
+
+    // 每个卷积核按绝对值最大值对称量化，全 0 的卷积核 scale 取 1
+    const float qmax = this->weight_bits_ == 8 ? 127.f : 7.f;
+    std::vector<float> kernel(kernel_elements);
+    for (uint32_t k = 0; k < kernel_count; ++k) {
+        this->CopyKernel(k, kernel.data());
+        float abs_max = 0.f;
+        for (const float value : kernel) {
+            abs_max = std::max(abs_max, std::fabs(value));
+        }
+        const float scale = abs_max > 0.f ? abs_max / qmax : 1.f;
+        uint8_t* dst = quantized->data.data() + k * kernel_bytes;
+        if (this->weight_bits_ == 8) {
+            QuantizeValues(kernel.data(), dst, kernel_elements, scale, 0, true);
+        } else {
+            QuantizeInt4Values(kernel.data(), dst, kernel_elements, scale);
+        }
+        quantized->scales.push_back(scale);
+    }
+    this->quantized_weights_ = std::move(quantized);
+    this->weights_.clear();
+    this->half_weights_.clear();
+    this->packed_weights_.clear();
+}
+
+uint32_t ConvOp::kernel_count() const {
+    if (this->quantized_weights_ != nullptr) {
+        return this->quantized_weights_->scales.size();
+    }
+    return this->half_weights_.empty() ? this->weights_.size() : this->half_weights_.size();
+}
+
+std::vector<uint32_t> ConvOp::kernel_shape() const {
+    CHECK(this->kernel_count() > 0) << "Conv operator has no weights";
+    if (this->quantized_weights_ != nullptr) {
+        return this->quantized_weights_->shape;
+    }
+    if (!this->half_weights_.empty()) {
+        return this->half_weights_.front()->shape();
+    }
+    const sftensor &kernel = this->weights_.front();
+    return {kernel->channels(), kernel->rows(), kernel->cols()};
+}
+
+void ConvOp::CopyKernel(uint32_t index, float* dst) const {
+    CHECK_LT(index, this->kernel_count());
+    if (this->quantized_weights_ != nullptr) {
+        this->quantized_weights_->Load(index, dst);
+    } else if (!this->half_weights_.empty()) {
+        const shtensor &kernel = this->half_weights_.at(index);
+        kernel->Load(0, kernel->size(), dst);
+    } else {
+        const sftensor &kernel = this->weights_.at(index);
+        memcpy(dst, kernel->raw_ptr(), kernel->size() * sizeof(float));
+    }
+}
+
+void ConvOp::EnableInt8(const QuantParams& input_params, const QuantParams& weight_params,
+                        const QuantParams& output_params, bool relu) {
+    const uint32_t kernel_count = this->kernel_count();
+    CHECK(kernel_count > 0) << "Conv operator has no weights";
+    CHECK(!input_params.is_signed && !input_params.per_channel() && !input_params.scales.empty())
+        << "Conv input must be quantized to uint8 per tensor";
+    CHECK(!output_params.is_signed && !output_params.per_channel() && !output_params.scales.empty())
+        << "Conv output must be quantized to uint8 per tensor";
+
+    const std::vector<uint32_t>& kernel_shape = this->kernel_shape();
+    const uint32_t kernel_elements = kernel_shape.at(0) * kernel_shape.at(1) * kernel_shape.at(2);
+    std::vector<float> kernel(kernel_elements);
+
+    // 没有给出卷积核参数时按输出通道对称量化
+    QuantParams params = weight_params;
+    if (params.scales.empty()) {
+        params.is_signed = true;
+        for (uint32_t k = 0; k < kernel_count; ++k) {
+            this->CopyKernel(k, kernel.data());
+            const auto [min, max] = std::minmax_element(kernel.begin(), kernel.end());
+            const auto [scale, zero_point] = ChooseQuantParams(*min, *max, true, true);
+            params.scales.push_back(scale);
+            params.zero_points.push_back(zero_point);
+        }
+    }
+    CHECK(params.is_signed) << "Conv weights must be quantized to int8";
+    CHECK(!params.per_channel() || params.scales.size() == kernel_count)
+        << "Weight params do not match the kernel count";
+    for (uint32_t k = 0; k < kernel_count; ++k) {
+        CHECK_EQ(params.zero_point(k), 0) << "Conv weights must be quantized symmetrically";
+    }
+
+    std::shared_ptr<ConvInt8Weights> int8_weights = std::make_shared<ConvInt8Weights>();
+    int8_weights->input_params = input_params;
+    int8_weights->weight_params = params;
+    int8_weights->output_params = output_params;
+    int8_weights->relu = relu;
+
+    // 每个 group 的卷积核按列主序展开为一行，和 im2col 的列顺序一致
+    const uint32_t kernels_per_group = kernel_count / this->groups_;
+    std::vector<int8_t> group_kernels(size_t(kernels_per_group) * kernel_elements);
+    for (uint32_t g = 0; g < this->groups_; ++g) {
+        Int8Epilogue epilogue;
+        epilogue.input_zero_point = input_params.zero_point(0);
+        epilogue.relu = relu;
+        epilogue.output_scale = output_params.scale(0);
+        epilogue.output_zero_point = output_params.zero_point(0);
+        for (uint32_t k = 0; k < kernels_per_group; ++k) {
+            const uint32_t channel = g * kernels_per_group + k;
+            this->CopyKernel(channel, kernel.data());
+            QuantizeValues(kernel.data(), reinterpret_cast<uint8_t*>(group_kernels.data()) + size_t(k) * kernel_elements,
+                           kernel_elements, params.scale(channel), 0, true);
+            epilogue.scales.push_back(input_params.scale(0) * params.scale(channel));
+            if (this->has_bias_) {
+                epilogue.bias.push_back(this->bias_.at(channel)->index(0));
+            }
+        }
+        int8_weights->packed_weights.push_back(
+            PackInt8Matrix(group_kernels.data(), kernels_per_group, kernel_elements));
+        int8_weights->epilogues.push_back(std::move(epilogue));
+    }
+    this->int8_weights_ = std::move(int8_weights);
+}
+
+bool ConvOp::int8_enabled() const {
+    return this->int8_weights_ != nullptr;
+}
+
+const std::shared_ptr<ConvInt8Weights>& ConvOp::int8_weights() const {
+    return this->int8_weights_;
+}
+
+// nn.Conv2d 的参数
+// bias=False dilation=(1,1) groups=1 in_channels=1 kernel_size=(5,5) out_channels=1 padding=(2,2) stride=(1,1)
+// 权重 @weight=(out_channels, in_channels / groups, kernel_h, kernel_w) @bias=(out_channels)
+std::shared_ptr<Operator> ConvOp::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    const auto& params = op->params;
+
+    CHECK(params.count("stride") && params.count("padding") && params.count("bias") && params.count("groups"))
+        << "Conv operator " << op->name << " is missing params";
+
+    auto stride = dynamic_cast<RuntimeParameterIntArray*>(params.at("stride"));
+    auto padding = dynamic_cast<RuntimeParameterIntArray*>(params.at("padding"));
+    auto has_bias = dynamic_cast<RuntimeParameterBool*>(params.at("bias"));
+    auto groups = dynamic_cast<RuntimeParameterInt*>(params.at("groups"));
+    CHECK(stride != nullptr && stride->value.size() == 2);
+    CHECK(padding != nullptr && padding->value.size() == 2);
+    CHECK(has_bias != nullptr && groups != nullptr);
+
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(
+        Shape(stride->value.at(0), stride->value.at(1)), Shape(padding->value.at(0), padding->value.at(1)),
+        has_bias->value, groups->value);
+
+    // 老版本导出的模型可能没有 dilation，按 1 处理
+    if (params.count("dilation")) {
+        auto dilation = dynamic_cast<RuntimeParameterIntArray*>(params.at("dilation"));
+        CHECK(dilation != nullptr && dilation->value.size() == 2);
+        CHECK(dilation->value.at(0) > 0 && dilation->value.at(1) > 0)
+            << "Conv operator " << op->name << " has invalid dilation";
+        conv_op->set_dilation(Shape(dilation->value.at(0), dilation->value.at(1)));
+    }
+
+    // 权重是行主序的 OIHW，每个输出通道对应一个 (I, H, W) 的卷积核
+    CHECK(op->attrs.count("weight")) << "Conv operator " << op->name << " is missing weight";
+    const auto& weight_attr = op->attrs.at("weight");
+    CHECK_EQ(weight_attr->shape.size(), 4);
+    const uint32_t kernel_n = weight_attr->shape.at(0);
+    const uint32_t kernel_c = weight_attr->shape.at(1);
+    const uint32_t kernel_h = weight_attr->shape.at(2);
+    const uint32_t kernel_w = weight_attr->shape.at(3);
+    const uint32_t kernel_size = kernel_c * kernel_h * kernel_w;
+
+    const std::vector<float>& weight_values = weight_attr->get<float>();
+    CHECK_EQ(weight_values.size(), kernel_n * kernel_size);
+
+    std::vector<sftensor> weights(kernel_n);
+    for (uint32_t k = 0; k < kernel_n; ++k) {
+        std::vector<float> kernel_values(weight_values.begin() + k * kernel_size,
+                                         weight_values.begin() + (k + 1) * kernel_size);
+        weights.at(k) = std::make_shared<ftensor>(kernel_c, kernel_h, kernel_w);
+        weights.at(k)->Fill(kernel_values, true);
+    }
+    conv_op->set_weights(weights);
+
+    if (has_bias->value) {
+        CHECK(op->attrs.count("bias")) << "Conv operator " << op->name << " is missing bias";
+        const std::vector<float>& bias_values = op->attrs.at("bias")->get<float>();
+        CHECK_EQ(bias_values.size(), kernel_n);
+
+        std::vector<sftensor> bias(kernel_n);
+        for (uint32_t k = 0; k < kernel_n; ++k) {
+            bias.at(k) = std::make_shared<ftensor>(1, 1, 1);
+            bias.at(k)->index(0) = bias_values.at(k);
+        }
+        conv_op->set_bias(bias);
+    }
+    return conv_op;
+}
+
+OpRegisterWrapper kConvOp("nn.Conv2d", ConvOp::CreateInstance);
+
 }
\ No newline at end of file
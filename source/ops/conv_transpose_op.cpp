@@ -0,0 +1,183 @@
+#include "ops/conv_transpose_op.hpp"
+#include <glog/logging.h>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
+
+namespace kuiper_infer {
+
+ConvTransposeOp::ConvTransposeOp(Shape stride, Shape padding, bool has_bias, uint32_t groups)
+    : Operator(OpType::kOperatorConvTranspose), has_bias_(has_bias), groups_(groups), stride_(stride),
+      padding_(padding) {
+    CHECK(groups > 0);
+    CHECK(stride.first > 0 && stride.second > 0);
+}
+
+void ConvTransposeOp::set_stride(Shape stride) {
+    CHECK(stride.first > 0 && stride.second > 0);
+    this->stride_ = stride;
+}
+
+void ConvTransposeOp::set_padding(Shape padding) {
+    this->padding_ = padding;
+}
+
+void ConvTransposeOp::set_output_padding(Shape output_padding) {
+    this->output_padding_ = output_padding;
+}
+
+void ConvTransposeOp::set_dilation(Shape dilation) {
+    CHECK(dilation.first > 0 && dilation.second > 0) << "Dilation must be positive";
+    this->dilation_ = dilation;
+}
+
+Shape ConvTransposeOp::get_stride() const {
+    return this->stride_;
+}
+
+Shape ConvTransposeOp::get_padding() const {
+    return this->padding_;
+}
+
+Shape ConvTransposeOp::get_output_padding() const {
+    return this->output_padding_;
+}
+
+Shape ConvTransposeOp::get_dilation() const {
+    return this->dilation_;
+}
+
+bool ConvTransposeOp::get_has_bias() const {
+    return this->has_bias_;
+}
+
+uint32_t ConvTransposeOp::get_groups() const {
+    return this->groups_;
+}
+
+void ConvTransposeOp::set_weights(const std::vector<sftensor> &weights) {
+    CHECK(!weights.empty());
+    CHECK_EQ(weights.size() % this->groups_, 0);
+    const std::vector<uint32_t> &shape = weights.front()->shape();
+    for (const sftensor &weight : weights) {
+        CHECK(weight != nullptr && weight->shape() == shape) << "Weights have different shapes";
+    }
+    this->weights_ = weights;
+
+    // 一个输入通道的权重在内存里是列主序的 (out / groups, kernel_h, kernel_w)，
+    // 展开后第 (oc, kw, kh) 个元素对应列 oc * kernel_h * kernel_w + kw * kernel_h + kh
+    const uint32_t channels_per_group = weights.size() / this->groups_;
+    const uint32_t columns = weights.front()->size();
+    this->packed_weights_.clear();
+    std::vector<float> matrix(size_t(channels_per_group) * columns);
+    for (uint32_t g = 0; g < this->groups_; ++g) {
+        for (uint32_t ic = 0; ic < channels_per_group; ++ic) {
+            const float *weight = weights.at(g * channels_per_group + ic)->raw_ptr();
+            for (uint32_t j = 0; j < columns; ++j) {
+                matrix.at(size_t(j) * channels_per_group + ic) = weight[j];
+            }
+        }
+        this->packed_weights_.push_back(PackSgemmMatrix(matrix.data(), channels_per_group, channels_per_group,
+                                                        columns));
+    }
+}
+
+void ConvTransposeOp::set_bias(const std::vector<sftensor> &bias) {
+    this->bias_ = bias;
+}
+
+const std::vector<sftensor>& ConvTransposeOp::get_weights() const {
+    return this->weights_;
+}
+
+const std::vector<sftensor>& ConvTransposeOp::get_bias() const {
+    return this->bias_;
+}
+
+uint32_t ConvTransposeOp::in_channels() const {
+    return this->weights_.size();
+}
+
+uint32_t ConvTransposeOp::out_channels() const {
+    CHECK(!this->weights_.empty());
+    return this->weights_.front()->channels() * this->groups_;
+}
+
+const std::vector<PackedSgemmMatrix>& ConvTransposeOp::packed_weights() const {
+    return this->packed_weights_;
+}
+
+Shape ConvTransposeOp::kernel_size() const {
+    CHECK(!this->weights_.empty());
+    return Shape(this->weights_.front()->rows(), this->weights_.front()->cols());
+}
+
+// nn.ConvTranspose2d 的参数
+// bias=True dilation=(1,1) groups=1 in_channels=16 kernel_size=(2,2) out_channels=8 output_padding=(0,0)
+// padding=(0,0) stride=(2,2)
+// 权重 @weight=(in_channels, out_channels / groups, kernel_h, kernel_w) @bias=(out_channels)
+std::shared_ptr<Operator> ConvTransposeOp::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    const auto& params = op->params;
+    CHECK(params.count("stride") && params.count("padding") && params.count("bias") && params.count("groups"))
+        << "ConvTranspose operator " << op->name << " is missing params";
+
+    auto stride = dynamic_cast<RuntimeParameterIntArray*>(params.at("stride"));
+    auto padding = dynamic_cast<RuntimeParameterIntArray*>(params.at("padding"));
+    auto has_bias = dynamic_cast<RuntimeParameterBool*>(params.at("bias"));
+    auto groups = dynamic_cast<RuntimeParameterInt*>(params.at("groups"));
+    CHECK(stride != nullptr && stride->value.size() == 2);
+    CHECK(padding != nullptr && padding->value.size() == 2);
+    CHECK(has_bias != nullptr && groups != nullptr);
+
+    std::shared_ptr<ConvTransposeOp> conv_op = std::make_shared<ConvTransposeOp>(
+        Shape(stride->value.at(0), stride->value.at(1)), Shape(padding->value.at(0), padding->value.at(1)),
+        has_bias->value, groups->value);
+    if (params.count("output_padding")) {
+        auto output_padding = dynamic_cast<RuntimeParameterIntArray*>(params.at("output_padding"));
+        CHECK(output_padding != nullptr && output_padding->value.size() == 2);
+        conv_op->set_output_padding(Shape(output_padding->value.at(0), output_padding->value.at(1)));
+    }
+    if (params.count("dilation")) {
+        auto dilation = dynamic_cast<RuntimeParameterIntArray*>(params.at("dilation"));
+        CHECK(dilation != nullptr && dilation->value.size() == 2);
+        conv_op->set_dilation(Shape(dilation->value.at(0), dilation->value.at(1)));
+    }
+
+    // 权重是行主序的 (in, out / groups, kh, kw)，每个输入通道对应一个 (out / groups, kh, kw)
+    CHECK(op->attrs.count("weight")) << "ConvTranspose operator " << op->name << " is missing weight";
+    const auto& weight_attr = op->attrs.at("weight");
+    CHECK_EQ(weight_attr->shape.size(), 4);
+    const uint32_t in_channels = weight_attr->shape.at(0);
+    const uint32_t out_per_group = weight_attr->shape.at(1);
+    const uint32_t kernel_h = weight_attr->shape.at(2);
+    const uint32_t kernel_w = weight_attr->shape.at(3);
+    const uint32_t weight_size = out_per_group * kernel_h * kernel_w;
+
+    const std::vector<float>& weight_values = weight_attr->get<float>();
+    CHECK_EQ(weight_values.size(), size_t(in_channels) * weight_size);
+    std::vector<sftensor> weights(in_channels);
+    for (uint32_t ic = 0; ic < in_channels; ++ic) {
+        std::vector<float> values(weight_values.begin() + size_t(ic) * weight_size,
+                                  weight_values.begin() + size_t(ic + 1) * weight_size);
+        weights.at(ic) = std::make_shared<ftensor>(out_per_group, kernel_h, kernel_w);
+        weights.at(ic)->Fill(values, true);
+    }
+    conv_op->set_weights(weights);
+
+    if (has_bias->value) {
+        CHECK(op->attrs.count("bias")) << "ConvTranspose operator " << op->name << " is missing bias";
+        const std::vector<float>& bias_values = op->attrs.at("bias")->get<float>();
+        CHECK_EQ(bias_values.size(), conv_op->out_channels());
+        std::vector<sftensor> bias(bias_values.size());
+        for (uint32_t k = 0; k < bias.size(); ++k) {
+            bias.at(k) = std::make_shared<ftensor>(1, 1, 1);
+            bias.at(k)->index(0) = bias_values.at(k);
+        }
+        conv_op->set_bias(bias);
+    }
+    return conv_op;
+}
+
+OpRegisterWrapper kConvTransposeOp("nn.ConvTranspose2d", ConvTransposeOp::CreateInstance);
+
+}
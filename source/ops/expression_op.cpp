@@ -1,5 +1,7 @@
 #include <glog/logging.h>
 #include "ops/expression_op.hpp"
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
 
 namespace kuiper_infer {
     
@@ -13,4 +15,16 @@ std::vector<std::shared_ptr<TokenNode>> ExpressionOp::Generate() {
     return this->nodes_;
 }
 
+// pnnx.Expression 的表达式存放在 expr 参数里，例如 expr=add(@0,@1)
+std::shared_ptr<Operator> ExpressionOp::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    CHECK(op->params.count("expr")) << "Expression operator " << op->name << " is missing expr";
+
+    auto expr = dynamic_cast<RuntimeParameterString*>(op->params.at("expr"));
+    CHECK(expr != nullptr && !expr->value.empty());
+    return std::make_shared<ExpressionOp>(expr->value);
+}
+
+OpRegisterWrapper kExpressionOp("pnnx.Expression", ExpressionOp::CreateInstance);
+
 }
\ No newline at end of file
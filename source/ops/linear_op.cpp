@@ -0,0 +1,139 @@
+#include "ops/linear_op.hpp"
+#include <glog/logging.h>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
+
+namespace kuiper_infer {
+
+LinearOp::LinearOp(uint32_t in_features, uint32_t out_features, bool has_bias)
+    : Operator(OpType::kOperatorLinear), in_features_(in_features), out_features_(out_features),
+      has_bias_(has_bias) {
+    CHECK(in_features > 0 && out_features > 0);
+}
+
+void LinearOp::set_weights(const std::vector<float> &weights, const std::vector<uint32_t> &input_shape) {
+    const uint32_t in_features = this->in_features_;
+    CHECK_EQ(weights.size(), size_t(in_features) * this->out_features_);
+    // 行主序的 (out, in) 就是列主序的 (in, out)，第 j 列是第 j 个输出的权重
+    this->packed_weights_ = PackSgemmMatrix(weights.data(), in_features, in_features, this->out_features_);
+    this->column_major_weights_ = PackedSgemmMatrix();
+    this->input_shape_ = input_shape;
+    if (input_shape.empty()) {
+        return;
+    }
+    CHECK_EQ(input_shape.size(), 3);
+    const uint32_t channels = input_shape.at(0);
+    const uint32_t rows = input_shape.at(1);
+    const uint32_t cols = input_shape.at(2);
+    CHECK_EQ(size_t(channels) * rows * cols, in_features) << "Linear input shape does not match in_features";
+    // 只有一行或一列时列主序和行主序的内存顺序相同
+    if (rows == 1 || cols == 1) {
+        return;
+    }
+
+    // 内存里第 c * rows * cols + col * rows + row 个元素是展平后的第 c * rows * cols + row * cols + col 个特征
+    std::vector<float> matrix(weights.size());
+    for (uint32_t j = 0; j < this->out_features_; ++j) {
+        const float *weight = weights.data() + size_t(j) * in_features;
+        float *column = matrix.data() + size_t(j) * in_features;
+        for (uint32_t c = 0; c < channels; ++c) {
+            const size_t plane = size_t(c) * rows * cols;
+            for (uint32_t col = 0; col < cols; ++col) {
+                for (uint32_t row = 0; row < rows; ++row) {
+                    column[plane + size_t(col) * rows + row] = weight[plane + size_t(row) * cols + col];
+                }
+            }
+        }
+    }
+    this->column_major_weights_ = PackSgemmMatrix(matrix.data(), in_features, in_features, this->out_features_);
+}
+
+void LinearOp::set_bias(const std::vector<float> &bias) {
+    CHECK_EQ(bias.size(), this->out_features_);
+    this->bias_ = bias;
+}
+
+void LinearOp::set_activation(SgemmActivation activation) {
+    this->activation_ = activation;
+}
+
+uint32_t LinearOp::in_features() const {
+    return this->in_features_;
+}
+
+uint32_t LinearOp::out_features() const {
+    return this->out_features_;
+}
+
+bool LinearOp::has_bias() const {
+    return this->has_bias_;
+}
+
+const std::vector<float>& LinearOp::bias() const {
+    return this->bias_;
+}
+
+SgemmActivation LinearOp::activation() const {
+    return this->activation_;
+}
+
+const PackedSgemmMatrix& LinearOp::packed_weights() const {
+    return this->packed_weights_;
+}
+
+const PackedSgemmMatrix& LinearOp::column_major_weights() const {
+    return this->column_major_weights_;
+}
+
+const std::vector<uint32_t>& LinearOp::input_shape() const {
+    return this->input_shape_;
+}
+
+// nn.Linear 的参数
+// bias=True in_features=512 out_features=1000 @weight=(1000,512) @bias=(1000)
+// 融合了激活函数时计算图构建时加上 activation=relu 或 activation=sigmoid
+// 输入操作数是 (batch, channels, rows, cols) 并且元素个数等于 in_features 时，加载时按列主序的输入打包权重
+std::shared_ptr<Operator> LinearOp::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    const auto& params = op->params;
+    CHECK(params.count("in_features") && params.count("out_features") && params.count("bias"))
+        << "Linear operator " << op->name << " is missing params";
+    auto in_features = dynamic_cast<RuntimeParameterInt*>(params.at("in_features"));
+    auto out_features = dynamic_cast<RuntimeParameterInt*>(params.at("out_features"));
+    auto has_bias = dynamic_cast<RuntimeParameterBool*>(params.at("bias"));
+    CHECK(in_features != nullptr && out_features != nullptr && has_bias != nullptr);
+
+    std::shared_ptr<LinearOp> linear_op =
+        std::make_shared<LinearOp>(in_features->value, out_features->value, has_bias->value);
+    CHECK(op->attrs.count("weight")) << "Linear operator " << op->name << " is missing weight";
+    std::vector<uint32_t> input_shape;
+    if (op->input_operands_seq.size() == 1) {
+        const std::vector<int32_t> &shape = op->input_operands_seq.front()->shape;
+        if (shape.size() == 4 && shape.at(1) > 0 && shape.at(2) > 0 && shape.at(3) > 0 &&
+            int64_t(shape.at(1)) * shape.at(2) * shape.at(3) == in_features->value) {
+            input_shape = {uint32_t(shape.at(1)), uint32_t(shape.at(2)), uint32_t(shape.at(3))};
+        }
+    }
+    linear_op->set_weights(op->attrs.at("weight")->get<float>(), input_shape);
+    if (has_bias->value) {
+        CHECK(op->attrs.count("bias")) << "Linear operator " << op->name << " is missing bias";
+        linear_op->set_bias(op->attrs.at("bias")->get<float>());
+    }
+
+    if (params.count("activation")) {
+        auto activation = dynamic_cast<RuntimeParameterString*>(params.at("activation"));
+        CHECK(activation != nullptr);
+        if (activation->value == "relu") {
+            linear_op->set_activation(SgemmActivation::kReLU);
+        } else if (activation->value == "sigmoid") {
+            linear_op->set_activation(SgemmActivation::kSigmoid);
+        } else {
+            LOG(FATAL) << "Unknown activation of " << op->name << ": " << activation->value;
+        }
+    }
+    return linear_op;
+}
+
+OpRegisterWrapper kLinearOp("nn.Linear", LinearOp::CreateInstance);
+
+}
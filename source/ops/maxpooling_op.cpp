@@ -1,4 +1,7 @@
 #include "ops/maxpooling_op.hpp"
+#include <glog/logging.h>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
 
 namespace kuiper_infer {
     
@@ -29,4 +32,27 @@ Shape MaxPoolingOp::get_padding() const {
     return padding_;
 }
 
+// nn.MaxPool2d 的参数
+// ceil_mode=False dilation=(1,1) kernel_size=(2,2) padding=(0,0) return_indices=False stride=(2,2)
+std::shared_ptr<Operator> MaxPoolingOp::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    const auto& params = op->params;
+
+    CHECK(params.count("kernel_size") && params.count("stride") && params.count("padding"))
+        << "MaxPooling operator " << op->name << " is missing params";
+
+    auto kernel_size = dynamic_cast<RuntimeParameterIntArray*>(params.at("kernel_size"));
+    auto stride = dynamic_cast<RuntimeParameterIntArray*>(params.at("stride"));
+    auto padding = dynamic_cast<RuntimeParameterIntArray*>(params.at("padding"));
+    CHECK(kernel_size != nullptr && kernel_size->value.size() == 2);
+    CHECK(stride != nullptr && stride->value.size() == 2);
+    CHECK(padding != nullptr && padding->value.size() == 2);
+
+    return std::make_shared<MaxPoolingOp>(Shape(kernel_size->value.at(0), kernel_size->value.at(1)),
+                                          Shape(stride->value.at(0), stride->value.at(1)),
+                                          Shape(padding->value.at(0), padding->value.at(1)));
+}
+
+OpRegisterWrapper kMaxPoolingOp("nn.MaxPool2d", MaxPoolingOp::CreateInstance);
+
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
 #include "ops/relu_op.hpp"
+#include <glog/logging.h>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
 
 namespace kuiper_infer {
     
@@ -13,4 +16,13 @@ float ReLUOperator::get_threshold() const {
     return threshold_;
 }
 
+// nn.ReLU 没有参数，阈值为0
+std::shared_ptr<Operator> ReLUOperator::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    return std::make_shared<ReLUOperator>(0.f);
+}
+
+OpRegisterWrapper kReLUOp("nn.ReLU", ReLUOperator::CreateInstance);
+OpRegisterWrapper kFReLUOp("F.relu", ReLUOperator::CreateInstance);
+
 }
\ No newline at end of file
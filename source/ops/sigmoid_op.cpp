@@ -1,4 +1,7 @@
 #include "ops/sigmoid_op.hpp"
+#include <glog/logging.h>
+#include "factory/op_factory.hpp"
+#include "runtime/runtime_operator.hpp"
 
 namespace kuiper_infer {
     
@@ -6,4 +9,12 @@ SigmoidOperator::SigmoidOperator() : Operator(OpType::kOperatorSigmoid) {
     
 }
 
+std::shared_ptr<Operator> SigmoidOperator::CreateInstance(const std::shared_ptr<RuntimeOperator> &op) {
+    CHECK(op != nullptr);
+    return std::make_shared<SigmoidOperator>();
+}
+
+OpRegisterWrapper kSigmoidOp("nn.Sigmoid", SigmoidOperator::CreateInstance);
+OpRegisterWrapper kFSigmoidOp("F.sigmoid", SigmoidOperator::CreateInstance);
+
 }
\ No newline at end of file
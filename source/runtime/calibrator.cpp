@@ -0,0 +1,537 @@
+#include "runtime/calibrator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <glog/logging.h>
+#include "data/load_data.hpp"
+#include "ops/conv_op.hpp"
+#include "runtime/ir.h"
+
+namespace kuiper_infer {
+
+const char* CalibrationMethodName(CalibrationMethod method) {
+    switch (method) {
+        case CalibrationMethod::kMinMax:
+            return "minmax";
+        case CalibrationMethod::kPercentile:
+            return "percentile";
+        case CalibrationMethod::kEntropy:
+            return "entropy";
+    }
+    return "unknown";
+}
+
+bool ParseCalibrationMethod(const std::string& name, CalibrationMethod& method) {
+    for (const CalibrationMethod item :
+         {CalibrationMethod::kMinMax, CalibrationMethod::kPercentile, CalibrationMethod::kEntropy}) {
+        if (name == CalibrationMethodName(item)) {
+            method = item;
+            return true;
+        }
+    }
+    return false;
+}
+
+ActivationHistogram::ActivationHistogram() : bins_(kBins, 0) {
+}
+
+void ActivationHistogram::Add(const float* values, size_t count) {
+    CHECK(values != nullptr || count == 0);
+    float abs_max = 0.f;
+    for (size_t i = 0; i < count; ++i) {
+        const float value = values[i];
+        if (std::isnan(value)) {
+            continue;
+        }
+        if (this->count_ == 0) {
+            this->min_ = this->max_ = value;
+        }
+        this->min_ = std::min(this->min_, value);
+        this->max_ = std::max(this->max_, value);
+        abs_max = std::max(abs_max, std::fabs(value));
+        this->count_ += 1;
+    }
+
+    // 范围翻倍时相邻的两个桶合并为一个，已经统计的值不需要重新读取
+    if (abs_max > this->range_) {
+        if (this->range_ == 0.f) {
+            this->range_ = abs_max;
+        }
+        while (abs_max > this->range_) {
+            for (uint32_t i = 0; i < kBins / 2; ++i) {
+                this->bins_.at(i) = this->bins_.at(2 * i) + this->bins_.at(2 * i + 1);
+            }
+            std::fill(this->bins_.begin() + kBins / 2, this->bins_.end(), 0);
+            this->range_ *= 2.f;
+        }
+    }
+
+    if (this->range_ == 0.f) {
+        // 到目前为止都是 0
+        for (size_t i = 0; i < count; ++i) {
+            this->bins_.front() += values[i] == 0.f;
+        }
+        return;
+    }
+    const float scale = float(kBins) / this->range_;
+    for (size_t i = 0; i < count; ++i) {
+        const float abs_value = std::fabs(values[i]);
+        if (std::isnan(abs_value)) {
+            continue;
+        }
+        const uint32_t bin = std::min(uint32_t(abs_value * scale), kBins - 1);
+        this->bins_.at(bin) += 1;
+    }
+}
+
+float ActivationHistogram::min() const {
+    return this->min_;
+}
+
+float ActivationHistogram::max() const {
+    return this->max_;
+}
+
+uint64_t ActivationHistogram::count() const {
+    return this->count_;
+}
+
+float ActivationHistogram::Percentile(float percentile) const {
+    CHECK(percentile > 0.f && percentile <= 1.f);
+    if (this->count_ == 0 || this->range_ == 0.f) {
+        return 0.f;
+    }
+    const float abs_max = std::max(std::fabs(this->min_), std::fabs(this->max_));
+    const double target = double(percentile) * this->count_;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < kBins; ++i) {
+        total += this->bins_.at(i);
+        if (double(total) >= target) {
+            return std::min(float(i + 1) * this->range_ / kBins, abs_max);
+        }
+    }
+    return abs_max;
+}
+
+float ActivationHistogram::EntropyThreshold(uint32_t num_levels) const {
+    CHECK(num_levels > 0 && num_levels <= kBins);
+    const float abs_max = std::max(std::fabs(this->min_), std::fabs(this->max_));
+    if (this->count_ == 0 || this->range_ == 0.f) {
+        return abs_max;
+    }
+    // 最后一个非空桶之后的截断不会改变分布
+    uint32_t last_bin = kBins;
+    while (last_bin > 0 && this->bins_.at(last_bin - 1) == 0) {
+        last_bin -= 1;
+    }
+    if (last_bin <= num_levels) {
+        return abs_max;
+    }
+
+    const float bin_width = this->range_ / kBins;
+    std::vector<double> reference;
+    std::vector<double> candidate;
+    double best_divergence = std::numeric_limits<double>::max();
+    uint32_t best_bins = last_bin;
+    for (uint32_t bins = num_levels; bins <= last_bin; ++bins) {
+        // 截断后的参考分布，超出部分都计入最后一个桶
+        reference.assign(this->bins_.begin(), this->bins_.begin() + bins);
+        for (uint32_t i = bins; i < last_bin; ++i) {
+            reference.back() += double(this->bins_.at(i));
+        }
+
+        // 量化为 num_levels 级，每一级的数量平均分配给它覆盖的非空桶
+        candidate.assign(bins, 0.);
+        for (uint32_t level = 0; level < num_levels; ++level) {
+            const uint32_t begin = uint32_t(uint64_t(level) * bins / num_levels);
+            const uint32_t end = uint32_t(uint64_t(level + 1) * bins / num_levels);
+            double sum = 0.;
+            uint32_t non_zero = 0;
+            for (uint32_t i = begin; i < end; ++i) {
+                sum += double(this->bins_.at(i));
+                non_zero += this->bins_.at(i) != 0;
+            }
+            for (uint32_t i = begin; i < end && non_zero != 0; ++i) {
+                if (this->bins_.at(i) != 0) {
+                    candidate.at(i) = sum / non_zero;
+                }
+            }
+        }
+
+        double reference_sum = 0.;
+        double candidate_sum = 0.;
+        for (uint32_t i = 0; i < bins; ++i) {
+            reference_sum += reference.at(i);
+            candidate_sum += candidate.at(i);
+        }
+        if (candidate_sum == 0.) {
+            continue;
+        }
+        // 候选分布为 0 而参考分布不为 0 的位置用一个很小的概率代替
+        double divergence = 0.;
+        for (uint32_t i = 0; i < bins; ++i) {
+            if (reference.at(i) == 0.) {
+                continue;
+            }
+            const double p = reference.at(i) / reference_sum;
+            const double q = std::max(candidate.at(i) / candidate_sum, 1e-12);
+            divergence += p * std::log(p / q);
+        }
+        if (divergence < best_divergence) {
+            best_divergence = divergence;
+            best_bins = bins;
+        }
+    }
+    return std::min((float(best_bins) + 0.5f) * bin_width, abs_max);
+}
+
+std::pair<float, float> ActivationHistogram::Range(CalibrationMethod method, float percentile) const {
+    if (method == CalibrationMethod::kMinMax || this->count_ == 0) {
+        return {this->min_, this->max_};
+    }
+    float threshold = 0.f;
+    if (method == CalibrationMethod::kPercentile) {
+        threshold = this->Percentile(percentile);
+    } else {
+        // 激活值量化为 uint8，非负时正半轴有 256 级，否则每个半轴 128 级
+        threshold = this->EntropyThreshold(this->min_ >= 0.f ? 256 : 128);
+    }
+    return {std::max(this->min_, -threshold), std::min(this->max_, threshold)};
+}
+
+// 原地量化再反量化，模拟 int8 推理的误差
+static void FakeQuantize(const sftensor& tensor, const QuantParams& params) {
+    CHECK(tensor != nullptr && !tensor->empty());
+    const uint32_t plane_size = tensor->rows() * tensor->cols();
+    std::vector<uint8_t> buffer(plane_size);
+    for (uint32_t c = 0; c < tensor->channels(); ++c) {
+        float* plane = tensor->slice(c).memptr();
+        QuantizeValues(plane, buffer.data(), plane_size, params.scale(c), params.zero_point(c), params.is_signed);
+        DequantizeValues(buffer.data(), plane, plane_size, params.scale(c), params.zero_point(c), params.is_signed);
+    }
+}
+
+Calibrator::Calibrator(const std::string& param_path, const std::string& bin_path, const std::string& input_name,
+                       const std::string& output_name)
+    : param_path_(param_path), bin_path_(bin_path), input_name_(input_name), output_name_(output_name),
+      graph_(param_path, bin_path) {
+    // 统计时读取算子的输出，不能带边框
+    this->graph_.set_reserve_halo(false);
+    // 量化表和保存的模型都对应 pnnx 里原始的卷积核，不能折叠 BatchNorm
+    this->graph_.set_fold_batchnorm(false);
+    this->graph_.Build(input_name, output_name);
+}
+
+std::vector<sftensor> Calibrator::LoadSamples(const std::string& dir, uint32_t channels, uint32_t rows,
+                                              uint32_t cols) {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        const std::string& extension = entry.path().extension().string();
+        if (entry.is_regular_file() && (extension == ".csv" || extension == ".bin")) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<sftensor> samples;
+    for (const auto& path : paths) {
+        sftensor sample = std::make_shared<ftensor>(channels, rows, cols);
+        if (path.extension() == ".csv") {
+            const arma::fmat& data = CSVDataLoader::LoadData(path.string());
+            CHECK(data.n_rows == size_t(channels) * rows && data.n_cols == cols)
+                << "Sample " << path << " has shape " << data.n_rows << "x" << data.n_cols;
+            for (uint32_t c = 0; c < channels; ++c) {
+                for (uint32_t r = 0; r < rows; ++r) {
+                    for (uint32_t col = 0; col < cols; ++col) {
+                        sample->at(c, r, col) = data.at(c * rows + r, col);
+                    }
+                }
+            }
+        } else {
+            std::vector<float> values(size_t(channels) * rows * cols);
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            CHECK(in.good()) << "Can not open sample " << path;
+            CHECK_EQ(size_t(in.tellg()), values.size() * sizeof(float)) << "Sample " << path << " has wrong size";
+            in.seekg(0);
+            in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+            sample->Fill(values, true);
+        }
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+std::vector<uint32_t> Calibrator::input_shape() const {
+    for (const auto& op : this->graph_.operators()) {
+        if (op->name != this->input_name_) {
+            continue;
+        }
+        CHECK(op->output_operands != nullptr);
+        const std::vector<int32_t>& shape = op->output_operands->shape;
+        CHECK(shape.size() >= 2 && shape.size() <= 4) << "Unsupported input shape of " << this->input_name_;
+        // 第一维是 batch，不足三维时在前面补 1
+        std::vector<uint32_t> chw(4 - shape.size(), 1);
+        for (size_t i = 1; i < shape.size(); ++i) {
+            CHECK(shape.at(i) > 0) << "Input shape of " << this->input_name_ << " is dynamic";
+            chw.push_back(shape.at(i));
+        }
+        return chw;
+    }
+    LOG(FATAL) << "Can not find input operator: " << this->input_name_;
+    return {};
+}
+
+void Calibrator::Observe(const std::vector<sftensor>& inputs) {
+    CHECK(!inputs.empty());
+    auto record = [this](const std::shared_ptr<RuntimeOperand>& operand) {
+        if (operand == nullptr) {
+            return;
+        }
+        ActivationHistogram& histogram = this->histograms_[operand->name];
+        for (const sftensor& tensor : operand->tensors) {
+            CHECK(tensor != nullptr);
+            histogram.Add(tensor->raw_ptr(), tensor->size());
+        }
+    };
+    this->graph_.set_output_hook([&record](const std::shared_ptr<RuntimeOperator>& op) {
+        record(op->output_operands);
+    });
+    this->graph_.Forward(inputs);
+    this->graph_.set_output_hook(nullptr);
+
+    // 计算图的输入不经过回调
+    for (const auto& op : this->graph_.topo_operators()) {
+        if (op->type == "pnnx.Input") {
+            record(op->output_operands);
+        }
+    }
+}
+
+const std::map<std::string, ActivationHistogram>& Calibrator::histograms() const {
+    return this->histograms_;
+}
+
+QuantTable Calibrator::Compute(CalibrationMethod method, float percentile) const {
+    CHECK(!this->histograms_.empty()) << "Observe some samples before computing the quant table";
+    QuantTable table;
+    for (const auto& [name, histogram] : this->histograms_) {
+        const auto [min, max] = histogram.Range(method, percentile);
+        const auto [scale, zero_point] = ChooseQuantParams(min, max, false, false);
+        QuantParams params;
+        params.scales = {scale};
+        params.zero_points = {zero_point};
+        params.is_signed = false;
+        table.activations.insert({name, params});
+    }
+
+    // 卷积核只保存在 ConvOp 里，每个输出通道对称量化
+    for (const auto& op : this->graph_.operators()) {
+        auto conv_op = std::dynamic_pointer_cast<ConvOp>(op->layer_op);
+        if (op->type != "nn.Conv2d" || conv_op == nullptr || conv_op->kernel_count() == 0) {
+            continue;
+        }
+        const uint32_t out_channels = conv_op->kernel_count();
+        const std::vector<uint32_t>& kernel_shape = conv_op->kernel_shape();
+        std::vector<float> kernel(size_t(kernel_shape.at(0)) * kernel_shape.at(1) * kernel_shape.at(2));
+        QuantParams params;
+        params.is_signed = true;
+        for (uint32_t k = 0; k < out_channels; ++k) {
+            conv_op->CopyKernel(k, kernel.data());
+            const auto [min, max] = std::minmax_element(kernel.begin(), kernel.end());
+            const auto [scale, zero_point] = ChooseQuantParams(*min, *max, true, true);
+            params.scales.push_back(scale);
+            params.zero_points.push_back(zero_point);
+        }
+        table.weights.insert({op->name, params});
+    }
+    return table;
+}
+
+bool Calibrator::SaveQuantizedModel(const QuantTable& table, const std::string& param_path,
+                                    const std::string& bin_path, const std::string& table_path) const {
+    pnnx::Graph graph;
+    if (graph.load(this->param_path_, this->bin_path_) != 0) {
+        LOG(ERROR) << "Can not load pnnx graph: " << this->param_path_;
+        return false;
+    }
+
+    for (pnnx::Operator* op : graph.ops) {
+        auto params = table.weights.find(op->name);
+        if (params == table.weights.end() || table.float_layers.count(op->name) || !op->attrs.count("weight")) {
+            continue;
+        }
+        pnnx::Attribute& weight = op->attrs.at("weight");
+        CHECK_EQ(weight.type, 1) << "Only f32 weights can be quantized: " << op->name;
+        const uint32_t out_channels = weight.shape.front();
+        CHECK_EQ(params->second.scales.size(), out_channels) << "Quant table does not match " << op->name;
+        float* values = reinterpret_cast<float*>(weight.data.data());
+        const size_t kernel_size = weight.data.size() / sizeof(float) / out_channels;
+        std::vector<uint8_t> buffer(kernel_size);
+        for (uint32_t k = 0; k < out_channels; ++k) {
+            float* kernel = values + k * kernel_size;
+            const float scale = params->second.scale(k);
+            const int32_t zero_point = params->second.zero_point(k);
+            QuantizeValues(kernel, buffer.data(), kernel_size, scale, zero_point, true);
+            DequantizeValues(buffer.data(), kernel, kernel_size, scale, zero_point, true);
+        }
+    }
+
+    if (graph.save(param_path, bin_path) != 0) {
+        LOG(ERROR) << "Can not save pnnx graph: " << param_path;
+        return false;
+    }
+    return table.Save(table_path);
+}
+
+// 多个样本上误差的累计
+struct DriftAccumulator {
+    TensorErrorStats stats;
+    double sum_abs = 0.;
+    double sum_magnitude = 0.;
+    uint64_t count = 0;
+
+    void Add(const std::vector<sftensor>& actual, const std::vector<sftensor>& expected) {
+        CHECK_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); ++i) {
+            const TensorErrorStats& item = TensorCompare(actual.at(i), expected.at(i));
+            this->stats.max_abs = std::max(this->stats.max_abs, item.max_abs);
+            this->stats.max_rel = std::max(this->stats.max_rel, item.max_rel);
+            this->sum_abs += double(item.mean_abs) * actual.at(i)->size();
+            const float* expected_ptr = expected.at(i)->raw_ptr();
+            for (uint32_t j = 0; j < expected.at(i)->size(); ++j) {
+                this->sum_magnitude += std::fabs(expected_ptr[j]);
+            }
+            this->count += actual.at(i)->size();
+        }
+    }
+
+    TensorErrorStats Result() const {
+        TensorErrorStats result = this->stats;
+        result.mean_abs = this->count == 0 ? 0.f : float(this->sum_abs / this->count);
+        return result;
+    }
+};
+
+std::vector<LayerDrift> Calibrator::MeasureDrift(const QuantTable& table, const std::string& quantized_param_path,
+                                                 const std::string& quantized_bin_path,
+                                                 const std::vector<sftensor>& samples) {
+    CHECK(!samples.empty());
+    RuntimeGraph quantized(quantized_param_path, quantized_bin_path);
+    quantized.set_reserve_halo(false);
+    // 和 fp32 计算图逐层比较，算子要一一对应
+    quantized.set_fold_batchnorm(false);
+    quantized.Build(this->input_name_, this->output_name_);
+
+    // 操作数名 -> 生产者和消费者
+    // 生产者在 float_layers 里，或者消费者全部在 float_layers 里时，这个操作数保持 fp32
+    std::map<std::string, std::shared_ptr<RuntimeOperator>> float_ops;
+    std::map<std::string, std::string> producers;
+    std::map<std::string, std::vector<std::string>> consumers;
+    for (const auto& op : this->graph_.topo_operators()) {
+        float_ops.insert({op->name, op});
+        if (op->output_operands != nullptr) {
+            producers.insert({op->output_operands->name, op->name});
+        }
+        for (const auto& operand : op->input_operands_seq) {
+            consumers[operand->name].push_back(op->name);
+        }
+    }
+    auto activation_params = [&](const std::string& operand_name) -> const QuantParams* {
+        auto producer = producers.find(operand_name);
+        if (producer != producers.end() && table.float_layers.count(producer->second)) {
+            return nullptr;
+        }
+        const std::vector<std::string>& operand_consumers = consumers[operand_name];
+        if (!operand_consumers.empty() &&
+            std::all_of(operand_consumers.begin(), operand_consumers.end(),
+                        [&](const std::string& name) { return table.float_layers.count(name) != 0; })) {
+            return nullptr;
+        }
+        auto params = table.activations.find(operand_name);
+        return params == table.activations.end() ? nullptr : &params->second;
+    };
+    auto quantize_outputs = [&](const std::shared_ptr<RuntimeOperand>& operand) {
+        const QuantParams* params = operand == nullptr ? nullptr : activation_params(operand->name);
+        if (params != nullptr) {
+            for (const sftensor& tensor : operand->tensors) {
+                FakeQuantize(tensor, *params);
+            }
+        }
+    };
+    quantized.set_output_hook([&](const std::shared_ptr<RuntimeOperator>& op) {
+        quantize_outputs(op->output_operands);
+    });
+
+    std::map<std::string, DriftAccumulator> isolated;
+    std::map<std::string, DriftAccumulator> cumulative;
+    for (const sftensor& sample : samples) {
+        this->graph_.Forward(std::vector<sftensor>{sample});
+
+        // 每一层单独量化：输入是 fp32 计算图的结果再模拟量化，保持 fp32 的层直接用准确的输入
+        for (const auto& op : quantized.topo_operators()) {
+            if (op->type == "pnnx.Input" || op->type == "pnnx.Output") {
+                continue;
+            }
+            const std::shared_ptr<RuntimeOperator>& float_op = float_ops.at(op->name);
+            const bool is_float = table.float_layers.count(op->name) != 0;
+            std::vector<sftensor> inputs;
+            for (const auto& operand : float_op->input_operands_seq) {
+                const QuantParams* params = is_float ? nullptr : activation_params(operand->name);
+                for (const sftensor& tensor : operand->tensors) {
+                    inputs.push_back(params == nullptr ? tensor : TensorClone(tensor));
+                    if (params != nullptr) {
+                        FakeQuantize(inputs.back(), *params);
+                    }
+                }
+            }
+            std::vector<sftensor> outputs(1);
+            op->layer->Forward(inputs, outputs);
+            const QuantParams* params = activation_params(float_op->output_operands->name);
+            for (const sftensor& output : outputs) {
+                if (params != nullptr) {
+                    FakeQuantize(output, *params);
+                }
+            }
+            isolated[op->name].Add(outputs, float_op->output_operands->tensors);
+        }
+
+        // 所有层都量化
+        sftensor input = TensorClone(sample);
+        for (const auto& op : quantized.topo_operators()) {
+            if (op->type == "pnnx.Input") {
+                const QuantParams* params = activation_params(op->output_operands->name);
+                if (params != nullptr) {
+                    FakeQuantize(input, *params);
+                }
+            }
+        }
+        quantized.Forward(std::vector<sftensor>{input});
+        for (const auto& op : quantized.topo_operators()) {
+            if (op->type == "pnnx.Input" || op->type == "pnnx.Output") {
+                continue;
+            }
+            cumulative[op->name].Add(op->output_operands->tensors, float_ops.at(op->name)->output_operands->tensors);
+        }
+    }
+    quantized.set_output_hook(nullptr);
+
+    std::vector<LayerDrift> drifts;
+    for (const auto& op : quantized.topo_operators()) {
+        if (op->type == "pnnx.Input" || op->type == "pnnx.Output") {
+            continue;
+        }
+        LayerDrift drift;
+        drift.name = op->name;
+        drift.type = op->type;
+        drift.isolated = isolated.at(op->name).Result();
+        drift.cumulative = cumulative.at(op->name).Result();
+        const DriftAccumulator& accumulator = cumulative.at(op->name);
+        drift.magnitude = accumulator.count == 0 ? 0.f : float(accumulator.sum_magnitude / accumulator.count);
+        drifts.push_back(drift);
+    }
+    return drifts;
+}
+
+}
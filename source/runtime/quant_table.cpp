@@ -0,0 +1,125 @@
+#include "runtime/quant_table.hpp"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+std::string QuantTable::TablePath(const std::string& param_path) {
+    const std::string suffix = ".param";
+    if (param_path.size() > suffix.size() &&
+        param_path.compare(param_path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return param_path.substr(0, param_path.size() - suffix.size()) + ".qtable";
+    }
+    return param_path + ".qtable";
+}
+
+// scale 用 9 位有效数字，读回后和原来的 float 完全相同
+static void WriteParams(std::ostream& out, const std::string& kind, const std::string& name,
+                        const QuantParams& params) {
+    out << kind << " " << name << " " << int(params.is_signed) << " " << params.scales.size();
+    for (size_t i = 0; i < params.scales.size(); ++i) {
+        out << " " << std::setprecision(9) << params.scales.at(i) << " " << params.zero_points.at(i);
+    }
+    out << "\n";
+}
+
+static bool ReadParams(std::istringstream& in, QuantParams& params) {
+    int is_signed = 0;
+    size_t count = 0;
+    if (!(in >> is_signed >> count) || count == 0) {
+        return false;
+    }
+    params.is_signed = is_signed != 0;
+    params.scales.resize(count);
+    params.zero_points.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!(in >> params.scales.at(i) >> params.zero_points.at(i)) || params.scales.at(i) <= 0.f ||
+            params.zero_points.at(i) < params.qmin() || params.zero_points.at(i) > params.qmax()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QuantTable::Save(const std::string& path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.good()) {
+        LOG(ERROR) << "Can not open quant table: " << path;
+        return false;
+    }
+    this->Write(out);
+    return out.good();
+}
+
+void QuantTable::Write(std::ostream& out) const {
+    out << "kuiper_quant_table " << kTableVersion << "\n";
+    for (const auto& [name, params] : this->activations) {
+        WriteParams(out, "activation", name, params);
+    }
+    for (const auto& [name, params] : this->weights) {
+        WriteParams(out, "weight", name, params);
+    }
+    for (const std::string& name : this->float_layers) {
+        out << "float " << name << "\n";
+    }
+}
+
+bool QuantTable::Load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        return false;
+    }
+    std::string magic;
+    uint32_t version = 0;
+    if (!(in >> magic >> version) || magic != "kuiper_quant_table" || version != kTableVersion) {
+        LOG(ERROR) << "Invalid quant table: " << path;
+        return false;
+    }
+
+    QuantTable table;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream line_in(line);
+        std::string kind;
+        std::string name;
+        if (!(line_in >> kind)) {
+            continue;
+        }
+        if (!(line_in >> name)) {
+            LOG(ERROR) << "Invalid quant table line: " << line;
+            return false;
+        }
+        QuantParams params;
+        if (kind == "activation" && ReadParams(line_in, params)) {
+            table.activations[name] = params;
+        } else if (kind == "weight" && ReadParams(line_in, params)) {
+            table.weights[name] = params;
+        } else if (kind == "float") {
+            table.float_layers.insert(name);
+        } else {
+            LOG(ERROR) << "Invalid quant table line: " << line;
+            return false;
+        }
+    }
+    *this = std::move(table);
+    return true;
+}
+
+bool QuantTable::empty() const {
+    return this->activations.empty() && this->weights.empty();
+}
+
+uint64_t QuantTable::Hash() const {
+    std::ostringstream out;
+    this->Write(out);
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char ch : out.str()) {
+        hash = (hash ^ uint8_t(ch)) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+}
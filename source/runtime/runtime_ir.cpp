@@ -1,14 +1,28 @@
 #include "runtime/runtime_ir.hpp"
+#include <algorithm>
 #include <memory>
 #include <iostream>
 #include <iomanip>
 #include <queue>
 #include <utility>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include "data/load_data.hpp"
 #include "factory/layer_factory.hpp"
+#include "factory/op_factory.hpp"
+#include "ops/batchnorm_op.hpp"
+#include "ops/conv_op.hpp"
+#include "runtime/runtime_plan.hpp"
 
 namespace kuiper_infer {
     
 RuntimeGraph::RuntimeGraph(std::string param_path, std::string bin_path) : param_path_(std::move(param_path)), bin_path_(std::move(bin_path)) {
+    const char* dump_dir = std::getenv("KUIPER_DUMP_DIR");
+    if (dump_dir != nullptr) {
+        this->set_dump_dir(dump_dir);
+    }
     std::cout << "param_path: " << this->param_path_ << std::endl;
     std::cout << "bin_path: " << this->bin_path_ << std::endl;
 }
@@ -29,6 +43,133 @@ const std::string& RuntimeGraph::bin_path() const {
     return this->bin_path_;
 }
 
+void RuntimeGraph::set_plan_cache(bool plan_cache) {
+    this->plan_cache_ = plan_cache;
+}
+
+bool RuntimeGraph::plan_cache() const {
+    return this->plan_cache_;
+}
+
+bool RuntimeGraph::loaded_from_plan() const {
+    return this->loaded_from_plan_;
+}
+
+void RuntimeGraph::set_share_weights(bool share_weights) {
+    this->share_weights_ = share_weights;
+}
+
+bool RuntimeGraph::share_weights() const {
+    return this->share_weights_;
+}
+
+void RuntimeGraph::set_reserve_halo(bool reserve_halo) {
+    this->reserve_halo_ = reserve_halo;
+}
+
+bool RuntimeGraph::reserve_halo() const {
+    return this->reserve_halo_;
+}
+
+void RuntimeGraph::set_fold_batchnorm(bool fold_batchnorm) {
+    this->fold_batchnorm_ = fold_batchnorm;
+}
+
+bool RuntimeGraph::fold_batchnorm() const {
+    return this->fold_batchnorm_;
+}
+
+void RuntimeGraph::set_weight_type(RuntimeDataType weight_type) {
+    CHECK(weight_type == RuntimeDataType::kTypeFloat32 || weight_type == RuntimeDataType::kTypeFloat16 ||
+          weight_type == RuntimeDataType::kTypeBFloat16 || weight_type == RuntimeDataType::kTypeInt8 ||
+          weight_type == RuntimeDataType::kTypeInt4)
+        << "Unsupported weight type " << int(weight_type);
+    this->weight_type_ = weight_type;
+}
+
+RuntimeDataType RuntimeGraph::weight_type() const {
+    return this->weight_type_;
+}
+
+void RuntimeGraph::set_quant_table(const std::string& table_path) {
+    this->quant_table_path_ = table_path;
+}
+
+const std::string& RuntimeGraph::quant_table() const {
+    return this->quant_table_path_;
+}
+
+void RuntimeGraph::set_auto_tune(bool auto_tune) {
+    this->auto_tune_ = auto_tune;
+}
+
+bool RuntimeGraph::auto_tune() const {
+    return this->auto_tune_;
+}
+
+void RuntimeGraph::set_tuning_cache(const std::string& cache_path) {
+    this->tuning_cache_path_ = cache_path;
+}
+
+std::string RuntimeGraph::tuning_cache() const {
+    return this->tuning_cache_path_.empty() ? TuningCache::CachePath(this->param_path_) : this->tuning_cache_path_;
+}
+
+void RuntimeGraph::set_output_hook(OutputHook hook) {
+    this->output_hook_ = std::move(hook);
+}
+
+void RuntimeGraph::set_profiler(std::shared_ptr<RuntimeProfiler> profiler) {
+    this->profiler_ = std::move(profiler);
+}
+
+const std::shared_ptr<RuntimeProfiler>& RuntimeGraph::profiler() const {
+    return this->profiler_;
+}
+
+void RuntimeGraph::set_dump_dir(const std::string& dump_dir) {
+    this->dump_dir_ = dump_dir;
+    if (!dump_dir.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(dump_dir, error);
+        LOG_IF(ERROR, error) << "Can not create dump dir: " << dump_dir << " " << error.message();
+    }
+}
+
+const std::string& RuntimeGraph::dump_dir() const {
+    return this->dump_dir_;
+}
+
+void RuntimeGraph::DumpOutputs(const std::shared_ptr<RuntimeOperator>& op) const {
+    const auto& outputs = op->output_operands->tensors;
+    for (uint32_t i = 0; i < outputs.size(); ++i) {
+        const auto& output = outputs.at(i);
+        if (output == nullptr || output->empty()) {
+            continue;
+        }
+
+        // 通道依次纵向拼接 (channels * rows, cols)，输出带边框时只保存内部
+        const Halo& halo = op->layer->output_halo();
+        const uint32_t rows = output->rows() - 2 * halo.h;
+        const uint32_t cols = output->cols() - 2 * halo.w;
+        arma::fmat stacked(output->channels() * rows, cols);
+        for (uint32_t c = 0; c < output->channels(); ++c) {
+            const arma::fmat& channel = output->slice(c);
+            for (uint32_t col = 0; col < cols; ++col) {
+                for (uint32_t row = 0; row < rows; ++row) {
+                    stacked.at(c * rows + row, col) = channel.at(row + halo.h, col + halo.w);
+                }
+            }
+        }
+
+        // 算子名里可能有 '/' 等字符
+        std::string file_name = op->name;
+        std::replace(file_name.begin(), file_name.end(), '/', '_');
+        const std::string file_path = this->dump_dir_ + "/" + file_name + "_" + std::to_string(i) + ".csv";
+        CSVDataLoader::SaveData(file_path, stacked);
+    }
+}
+
 
 // pnnx::Graph里有操作数表和算子表
 // 但实际上每个Operator和每个Operand都相互指向
@@ -42,6 +183,82 @@ bool RuntimeGraph::Init() {
         return false;
     }
 
+    // 模型的 key 同时用于执行计划缓存和权重共享
+    this->model_key_ = 0;
+    this->weights_.reset();
+    if (this->plan_cache_ || this->share_weights_) {
+        this->model_key_ = RuntimePlan::PlanKey(this->param_path_, this->bin_path_);
+    }
+
+    // 优先从执行计划缓存恢复算子，跳过 pnnx 的解析
+    std::string plan_path;
+    this->loaded_from_plan_ = false;
+    if (this->plan_cache_) {
+        plan_path = RuntimePlan::PlanPath(this->param_path_);
+        if (this->model_key_ != 0 && RuntimePlan::Load(plan_path, this->model_key_, this->operators_)) {
+            this->loaded_from_plan_ = true;
+        }
+    }
+
+    if (!this->loaded_from_plan_) {
+        if (!InitFromPnnx()) {
+            return false;
+        }
+        if (this->plan_cache_ && this->model_key_ != 0) {
+            RuntimePlan::Save(plan_path, this->model_key_, this->operators_);
+        }
+        // 算子已经转换为 RuntimeOperator，pnnx 计算图里的权重不再需要
+        this->graph_.reset();
+    }
+
+    // 执行计划缓存里保存的是融合前的计算图，BatchNorm 折叠在压缩和量化之前，使用 fp32 权重
+    if (this->fold_batchnorm_) {
+        FoldBatchNorm();
+    }
+    FuseActivations();
+
+    // 执行计划缓存里保存的是 fp32 权重，恢复后再压缩
+    // 只量化权重时属性保持 fp32，创建卷积算子时量化卷积核后释放
+    if (this->weight_type_ == RuntimeDataType::kTypeFloat16 || this->weight_type_ == RuntimeDataType::kTypeBFloat16) {
+        CompressAttrs();
+    }
+
+    this->quant_table_.reset();
+    if (!this->quant_table_path_.empty()) {
+        std::shared_ptr<QuantTable> quant_table = std::make_shared<QuantTable>();
+        if (quant_table->Load(this->quant_table_path_) && !quant_table->empty()) {
+            this->quant_table_ = quant_table;
+        } else {
+            LOG(WARNING) << "Can not load quant table: " << this->quant_table_path_ << ", fall back to fp32";
+        }
+    }
+
+    if (this->share_weights_ && this->model_key_ != 0) {
+        ShareAttrs();
+    }
+
+    for (const auto& cur_op : this->operators_) {
+        // 输出节点的名字在InitOperatorOutputs函数里得到
+        // 为什么不在得到输出节点的名字的时候就加入{next_op->name, next_op}，因此那个时候，输出节点还有被初始化完成RuntimeOperator，还有param和attr
+        const std::vector<std::string>& output_names = cur_op->output_names;
+
+        for (const auto& next_op : this->operators_) {
+            if (next_op == cur_op) {
+                continue;
+            }
+            if (std::find(output_names.begin(), output_names.end(), next_op->name) != output_names.end()) {
+                // 将输出算子的名字和算子关联
+                cur_op->output_operators.insert({next_op->name, next_op});
+            }
+        }
+    }
+
+    graph_state_ = GraphState::kToBuild;
+
+    return true;
+}
+
+bool RuntimeGraph::InitFromPnnx() {
     this->graph_ = std::make_unique<pnnx::Graph>();
     int load_status = this->graph_->load(this->param_path_, this->bin_path_);
     // 加载pnnx计算图
@@ -107,26 +324,6 @@ bool RuntimeGraph::Init() {
 
         }
     }
-
-    
-    for (const auto& cur_op : this->operators_) {
-        // 输出节点的名字在InitOperatorOutputs函数里得到
-        // 为什么不在得到输出节点的名字的时候就加入{next_op->name, next_op}，因此那个时候，输出节点还有被初始化完成RuntimeOperator，还有param和attr
-        const std::vector<std::string>& output_names = cur_op->output_names;
-
-        for (const auto& next_op : this->operators_) {
-            if (next_op == cur_op) {
-                continue;
-            }
-            if (std::find(output_names.begin(), output_names.end(), next_op->name) != output_names.end()) {
-                // 将输出算子的名字和算子关联
-                cur_op->output_operators.insert({next_op->name, next_op});
-            }
-        }
-    }
-
-    graph_state_ = GraphState::kToBuild;
-
     return true;
 }
 
@@ -170,6 +367,14 @@ void RuntimeGraph::InitOperatorOutputs(const std::vector<pnnx::Operand*>& output
             continue;
         }
         // 遍历所有生产者就可以得到所有operands，因此不需要将消费者转为RuntimeOperand
+        // 这里只记录输出操作数的名字和形状，Build 时再和消费者的输入操作数连接
+        if (!runtime_operator->output_operands) {
+            std::shared_ptr<RuntimeOperand> runtime_operand = std::make_shared<RuntimeOperand>();
+            runtime_operand->name = output->name;
+            runtime_operand->shape = output->shape;
+            runtime_operand->type = output->type == 1 ? RuntimeDataType::kTypeFloat32 : RuntimeDataType::kTypeUnknown;
+            runtime_operator->output_operands = runtime_operand;
+        }
         const auto& consumers = output->consumers;
         // 可能会有多个消费者
         for (const auto &c : consumers) {
@@ -278,6 +483,16 @@ void RuntimeGraph::InitGraphAttrs(const std::map<std::string, pnnx::Attribute>&
                 runtime_operator->attrs.insert({name, runtime_attribute});
                 break;
             }
+            case 3 : {
+                std::shared_ptr<RuntimeAttribute> runtime_attribute = std::make_shared<RuntimeAttribute>();
+
+                runtime_attribute->type = RuntimeDataType::kTypeFloat16;
+                runtime_attribute->shape = attribute.shape;
+                runtime_attribute->weight_data = attribute.data;
+
+                runtime_operator->attrs.insert({name, runtime_attribute});
+                break;
+            }
             default: {
                 LOG(FATAL) << "unknown attribute type" << attribute.type;
             }
@@ -292,40 +507,549 @@ const std::vector<std::shared_ptr<RuntimeOperator>> RuntimeGraph::operators() co
     return this->operators_;
 }
 
-// //void Build(const std::string& input_name, const std::string& output_name);
-// void RuntimeGraph::Build(const std::string& input_name, const std::string& output_name) {
-//     if (graph_state_ == GraphState::kToInit) {
-//         bool init_graph = Init();
-//         LOG_IF(FATAL, !init_graph) << "Init graph failed!";
-//     }
+const std::vector<std::shared_ptr<RuntimeOperator>>& RuntimeGraph::topo_operators() const {
+    return this->topo_operators_;
+}
+
+void RuntimeGraph::Build(const std::string& input_name, const std::string& output_name) {
+    if (graph_state_ == GraphState::kToInit) {
+        bool init_graph = Init();
+        LOG_IF(FATAL, !init_graph) << "Init graph failed!";
+    }
+
+    // 初始化之后,得到了所有的operators和operands
+    // 以及算子之间的关系
 
-//     // 初始化之后,得到了所有的operators和operands
-//     // 以及算子之间的关系
+    CHECK(graph_state_ >= GraphState::kToBuild)
+        << "Graph status error, current state is " << int(graph_state_);
 
-//     CHECK(graph_state_ >= GraphState::kToBuild)
-//         << "Graph status error, current state is " << int(graph_state_);
+    LOG_IF(FATAL, this->operators_.empty())
+          << "Graph operators is empty, init may failed";
 
-//     LOG_IF(FATAL, this->operators_.empty())
-//           << "Graph operators is empty, init may failed";
+    if (graph_state_ == GraphState::kComplete) {
+        return;
+    }
+
+    this->input_operators_map_.clear();
+    this->output_operators_map_.clear();
+
+    TuningCache tuning_cache;
+    bool cache_changed = false;
+    if (this->auto_tune_) {
+        tuning_cache.Load(this->tuning_cache());
+    }
+    for (const auto& op : this->operators_) {
+        if (op->type == "pnnx.Input") {
+            this->input_operators_map_.insert({op->name, op});
+        } else if (op->type == "pnnx.Output") {
+            this->output_operators_map_.insert({op->name, op});
+        } else {
+            // 根据节点的参数和权重构造 Operator，再从注册表创建 Layer
+            op->layer_op = CreateOperator(op);
+            op->layer = CreateLayer(op, op->layer_op, tuning_cache, cache_changed);
+        }
+    }
+    if (cache_changed) {
+        tuning_cache.Save(this->tuning_cache());
+    }
+
+    // 每个消费者解析时都复制了一份输入操作数
+    // 这里统一指向生产者的输出操作数，前向时生产者写入的张量消费者直接可见
+    for (const auto& op : this->operators_) {
+        const std::shared_ptr<RuntimeOperand>& output_operand = op->output_operands;
+        if (!output_operand) {
+            continue;
+        }
+        for (const auto& [next_name, next_op] : op->output_operators) {
+            auto input_operand = next_op->input_operands.find(op->name);
+            CHECK(input_operand != next_op->input_operands.end())
+                << "Operator " << next_name << " has no input from " << op->name;
 
-//     this->input_operators_map_.clear();
-//     this->output_operators_map_.clear();
+            for (auto& operand : next_op->input_operands_seq) {
+                if (operand == input_operand->second) {
+                    operand = output_operand;
+                }
+            }
+            input_operand->second = output_operand;
+        }
+    }
 
-//     for (const auto& op : this->operators_) {
-//         if (op->type == "pnnx.Input") {
-//             this->input_operators_map_.insert({op->name, op});
-//             } else if (op->type == "pnnx.Output") {
-//                 this->output_operators_map_.insert({op->name, op});
-//     } else {
-//       // 以后的课中加layer的
-//       }
-//     }
+    TopoSort();
 
-//     input_name_ = input_name;
-//     output_name_ = output_name;
-//     graph_state_ = GraphState::kComplete;
+    CHECK(this->input_operators_map_.count(input_name)) << "Can not find the input operator: " << input_name;
+    CHECK(this->output_operators_map_.count(output_name)) << "Can not find the output operator: " << output_name;
 
-// }
+    input_name_ = input_name;
+    output_name_ = output_name;
 
+    // 输入边的排布：只有一个输入且能读取任意步长视图的消费者直接读取视图
+    // 其他消费者(包括输出节点)读取转换后的列主序张量
+    this->view_consumers_.clear();
+    this->input_needs_tensor_ = false;
+    const auto& input_op = this->input_operators_map_.at(input_name_);
+    for (const auto& [next_name, next_op] : input_op->output_operators) {
+        if (next_op->layer != nullptr && next_op->input_operands_seq.size() == 1 &&
+            next_op->layer->AcceptsStridedViews()) {
+            this->view_consumers_.insert(next_op.get());
+        } else {
+            this->input_needs_tensor_ = true;
+        }
+    }
+    if (this->reserve_halo_) {
+        PlanHalos();
+    }
+    graph_state_ = GraphState::kComplete;
+}
+
+std::shared_ptr<Layer> RuntimeGraph::CreateLayer(const std::shared_ptr<RuntimeOperator>& op,
+                                                 const std::shared_ptr<Operator>& layer_op, TuningCache& cache,
+                                                 bool& cache_changed) const {
+    const std::vector<std::string>& candidates = LayerRegister::Implementations(layer_op);
+    CHECK(!candidates.empty()) << "Can not find the layer type: " << int(layer_op->op_type_);
+    std::string name = candidates.front();
+    if (this->auto_tune_ && candidates.size() > 1) {
+        // 缓存里的实现不再适用(例如权重改为 int8)时重新计时
+        const std::string& key = LayerTuner::TuningKey(*op);
+        auto iter = cache.entries.find(key);
+        if (iter != cache.entries.end() &&
+            std::find(candidates.begin(), candidates.end(), iter->second) != candidates.end()) {
+            name = iter->second;
+        } else {
+            const std::string& fastest = LayerTuner::SelectFastest(*op, layer_op, candidates);
+            if (!fastest.empty()) {
+                name = fastest;
+                cache.entries[key] = fastest;
+                cache_changed = true;
+            }
+        }
+    }
+    op->layer_impl = name;
+    std::shared_ptr<Layer> layer = LayerRegister::CreateLayer(layer_op, name);
+    LOG_IF(FATAL, !layer) << "Layer init failed!";
+    return layer;
+}
+
+void RuntimeGraph::PlanHalos() {
+    // 生产者的所有消费者都在计算前做相同的 padding 时，生产者的输出直接预留这圈边框
+    // 消费者读取带边框的输入，稳态下 padding 不再分配和复制
+    for (const auto& op : this->operators_) {
+        if (op->layer == nullptr || !op->layer->SupportsOutputHalo() || op->output_operators.empty()) {
+            continue;
+        }
+
+        std::optional<Halo> halo;
+        for (const auto& [next_name, next_op] : op->output_operators) {
+            if (next_op->layer == nullptr || next_op->input_operands_seq.size() != 1) {
+                halo.reset();
+                break;
+            }
+            const Halo& padding = next_op->layer->InputPadding();
+            if (padding.empty() || (halo.has_value() && *halo != padding)) {
+                halo.reset();
+                break;
+            }
+            halo = padding;
+        }
+        if (!halo.has_value()) {
+            continue;
+        }
+
+        op->layer->set_output_halo(*halo);
+        for (const auto& [next_name, next_op] : op->output_operators) {
+            next_op->layer->set_input_halo(*halo);
+        }
+    }
+}
+
+void RuntimeGraph::CompressAttrs() {
+    const HalfType half_type =
+        this->weight_type_ == RuntimeDataType::kTypeFloat16 ? HalfType::kFloat16 : HalfType::kBFloat16;
+    for (const auto& op : this->operators_) {
+        for (auto& [name, attr] : op->attrs) {
+            if (attr->type != RuntimeDataType::kTypeFloat32) {
+                continue;
+            }
+            const size_t count = attr->weight_data.size() / sizeof(float);
+            std::vector<char> half_data(count * sizeof(uint16_t));
+            ConvertToHalf((const float*)attr->weight_data.data(), (uint16_t*)half_data.data(), count, half_type);
+            attr->weight_data = std::move(half_data);
+            attr->type = this->weight_type_;
+        }
+    }
+}
+
+// producer 的唯一消费者 op 被合并到 producer 里: producer 直接输出 op 的输出操作数，op 的消费者改为从 producer 读取
+static void BypassOperator(const std::shared_ptr<RuntimeOperator>& producer, const std::shared_ptr<RuntimeOperator>& op,
+                           const std::map<std::string, std::shared_ptr<RuntimeOperator>>& operators_by_name) {
+    producer->output_operands = op->output_operands;
+    producer->output_names = op->output_names;
+    for (const std::string& next_name : op->output_names) {
+        auto next_op = operators_by_name.find(next_name);
+        CHECK(next_op != operators_by_name.end()) << "Can not find the operator: " << next_name;
+        auto& input_operands = next_op->second->input_operands;
+        auto input_operand = input_operands.find(op->name);
+        if (input_operand != input_operands.end()) {
+            std::shared_ptr<RuntimeOperand> operand = input_operand->second;
+            input_operands.erase(input_operand);
+            input_operands.insert({producer->name, operand});
+        }
+    }
+}
+
+static void RemoveOperators(std::vector<std::shared_ptr<RuntimeOperator>>& operators,
+                            const std::set<std::string>& names) {
+    operators.erase(std::remove_if(operators.begin(), operators.end(),
+                                   [&names](const std::shared_ptr<RuntimeOperator>& op) {
+                                       return names.count(op->name) != 0;
+                                   }),
+                    operators.end());
+}
+
+void RuntimeGraph::FoldBatchNorm() {
+    std::map<std::string, std::shared_ptr<RuntimeOperator>> operators_by_name;
+    for (const auto& op : this->operators_) {
+        operators_by_name.insert({op->name, op});
+    }
+
+    // 推理时 BatchNorm 是每个通道的 y = x * scale + shift，卷积的第 k 个卷积核和 bias 乘上 scale[k]，bias 再加上 shift[k]
+    this->folded_convs_.clear();
+    std::set<std::string> folded;
+    for (const auto& bn : this->operators_) {
+        if (bn->type != "nn.BatchNorm2d" || bn->input_operands.size() != 1 || bn->input_operands_seq.size() != 1) {
+            continue;
+        }
+        auto producer = operators_by_name.find(bn->input_operands.begin()->first);
+        if (producer == operators_by_name.end()) {
+            continue;
+        }
+        // 卷积的输出还有其他消费者时需要保留折叠前的结果，不能折叠
+        const std::shared_ptr<RuntimeOperator>& conv = producer->second;
+        if (conv->type != "nn.Conv2d" || conv->output_names != std::vector<std::string>{bn->name} ||
+            !conv->attrs.count("weight") || !conv->params.count("bias")) {
+            continue;
+        }
+        auto has_bias = dynamic_cast<RuntimeParameterBool*>(conv->params.at("bias"));
+        const std::shared_ptr<RuntimeAttribute>& weight_attr = conv->attrs.at("weight");
+        if (has_bias == nullptr || weight_attr->shape.empty() || (has_bias->value && !conv->attrs.count("bias"))) {
+            continue;
+        }
+        std::shared_ptr<BatchNormOp> bn_op = std::dynamic_pointer_cast<BatchNormOp>(OpRegister::CreateOperator(bn));
+        CHECK(bn_op != nullptr) << "Can not create BatchNorm operator " << bn->name;
+        const uint32_t kernel_count = weight_attr->shape.front();
+        if (kernel_count != bn_op->channels()) {
+            LOG(WARNING) << "BatchNorm " << bn->name << " does not match the channels of " << conv->name;
+            continue;
+        }
+        const std::vector<float>& scale = bn_op->scale();
+        const std::vector<float>& shift = bn_op->shift();
+
+        // 权重是行主序的 (out, in / groups, kh, kw)，每个卷积核连续存储
+        std::vector<float> weights = weight_attr->get<float>();
+        const size_t kernel_size = weights.size() / kernel_count;
+        for (uint32_t k = 0; k < kernel_count; ++k) {
+            for (size_t j = 0; j < kernel_size; ++j) {
+                weights.at(k * kernel_size + j) *= scale.at(k);
+            }
+        }
+        std::vector<float> bias(kernel_count, 0.f);
+        if (has_bias->value) {
+            bias = conv->attrs.at("bias")->get<float>();
+            CHECK_EQ(bias.size(), kernel_count);
+        }
+        for (uint32_t k = 0; k < kernel_count; ++k) {
+            bias.at(k) = bias.at(k) * scale.at(k) + shift.at(k);
+        }
+
+        auto make_attr = [](const std::vector<float>& values, const std::vector<int>& shape) {
+            std::shared_ptr<RuntimeAttribute> attr = std::make_shared<RuntimeAttribute>();
+            attr->type = RuntimeDataType::kTypeFloat32;
+            attr->shape = shape;
+            attr->weight_data.resize(values.size() * sizeof(float));
+            std::memcpy(attr->weight_data.data(), values.data(), attr->weight_data.size());
+            return attr;
+        };
+        conv->attrs["weight"] = make_attr(weights, weight_attr->shape);
+        conv->attrs["bias"] = make_attr(bias, {int(kernel_count)});
+        has_bias->value = true;
+
+        BypassOperator(conv, bn, operators_by_name);
+        folded.insert(bn->name);
+        this->folded_convs_.insert(conv->name);
+    }
+    RemoveOperators(this->operators_, folded);
+}
+
+void RuntimeGraph::FuseActivations() {
+    std::map<std::string, std::shared_ptr<RuntimeOperator>> operators_by_name;
+    for (const auto& op : this->operators_) {
+        operators_by_name.insert({op->name, op});
+    }
+
+    // 全连接层的输出只给一个 ReLU 或 Sigmoid 时，激活函数在矩阵乘的 epilogue 里计算
+    std::set<std::string> fused;
+    for (const auto& activation : this->operators_) {
+        std::string activation_name;
+        if (activation->type == "nn.ReLU" || activation->type == "F.relu") {
+            activation_name = "relu";
+        } else if (activation->type == "nn.Sigmoid" || activation->type == "F.sigmoid") {
+            activation_name = "sigmoid";
+        }
+        if (activation_name.empty() || activation->input_operands.size() != 1 ||
+            activation->input_operands_seq.size() != 1) {
+            continue;
+        }
+        auto producer = operators_by_name.find(activation->input_operands.begin()->first);
+        if (producer == operators_by_name.end()) {
+            continue;
+        }
+        const std::shared_ptr<RuntimeOperator>& linear = producer->second;
+        if (linear->type != "nn.Linear" || linear->output_names != std::vector<std::string>{activation->name} ||
+            linear->params.count("activation")) {
+            continue;
+        }
+        RuntimeParameterString* parameter = new RuntimeParameterString;
+        parameter->value = activation_name;
+        linear->params.insert({"activation", parameter});
+        BypassOperator(linear, activation, operators_by_name);
+        fused.insert(activation->name);
+    }
+    RemoveOperators(this->operators_, fused);
+}
+
+void RuntimeGraph::ShareAttrs() {
+    // 不同存储类型的权重不能共享，类型混入 key 里区分
+    uint64_t store_key = this->model_key_;
+    if (this->weight_type_ != RuntimeDataType::kTypeFloat32) {
+        store_key ^= (uint64_t(this->weight_type_) + 1) * 0x9E3779B97F4A7C15ull;
+    }
+    if (this->quant_table_ != nullptr) {
+        store_key ^= this->quant_table_->Hash();
+    }
+    // 折叠了 BatchNorm 的卷积权重和原始权重不同
+    if (!this->fold_batchnorm_) {
+        store_key ^= 0xC2B2AE3D27D4EB4Full;
+    }
+    this->weights_ = WeightStore::Acquire(store_key);
+    std::lock_guard<std::mutex> lock(this->weights_->mutex);
+
+    // 第一个计算图把自己的权重放入共享存储，之后的计算图丢弃自己解析的权重，改为引用共享的那份
+    for (const auto& op : this->operators_) {
+        if (op->attrs.empty()) {
+            continue;
+        }
+        auto shared_attrs = this->weights_->attrs.find(op->name);
+        if (shared_attrs == this->weights_->attrs.end()) {
+            this->weights_->attrs.insert({op->name, op->attrs});
+        } else {
+            CHECK_EQ(shared_attrs->second.size(), op->attrs.size());
+            op->attrs = shared_attrs->second;
+        }
+    }
+}
+
+std::shared_ptr<Operator> RuntimeGraph::CreateOperator(const std::shared_ptr<RuntimeOperator>& op) {
+    // 卷积核按 weight_type_ 压缩或量化存储，共享时只压缩一次
+    auto create = [this, &op]() {
+        std::shared_ptr<Operator> new_op = OpRegister::CreateOperator(op);
+        if (new_op == nullptr || new_op->op_type_ != OpType::kOperatorConv) {
+            return new_op;
+        }
+        std::shared_ptr<ConvOp> conv_op = std::dynamic_pointer_cast<ConvOp>(new_op);
+        // int8 卷积核从 fp32 权重量化，在压缩为半精度之前
+        if (this->quant_table_ != nullptr) {
+            QuantizeConv(op, *conv_op);
+        }
+        if (this->weight_type_ == RuntimeDataType::kTypeInt8 || this->weight_type_ == RuntimeDataType::kTypeInt4) {
+            conv_op->set_weight_bits(this->weight_type_ == RuntimeDataType::kTypeInt8 ? 8 : 4);
+        } else if (this->weight_type_ != RuntimeDataType::kTypeFloat32) {
+            conv_op->CompressWeights(
+                this->weight_type_ == RuntimeDataType::kTypeFloat16 ? HalfType::kFloat16 : HalfType::kBFloat16);
+        }
+        // 卷积核只保留 ConvOp 里的一份，属性只留下类型和形状，需要权重时从 RuntimeOperator::layer_op 读取
+        auto weight_attr = op->attrs.find("weight");
+        if (weight_attr != op->attrs.end()) {
+            std::vector<char>().swap(weight_attr->second->weight_data);
+        }
+        return new_op;
+    };
+
+    if (this->weights_ == nullptr) {
+        return create();
+    }
+
+    // Operator 创建后只读，同一模型的计算图共用一个，卷积核等打包好的权重也只有一份
+    std::lock_guard<std::mutex> lock(this->weights_->mutex);
+    auto shared_op = this->weights_->operators.find(op->name);
+    if (shared_op != this->weights_->operators.end()) {
+        return shared_op->second;
+    }
+    std::shared_ptr<Operator> new_op = create();
+    this->weights_->operators.insert({op->name, new_op});
+    return new_op;
+}
+
+void RuntimeGraph::QuantizeConv(const std::shared_ptr<RuntimeOperator>& op, ConvOp& conv_op) const {
+    const QuantTable& table = *this->quant_table_;
+    if (table.float_layers.count(op->name) || op->input_operands_seq.size() != 1 || op->output_operands == nullptr) {
+        return;
+    }
+    auto input_params = table.activations.find(op->input_operands_seq.front()->name);
+    if (input_params == table.activations.end()) {
+        return;
+    }
+
+    // 唯一的消费者是 nn.ReLU 时把 relu 融合到后处理里，按 ReLU 输出的参数重新量化
+    // ReLU 层照常执行，输入已经非负，结果不变
+    std::string output_name = op->output_operands->name;
+    bool relu = false;
+    if (op->output_operators.size() == 1) {
+        const std::shared_ptr<RuntimeOperator>& next_op = op->output_operators.begin()->second;
+        if (next_op->type == "nn.ReLU" && next_op->output_operands != nullptr &&
+            !table.float_layers.count(next_op->name) && table.activations.count(next_op->output_operands->name)) {
+            output_name = next_op->output_operands->name;
+            relu = true;
+        }
+    }
+    auto output_params = table.activations.find(output_name);
+    if (output_params == table.activations.end()) {
+        return;
+    }
+
+    // 表里没有卷积核参数时按输出通道对称量化
+    // 表里的参数对应折叠 BatchNorm 之前的卷积核，折叠过的卷积核也重新计算
+    QuantParams weight_params;
+    auto table_weights = table.weights.find(op->name);
+    if (table_weights != table.weights.end() && !this->folded_convs_.count(op->name)) {
+        weight_params = table_weights->second;
+        if (weight_params.per_channel() && weight_params.scales.size() != conv_op.kernel_count()) {
+            LOG(WARNING) << "Quant table does not match " << op->name << ", fall back to fp32";
+            return;
+        }
+    }
+    conv_op.EnableInt8(input_params->second, weight_params, output_params->second, relu);
+}
+
+// 按入度进行拓扑排序，入度为0的算子先执行
+void RuntimeGraph::TopoSort() {
+    std::map<std::string, uint32_t> in_degrees;
+    for (const auto& op : this->operators_) {
+        in_degrees.insert({op->name, 0});
+    }
+    for (const auto& op : this->operators_) {
+        for (const auto& [next_name, next_op] : op->output_operators) {
+            in_degrees.at(next_name) += 1;
+        }
+    }
+
+    std::queue<std::shared_ptr<RuntimeOperator>> ready_ops;
+    for (const auto& op : this->operators_) {
+        if (in_degrees.at(op->name) == 0) {
+            ready_ops.push(op);
+        }
+    }
+
+    this->topo_operators_.clear();
+    while (!ready_ops.empty()) {
+        std::shared_ptr<RuntimeOperator> op = ready_ops.front();
+        ready_ops.pop();
+        this->topo_operators_.push_back(op);
+
+        for (const auto& [next_name, next_op] : op->output_operators) {
+            uint32_t& in_degree = in_degrees.at(next_name);
+            in_degree -= 1;
+            if (in_degree == 0) {
+                ready_ops.push(next_op);
+            }
+        }
+    }
+
+    CHECK_EQ(this->topo_operators_.size(), this->operators_.size()) << "Graph has a cycle";
+}
+
+std::vector<std::shared_ptr<Tensor<float>>> RuntimeGraph::Forward(
+    const std::vector<std::shared_ptr<Tensor<float>>>& inputs) {
+    CHECK(graph_state_ == GraphState::kComplete) << "Graph need to be built before forward";
+    CHECK(!inputs.empty());
+
+    const auto& input_op = this->input_operators_map_.at(input_name_);
+    CHECK(input_op->output_operands != nullptr);
+    input_op->output_operands->tensors = inputs;
+
+    Run(inputs.size(), nullptr);
+
+    const auto& output_op = this->output_operators_map_.at(output_name_);
+    CHECK(!output_op->input_operands_seq.empty());
+    return output_op->input_operands_seq.front()->tensors;
+}
+
+std::vector<std::shared_ptr<Tensor<float>>> RuntimeGraph::Forward(const std::vector<TensorView>& inputs) {
+    CHECK(graph_state_ == GraphState::kComplete) << "Graph need to be built before forward";
+    CHECK(!inputs.empty());
+
+    uint32_t batch_size = 0;
+    bool contiguous = true;
+    for (const TensorView& input : inputs) {
+        CHECK(!input.empty());
+        batch_size += input.batch();
+        contiguous = contiguous && input.is_contiguous();
+    }
+
+    // 列主序连续的视图转换为张量不需要复制，其他排布只在有消费者需要时转换一次
+    const auto& input_op = this->input_operators_map_.at(input_name_);
+    CHECK(input_op->output_operands != nullptr);
+    std::vector<std::shared_ptr<Tensor<float>>>& input_tensors = input_op->output_operands->tensors;
+    input_tensors.clear();
+    if (contiguous || this->input_needs_tensor_) {
+        for (const TensorView& input : inputs) {
+            for (uint32_t i = 0; i < input.batch(); ++i) {
+                input_tensors.push_back(input.Batch(i).AsTensor());
+            }
+        }
+    }
+
+    Run(batch_size, contiguous ? nullptr : &inputs);
+
+    const auto& output_op = this->output_operators_map_.at(output_name_);
+    CHECK(!output_op->input_operands_seq.empty());
+    return output_op->input_operands_seq.front()->tensors;
+}
+
+void RuntimeGraph::Run(uint32_t batch_size, const std::vector<TensorView>* input_views) {
+    for (const auto& op : this->topo_operators_) {
+        if (op->type == "pnnx.Input" || op->type == "pnnx.Output") {
+            continue;
+        }
+        CHECK(op->layer != nullptr) << "Layer of " << op->name << " is empty";
+
+        // 多个输入按顺序拼在一起，每个输入是一个 batch
+        std::vector<std::shared_ptr<Tensor<float>>> layer_inputs;
+        for (const auto& operand : op->input_operands_seq) {
+            layer_inputs.insert(layer_inputs.end(), operand->tensors.begin(), operand->tensors.end());
+        }
+
+        std::vector<std::shared_ptr<Tensor<float>>>& layer_outputs = op->output_operands->tensors;
+        layer_outputs.clear();
+        layer_outputs.resize(batch_size);
+
+        const bool read_views = input_views != nullptr && this->view_consumers_.count(op.get());
+        const uint64_t start_ns = this->profiler_ == nullptr ? 0 : RuntimeProfiler::NowNs();
+        if (read_views) {
+            op->layer->ForwardViews(*input_views, layer_outputs);
+        } else {
+            op->layer->Forward(layer_inputs, layer_outputs);
+        }
+        if (this->profiler_ != nullptr) {
+            this->profiler_->Record(op, layer_inputs, layer_outputs, start_ns, RuntimeProfiler::NowNs());
+        }
+
+        if (this->output_hook_) {
+            this->output_hook_(op);
+        }
+
+        if (!this->dump_dir_.empty()) {
+            DumpOutputs(op);
+        }
+    }
+}
 
 }
\ No newline at end of file
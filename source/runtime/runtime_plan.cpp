@@ -0,0 +1,491 @@
+#include "runtime/runtime_plan.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+namespace {
+
+constexpr char kPlanMagic[4] = {'K', 'P', 'L', 'N'};
+
+// FNV-1a 64
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t HashBytes(const char* data, size_t size, uint64_t hash) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// 只读映射整个文件，析构时解除映射
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const char*>(addr);
+                size_ = st.st_size;
+            }
+        }
+        close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+class PlanWriter {
+public:
+    explicit PlanWriter(std::ofstream& out) : out_(out) {}
+
+    template <typename T>
+    void Write(const T& value) {
+        out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void WriteString(const std::string& value) {
+        Write<uint32_t>(value.size());
+        out_.write(value.data(), value.size());
+    }
+
+    template <typename T>
+    void WriteVector(const std::vector<T>& values) {
+        Write<uint32_t>(values.size());
+        out_.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+private:
+    std::ofstream& out_;
+};
+
+// 读取时每一步都检查越界，损坏的缓存只会导致加载失败
+class PlanReader {
+public:
+    PlanReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        if (offset_ + sizeof(T) > size_) {
+            return false;
+        }
+        memcpy(&value, data_ + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool ReadString(std::string& value) {
+        uint32_t length = 0;
+        if (!Read(length) || offset_ + length > size_) {
+            return false;
+        }
+        value.assign(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+    template <typename T>
+    bool ReadVector(std::vector<T>& values) {
+        uint32_t length = 0;
+        if (!Read(length) || offset_ + size_t(length) * sizeof(T) > size_) {
+            return false;
+        }
+        values.resize(length);
+        memcpy(values.data(), data_ + offset_, size_t(length) * sizeof(T));
+        offset_ += size_t(length) * sizeof(T);
+        return true;
+    }
+
+    bool finished() const { return offset_ == size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t offset_ = 0;
+};
+
+void WriteOperand(PlanWriter& writer, const std::shared_ptr<RuntimeOperand>& operand) {
+    writer.WriteString(operand->name);
+    writer.Write<int32_t>(int32_t(operand->type));
+    writer.WriteVector(operand->shape);
+}
+
+std::shared_ptr<RuntimeOperand> ReadOperand(PlanReader& reader) {
+    std::shared_ptr<RuntimeOperand> operand = std::make_shared<RuntimeOperand>();
+    int32_t type = 0;
+    if (!reader.ReadString(operand->name) || !reader.Read(type) || !reader.ReadVector(operand->shape)) {
+        return nullptr;
+    }
+    operand->type = RuntimeDataType(type);
+    return operand;
+}
+
+void WriteParameter(PlanWriter& writer, const RuntimeParameter* param) {
+    writer.Write<int32_t>(int32_t(param->type));
+    switch (param->type) {
+        case RuntimeParameterType::kParameterBool: {
+            writer.Write<uint8_t>(dynamic_cast<const RuntimeParameterBool*>(param)->value);
+            break;
+        }
+        case RuntimeParameterType::kParameterInt: {
+            writer.Write<int32_t>(dynamic_cast<const RuntimeParameterInt*>(param)->value);
+            break;
+        }
+        case RuntimeParameterType::kParameterFloat: {
+            writer.Write<float>(dynamic_cast<const RuntimeParameterFloat*>(param)->value);
+            break;
+        }
+        case RuntimeParameterType::kParameterString: {
+            writer.WriteString(dynamic_cast<const RuntimeParameterString*>(param)->value);
+            break;
+        }
+        case RuntimeParameterType::kParameterIntArray: {
+            writer.WriteVector(dynamic_cast<const RuntimeParameterIntArray*>(param)->value);
+            break;
+        }
+        case RuntimeParameterType::kParameterFloatArray: {
+            writer.WriteVector(dynamic_cast<const RuntimeParameterFloatArray*>(param)->value);
+            break;
+        }
+        case RuntimeParameterType::kParameterStringArray: {
+            const auto& values = dynamic_cast<const RuntimeParameterStringArray*>(param)->value;
+            writer.Write<uint32_t>(values.size());
+            for (const auto& value : values) {
+                writer.WriteString(value);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+RuntimeParameter* ReadParameter(PlanReader& reader) {
+    int32_t type = 0;
+    if (!reader.Read(type)) {
+        return nullptr;
+    }
+    switch (RuntimeParameterType(type)) {
+        case RuntimeParameterType::kParameterUnknown: {
+            return new RuntimeParameter;
+        }
+        case RuntimeParameterType::kParameterBool: {
+            uint8_t value = 0;
+            if (!reader.Read(value)) return nullptr;
+            RuntimeParameterBool* param = new RuntimeParameterBool;
+            param->value = value;
+            return param;
+        }
+        case RuntimeParameterType::kParameterInt: {
+            RuntimeParameterInt* param = new RuntimeParameterInt;
+            if (reader.Read(param->value)) return param;
+            delete param;
+            return nullptr;
+        }
+        case RuntimeParameterType::kParameterFloat: {
+            RuntimeParameterFloat* param = new RuntimeParameterFloat;
+            if (reader.Read(param->value)) return param;
+            delete param;
+            return nullptr;
+        }
+        case RuntimeParameterType::kParameterString: {
+            RuntimeParameterString* param = new RuntimeParameterString;
+            if (reader.ReadString(param->value)) return param;
+            delete param;
+            return nullptr;
+        }
+        case RuntimeParameterType::kParameterIntArray: {
+            RuntimeParameterIntArray* param = new RuntimeParameterIntArray;
+            if (reader.ReadVector(param->value)) return param;
+            delete param;
+            return nullptr;
+        }
+        case RuntimeParameterType::kParameterFloatArray: {
+            RuntimeParameterFloatArray* param = new RuntimeParameterFloatArray;
+            if (reader.ReadVector(param->value)) return param;
+            delete param;
+            return nullptr;
+        }
+        case RuntimeParameterType::kParameterStringArray: {
+            RuntimeParameterStringArray* param = new RuntimeParameterStringArray;
+            uint32_t count = 0;
+            bool ok = reader.Read(count);
+            for (uint32_t i = 0; ok && i < count; ++i) {
+                std::string value;
+                ok = reader.ReadString(value);
+                param->value.push_back(value);
+            }
+            if (ok) return param;
+            delete param;
+            return nullptr;
+        }
+        default: {
+            return nullptr;
+        }
+    }
+}
+
+}  // namespace
+
+std::string RuntimePlan::PlanPath(const std::string& param_path) {
+    const std::string suffix = ".param";
+    if (param_path.size() > suffix.size() &&
+        param_path.compare(param_path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return param_path.substr(0, param_path.size() - suffix.size()) + ".kplan";
+    }
+    return param_path + ".kplan";
+}
+
+const std::string& RuntimePlan::IsaSignature() {
+    static const std::string kSignature = [] {
+        std::string signature;
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) signature += "sse4.2,";
+        if (__builtin_cpu_supports("avx")) signature += "avx,";
+        if (__builtin_cpu_supports("avx2")) signature += "avx2,";
+        if (__builtin_cpu_supports("fma")) signature += "fma,";
+        if (__builtin_cpu_supports("avx512f")) signature += "avx512f,";
+#else
+        signature += "generic,";
+#endif
+        if (!signature.empty()) {
+            signature.pop_back();
+        }
+        return signature;
+    }();
+    return kSignature;
+}
+
+uint64_t RuntimePlan::PlanKey(const std::string& param_path, const std::string& bin_path) {
+    MappedFile param_file(param_path);
+    MappedFile bin_file(bin_path);
+    if (param_file.data() == nullptr || bin_file.data() == nullptr) {
+        return 0;
+    }
+
+    uint64_t hash = kFnvOffset;
+    hash = HashBytes(param_file.data(), param_file.size(), hash);
+    hash = HashBytes(bin_file.data(), bin_file.size(), hash);
+    const std::string& isa = IsaSignature();
+    hash = HashBytes(isa.data(), isa.size(), hash);
+    return hash;
+}
+
+// 格式：
+// magic version key operator_count
+// 每个算子：name type 输入操作数(生产者名字和操作数) 输出操作数 消费者名字 参数 属性
+bool RuntimePlan::Save(const std::string& plan_path, uint64_t key,
+                       const std::vector<std::shared_ptr<RuntimeOperator>>& operators) {
+    // 先写临时文件再改名，多个进程同时启动时不会读到写了一半的缓存
+    const std::string tmp_path = plan_path + ".tmp" + std::to_string(getpid());
+    std::ofstream out(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+        LOG(WARNING) << "Can not write plan cache: " << tmp_path;
+        return false;
+    }
+
+    PlanWriter writer(out);
+    out.write(kPlanMagic, sizeof(kPlanMagic));
+    writer.Write<uint32_t>(kPlanVersion);
+    writer.Write<uint64_t>(key);
+    writer.Write<uint32_t>(operators.size());
+
+    for (const auto& op : operators) {
+        writer.WriteString(op->name);
+        writer.WriteString(op->type);
+
+        // 输入操作数按顺序保存，同时保存生产者名字
+        writer.Write<uint32_t>(op->input_operands_seq.size());
+        for (const auto& operand : op->input_operands_seq) {
+            std::string producer;
+            for (const auto& [name, input_operand] : op->input_operands) {
+                if (input_operand == operand) {
+                    producer = name;
+                    break;
+                }
+            }
+            writer.WriteString(producer);
+            WriteOperand(writer, operand);
+        }
+
+        writer.Write<uint8_t>(op->output_operands != nullptr);
+        if (op->output_operands != nullptr) {
+            WriteOperand(writer, op->output_operands);
+        }
+
+        writer.Write<uint32_t>(op->output_names.size());
+        for (const auto& output_name : op->output_names) {
+            writer.WriteString(output_name);
+        }
+
+        writer.Write<uint32_t>(op->params.size());
+        for (const auto& [name, param] : op->params) {
+            writer.WriteString(name);
+            WriteParameter(writer, param);
+        }
+
+        writer.Write<uint32_t>(op->attrs.size());
+        for (const auto& [name, attr] : op->attrs) {
+            writer.WriteString(name);
+            writer.Write<int32_t>(int32_t(attr->type));
+            writer.WriteVector(attr->shape);
+            writer.WriteVector(attr->weight_data);
+        }
+    }
+    out.close();
+
+    if (!out.good() || std::rename(tmp_path.c_str(), plan_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        LOG(WARNING) << "Can not write plan cache: " << plan_path;
+        return false;
+    }
+    return true;
+}
+
+bool RuntimePlan::Load(const std::string& plan_path, uint64_t key,
+                       std::vector<std::shared_ptr<RuntimeOperator>>& operators) {
+    MappedFile plan_file(plan_path);
+    if (plan_file.data() == nullptr || plan_file.size() < sizeof(kPlanMagic)) {
+        return false;
+    }
+    if (memcmp(plan_file.data(), kPlanMagic, sizeof(kPlanMagic)) != 0) {
+        LOG(WARNING) << "Plan cache magic mismatch: " << plan_path;
+        return false;
+    }
+
+    PlanReader reader(plan_file.data() + sizeof(kPlanMagic), plan_file.size() - sizeof(kPlanMagic));
+    uint32_t version = 0;
+    uint64_t plan_key = 0;
+    uint32_t operator_count = 0;
+    if (!reader.Read(version) || version != kPlanVersion) {
+        LOG(WARNING) << "Plan cache version mismatch: " << plan_path;
+        return false;
+    }
+    if (!reader.Read(plan_key) || plan_key != key) {
+        LOG(WARNING) << "Plan cache is stale: " << plan_path;
+        return false;
+    }
+    if (!reader.Read(operator_count)) {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<RuntimeOperator>> plan_operators;
+    for (uint32_t i = 0; i < operator_count; ++i) {
+        std::shared_ptr<RuntimeOperator> op = std::make_shared<RuntimeOperator>();
+        if (!reader.ReadString(op->name) || !reader.ReadString(op->type)) {
+            return false;
+        }
+
+        uint32_t input_count = 0;
+        if (!reader.Read(input_count)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < input_count; ++j) {
+            std::string producer;
+            if (!reader.ReadString(producer)) {
+                return false;
+            }
+            std::shared_ptr<RuntimeOperand> operand = ReadOperand(reader);
+            if (operand == nullptr) {
+                return false;
+            }
+            op->input_operands.insert({producer, operand});
+            op->input_operands_seq.push_back(operand);
+        }
+
+        uint8_t has_output = 0;
+        if (!reader.Read(has_output)) {
+            return false;
+        }
+        if (has_output) {
+            op->output_operands = ReadOperand(reader);
+            if (op->output_operands == nullptr) {
+                return false;
+            }
+        }
+
+        uint32_t output_count = 0;
+        if (!reader.Read(output_count)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < output_count; ++j) {
+            std::string output_name;
+            if (!reader.ReadString(output_name)) {
+                return false;
+            }
+            op->output_names.push_back(output_name);
+        }
+
+        uint32_t param_count = 0;
+        if (!reader.Read(param_count)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < param_count; ++j) {
+            std::string name;
+            if (!reader.ReadString(name)) {
+                return false;
+            }
+            RuntimeParameter* param = ReadParameter(reader);
+            if (param == nullptr) {
+                return false;
+            }
+            op->params.insert({name, param});
+        }
+
+        uint32_t attr_count = 0;
+        if (!reader.Read(attr_count)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < attr_count; ++j) {
+            std::string name;
+            int32_t type = 0;
+            std::shared_ptr<RuntimeAttribute> attr = std::make_shared<RuntimeAttribute>();
+            if (!reader.ReadString(name) || !reader.Read(type) || !reader.ReadVector(attr->shape) ||
+                !reader.ReadVector(attr->weight_data)) {
+                return false;
+            }
+            attr->type = RuntimeDataType(type);
+            op->attrs.insert({name, attr});
+        }
+        plan_operators.push_back(op);
+    }
+
+    if (!reader.finished()) {
+        LOG(WARNING) << "Plan cache has trailing data: " << plan_path;
+        return false;
+    }
+    operators = std::move(plan_operators);
+    return true;
+}
+
+}
@@ -0,0 +1,250 @@
+#include "runtime/runtime_profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <glog/logging.h>
+#include "ops/conv_op.hpp"
+
+namespace kuiper_infer {
+
+namespace {
+
+uint64_t CurrentThreadId() {
+    static thread_local uint64_t kThreadId = static_cast<uint64_t>(syscall(SYS_gettid));
+    return kThreadId;
+}
+
+std::string ShapeString(const std::vector<std::vector<uint32_t>>& shapes) {
+    std::ostringstream ss;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        if (i != 0) {
+            ss << " ";
+        }
+        ss << "(";
+        for (size_t j = 0; j < shapes.at(i).size(); ++j) {
+            if (j != 0) {
+                ss << ",";
+            }
+            ss << shapes.at(i).at(j);
+        }
+        ss << ")";
+    }
+    return ss.str();
+}
+
+std::string JsonEscape(const std::string& value) {
+    std::string escaped;
+    for (const char c : value) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+// 去掉边框之后的形状，预留了边框的张量按内部统计
+std::vector<uint32_t> InteriorShape(const Tensor<float>& tensor, const Halo& halo) {
+    CHECK(tensor.rows() >= 2 * halo.h && tensor.cols() >= 2 * halo.w);
+    return {tensor.channels(), tensor.rows() - 2 * halo.h, tensor.cols() - 2 * halo.w};
+}
+
+uint64_t OutputElements(const std::vector<std::shared_ptr<Tensor<float>>>& outputs, const Halo& halo) {
+    uint64_t elements = 0;
+    for (const auto& output : outputs) {
+        if (output != nullptr && !output->empty()) {
+            const std::vector<uint32_t>& shape = InteriorShape(*output, halo);
+            elements += uint64_t(shape.at(0)) * shape.at(1) * shape.at(2);
+        }
+    }
+    return elements;
+}
+
+}  // namespace
+
+uint64_t RuntimeProfiler::NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t RuntimeProfiler::EstimateFlops(const std::shared_ptr<RuntimeOperator>& op,
+                                        const std::vector<std::shared_ptr<Tensor<float>>>& inputs,
+                                        const std::vector<std::shared_ptr<Tensor<float>>>& outputs,
+                                        const Halo& output_halo) {
+    CHECK(op != nullptr);
+    const uint64_t output_elements = OutputElements(outputs, output_halo);
+
+    if (op->type == "nn.Conv2d") {
+        // 每个输出元素需要 (in_channels / groups) * kernel_h * kernel_w 次乘加
+        // 卷积核只保存在 ConvOp 里，属性里的权重已经释放
+        auto conv_op = std::dynamic_pointer_cast<ConvOp>(op->layer_op);
+        if (conv_op == nullptr || conv_op->kernel_count() == 0) {
+            return 0;
+        }
+        const std::vector<uint32_t>& shape = conv_op->kernel_shape();
+        const uint64_t macs = uint64_t(shape.at(0)) * shape.at(1) * shape.at(2);
+        uint64_t flops = 2 * macs * output_elements;
+        if (conv_op->get_has_bias()) {
+            flops += output_elements;
+        }
+        return flops;
+    } else if (op->type == "nn.MaxPool2d") {
+        // 每个输出元素在窗口内比较 kernel_h * kernel_w 次
+        auto kernel_size = op->params.find("kernel_size");
+        if (kernel_size == op->params.end()) {
+            return 0;
+        }
+        auto kernel = dynamic_cast<RuntimeParameterIntArray*>(kernel_size->second);
+        if (kernel == nullptr || kernel->value.size() != 2) {
+            return 0;
+        }
+        return output_elements * kernel->value.at(0) * kernel->value.at(1);
+    } else if (op->type == "pnnx.Expression") {
+        // n 个输入需要 n - 1 次二元运算
+        if (outputs.empty() || inputs.size() <= outputs.size()) {
+            return 0;
+        }
+        return output_elements * (inputs.size() / outputs.size() - 1);
+    } else if (op->type == "nn.ReLU" || op->type == "F.relu" ||
+               op->type == "nn.Sigmoid" || op->type == "F.sigmoid") {
+        return output_elements;
+    }
+    return 0;
+}
+
+void RuntimeProfiler::Record(const std::shared_ptr<RuntimeOperator>& op,
+                             const std::vector<std::shared_ptr<Tensor<float>>>& inputs,
+                             const std::vector<std::shared_ptr<Tensor<float>>>& outputs,
+                             uint64_t start_ns, uint64_t end_ns) {
+    CHECK(op != nullptr);
+    ProfileRecord record;
+    record.name = op->name;
+    record.type = op->type;
+    record.start_ns = start_ns;
+    record.end_ns = end_ns;
+    record.thread_id = CurrentThreadId();
+    // 生产者预留的边框不算在形状、字节数和计算量里
+    Halo input_halo;
+    Halo output_halo;
+    if (op->layer != nullptr) {
+        input_halo = op->layer->input_halo();
+        output_halo = op->layer->output_halo();
+    }
+    for (const auto& input : inputs) {
+        if (input != nullptr && !input->empty()) {
+            record.input_shapes.push_back(InteriorShape(*input, input_halo));
+        }
+    }
+    for (const auto& output : outputs) {
+        if (output != nullptr && !output->empty()) {
+            record.output_shapes.push_back(InteriorShape(*output, output_halo));
+        }
+    }
+    record.bytes = OutputElements(outputs, output_halo) * sizeof(float);
+    record.flops = EstimateFlops(op, inputs, outputs, output_halo);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.push_back(std::move(record));
+}
+
+void RuntimeProfiler::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+}
+
+std::vector<ProfileRecord> RuntimeProfiler::records() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_;
+}
+
+std::string RuntimeProfiler::Summary() const {
+    struct Aggregate {
+        std::string type;
+        uint32_t calls = 0;
+        uint64_t total_ns = 0;
+        uint64_t bytes = 0;
+        uint64_t flops = 0;
+    };
+
+    std::map<std::string, Aggregate> aggregates;
+    uint64_t total_ns = 0;
+    for (const auto& record : records()) {
+        Aggregate& aggregate = aggregates[record.name];
+        aggregate.type = record.type;
+        aggregate.calls += 1;
+        aggregate.total_ns += record.end_ns - record.start_ns;
+        aggregate.bytes += record.bytes;
+        aggregate.flops += record.flops;
+        total_ns += record.end_ns - record.start_ns;
+    }
+
+    std::vector<std::pair<std::string, Aggregate>> sorted(aggregates.begin(), aggregates.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return a.second.total_ns > b.second.total_ns;
+    });
+
+    std::ostringstream ss;
+    ss << std::left << std::setw(24) << "name" << std::setw(20) << "type" << std::right
+       << std::setw(8) << "calls" << std::setw(12) << "total(ms)" << std::setw(12) << "avg(ms)"
+       << std::setw(8) << "%" << std::setw(12) << "MB" << std::setw(12) << "GFLOP/s" << "\n";
+    ss << std::fixed;
+    for (const auto& [name, aggregate] : sorted) {
+        const double total_ms = aggregate.total_ns / 1e6;
+        const double percent = total_ns == 0 ? 0. : 100. * aggregate.total_ns / total_ns;
+        const double gflops = aggregate.total_ns == 0 ? 0. : double(aggregate.flops) / aggregate.total_ns;
+        ss << std::left << std::setw(24) << name << std::setw(20) << aggregate.type << std::right
+           << std::setw(8) << aggregate.calls << std::setw(12) << std::setprecision(3) << total_ms
+           << std::setw(12) << total_ms / aggregate.calls << std::setw(8) << std::setprecision(1) << percent
+           << std::setw(12) << std::setprecision(3) << aggregate.bytes / 1e6 << std::setw(12) << gflops << "\n";
+    }
+    return ss.str();
+}
+
+std::string RuntimeProfiler::ChromeTrace() const {
+    const std::vector<ProfileRecord>& all_records = records();
+    uint64_t base_ns = 0;
+    if (!all_records.empty()) {
+        base_ns = std::min_element(all_records.begin(), all_records.end(), [](const auto& a, const auto& b) {
+            return a.start_ns < b.start_ns;
+        })->start_ns;
+    }
+
+    // 时间单位是微秒，完整事件 ph = X
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < all_records.size(); ++i) {
+        const ProfileRecord& record = all_records.at(i);
+        if (i != 0) {
+            ss << ",";
+        }
+        ss << "\n{\"name\":\"" << JsonEscape(record.name) << "\",\"cat\":\"" << JsonEscape(record.type)
+           << "\",\"ph\":\"X\",\"pid\":" << getpid() << ",\"tid\":" << record.thread_id
+           << ",\"ts\":" << (record.start_ns - base_ns) / 1e3 << ",\"dur\":" << (record.end_ns - record.start_ns) / 1e3
+           << ",\"args\":{\"inputs\":\"" << ShapeString(record.input_shapes)
+           << "\",\"outputs\":\"" << ShapeString(record.output_shapes)
+           << "\",\"bytes\":" << record.bytes << ",\"flops\":" << record.flops << "}}";
+    }
+    ss << "\n]}\n";
+    return ss.str();
+}
+
+bool RuntimeProfiler::DumpChromeTrace(const std::string& path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.good()) {
+        LOG(ERROR) << "Can not open trace file: " << path;
+        return false;
+    }
+    out << ChromeTrace();
+    return out.good();
+}
+
+}
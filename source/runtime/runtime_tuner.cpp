@@ -0,0 +1,181 @@
+#include "runtime/runtime_tuner.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <glog/logging.h>
+#include "data/cpu_isa.hpp"
+#include "factory/layer_factory.hpp"
+
+namespace kuiper_infer {
+
+std::string TuningCache::CachePath(const std::string& param_path) {
+    const std::string suffix = ".param";
+    if (param_path.size() > suffix.size() &&
+        param_path.compare(param_path.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        return param_path.substr(0, param_path.size() - suffix.size()) + ".ktune";
+    }
+    return param_path + ".ktune";
+}
+
+bool TuningCache::Save(const std::string& path) const {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.good()) {
+        LOG(ERROR) << "Can not open tuning cache: " << path;
+        return false;
+    }
+    out << "kuiper_tuning_cache " << kCacheVersion << "\n";
+    for (const auto& [key, name] : this->entries) {
+        out << key << " " << name << "\n";
+    }
+    return out.good();
+}
+
+bool TuningCache::Load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        return false;
+    }
+    std::string magic;
+    uint32_t version = 0;
+    if (!(in >> magic >> version) || magic != "kuiper_tuning_cache" || version != kCacheVersion) {
+        LOG(ERROR) << "Invalid tuning cache: " << path;
+        return false;
+    }
+
+    std::map<std::string, std::string> entries;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream line_in(line);
+        std::string key;
+        std::string name;
+        if (!(line_in >> key)) {
+            continue;
+        }
+        if (!(line_in >> name)) {
+            LOG(ERROR) << "Invalid tuning cache line: " << line;
+            return false;
+        }
+        entries[key] = name;
+    }
+    this->entries = std::move(entries);
+    return true;
+}
+
+static void WriteShape(std::ostream& out, const std::vector<int32_t>& shape) {
+    out << "[";
+    for (size_t i = 0; i < shape.size(); ++i) {
+        out << (i == 0 ? "" : ",") << shape.at(i);
+    }
+    out << "]";
+}
+
+// 参数按名字排序写出，只用于区分不同的算子配置
+static void WriteParam(std::ostream& out, const RuntimeParameter* param) {
+    switch (param->type) {
+        case RuntimeParameterType::kParameterBool:
+            out << dynamic_cast<const RuntimeParameterBool*>(param)->value;
+            break;
+        case RuntimeParameterType::kParameterInt:
+            out << dynamic_cast<const RuntimeParameterInt*>(param)->value;
+            break;
+        case RuntimeParameterType::kParameterFloat:
+            out << dynamic_cast<const RuntimeParameterFloat*>(param)->value;
+            break;
+        case RuntimeParameterType::kParameterString:
+            out << dynamic_cast<const RuntimeParameterString*>(param)->value;
+            break;
+        case RuntimeParameterType::kParameterIntArray:
+            WriteShape(out, dynamic_cast<const RuntimeParameterIntArray*>(param)->value);
+            break;
+        case RuntimeParameterType::kParameterFloatArray:
+            for (const float value : dynamic_cast<const RuntimeParameterFloatArray*>(param)->value) {
+                out << value << ",";
+            }
+            break;
+        case RuntimeParameterType::kParameterStringArray:
+            for (const std::string& value : dynamic_cast<const RuntimeParameterStringArray*>(param)->value) {
+                out << value << ",";
+            }
+            break;
+        default:
+            out << "?";
+            break;
+    }
+}
+
+std::string LayerTuner::TuningKey(const RuntimeOperator& op) {
+    std::ostringstream out;
+    out << CpuModelName() << "|" << CpuIsaName(ActiveCpuIsa()) << "|" << op.type << "|";
+    for (const auto& operand : op.input_operands_seq) {
+        WriteShape(out, operand->shape);
+    }
+    out << "->";
+    if (op.output_operands != nullptr) {
+        WriteShape(out, op.output_operands->shape);
+    }
+    out << "|";
+    for (const auto& [name, param] : op.params) {
+        out << name << "=";
+        WriteParam(out, param);
+        out << ";";
+    }
+    out << "|";
+    for (const auto& [name, attr] : op.attrs) {
+        out << name;
+        WriteShape(out, attr->shape);
+    }
+
+    // 文件里用空白分隔 key 和实现名
+    std::string key = out.str();
+    std::replace_if(key.begin(), key.end(), [](char ch) { return std::isspace(uint8_t(ch)); }, '_');
+    return key;
+}
+
+std::string LayerTuner::SelectFastest(const RuntimeOperator& op, const std::shared_ptr<Operator>& layer_op,
+                                      const std::vector<std::string>& candidates, uint32_t repeats) {
+    CHECK(layer_op != nullptr);
+    CHECK_GT(repeats, 0);
+    std::vector<std::shared_ptr<Tensor<float>>> inputs;
+    for (const auto& operand : op.input_operands_seq) {
+        const std::vector<int32_t>& shape = operand->shape;
+        if (shape.size() != 4 || *std::min_element(shape.begin(), shape.end()) <= 0) {
+            return "";
+        }
+        std::shared_ptr<Tensor<float>> input = TensorCreate(shape.at(1), shape.at(2), shape.at(3));
+        input->Rand();
+        inputs.push_back(input);
+    }
+    if (inputs.empty() || candidates.empty()) {
+        return "";
+    }
+
+    std::string fastest;
+    double fastest_time = std::numeric_limits<double>::max();
+    for (const std::string& name : candidates) {
+        const std::shared_ptr<Layer>& layer = LayerRegister::CreateLayer(layer_op, name);
+        if (layer == nullptr) {
+            continue;
+        }
+        std::vector<std::shared_ptr<Tensor<float>>> outputs;
+        layer->Forward(inputs, outputs);
+        double best = std::numeric_limits<double>::max();
+        for (uint32_t i = 0; i < repeats; ++i) {
+            outputs.clear();
+            const auto start = std::chrono::steady_clock::now();
+            layer->Forward(inputs, outputs);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        LOG(INFO) << "Tuning " << op.name << ": " << name << " " << best * 1e6 << " us";
+        if (best < fastest_time) {
+            fastest_time = best;
+            fastest = name;
+        }
+    }
+    return fastest;
+}
+
+}
@@ -0,0 +1,51 @@
+#include "runtime/weight_store.hpp"
+#include <glog/logging.h>
+
+namespace kuiper_infer {
+
+std::map<uint64_t, std::weak_ptr<WeightStore::ModelWeights>>& WeightStore::Registry() {
+    static auto *kRegistry = new std::map<uint64_t, std::weak_ptr<ModelWeights>>();
+    CHECK(kRegistry != nullptr);
+    return *kRegistry;
+}
+
+std::mutex& WeightStore::Mutex() {
+    static auto *kMutex = new std::mutex();
+    return *kMutex;
+}
+
+std::shared_ptr<WeightStore::ModelWeights> WeightStore::Acquire(uint64_t model_key) {
+    std::lock_guard<std::mutex> lock(Mutex());
+    auto& registry = Registry();
+
+    // 注册表只保存弱引用，权重的生命周期由计算图决定
+    auto iter = registry.find(model_key);
+    if (iter != registry.end()) {
+        std::shared_ptr<ModelWeights> weights = iter->second.lock();
+        if (weights != nullptr) {
+            return weights;
+        }
+    }
+
+    std::shared_ptr<ModelWeights> weights = std::make_shared<ModelWeights>();
+    registry[model_key] = weights;
+    return weights;
+}
+
+uint32_t WeightStore::model_count() {
+    std::lock_guard<std::mutex> lock(Mutex());
+    auto& registry = Registry();
+
+    uint32_t count = 0;
+    for (auto iter = registry.begin(); iter != registry.end();) {
+        if (iter->second.expired()) {
+            iter = registry.erase(iter);
+        } else {
+            ++count;
+            ++iter;
+        }
+    }
+    return count;
+}
+
+}
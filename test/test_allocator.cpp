@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <thread>
+#include "data/tensor_allocator.hpp"
+#include "data/tensor_util.hpp"
+
+TEST(test_allocator, size_class) {
+  using namespace kuiper_infer;
+  ASSERT_EQ(PoolAllocator::SizeClass(1), 64);
+  ASSERT_EQ(PoolAllocator::SizeClass(64), 64);
+  ASSERT_EQ(PoolAllocator::SizeClass(65), 80);
+  ASSERT_EQ(PoolAllocator::SizeClass(1000), 1024);
+  ASSERT_EQ(PoolAllocator::SizeClass(1025), 1280);
+  for (size_t bytes = 1; bytes < 100000; bytes += 77) {
+    const size_t size_class = PoolAllocator::SizeClass(bytes);
+    ASSERT_GE(size_class, bytes);
+    ASSERT_LE(size_class, bytes + bytes / 4 + 64);
+  }
+}
+
+TEST(test_allocator, reuse) {
+  using namespace kuiper_infer;
+  std::shared_ptr<PoolAllocator> allocator = PoolAllocator::Instance();
+  const AllocatorStats &before = allocator->stats();
+
+  void *ptr1 = allocator->Allocate(12345);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr1) % PoolAllocator::kAlignment, 0);
+  ASSERT_GE(allocator->stats().bytes_in_use, before.bytes_in_use + 12345);
+  allocator->Free(ptr1, 12345);
+
+  // 同一尺寸等级再次申请时命中缓存
+  const uint64_t hits = allocator->stats().hits;
+  void *ptr2 = allocator->Allocate(12300);
+  ASSERT_EQ(ptr1, ptr2);
+  ASSERT_EQ(allocator->stats().hits, hits + 1);
+  allocator->Free(ptr2, 12300);
+  ASSERT_EQ(allocator->stats().bytes_in_use, before.bytes_in_use);
+
+  allocator->Trim();
+  ASSERT_EQ(allocator->stats().bytes_cached, 0);
+}
+
+TEST(test_allocator, tensor_create) {
+  using namespace kuiper_infer;
+  std::shared_ptr<PoolAllocator> allocator = PoolAllocator::Instance();
+  allocator->Trim();
+  const AllocatorStats &before = allocator->stats();
+
+  const float *first_ptr = nullptr;
+  for (int i = 0; i < 4; ++i) {
+    sftensor tensor = TensorCreate(3, 32, 32);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(tensor->raw_ptr()) % PoolAllocator::kAlignment, 0);
+    tensor->Fill(float(i));
+    ASSERT_EQ(tensor->at(2, 31, 31), float(i));
+    if (first_ptr == nullptr) {
+      first_ptr = tensor->raw_ptr();
+    } else {
+      ASSERT_EQ(tensor->raw_ptr(), first_ptr);
+    }
+  }
+  const AllocatorStats &after = allocator->stats();
+  ASSERT_EQ(after.misses, before.misses + 1);
+  ASSERT_EQ(after.hits, before.hits + 3);
+  ASSERT_EQ(after.bytes_in_use, before.bytes_in_use);
+
+  // 重新分配内存的操作之后张量仍然可用，原来的内存照常归还
+  sftensor tensor = TensorCreate(2, 4, 4);
+  tensor->Fill(1.f);
+  tensor->Padding({1, 1, 1, 1}, 0.f);
+  ASSERT_EQ(tensor->shape(), std::vector<uint32_t>({2, 6, 6}));
+  ASSERT_EQ(tensor->at(1, 3, 3), 1.f);
+  tensor.reset();
+  ASSERT_EQ(allocator->stats().bytes_in_use, before.bytes_in_use);
+}
+
+TEST(test_allocator, threads) {
+  using namespace kuiper_infer;
+  std::shared_ptr<PoolAllocator> allocator = PoolAllocator::Instance();
+  const uint64_t bytes_in_use = allocator->stats().bytes_in_use;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 100; ++i) {
+        sftensor tensor = TensorCreate(4, 16, 16 + i % 3);
+        tensor->Fill(1.f);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(allocator->stats().bytes_in_use, bytes_in_use);
+}
+
+TEST(test_allocator, huge_pages) {
+  using namespace kuiper_infer;
+  std::shared_ptr<PoolAllocator> allocator = PoolAllocator::Instance();
+  allocator->set_huge_pages(true);
+  void *ptr = allocator->Allocate(PoolAllocator::kHugePageSize * 2);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % PoolAllocator::kHugePageSize, 0);
+  allocator->Free(ptr, PoolAllocator::kHugePageSize * 2);
+  allocator->set_huge_pages(false);
+  allocator->Trim();
+}
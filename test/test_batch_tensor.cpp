@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "data/batch_tensor.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/expression_layer.hpp"
+#include "layer/maxpooling_layer.hpp"
+#include "layer/relu_layer.hpp"
+#include "layer/sigmoid_layer.hpp"
+#include "ops/expression_op.hpp"
+#include "ops/maxpooling_op.hpp"
+#include "ops/relu_op.hpp"
+#include "ops/sigmoid_op.hpp"
+
+using namespace kuiper_infer;
+
+static std::vector<sftensor> RandTensors(uint32_t batch_size, uint32_t channels, uint32_t rows, uint32_t cols) {
+  std::vector<sftensor> tensors;
+  for (uint32_t i = 0; i < batch_size; ++i) {
+    sftensor tensor = std::make_shared<ftensor>(channels, rows, cols);
+    tensor->Rand();
+    tensors.push_back(tensor);
+  }
+  return tensors;
+}
+
+static void ExpectSame(const BatchTensor &batch, const std::vector<sftensor> &tensors) {
+  ASSERT_EQ(batch.batch(), tensors.size());
+  const std::vector<sftensor> &elements = batch.ToVector();
+  for (uint32_t i = 0; i < tensors.size(); ++i) {
+    ASSERT_TRUE(TensorIsSame(elements.at(i), tensors.at(i)));
+  }
+}
+
+TEST(test_batch_tensor, create) {
+  BatchTensor batch(2, 3, 4, 5);
+  ASSERT_EQ(batch.shape(), std::vector<uint32_t>({2, 3, 4, 5}));
+  ASSERT_EQ(batch.size(), 120);
+  ASSERT_EQ(batch.data()->shape(), std::vector<uint32_t>({6, 4, 5}));
+
+  // 每个 batch 元素直接使用 batch 的内存
+  const std::vector<sftensor> &elements = batch.ToVector();
+  ASSERT_EQ(elements.size(), 2);
+  ASSERT_EQ(elements.at(1)->raw_ptr(), batch.raw_ptr() + 60);
+  elements.at(1)->at(2, 3, 4) = 7.f;
+  ASSERT_EQ(batch.at(1, 2, 3, 4), 7.f);
+  ASSERT_EQ(batch.view().at(1, 2, 3, 4), 7.f);
+}
+
+TEST(test_batch_tensor, from_vector) {
+  const std::vector<sftensor> &tensors = RandTensors(3, 2, 4, 4);
+  const BatchTensor &batch = BatchTensor::FromVector(tensors);
+  ASSERT_EQ(batch.shape(), std::vector<uint32_t>({3, 2, 4, 4}));
+  ExpectSame(batch, tensors);
+}
+
+TEST(test_batch_tensor, relu_sigmoid) {
+  const std::vector<sftensor> &tensors = RandTensors(4, 3, 5, 5);
+  const BatchTensor &input = BatchTensor::FromVector(tensors);
+
+  ReLULayer relu(std::make_shared<ReLUOperator>(0.f));
+  std::vector<sftensor> relu_outputs;
+  relu.Forward(tensors, relu_outputs);
+  BatchTensor relu_output;
+  relu.ForwardBatch({input}, relu_output);
+  ExpectSame(relu_output, relu_outputs);
+
+  SigmoidLayer sigmoid(std::make_shared<SigmoidOperator>());
+  std::vector<sftensor> sigmoid_outputs;
+  sigmoid.Forward(tensors, sigmoid_outputs);
+  BatchTensor sigmoid_output;
+  sigmoid.ForwardBatch({input}, sigmoid_output);
+  ExpectSame(sigmoid_output, sigmoid_outputs);
+}
+
+TEST(test_batch_tensor, expression) {
+  const std::vector<sftensor> &tensors1 = RandTensors(2, 3, 4, 4);
+  const std::vector<sftensor> &tensors2 = RandTensors(2, 3, 4, 4);
+  const std::vector<sftensor> &tensors3 = RandTensors(2, 3, 4, 4);
+
+  ExpressionLayer layer(std::make_shared<ExpressionOp>("add(mul(@0,@1),@2)"));
+  std::vector<sftensor> inputs = tensors1;
+  inputs.insert(inputs.end(), tensors2.begin(), tensors2.end());
+  inputs.insert(inputs.end(), tensors3.begin(), tensors3.end());
+  std::vector<sftensor> outputs(2);
+  layer.Forward(inputs, outputs);
+
+  BatchTensor output;
+  layer.ForwardBatch({BatchTensor::FromVector(tensors1), BatchTensor::FromVector(tensors2),
+                      BatchTensor::FromVector(tensors3)}, output);
+  ExpectSame(output, outputs);
+}
+
+// 直接按定义计算卷积的一个输出
+static float NaiveConv(const sftensor &input, const std::vector<sftensor> &weights, const std::vector<sftensor> &bias,
+                       uint32_t groups, Shape stride, Shape padding, uint32_t k, uint32_t oh, uint32_t ow) {
+  const sftensor &kernel = weights.at(k);
+  const uint32_t group = k / (weights.size() / groups);
+  float sum = bias.at(k)->index(0);
+  for (uint32_t ic = 0; ic < kernel->channels(); ++ic) {
+    for (uint32_t kh = 0; kh < kernel->rows(); ++kh) {
+      for (uint32_t kw = 0; kw < kernel->cols(); ++kw) {
+        const int h = int(oh * stride.first + kh) - int(padding.first);
+        const int w = int(ow * stride.second + kw) - int(padding.second);
+        if (h < 0 || w < 0 || h >= int(input->rows()) || w >= int(input->cols())) {
+          continue;
+        }
+        sum += kernel->at(ic, kh, kw) * input->at(group * kernel->channels() + ic, h, w);
+      }
+    }
+  }
+  return sum;
+}
+
+TEST(test_batch_tensor, conv) {
+  const uint32_t in_channels = 4;
+  const uint32_t out_channels = 6;
+  for (uint32_t groups : {1, 2}) {
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(2, 1), Shape(1, 2), true, groups);
+    std::vector<sftensor> weights = RandTensors(out_channels, in_channels / groups, 3, 3);
+    std::vector<sftensor> bias = RandTensors(out_channels, 1, 1, 1);
+    conv_op->set_weights(weights);
+    conv_op->set_bias(bias);
+    ConvLayer layer(conv_op);
+
+    const std::vector<sftensor> &tensors = RandTensors(3, in_channels, 9, 7);
+    std::vector<sftensor> outputs;
+    layer.Forward(tensors, outputs);
+    ASSERT_EQ(outputs.front()->shape(), std::vector<uint32_t>({out_channels, 5, 9}));
+    for (uint32_t k = 0; k < out_channels; ++k) {
+      for (uint32_t oh = 0; oh < 5; ++oh) {
+        for (uint32_t ow = 0; ow < 9; ++ow) {
+          ASSERT_NEAR(outputs.at(1)->at(k, oh, ow),
+                      NaiveConv(tensors.at(1), weights, bias, groups, Shape(2, 1), Shape(1, 2), k, oh, ow), 1e-4);
+        }
+      }
+    }
+
+    // 和逐个输入计算的结果一致
+    for (uint32_t i = 0; i < tensors.size(); ++i) {
+      std::vector<sftensor> single_output;
+      layer.Forward({tensors.at(i)}, single_output);
+      ASSERT_TRUE(TensorIsSame(single_output.front(), outputs.at(i)));
+    }
+
+    BatchTensor output;
+    layer.ForwardBatch({BatchTensor::FromVector(tensors)}, output);
+    ExpectSame(output, outputs);
+  }
+}
+
+TEST(test_batch_tensor, default_adapter) {
+  const std::vector<sftensor> &tensors = RandTensors(2, 3, 8, 8);
+  std::shared_ptr<Layer> layer = std::make_shared<MaxPoolingLayer>(
+      std::make_shared<MaxPoolingOp>(Shape(2, 2), Shape(2, 2), Shape(0, 0)));
+
+  std::vector<sftensor> outputs(2);
+  layer->Forward(tensors, outputs);
+  BatchTensor output;
+  layer->ForwardBatch({BatchTensor::FromVector(tensors)}, output);
+  ASSERT_EQ(output.shape(), std::vector<uint32_t>({2, 3, 4, 4}));
+  ExpectSame(output, outputs);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include "data/tensor_util.hpp"
+#include "layer/batchnorm_layer.hpp"
+#include "runtime/runtime_ir.hpp"
+#include "test_model_file.hpp"
+
+using namespace kuiper_infer;
+
+static std::vector<float> RandValues(uint32_t count, float low, float high) {
+  std::vector<float> values(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    values.at(i) = low + (high - low) * float((i * 37 + 11) % 101) / 100.f;
+  }
+  return values;
+}
+
+TEST(test_batchnorm, layer) {
+  const std::vector<float> &mean = RandValues(5, -1.f, 1.f);
+  const std::vector<float> &var = RandValues(5, 0.5f, 2.f);
+  const std::vector<float> &weight = RandValues(5, -2.f, 2.f);
+  const std::vector<float> &bias = RandValues(5, -0.5f, 0.5f);
+  std::shared_ptr<BatchNormOp> op = std::make_shared<BatchNormOp>(mean, var, weight, bias, 1e-3f);
+
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 2; ++i) {
+    sftensor input = std::make_shared<ftensor>(5, 11, 13);
+    input->Rand();
+    inputs.push_back(input);
+  }
+  std::vector<sftensor> outputs;
+  BatchNormLayer(op).Forward(inputs, outputs);
+  ASSERT_EQ(outputs.size(), 2);
+  for (uint32_t i = 0; i < 2; ++i) {
+    for (uint32_t c = 0; c < 5; ++c) {
+      for (uint32_t r = 0; r < 11; ++r) {
+        for (uint32_t col = 0; col < 13; ++col) {
+          const float expected =
+              (inputs.at(i)->at(c, r, col) - mean.at(c)) / std::sqrt(var.at(c) + 1e-3f) * weight.at(c) + bias.at(c);
+          ASSERT_NEAR(outputs.at(i)->at(c, r, col), expected, 1e-4f);
+        }
+      }
+    }
+  }
+
+  // 整个 batch 连续存储和输出带边框时结果相同
+  BatchTensor batch_output;
+  BatchNormLayer(op).ForwardBatch({BatchTensor::FromVector(inputs)}, batch_output);
+  const std::vector<sftensor> &batch_outputs = batch_output.ToVector();
+  for (uint32_t i = 0; i < 2; ++i) {
+    ASSERT_LT(TensorCompare(batch_outputs.at(i), outputs.at(i)).max_abs, 1e-6f);
+  }
+
+  BatchNormLayer layer(op);
+  Halo halo;
+  halo.h = 2;
+  halo.w = 1;
+  layer.set_output_halo(halo);
+  std::vector<sftensor> padded_outputs;
+  layer.Forward({inputs.front()}, padded_outputs);
+  for (uint32_t c = 0; c < 5; ++c) {
+    for (uint32_t r = 0; r < 11; ++r) {
+      for (uint32_t col = 0; col < 13; ++col) {
+        ASSERT_EQ(padded_outputs.front()->at(c, r + 2, col + 1), outputs.front()->at(c, r, col));
+      }
+    }
+  }
+}
+
+TEST(test_batchnorm, fold) {
+  // conv1 -> bn1 -> relu -> max -> bn2，bn1 折叠到 conv1 里，bn2 前面不是卷积，由 BatchNormLayer 执行
+  TempModelFile model("batchnorm_test");
+  model.WriteParam("7767517\n7 6\n"
+                   "pnnx.Input pnnx_input_0 0 1 0 #0=(1,3,8,8)f32\n"
+                   "nn.Conv2d conv1 1 1 0 1 bias=False dilation=(1,1) groups=1 in_channels=3 kernel_size=(3,3) "
+                   "out_channels=4 padding=(1,1) padding_mode=zeros stride=(1,1) @weight=(4,3,3,3)f32 "
+                   "#0=(1,3,8,8)f32 #1=(1,4,8,8)f32\n"
+                   "nn.BatchNorm2d bn1 1 1 1 2 affine=True eps=1.000000e-05 num_features=4 @running_mean=(4)f32 "
+                   "@running_var=(4)f32 @weight=(4)f32 @bias=(4)f32 #1=(1,4,8,8)f32 #2=(1,4,8,8)f32\n"
+                   "nn.ReLU relu 1 1 2 3 #2=(1,4,8,8)f32 #3=(1,4,8,8)f32\n"
+                   "nn.MaxPool2d max 1 1 3 4 ceil_mode=False dilation=(1,1) kernel_size=(2,2) padding=(0,0) "
+                   "return_indices=False stride=(2,2) #3=(1,4,8,8)f32 #4=(1,4,4,4)f32\n"
+                   "nn.BatchNorm2d bn2 1 1 4 5 affine=False eps=1.000000e-03 num_features=4 @running_mean=(4)f32 "
+                   "@running_var=(4)f32 #4=(1,4,4,4)f32 #5=(1,4,4,4)f32\n"
+                   "pnnx.Output pnnx_output_0 1 0 5 #5=(1,4,4,4)f32\n");
+  ASSERT_TRUE(model.WriteBin({{"conv1.weight", RandValues(4 * 3 * 3 * 3, -1.f, 1.f)},
+                              {"bn1.running_mean", RandValues(4, -0.5f, 0.5f)},
+                              {"bn1.running_var", RandValues(4, 0.2f, 3.f)},
+                              {"bn1.weight", RandValues(4, -1.5f, 1.5f)},
+                              {"bn1.bias", RandValues(4, -0.3f, 0.3f)},
+                              {"bn2.running_mean", RandValues(4, 0.f, 1.f)},
+                              {"bn2.running_var", RandValues(4, 1.f, 2.f)}}));
+
+  RuntimeGraph graph(model.param_path(), model.bin_path());
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  RuntimeGraph reference(model.param_path(), model.bin_path());
+  reference.set_fold_batchnorm(false);
+  reference.Build("pnnx_input_0", "pnnx_output_0");
+
+  std::vector<std::string> names;
+  for (const auto &op : graph.operators()) {
+    names.push_back(op->name);
+  }
+  ASSERT_TRUE(std::find(names.begin(), names.end(), "bn1") == names.end());
+  ASSERT_TRUE(std::find(names.begin(), names.end(), "bn2") != names.end());
+  ASSERT_EQ(reference.operators().size(), graph.operators().size() + 1);
+
+  for (uint32_t iteration = 0; iteration < 2; ++iteration) {
+    sftensor input = std::make_shared<ftensor>(3, 8, 8);
+    input->Rand();
+    const std::vector<sftensor> &outputs = graph.Forward(std::vector<sftensor>{input});
+    const std::vector<sftensor> &expected = reference.Forward(std::vector<sftensor>{input});
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_EQ(outputs.front()->shape(), std::vector<uint32_t>({4, 4, 4}));
+    ASSERT_LT(TensorCompare(outputs.front(), expected.front()).max_abs, 1e-4f);
+  }
+}
@@ -0,0 +1,286 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include "runtime/calibrator.hpp"
+#include "runtime/quant_table.hpp"
+#include "data/tensor_util.hpp"
+#include "test_model_file.hpp"
+
+using namespace kuiper_infer;
+
+TEST(test_calibrator, histogram) {
+  // 大部分值在 [-1, 1]，加上少量离群值
+  std::mt19937 engine(7);
+  std::normal_distribution<float> distribution(0.f, 0.3f);
+  std::vector<float> values(100000);
+  for (float &value : values) {
+    value = std::max(-1.f, std::min(1.f, distribution(engine)));
+  }
+  values.at(10) = 40.f;
+  values.at(20) = -30.f;
+
+  ActivationHistogram histogram;
+  // 分两次加入，第二次加入离群值时范围翻倍
+  histogram.Add(values.data(), 50);
+  histogram.Add(values.data() + 50, values.size() - 50);
+  ASSERT_EQ(histogram.count(), values.size());
+  ASSERT_EQ(histogram.min(), -30.f);
+  ASSERT_EQ(histogram.max(), 40.f);
+
+  const auto [min, max] = histogram.Range(CalibrationMethod::kMinMax, 1.f);
+  ASSERT_EQ(min, -30.f);
+  ASSERT_EQ(max, 40.f);
+
+  // 分位数和熵方法都会截掉离群值
+  const float percentile = histogram.Percentile(0.999f);
+  ASSERT_GT(percentile, 0.5f);
+  ASSERT_LT(percentile, 2.f);
+  const float threshold = histogram.EntropyThreshold(128);
+  ASSERT_GT(threshold, 0.5f);
+  ASSERT_LT(threshold, 5.f);
+  const auto [entropy_min, entropy_max] = histogram.Range(CalibrationMethod::kEntropy, 1.f);
+  ASSERT_FLOAT_EQ(entropy_min, -threshold);
+  ASSERT_FLOAT_EQ(entropy_max, threshold);
+
+  // 全 0
+  ActivationHistogram zeros;
+  std::vector<float> zero_values(16, 0.f);
+  zeros.Add(zero_values.data(), zero_values.size());
+  ASSERT_EQ(zeros.Percentile(0.99f), 0.f);
+  ASSERT_EQ(zeros.EntropyThreshold(128), 0.f);
+}
+
+TEST(test_calibrator, method_name) {
+  CalibrationMethod method = CalibrationMethod::kMinMax;
+  ASSERT_TRUE(ParseCalibrationMethod("entropy", method));
+  ASSERT_EQ(method, CalibrationMethod::kEntropy);
+  ASSERT_TRUE(ParseCalibrationMethod(CalibrationMethodName(CalibrationMethod::kPercentile), method));
+  ASSERT_EQ(method, CalibrationMethod::kPercentile);
+  ASSERT_FALSE(ParseCalibrationMethod("kl", method));
+  ASSERT_EQ(method, CalibrationMethod::kPercentile);
+}
+
+TEST(test_calibrator, quant_table) {
+  ASSERT_EQ(QuantTable::TablePath("../tmp/test.pnnx.param"), "../tmp/test.pnnx.qtable");
+  ASSERT_EQ(QuantTable::TablePath("model"), "model.qtable");
+
+  QuantTable table;
+  QuantParams activation;
+  activation.scales = {0.0123456789f};
+  activation.zero_points = {17};
+  table.activations.insert({"0", activation});
+  QuantParams weight;
+  weight.is_signed = true;
+  weight.scales = {0.5f, 1.f / 3.f};
+  weight.zero_points = {0, 0};
+  table.weights.insert({"conv1", weight});
+  table.float_layers.insert("max");
+
+  const std::string &table_path = "../tmp/test_table.qtable";
+  ASSERT_TRUE(table.Save(table_path));
+  QuantTable loaded;
+  ASSERT_TRUE(loaded.Load(table_path));
+  ASSERT_EQ(loaded.activations, table.activations);
+  ASSERT_EQ(loaded.weights, table.weights);
+  ASSERT_EQ(loaded.float_layers, table.float_layers);
+
+  // 损坏的文件不改变表的内容
+  {
+    std::ofstream out(table_path, std::ios::app);
+    out << "weight conv2 1 2 0.5\n";
+  }
+  ASSERT_FALSE(loaded.Load(table_path));
+  ASSERT_EQ(loaded.weights, table.weights);
+  std::filesystem::remove(table_path);
+  ASSERT_FALSE(loaded.Load(table_path));
+}
+
+TEST(test_calibrator, load_samples) {
+  const std::string &dir = "../tmp/calibrate_samples";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  // 同一个样本分别保存为 csv 和 bin
+  const std::vector<float> values{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  {
+    std::ofstream out(dir + "/a.csv");
+    // 2 个通道，每个通道 2x3，通道的矩阵按行排列
+    out << "1,2,3\n4,5,6\n7,8,9\n10,11,12\n";
+  }
+  {
+    std::ofstream out(dir + "/b.bin", std::ios::binary);
+    out.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(float));
+  }
+  {
+    std::ofstream out(dir + "/ignored.txt");
+    out << "1\n";
+  }
+
+  const std::vector<sftensor> &samples = Calibrator::LoadSamples(dir, 2, 2, 3);
+  ASSERT_EQ(samples.size(), 2);
+  for (const sftensor &sample : samples) {
+    ASSERT_EQ(sample->channels(), 2);
+    ASSERT_EQ(sample->at(0, 0, 1), 2.f);
+    ASSERT_EQ(sample->at(0, 1, 0), 4.f);
+    ASSERT_EQ(sample->at(1, 1, 2), 12.f);
+  }
+  ASSERT_TRUE(TensorIsSame(samples.at(0), samples.at(1)));
+  std::filesystem::remove_all(dir);
+}
+
+TEST(test_calibrator, calibrate) {
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  Calibrator calibrator(param_path, bin_path, "pnnx_input_0", "pnnx_output_0");
+  ASSERT_EQ(calibrator.input_shape(), std::vector<uint32_t>({1, 16, 16}));
+
+  std::vector<sftensor> samples;
+  for (uint32_t i = 0; i < 8; ++i) {
+    sftensor sample = std::make_shared<ftensor>(1, 16, 16);
+    sample->Rand();
+    samples.push_back(sample);
+  }
+  calibrator.Observe(std::vector<sftensor>(samples.begin(), samples.begin() + 4));
+  calibrator.Observe(std::vector<sftensor>(samples.begin() + 4, samples.end()));
+  // 输入和每个算子的输出
+  ASSERT_EQ(calibrator.histograms().size(), 5);
+  ASSERT_EQ(calibrator.histograms().at("0").count(), 8 * 16 * 16);
+  ASSERT_EQ(calibrator.histograms().at("4").count(), 8 * 8 * 8);
+
+  const QuantTable &table = calibrator.Compute(CalibrationMethod::kMinMax);
+  ASSERT_EQ(table.activations.size(), 5);
+  ASSERT_EQ(table.weights.size(), 2);
+  ASSERT_EQ(table.weights.at("conv1").scales.size(), 1);
+  ASSERT_TRUE(table.weights.at("conv2").is_signed);
+  ASSERT_EQ(table.weights.at("conv2").zero_point(0), 0);
+
+  const std::string &quantized_param = "../tmp/test_int8.pnnx.param";
+  const std::string &quantized_bin = "../tmp/test_int8.pnnx.bin";
+  const std::string &table_path = QuantTable::TablePath(quantized_param);
+  ASSERT_TRUE(calibrator.SaveQuantizedModel(table, quantized_param, quantized_bin, table_path));
+  QuantTable loaded;
+  ASSERT_TRUE(loaded.Load(table_path));
+  ASSERT_EQ(loaded.weights, table.weights);
+
+  // 量化后的模型仍然可以直接运行，和 fp32 的结果接近
+  RuntimeGraph graph(param_path, bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  RuntimeGraph quantized_graph(quantized_param, quantized_bin);
+  quantized_graph.Build("pnnx_input_0", "pnnx_output_0");
+  const std::vector<sftensor> &outputs = graph.Forward(std::vector<sftensor>{samples.front()});
+  const std::vector<sftensor> &quantized_outputs = quantized_graph.Forward(std::vector<sftensor>{samples.front()});
+  const TensorErrorStats &stats = TensorCompare(quantized_outputs.front(), outputs.front());
+  ASSERT_GT(stats.max_abs, 0.f);
+  ASSERT_LT(stats.max_abs, 0.05f);
+
+  const std::vector<LayerDrift> &drifts = calibrator.MeasureDrift(table, quantized_param, quantized_bin, samples);
+  ASSERT_EQ(drifts.size(), 4);
+  ASSERT_EQ(drifts.front().type, "nn.Conv2d");
+  for (const LayerDrift &drift : drifts) {
+    ASSERT_GT(drift.magnitude, 0.f) << drift.name;
+    ASSERT_LT(drift.isolated.mean_abs, 0.05f * drift.magnitude) << drift.name;
+    ASSERT_LT(drift.cumulative.mean_abs, 0.1f * drift.magnitude) << drift.name;
+  }
+
+  // 全部保持 fp32 时没有误差
+  QuantTable float_table = table;
+  float_table.float_layers = {"conv1", "conv2", "pnnx_expr_0", "max"};
+  ASSERT_TRUE(calibrator.SaveQuantizedModel(float_table, quantized_param, quantized_bin, table_path));
+  const std::vector<LayerDrift> &float_drifts =
+      calibrator.MeasureDrift(float_table, quantized_param, quantized_bin, samples);
+  ASSERT_EQ(float_drifts.size(), 4);
+  for (const LayerDrift &drift : float_drifts) {
+    ASSERT_LT(drift.isolated.max_abs, 1e-5f) << drift.name;
+    ASSERT_LT(drift.cumulative.max_abs, 1e-5f) << drift.name;
+  }
+
+  std::filesystem::remove(quantized_param);
+  std::filesystem::remove(quantized_bin);
+  std::filesystem::remove(table_path);
+}
+
+TEST(test_calibrator, conv_batchnorm) {
+  // bn1 的 weight / sqrt(var) 远小于 1，折叠后的卷积核和原始卷积核的范围不同
+  TempModelFile model("calibrate_batchnorm");
+  model.WriteParam("7767517\n5 4\n"
+                   "pnnx.Input pnnx_input_0 0 1 0 #0=(1,3,8,8)f32\n"
+                   "nn.Conv2d conv1 1 1 0 1 bias=False dilation=(1,1) groups=1 in_channels=3 kernel_size=(3,3) "
+                   "out_channels=4 padding=(1,1) padding_mode=zeros stride=(1,1) @weight=(4,3,3,3)f32 "
+                   "#0=(1,3,8,8)f32 #1=(1,4,8,8)f32\n"
+                   "nn.BatchNorm2d bn1 1 1 1 2 affine=True eps=1.000000e-05 num_features=4 @running_mean=(4)f32 "
+                   "@running_var=(4)f32 @weight=(4)f32 @bias=(4)f32 #1=(1,4,8,8)f32 #2=(1,4,8,8)f32\n"
+                   "nn.ReLU relu 1 1 2 3 #2=(1,4,8,8)f32 #3=(1,4,8,8)f32\n"
+                   "pnnx.Output pnnx_output_0 1 0 3 #3=(1,4,8,8)f32\n");
+  auto values = [](uint32_t count, float low, float high) {
+    std::vector<float> result(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      result.at(i) = low + (high - low) * float((i * 37 + 11) % 101) / 100.f;
+    }
+    return result;
+  };
+  const std::vector<float> &weight = values(4 * 3 * 3 * 3, -1.f, 1.f);
+  ASSERT_TRUE(model.WriteBin({{"conv1.weight", weight},
+                              {"bn1.running_mean", values(4, -0.1f, 0.1f)},
+                              {"bn1.running_var", values(4, 1.f, 2.f)},
+                              {"bn1.weight", values(4, 0.05f, 0.2f)},
+                              {"bn1.bias", values(4, 0.f, 0.1f)}}));
+
+  Calibrator calibrator(model.param_path(), model.bin_path(), "pnnx_input_0", "pnnx_output_0");
+  std::vector<sftensor> samples;
+  for (uint32_t i = 0; i < 4; ++i) {
+    sftensor sample = std::make_shared<ftensor>(3, 8, 8);
+    sample->Rand();
+    samples.push_back(sample);
+  }
+  calibrator.Observe(samples);
+  // 卷积和 BatchNorm 的输出分别统计
+  ASSERT_EQ(calibrator.histograms().size(), 4);
+  ASSERT_EQ(calibrator.histograms().count("1"), 1);
+
+  // 卷积核参数来自 pnnx 里原始的卷积核
+  const QuantTable &table = calibrator.Compute(CalibrationMethod::kMinMax);
+  const QuantParams &weight_params = table.weights.at("conv1");
+  ASSERT_EQ(weight_params.scales.size(), 4);
+  const size_t kernel_size = weight.size() / 4;
+  for (uint32_t k = 0; k < 4; ++k) {
+    const auto [min, max] =
+        std::minmax_element(weight.begin() + k * kernel_size, weight.begin() + (k + 1) * kernel_size);
+    ASSERT_FLOAT_EQ(weight_params.scale(k), ChooseQuantParams(*min, *max, true, true).first);
+  }
+
+  const std::string &quantized_param = "../tmp/calibrate_batchnorm_int8.pnnx.param";
+  const std::string &quantized_bin = "../tmp/calibrate_batchnorm_int8.pnnx.bin";
+  const std::string &table_path = QuantTable::TablePath(quantized_param);
+  ASSERT_TRUE(calibrator.SaveQuantizedModel(table, quantized_param, quantized_bin, table_path));
+
+  RuntimeGraph graph(model.param_path(), model.bin_path());
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  const std::vector<sftensor> &outputs = graph.Forward(std::vector<sftensor>{samples.front()});
+  const sftensor expected = TensorClone(outputs.front());
+  float magnitude = 0.f;
+  for (uint32_t i = 0; i < expected->size(); ++i) {
+    magnitude = std::max(magnitude, std::abs(expected->raw_ptr()[i]));
+  }
+  ASSERT_GT(magnitude, 0.f);
+
+  // 保存的模型折叠 BatchNorm 后运行，卷积核没有被截断
+  RuntimeGraph quantized_graph(quantized_param, quantized_bin);
+  quantized_graph.Build("pnnx_input_0", "pnnx_output_0");
+  const std::vector<sftensor> &quantized_outputs = quantized_graph.Forward(std::vector<sftensor>{samples.front()});
+  ASSERT_LT(TensorCompare(quantized_outputs.front(), expected).max_abs, 0.02f * magnitude);
+
+  // 按量化表 int8 计算，折叠后的卷积核重新计算参数
+  RuntimeGraph int8_graph(model.param_path(), model.bin_path());
+  int8_graph.set_quant_table(table_path);
+  int8_graph.Build("pnnx_input_0", "pnnx_output_0");
+  const std::vector<sftensor> &int8_outputs = int8_graph.Forward(std::vector<sftensor>{samples.front()});
+  ASSERT_LT(TensorCompare(int8_outputs.front(), expected).max_abs, 0.05f * magnitude);
+
+  std::filesystem::remove(quantized_param);
+  std::filesystem::remove(quantized_bin);
+  std::filesystem::remove(table_path);
+}
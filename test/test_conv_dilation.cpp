@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "data/tensor_util.hpp"
+#include "data/tensor_view.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/direct_conv_layer.hpp"
+
+using namespace kuiper_infer;
+
+static std::shared_ptr<ConvOp> MakeDilatedConvOp(uint32_t in_channels, uint32_t out_channels, uint32_t groups,
+                                                 uint32_t kernel_size, Shape stride, Shape padding, Shape dilation) {
+  std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(stride, padding, true, groups);
+  conv_op->set_dilation(dilation);
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < out_channels; ++k) {
+    sftensor kernel = std::make_shared<ftensor>(in_channels / groups, kernel_size, kernel_size);
+    kernel->Rand();
+    weights.push_back(kernel);
+    sftensor bias_value = std::make_shared<ftensor>(1, 1, 1);
+    bias_value->index(0) = 0.1f * float(k);
+    bias.push_back(bias_value);
+  }
+  conv_op->set_weights(weights);
+  conv_op->set_bias(bias);
+  return conv_op;
+}
+
+// 按定义逐个元素计算的参考实现
+static sftensor ReferenceConv(const sftensor &input, const ConvOp &conv_op) {
+  const auto [stride_h, stride_w] = conv_op.get_stride();
+  const auto [padding_h, padding_w] = conv_op.get_padding();
+  const auto [dilation_h, dilation_w] = conv_op.get_dilation();
+  const std::vector<uint32_t> &kernel_shape = conv_op.kernel_shape();
+  const uint32_t kernel_c = kernel_shape.at(0);
+  const uint32_t kernel_h = kernel_shape.at(1);
+  const uint32_t kernel_w = kernel_shape.at(2);
+  const uint32_t kernels_per_group = conv_op.kernel_count() / conv_op.get_groups();
+  const uint32_t output_h = (input->rows() + 2 * padding_h - dilation_h * (kernel_h - 1) - 1) / stride_h + 1;
+  const uint32_t output_w = (input->cols() + 2 * padding_w - dilation_w * (kernel_w - 1) - 1) / stride_w + 1;
+  sftensor output = std::make_shared<ftensor>(conv_op.kernel_count(), output_h, output_w);
+  for (uint32_t k = 0; k < conv_op.kernel_count(); ++k) {
+    const sftensor &kernel = conv_op.get_weights().at(k);
+    const uint32_t first_channel = k / kernels_per_group * kernel_c;
+    for (uint32_t oh = 0; oh < output_h; ++oh) {
+      for (uint32_t ow = 0; ow < output_w; ++ow) {
+        float sum = conv_op.get_bias().at(k)->index(0);
+        for (uint32_t c = 0; c < kernel_c; ++c) {
+          for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+            for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+              const int row = int(oh * stride_h + kh * dilation_h) - int(padding_h);
+              const int col = int(ow * stride_w + kw * dilation_w) - int(padding_w);
+              if (row >= 0 && row < int(input->rows()) && col >= 0 && col < int(input->cols())) {
+                sum += kernel->at(c, kh, kw) * input->at(first_channel + c, row, col);
+              }
+            }
+          }
+        }
+        output->at(k, oh, ow) = sum;
+      }
+    }
+  }
+  return output;
+}
+
+TEST(test_conv_dilation, all_paths) {
+  // im2col(连续和按步长读取)、隐式 GEMM 和直接卷积都和参考实现一致
+  sftensor input = std::make_shared<ftensor>(4, 21, 18);
+  input->Rand();
+  auto values = std::make_shared<std::vector<float>>();
+  for (uint32_t c = 0; c < input->channels(); ++c) {
+    for (uint32_t r = 0; r < input->rows(); ++r) {
+      for (uint32_t col = 0; col < input->cols(); ++col) {
+        values->push_back(input->at(c, r, col));
+      }
+    }
+  }
+  const TensorView &row_major = TensorView::RowMajor(values, values->data(), 4, 21, 18);
+
+  for (const uint32_t groups : {1u, 4u}) {
+    for (const Shape &dilation : {Shape(2, 2), Shape(3, 1), Shape(4, 6)}) {
+      for (const uint32_t stride : {1u, 2u}) {
+        const std::shared_ptr<ConvOp> &conv_op =
+            MakeDilatedConvOp(4, 8, groups, 3, Shape(stride, stride), Shape(dilation.first, dilation.second),
+                              dilation);
+        const sftensor &expected = ReferenceConv(input, *conv_op);
+        const std::string label = std::to_string(groups) + " " + std::to_string(dilation.first) + "x" +
+                                  std::to_string(dilation.second) + " " + std::to_string(stride);
+
+        std::vector<sftensor> outputs;
+        ConvLayer(conv_op).Forward({input}, outputs);
+        ASSERT_EQ(outputs.front()->shape(), expected->shape()) << label;
+        ASSERT_LT(TensorCompare(outputs.front(), expected).max_abs, 1e-4f) << label;
+
+        std::vector<sftensor> view_outputs;
+        ConvLayer(conv_op).ForwardViews({row_major}, view_outputs);
+        ASSERT_LT(TensorCompare(view_outputs.front(), expected).max_abs, 1e-4f) << label;
+
+        std::vector<sftensor> implicit_outputs;
+        ConvLayer(conv_op, true).Forward({input}, implicit_outputs);
+        ASSERT_LT(TensorCompare(implicit_outputs.front(), expected).max_abs, 1e-4f) << label;
+
+        std::vector<sftensor> direct_outputs;
+        DirectConvLayer(conv_op).Forward({input}, direct_outputs);
+        ASSERT_LT(TensorCompare(direct_outputs.front(), expected).max_abs, 1e-4f) << label;
+      }
+    }
+  }
+}
+
+TEST(test_conv_dilation, output_size) {
+  // DeepLab 的 atrous 卷积: 3x3、dilation 和 padding 相同时输出尺寸不变
+  sftensor input = std::make_shared<ftensor>(2, 33, 33);
+  input->Rand();
+  const std::shared_ptr<ConvOp> &conv_op = MakeDilatedConvOp(2, 3, 1, 3, Shape(1, 1), Shape(12, 12), Shape(12, 12));
+  std::vector<sftensor> outputs;
+  ConvLayer(conv_op).Forward({input}, outputs);
+  ASSERT_EQ(outputs.front()->shape(), std::vector<uint32_t>({3, 33, 33}));
+  ASSERT_LT(TensorCompare(outputs.front(), ReferenceConv(input, *conv_op)).max_abs, 1e-4f);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "data/tensor_util.hpp"
+#include "factory/layer_factory.hpp"
+#include "layer/conv_layer.hpp"
+
+using namespace kuiper_infer;
+
+static std::shared_ptr<ConvOp> MakeConvOp(uint32_t in_channels, uint32_t out_channels, uint32_t groups,
+                                          uint32_t kernel_size, Shape stride, Shape padding) {
+  std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(stride, padding, true, groups);
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < out_channels; ++k) {
+    sftensor kernel = std::make_shared<ftensor>(in_channels / groups, kernel_size, kernel_size);
+    kernel->Rand();
+    weights.push_back(kernel);
+    sftensor bias_value = std::make_shared<ftensor>(1, 1, 1);
+    bias_value->index(0) = 0.1f * float(k);
+    bias.push_back(bias_value);
+  }
+  conv_op->set_weights(weights);
+  conv_op->set_bias(bias);
+  return conv_op;
+}
+
+static std::vector<sftensor> RandInputs(uint32_t batch, uint32_t channels, uint32_t rows, uint32_t cols) {
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < batch; ++i) {
+    sftensor input = std::make_shared<ftensor>(channels, rows, cols);
+    input->Rand();
+    inputs.push_back(input);
+  }
+  return inputs;
+}
+
+static void ExpectSameOutputs(const std::vector<sftensor> &outputs, const std::vector<sftensor> &expected) {
+  ASSERT_EQ(outputs.size(), expected.size());
+  for (uint32_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_EQ(outputs.at(i)->shape(), expected.at(i)->shape());
+    ASSERT_LT(TensorCompare(outputs.at(i), expected.at(i)).max_abs, 1e-4f) << i;
+  }
+}
+
+TEST(test_conv_implicit, same_as_im2col) {
+  // 覆盖分组、步长、不对称的 padding、多个 batch 元素(结果分段写回)和单个输入(直接写到输出)
+  for (const uint32_t batch : {1u, 2u}) {
+    const std::vector<sftensor> &inputs = RandInputs(batch, 6, 19, 15);
+    for (const uint32_t groups : {1u, 3u}) {
+      for (const uint32_t stride : {1u, 2u}) {
+        const std::shared_ptr<ConvOp> &conv_op = MakeConvOp(6, 12, groups, 3, Shape(stride, stride), Shape(1, 2));
+        // 卷积核在 set_weights 时按 group 预打包
+        ASSERT_EQ(conv_op->packed_weights().size(), groups);
+        std::vector<sftensor> expected;
+        ConvLayer(conv_op).Forward(inputs, expected);
+        std::vector<sftensor> outputs;
+        ConvLayer(conv_op, true).Forward(inputs, outputs);
+        ExpectSameOutputs(outputs, expected);
+      }
+    }
+  }
+}
+
+TEST(test_conv_implicit, halo) {
+  // 输入和输出都带边框，和计算图里 PlanHalos 之后一样
+  const std::vector<sftensor> &inputs = RandInputs(1, 4, 13, 11);
+  const std::shared_ptr<ConvOp> &conv_op = MakeConvOp(4, 5, 1, 3, Shape(1, 1), Shape(1, 1));
+  std::vector<sftensor> expected;
+  ConvLayer(conv_op).Forward(inputs, expected);
+
+  ConvLayer layer(conv_op, true);
+  Halo output_halo;
+  output_halo.h = 1;
+  output_halo.w = 2;
+  layer.set_input_halo(layer.InputPadding());
+  layer.set_output_halo(output_halo);
+  std::vector<sftensor> padded_outputs;
+  layer.Forward({TensorPadding(inputs.front(), {1, 1, 1, 1}, 0.f)}, padded_outputs);
+  const sftensor &padded = padded_outputs.front();
+  const sftensor &reference = expected.front();
+  for (uint32_t c = 0; c < reference->channels(); ++c) {
+    for (uint32_t r = 0; r < reference->rows(); ++r) {
+      for (uint32_t col = 0; col < reference->cols(); ++col) {
+        ASSERT_NEAR(padded->at(c, r + 1, col + 2), reference->at(c, r, col), 1e-4f);
+      }
+    }
+  }
+}
+
+TEST(test_conv_implicit, workspace_limit) {
+  // im2col 矩阵超过上限时默认实现也改用隐式 GEMM，结果矩阵按 workspace 分段
+  const std::vector<sftensor> &inputs = RandInputs(2, 8, 41, 37);
+  const std::shared_ptr<ConvOp> &conv_op = MakeConvOp(8, 16, 1, 3, Shape(1, 1), Shape(1, 1));
+  std::vector<sftensor> expected;
+  ConvLayer(conv_op).Forward(inputs, expected);
+
+  const size_t limit = ConvLayer::workspace_limit();
+  ConvLayer::set_workspace_limit(16 * 1024);
+  std::vector<sftensor> outputs;
+  ConvLayer(conv_op).Forward(inputs, outputs);
+  ConvLayer::set_workspace_limit(limit);
+  ExpectSameOutputs(outputs, expected);
+
+  ASSERT_TRUE(LayerRegister::CreateLayer(conv_op, "implicit_gemm") != nullptr);
+}
+
+TEST(test_conv_implicit, compressed) {
+  // 卷积核压缩存储时按段转换，64 * 3 * 3 的卷积核一段 16 个，40 个卷积核分成 3 段
+  for (const uint32_t batch : {1u, 2u}) {
+    const std::vector<sftensor> &inputs = RandInputs(batch, 64, 12, 10);
+    for (const uint32_t bits : {16u, 8u}) {
+      const std::shared_ptr<ConvOp> &conv_op = MakeConvOp(64, 40, 1, 3, Shape(1, 1), Shape(1, 1));
+      if (bits == 16) {
+        conv_op->CompressWeights(HalfType::kFloat16);
+      } else {
+        conv_op->set_weight_bits(bits);
+      }
+      ASSERT_TRUE(conv_op->weights_compressed());
+      std::vector<sftensor> expected;
+      ConvLayer(conv_op).Forward(inputs, expected);
+      std::vector<sftensor> outputs;
+      ConvLayer(conv_op, true).Forward(inputs, outputs);
+      ExpectSameOutputs(outputs, expected);
+    }
+  }
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include "data/gemm_int8.hpp"
+#include "data/quantize.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+#include "runtime/calibrator.hpp"
+#include "runtime/runtime_ir.hpp"
+
+using namespace kuiper_infer;
+
+static QuantParams MakeParams(float min, float max) {
+  const auto [scale, zero_point] = ChooseQuantParams(min, max, false, false);
+  QuantParams params;
+  params.scales = {scale};
+  params.zero_points = {zero_point};
+  return params;
+}
+
+static sftensor FakeQuantize(const sftensor &tensor, const QuantParams &params) {
+  return qtensor::Quantize(*tensor, params)->Dequantize();
+}
+
+TEST(test_conv_int8, gemm) {
+  // 尺寸都不是分块大小的整数倍，A 取到 255，B 取到 -128 和 127，覆盖 vpmaddubsw 会饱和的情况
+  const uint32_t m = 75, n = 21, k = 27;
+  std::mt19937 engine(3);
+  std::uniform_int_distribution<int> a_dist(0, 255);
+  std::uniform_int_distribution<int> b_dist(-128, 127);
+  std::vector<uint8_t> a(m * 28);
+  std::vector<int8_t> b(n * k);
+  for (auto &value : a) {
+    value = uint8_t(a_dist(engine));
+  }
+  for (auto &value : b) {
+    value = int8_t(b_dist(engine));
+  }
+  std::fill(a.begin(), a.begin() + 28, uint8_t(255));
+  std::fill(b.begin(), b.begin() + k, int8_t(127));
+  std::fill(b.begin() + k, b.begin() + 2 * k, int8_t(-128));
+
+  const PackedInt8Matrix &packed = PackInt8Matrix(b.data(), n, k);
+  ASSERT_EQ(packed.k_padded, 28);
+  std::vector<int32_t> c(m * n);
+  GemmU8S8(a.data(), 28, m, packed, c.data(), m);
+  for (uint32_t i = 0; i < m; ++i) {
+    for (uint32_t j = 0; j < n; ++j) {
+      int32_t expected = 0;
+      for (uint32_t p = 0; p < k; ++p) {
+        expected += int32_t(a.at(i * 28 + p)) * int32_t(b.at(j * k + p));
+      }
+      ASSERT_EQ(c.at(j * m + i), expected) << i << " " << j;
+    }
+  }
+
+  // 后处理：扣除零点、缩放、bias、relu 后重新量化
+  Int8Epilogue epilogue;
+  epilogue.input_zero_point = 7;
+  epilogue.relu = true;
+  epilogue.output_scale = 20.f;
+  epilogue.output_zero_point = 3;
+  for (uint32_t j = 0; j < n; ++j) {
+    epilogue.scales.push_back(0.01f * float(j + 1));
+    epilogue.bias.push_back(float(j) - 10.f);
+  }
+  std::vector<uint8_t> q(m * n);
+  GemmU8S8(a.data(), 28, m, packed, epilogue, q.data(), m);
+  for (uint32_t i = 0; i < m; ++i) {
+    for (uint32_t j = 0; j < n; ++j) {
+      const int32_t acc = c.at(j * m + i) - epilogue.input_zero_point * packed.column_sums.at(j);
+      const float value = std::max(float(acc) * epilogue.scales.at(j) + epilogue.bias.at(j), 0.f);
+      const int32_t expected =
+          std::clamp(int32_t(std::nearbyint(value / epilogue.output_scale)) + epilogue.output_zero_point, 0, 255);
+      ASSERT_NEAR(q.at(j * m + i), expected, 1) << i << " " << j;
+    }
+  }
+}
+
+TEST(test_conv_int8, conv) {
+  // 分组、步长、padding 和 bias 都和 fp32 的模拟量化结果比较
+  const uint32_t in_channels = 8, out_channels = 12, groups = 2;
+  const uint32_t kernel_c = in_channels / groups;
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < out_channels; ++k) {
+    sftensor kernel = std::make_shared<ftensor>(kernel_c, 3, 3);
+    kernel->Rand();
+    kernel->Transform([](float value) { return (value - 0.5f) * 0.4f; });
+    weights.push_back(kernel);
+    sftensor bias_value = std::make_shared<ftensor>(1, 1, 1);
+    bias_value->index(0) = 0.1f * float(k) - 0.5f;
+    bias.push_back(bias_value);
+  }
+  std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(2, 1), Shape(1, 1), true, groups);
+  conv_op->set_weights(weights);
+  conv_op->set_bias(bias);
+
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 3; ++i) {
+    sftensor input = std::make_shared<ftensor>(in_channels, 15, 13);
+    input->Rand();
+    input->Transform([](float value) { return (value - 0.5f) * 6.f; });
+    inputs.push_back(input);
+  }
+  const QuantParams &input_params = MakeParams(-4.f, 4.f);
+  const QuantParams &output_params = MakeParams(-6.f, 6.f);
+
+  // 参考结果：输入模拟量化，卷积核按输出通道量化再反量化，fp32 卷积后模拟量化输出
+  std::vector<sftensor> expected;
+  {
+    std::vector<sftensor> quantized_weights;
+    for (const sftensor &kernel : weights) {
+      float abs_max = 0.f;
+      for (uint32_t i = 0; i < kernel->size(); ++i) {
+        abs_max = std::max(abs_max, std::fabs(kernel->index(i)));
+      }
+      QuantParams params;
+      params.scales = {abs_max / 127.f};
+      params.zero_points = {0};
+      params.is_signed = true;
+      quantized_weights.push_back(FakeQuantize(kernel, params));
+    }
+    std::shared_ptr<ConvOp> float_op = std::make_shared<ConvOp>(Shape(2, 1), Shape(1, 1), true, groups);
+    float_op->set_weights(quantized_weights);
+    float_op->set_bias(bias);
+    std::vector<sftensor> quantized_inputs;
+    for (const sftensor &input : inputs) {
+      quantized_inputs.push_back(FakeQuantize(input, input_params));
+    }
+    ConvLayer float_layer(float_op);
+    float_layer.Forward(quantized_inputs, expected);
+    for (sftensor &output : expected) {
+      output = FakeQuantize(output, output_params);
+    }
+  }
+
+  conv_op->EnableInt8(input_params, QuantParams(), output_params, false);
+  ASSERT_TRUE(conv_op->int8_enabled());
+  ASSERT_EQ(conv_op->int8_weights()->packed_weights.size(), groups);
+  ConvLayer layer(conv_op);
+  std::vector<sftensor> outputs;
+  layer.Forward(inputs, outputs);
+  ASSERT_EQ(outputs.size(), 3);
+  for (uint32_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_EQ(outputs.at(i)->shape(), expected.at(i)->shape());
+    // 浮点累加顺序不同，最多差一个量化间隔
+    const TensorErrorStats &stats = TensorCompare(outputs.at(i), expected.at(i));
+    ASSERT_LE(stats.max_abs, output_params.scale(0) * 1.01f);
+    ASSERT_LT(stats.mean_abs, output_params.scale(0) * 0.05f);
+  }
+
+  // 行主序的视图直接量化，不需要先转换排布
+  std::vector<TensorView> views;
+  for (const sftensor &input : inputs) {
+    auto values = std::make_shared<std::vector<float>>(input->values(true));
+    views.push_back(TensorView::RowMajor(values, values->data(), in_channels, 15, 13));
+  }
+  std::vector<sftensor> view_outputs;
+  layer.ForwardViews(views, view_outputs);
+  for (uint32_t i = 0; i < outputs.size(); ++i) {
+    ASSERT_TRUE(TensorIsSame(view_outputs.at(i), outputs.at(i)));
+  }
+
+  // 重新设置权重后回到 fp32
+  conv_op->set_weights(weights);
+  ASSERT_FALSE(conv_op->int8_enabled());
+}
+
+TEST(test_conv_int8, graph) {
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  const std::string &table_path = "../tmp/test_conv_int8.qtable";
+
+  std::vector<sftensor> samples;
+  for (uint32_t i = 0; i < 4; ++i) {
+    sftensor sample = std::make_shared<ftensor>(1, 16, 16);
+    sample->Rand();
+    samples.push_back(sample);
+  }
+  Calibrator calibrator(param_path, bin_path, "pnnx_input_0", "pnnx_output_0");
+  calibrator.Observe(samples);
+  QuantTable table = calibrator.Compute(CalibrationMethod::kMinMax);
+  table.float_layers.insert("conv2");
+  ASSERT_TRUE(table.Save(table_path));
+
+  RuntimeGraph graph(param_path, bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  RuntimeGraph int8_graph(param_path, bin_path);
+  int8_graph.set_quant_table(table_path);
+  ASSERT_EQ(int8_graph.quant_table(), table_path);
+  int8_graph.Build("pnnx_input_0", "pnnx_output_0");
+
+  const std::vector<sftensor> &outputs = graph.Forward(samples);
+  std::vector<sftensor> expected;
+  for (const sftensor &output : outputs) {
+    expected.push_back(TensorClone(output));
+  }
+  const std::vector<sftensor> &int8_outputs = int8_graph.Forward(samples);
+
+  // conv1 使用 int8 计算，标记为 float 的 conv2 保持 fp32，结果和 fp32 计算图完全相同
+  auto operand_tensors = [](const RuntimeGraph &runtime_graph, const std::string &name) {
+    for (const auto &op : runtime_graph.topo_operators()) {
+      if (op->name == name) {
+        return op->output_operands->tensors;
+      }
+    }
+    return std::vector<sftensor>();
+  };
+  for (uint32_t i = 0; i < samples.size(); ++i) {
+    ASSERT_FALSE(TensorIsSame(operand_tensors(int8_graph, "conv1").at(i), operand_tensors(graph, "conv1").at(i)));
+    ASSERT_TRUE(TensorIsSame(operand_tensors(int8_graph, "conv2").at(i), operand_tensors(graph, "conv2").at(i)));
+  }
+  ASSERT_EQ(int8_outputs.size(), samples.size());
+  for (uint32_t i = 0; i < samples.size(); ++i) {
+    const TensorErrorStats &stats = TensorCompare(int8_outputs.at(i), expected.at(i));
+    ASSERT_GT(stats.max_abs, 0.f);
+    ASSERT_LT(stats.max_abs, 0.1f);
+  }
+
+  // 量化表不存在时回退到 fp32
+  RuntimeGraph missing_graph(param_path, bin_path);
+  missing_graph.set_quant_table("../tmp/missing.qtable");
+  missing_graph.Build("pnnx_input_0", "pnnx_output_0");
+  const std::vector<sftensor> &missing_outputs = missing_graph.Forward(samples);
+  for (uint32_t i = 0; i < samples.size(); ++i) {
+    ASSERT_TRUE(TensorIsSame(missing_outputs.at(i), expected.at(i)));
+  }
+  std::filesystem::remove(table_path);
+}
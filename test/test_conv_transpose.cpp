@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "data/tensor_util.hpp"
+#include "factory/layer_factory.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/conv_transpose_layer.hpp"
+
+using namespace kuiper_infer;
+
+static std::shared_ptr<ConvTransposeOp> MakeConvTransposeOp(uint32_t in_channels, uint32_t out_channels,
+                                                            uint32_t groups, Shape kernel_size, Shape stride,
+                                                            Shape padding) {
+  std::shared_ptr<ConvTransposeOp> op = std::make_shared<ConvTransposeOp>(stride, padding, true, groups);
+  std::vector<sftensor> weights;
+  for (uint32_t ic = 0; ic < in_channels; ++ic) {
+    sftensor weight = std::make_shared<ftensor>(out_channels / groups, kernel_size.first, kernel_size.second);
+    weight->Rand();
+    weights.push_back(weight);
+  }
+  std::vector<sftensor> bias;
+  for (uint32_t oc = 0; oc < out_channels; ++oc) {
+    sftensor bias_value = std::make_shared<ftensor>(1, 1, 1);
+    bias_value->index(0) = 0.1f * float(oc);
+    bias.push_back(bias_value);
+  }
+  op->set_weights(weights);
+  op->set_bias(bias);
+  return op;
+}
+
+// 按定义把每个输入像素散射到输出的参考实现
+static sftensor ReferenceConvTranspose(const sftensor &input, const ConvTransposeOp &op) {
+  const auto [stride_h, stride_w] = op.get_stride();
+  const auto [padding_h, padding_w] = op.get_padding();
+  const auto [dilation_h, dilation_w] = op.get_dilation();
+  const auto [output_padding_h, output_padding_w] = op.get_output_padding();
+  const auto [kernel_h, kernel_w] = op.kernel_size();
+  const uint32_t in_per_group = op.in_channels() / op.get_groups();
+  const uint32_t out_per_group = op.out_channels() / op.get_groups();
+  const uint32_t output_h =
+      (input->rows() - 1) * stride_h - 2 * padding_h + dilation_h * (kernel_h - 1) + output_padding_h + 1;
+  const uint32_t output_w =
+      (input->cols() - 1) * stride_w - 2 * padding_w + dilation_w * (kernel_w - 1) + output_padding_w + 1;
+  sftensor output = std::make_shared<ftensor>(op.out_channels(), output_h, output_w);
+  for (uint32_t oc = 0; oc < op.out_channels(); ++oc) {
+    output->slice(oc).fill(op.get_bias().at(oc)->index(0));
+  }
+  for (uint32_t ic = 0; ic < op.in_channels(); ++ic) {
+    const sftensor &weight = op.get_weights().at(ic);
+    const uint32_t first_output = ic / in_per_group * out_per_group;
+    for (uint32_t k = 0; k < out_per_group; ++k) {
+      for (uint32_t h = 0; h < input->rows(); ++h) {
+        for (uint32_t w = 0; w < input->cols(); ++w) {
+          for (uint32_t kh = 0; kh < kernel_h; ++kh) {
+            for (uint32_t kw = 0; kw < kernel_w; ++kw) {
+              const int row = int(h * stride_h + kh * dilation_h) - int(padding_h);
+              const int col = int(w * stride_w + kw * dilation_w) - int(padding_w);
+              if (row >= 0 && row < int(output_h) && col >= 0 && col < int(output_w)) {
+                output->at(first_output + k, row, col) += weight->at(k, kh, kw) * input->at(ic, h, w);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+  return output;
+}
+
+TEST(test_conv_transpose, same_as_reference) {
+  // 覆盖分组、步长、padding、output_padding 和 dilation，以及比 kernel 和 padding 还小的输入
+  for (const std::vector<uint32_t> &shape :
+       {std::vector<uint32_t>{6, 9, 7}, std::vector<uint32_t>{6, 1, 5}, std::vector<uint32_t>{6, 2, 3}}) {
+    sftensor input = std::make_shared<ftensor>(shape.at(0), shape.at(1), shape.at(2));
+    input->Rand();
+    for (const uint32_t groups : {1u, 3u}) {
+      for (const uint32_t stride : {1u, 2u, 3u}) {
+        for (const uint32_t dilation : {1u, 2u}) {
+          for (const Shape &padding : {Shape(0, 0), Shape(1, 2)}) {
+            for (const uint32_t output_padding : {0u, std::max(stride, dilation) - 1}) {
+              const std::shared_ptr<ConvTransposeOp> &op =
+                  MakeConvTransposeOp(6, 9, groups, Shape(3, 4), Shape(stride, stride), padding);
+              op->set_dilation(Shape(dilation, dilation));
+              op->set_output_padding(Shape(output_padding, 0));
+              const sftensor &expected = ReferenceConvTranspose(input, *op);
+              const std::string label = std::to_string(shape.at(1)) + "x" + std::to_string(shape.at(2)) + " " +
+                                        std::to_string(groups) + " " + std::to_string(stride) + " " +
+                                        std::to_string(dilation) + " " + std::to_string(padding.first) + " " +
+                                        std::to_string(output_padding);
+
+              std::vector<sftensor> outputs;
+              ConvTransposeLayer(op).Forward({input}, outputs);
+              ASSERT_EQ(outputs.front()->shape(), expected->shape()) << label;
+              ASSERT_LT(TensorCompare(outputs.front(), expected).max_abs, 1e-4f) << label;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(test_conv_transpose, upsample_2x2) {
+  // stride 2、kernel 2 的上采样输出互不重叠，走直接写回的路径；多个 batch 元素和输出边框
+  const std::shared_ptr<ConvTransposeOp> &op = MakeConvTransposeOp(16, 8, 1, Shape(2, 2), Shape(2, 2), Shape(0, 0));
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 2; ++i) {
+    sftensor input = std::make_shared<ftensor>(16, 13, 10);
+    input->Rand();
+    inputs.push_back(input);
+  }
+  std::vector<sftensor> outputs;
+  ConvTransposeLayer(op).Forward(inputs, outputs);
+  ASSERT_EQ(outputs.size(), 2);
+  for (uint32_t i = 0; i < 2; ++i) {
+    ASSERT_EQ(outputs.at(i)->shape(), std::vector<uint32_t>({8, 26, 20}));
+    ASSERT_LT(TensorCompare(outputs.at(i), ReferenceConvTranspose(inputs.at(i), *op)).max_abs, 1e-4f) << i;
+  }
+
+  ConvTransposeLayer layer(op);
+  Halo output_halo;
+  output_halo.h = 1;
+  output_halo.w = 2;
+  layer.set_output_halo(output_halo);
+  std::vector<sftensor> padded_outputs;
+  layer.Forward({inputs.front()}, padded_outputs);
+  const sftensor &padded = padded_outputs.front();
+  const sftensor &reference = outputs.front();
+  for (uint32_t c = 0; c < reference->channels(); ++c) {
+    for (uint32_t r = 0; r < reference->rows(); ++r) {
+      for (uint32_t col = 0; col < reference->cols(); ++col) {
+        ASSERT_NEAR(padded->at(c, r + 1, col + 2), reference->at(c, r, col), 1e-4f);
+      }
+    }
+  }
+}
+
+TEST(test_conv_transpose, workspace_limit) {
+  // 结果矩阵超过 workspace 上限时按输入列分段计算
+  sftensor input = std::make_shared<ftensor>(8, 17, 23);
+  input->Rand();
+  for (const uint32_t stride : {1u, 2u}) {
+    const std::shared_ptr<ConvTransposeOp> &op =
+        MakeConvTransposeOp(8, 12, 2, Shape(stride, stride), Shape(stride, stride), Shape(0, 0));
+    const sftensor &expected = ReferenceConvTranspose(input, *op);
+    const size_t limit = ConvLayer::workspace_limit();
+    ConvLayer::set_workspace_limit(4 * 1024);
+    std::vector<sftensor> outputs;
+    ConvTransposeLayer(op).Forward({input}, outputs);
+    ConvLayer::set_workspace_limit(limit);
+    ASSERT_LT(TensorCompare(outputs.front(), expected).max_abs, 1e-4f) << stride;
+  }
+  ASSERT_TRUE(LayerRegister::CreateLayer(MakeConvTransposeOp(4, 4, 1, Shape(3, 3), Shape(1, 1), Shape(1, 1))) !=
+              nullptr);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include "data/quantize.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+#include "runtime/runtime_ir.hpp"
+
+using namespace kuiper_infer;
+
+// 按输出通道对称量化再反量化，和 ConvOp 只量化权重时的取值一致
+static sftensor FakeQuantizeKernel(const sftensor &kernel, uint32_t bits) {
+  float abs_max = 0.f;
+  for (uint32_t i = 0; i < kernel->size(); ++i) {
+    abs_max = std::max(abs_max, std::fabs(kernel->index(i)));
+  }
+  const float qmax = bits == 8 ? 127.f : 7.f;
+  const float scale = abs_max > 0.f ? abs_max / qmax : 1.f;
+  sftensor result = TensorClone(kernel);
+  result->Transform([scale, qmax](float value) {
+    return std::clamp(std::nearbyint(value / scale), -qmax, qmax) * scale;
+  });
+  return result;
+}
+
+TEST(test_conv_weight_bits, int4_values) {
+  // 奇数个，覆盖向量和标量两部分
+  const float scale = 0.5f;
+  std::vector<float> src;
+  for (int i = 0; i < 21; ++i) {
+    src.push_back(float(i - 10) * 0.37f);
+  }
+  src.push_back(100.f);
+  src.push_back(-100.f);
+  std::vector<uint8_t> packed((src.size() + 1) / 2);
+  QuantizeInt4Values(src.data(), packed.data(), src.size(), scale);
+  ASSERT_EQ(packed.back() >> 4, 0);
+
+  std::vector<float> dst(src.size());
+  DequantizeInt4Values(packed.data(), dst.data(), dst.size(), scale);
+  for (size_t i = 0; i < src.size(); ++i) {
+    const float expected = std::clamp(std::nearbyint(src.at(i) / scale), -7.f, 7.f) * scale;
+    ASSERT_EQ(dst.at(i), expected) << i;
+  }
+}
+
+TEST(test_conv_weight_bits, conv) {
+  // 输入矩阵分成多个行块，块的边界跨过 batch 元素，每个 group 的卷积核分成多个块反量化
+  const uint32_t in_channels = 64, out_channels = 72, groups = 2;
+  const uint32_t kernel_c = in_channels / groups;
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < out_channels; ++k) {
+    sftensor kernel = std::make_shared<ftensor>(kernel_c, 3, 3);
+    kernel->Rand();
+    kernel->Transform([](float value) { return value - 0.5f; });
+    weights.push_back(kernel);
+    sftensor bias_value = std::make_shared<ftensor>(1, 1, 1);
+    bias_value->index(0) = 0.01f * float(k);
+    bias.push_back(bias_value);
+  }
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 2; ++i) {
+    sftensor input = std::make_shared<ftensor>(in_channels, 20, 18);
+    input->Rand();
+    inputs.push_back(input);
+  }
+
+  for (const uint32_t bits : {8u, 4u}) {
+    std::vector<sftensor> quantized_weights;
+    for (const sftensor &kernel : weights) {
+      quantized_weights.push_back(FakeQuantizeKernel(kernel, bits));
+    }
+    std::shared_ptr<ConvOp> float_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(1, 1), true, groups);
+    float_op->set_weights(quantized_weights);
+    float_op->set_bias(bias);
+    std::vector<sftensor> expected;
+    ConvLayer(float_op).Forward(inputs, expected);
+
+    // set_weights 之前设置位数，直接量化传入的卷积核
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(1, 1), true, groups);
+    conv_op->set_weight_bits(bits);
+    conv_op->set_weights(weights);
+    conv_op->set_bias(bias);
+    ASSERT_EQ(conv_op->weight_bits(), bits);
+    ASSERT_TRUE(conv_op->weights_compressed());
+    ASSERT_TRUE(conv_op->get_weights().empty());
+    ASSERT_EQ(conv_op->kernel_count(), out_channels);
+    ASSERT_EQ(conv_op->kernel_shape(), std::vector<uint32_t>({kernel_c, 3, 3}));
+    const size_t kernel_bytes = bits == 8 ? kernel_c * 9 : (kernel_c * 9 + 1) / 2;
+    ASSERT_EQ(conv_op->get_quantized_weights()->data.size(), kernel_bytes * out_channels);
+
+    ConvLayer layer(conv_op);
+    std::vector<sftensor> outputs;
+    layer.Forward(inputs, outputs);
+    ASSERT_EQ(outputs.size(), inputs.size());
+    for (uint32_t i = 0; i < outputs.size(); ++i) {
+      const TensorErrorStats &stats = TensorCompare(outputs.at(i), expected.at(i));
+      ASSERT_LT(stats.max_abs, 1e-4f) << bits;
+    }
+
+    // 输出带边框时只写内部
+    Halo halo;
+    halo.h = 1;
+    halo.w = 2;
+    layer.set_output_halo(halo);
+    std::vector<sftensor> padded_outputs;
+    layer.Forward(inputs, padded_outputs);
+    for (uint32_t i = 0; i < padded_outputs.size(); ++i) {
+      const sftensor &padded = padded_outputs.at(i);
+      ASSERT_EQ(padded->rows(), expected.at(i)->rows() + 2);
+      ASSERT_EQ(padded->cols(), expected.at(i)->cols() + 4);
+      for (uint32_t c = 0; c < padded->channels(); ++c) {
+        for (uint32_t r = 0; r < expected.at(i)->rows(); ++r) {
+          for (uint32_t col = 0; col < expected.at(i)->cols(); ++col) {
+            ASSERT_NEAR(padded->at(c, r + 1, col + 2), expected.at(i)->at(c, r, col), 1e-4f);
+          }
+        }
+      }
+    }
+
+    // 不同位数之间转换时从当前存储重新量化
+    if (bits == 8) {
+      conv_op->set_weight_bits(0);
+      ASSERT_FALSE(conv_op->weights_compressed());
+      ASSERT_EQ(conv_op->get_weights().size(), out_channels);
+      std::vector<float> kernel(kernel_c * 9);
+      conv_op->set_weight_bits(8);
+      conv_op->CopyKernel(5, kernel.data());
+      for (uint32_t j = 0; j < kernel.size(); ++j) {
+        ASSERT_FLOAT_EQ(kernel.at(j), quantized_weights.at(5)->index(j));
+      }
+    }
+  }
+}
+
+TEST(test_conv_weight_bits, graph_weight_type) {
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  RuntimeGraph reference(param_path, bin_path);
+  reference.Build("pnnx_input_0", "pnnx_output_0");
+
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+  const std::vector<sftensor> expected = reference.Forward(std::vector<sftensor>{input});
+
+  for (const RuntimeDataType weight_type : {RuntimeDataType::kTypeInt8, RuntimeDataType::kTypeInt4}) {
+    RuntimeGraph graph(param_path, bin_path);
+    graph.set_weight_type(weight_type);
+    ASSERT_EQ(graph.weight_type(), weight_type);
+    graph.Build("pnnx_input_0", "pnnx_output_0");
+
+    // 卷积核只保留量化后的一份
+    const uint32_t bits = weight_type == RuntimeDataType::kTypeInt8 ? 8 : 4;
+    for (const auto &op : graph.operators()) {
+      if (op->type != "nn.Conv2d") {
+        continue;
+      }
+      ASSERT_TRUE(op->attrs.at("weight")->weight_data.empty());
+      if (op->attrs.count("bias")) {
+        ASSERT_EQ(op->attrs.at("bias")->type, RuntimeDataType::kTypeFloat32);
+        ASSERT_FALSE(op->attrs.at("bias")->weight_data.empty());
+      }
+    }
+
+    const std::vector<sftensor> outputs = graph.Forward(std::vector<sftensor>{input});
+    ASSERT_EQ(outputs.size(), expected.size());
+    const TensorErrorStats &stats = TensorCompare(outputs.front(), expected.front());
+    LOG(INFO) << "int" << bits << " weights: max abs " << stats.max_abs << ", mean abs " << stats.mean_abs
+              << ", max rel " << stats.max_rel;
+    ASSERT_GT(stats.max_abs, 0.f);
+    ASSERT_LT(stats.max_abs, bits == 8 ? 0.02f : 0.2f);
+  }
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include "data/cpu_isa.hpp"
+#include "data/gemm_int8.hpp"
+#include "data/half.hpp"
+#include "data/quantize.hpp"
+#include "data/tensor_util.hpp"
+#include "data/vector_kernels.hpp"
+
+using namespace kuiper_infer;
+
+// CPU 支持的各个指令集，从标量开始
+static std::vector<CpuIsa> SupportedIsas() {
+  std::vector<CpuIsa> isas;
+  for (uint32_t i = 0; i <= uint32_t(DetectCpuIsa()); ++i) {
+    isas.push_back(CpuIsa(i));
+  }
+  return isas;
+}
+
+// 依次用每个指令集运行 run，结果和标量版本比较，结束后恢复原来的指令集
+template <typename Run, typename Compare>
+static void ForEachIsa(const Run &run, const Compare &compare) {
+  const CpuIsa active = ActiveCpuIsa();
+  SetActiveCpuIsa(CpuIsa::kScalar);
+  const auto expected = run();
+  for (const CpuIsa isa : SupportedIsas()) {
+    SetActiveCpuIsa(isa);
+    compare(run(), expected, CpuIsaName(isa));
+  }
+  SetActiveCpuIsa(active);
+}
+
+static std::vector<float> RandomValues(size_t count, float low, float high) {
+  std::mt19937 engine(7);
+  std::uniform_real_distribution<float> dist(low, high);
+  std::vector<float> values(count);
+  for (float &value : values) {
+    value = dist(engine);
+  }
+  return values;
+}
+
+static void ExpectSame(const std::vector<float> &actual, const std::vector<float> &expected, const char *isa) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    if (std::isnan(expected.at(i))) {
+      ASSERT_TRUE(std::isnan(actual.at(i))) << isa << " " << i;
+    } else {
+      ASSERT_EQ(actual.at(i), expected.at(i)) << isa << " " << i;
+    }
+  }
+}
+
+TEST(test_cpu_isa, detect) {
+  const CpuFeatures &features = GetCpuFeatures();
+  ASSERT_TRUE(!features.avx512 || features.avx2);
+  ASSERT_TRUE(!features.avx512_vnni || features.avx512);
+  ASSERT_LE(int(ActiveCpuIsa()), int(DetectCpuIsa()));
+  LOG(INFO) << "detected " << CpuIsaName(DetectCpuIsa()) << ", active " << CpuIsaName(ActiveCpuIsa());
+
+  for (uint32_t i = 0; i < kCpuIsaCount; ++i) {
+    CpuIsa isa;
+    ASSERT_TRUE(ParseCpuIsa(CpuIsaName(CpuIsa(i)), isa));
+    ASSERT_EQ(isa, CpuIsa(i));
+  }
+  CpuIsa isa = CpuIsa::kAVX2;
+  ASSERT_FALSE(ParseCpuIsa("sse4", isa));
+  ASSERT_EQ(isa, CpuIsa::kAVX2);
+}
+
+static int KernelScalar() {
+  return 0;
+}
+
+static int KernelAvx2() {
+  return 1;
+}
+
+TEST(test_cpu_isa, select) {
+  // 没有 AVX-512 版本时回退到 AVX2，空的版本不注册
+  using Fn = int (*)();
+  const IsaKernel<Fn> kernel = IsaKernel<Fn>("test_select", KernelScalar).Add(CpuIsa::kAVX2, KernelAvx2)
+                                   .Add(CpuIsa::kAVX512, nullptr);
+  ASSERT_EQ(kernel.Select(CpuIsa::kScalar)(), 0);
+  ASSERT_EQ(kernel.Select(CpuIsa::kAVX2)(), 1);
+  ASSERT_EQ(kernel.Select(CpuIsa::kAVX512)(), 1);
+
+  bool found = false;
+  for (const KernelInfo &info : RegisteredKernels()) {
+    if (info.name == "test_select") {
+      found = true;
+      ASSERT_EQ(info.variants, std::vector<CpuIsa>({CpuIsa::kScalar, CpuIsa::kAVX2}));
+    }
+  }
+  ASSERT_TRUE(found);
+}
+
+TEST(test_cpu_isa, registry) {
+  // 热点内核都注册了标量版本
+  const std::vector<KernelInfo> &kernels = RegisteredKernels();
+  for (const char *name : {"relu", "sigmoid", "add", "mul", "scale_shift", "maxpool", "copy_strided", "transpose",
+                           "gemm_u8s8", "sgemm", "sgemm_small_m", "quantize", "dequantize", "to_fp16", "from_fp16"}) {
+    auto iter = std::find_if(kernels.begin(), kernels.end(),
+                             [&](const KernelInfo &info) { return info.name == name; });
+    ASSERT_TRUE(iter != kernels.end()) << name;
+    ASSERT_EQ(iter->variants.front(), CpuIsa::kScalar) << name;
+    ASSERT_TRUE(std::is_sorted(iter->variants.begin(), iter->variants.end())) << name;
+  }
+}
+
+TEST(test_cpu_isa, elementwise) {
+  // 长度不是向量宽度的整数倍，覆盖尾部
+  const size_t count = 1000 + 13;
+  std::vector<float> a = RandomValues(count, -3.f, 3.f);
+  const std::vector<float> b = RandomValues(count + 1, -2.f, 2.f);
+  a.at(5) = std::numeric_limits<float>::quiet_NaN();
+
+  ForEachIsa([&]() {
+    std::vector<float> dst(count);
+    ReluValues(a.data(), dst.data(), count, 0.25f);
+    return dst;
+  }, ExpectSame);
+  ForEachIsa([&]() {
+    std::vector<float> dst(count);
+    AddValues(a.data(), b.data() + 1, dst.data(), count);
+    return dst;
+  }, ExpectSame);
+  ForEachIsa([&]() {
+    std::vector<float> dst(a);
+    MulValues(dst.data(), b.data(), dst.data(), count);
+    return dst;
+  }, ExpectSame);
+}
+
+TEST(test_cpu_isa, sigmoid) {
+  std::vector<float> src = RandomValues(517, -20.f, 20.f);
+  src.push_back(-100.f);
+  src.push_back(100.f);
+  src.push_back(0.f);
+  ForEachIsa([&]() {
+    std::vector<float> dst(src.size());
+    SigmoidValues(src.data(), dst.data(), src.size());
+    return dst;
+  }, [](const std::vector<float> &actual, const std::vector<float> &expected, const char *isa) {
+    for (size_t i = 0; i < actual.size(); ++i) {
+      ASSERT_NEAR(actual.at(i), expected.at(i), 1e-6f) << isa << " " << i;
+      ASSERT_LE(std::fabs(actual.at(i) - expected.at(i)), 4e-7f * expected.at(i) + 1e-30f) << isa << " " << i;
+    }
+  });
+}
+
+TEST(test_cpu_isa, maxpool_and_copy) {
+  // 输出写到带边框的通道里，步长 1 和 2 都比较
+  const uint32_t input_h = 23, input_w = 19;
+  const std::vector<float> input = RandomValues(input_h * input_w, -1.f, 1.f);
+  for (const uint32_t stride : {1u, 2u}) {
+    const uint32_t output_h = (input_h - 3) / stride + 1;
+    const uint32_t output_w = (input_w - 2) / stride + 1;
+    ForEachIsa([&]() {
+      std::vector<float> dst((output_h + 2) * (output_w + 2), 0.f);
+      MaxPoolPlane(input.data(), input_h, dst.data() + output_h + 2 + 1, output_h + 2, output_h, output_w, 3, 2,
+                   stride, stride);
+      return dst;
+    }, ExpectSame);
+  }
+  for (const size_t stride : {1ul, 2ul, 3ul}) {
+    ForEachIsa([&]() {
+      std::vector<float> dst(input.size() / stride);
+      CopyStrided(input.data(), stride, dst.data(), dst.size());
+      return dst;
+    }, ExpectSame);
+  }
+}
+
+TEST(test_cpu_isa, data_kernels) {
+  // 量化、半精度转换、转置和 int8 GEMM 的各个版本结果完全一致
+  const std::vector<float> src = RandomValues(301, -5.f, 5.f);
+  ForEachIsa([&]() {
+    std::vector<uint8_t> q(src.size());
+    QuantizeValues(src.data(), q.data(), src.size(), 0.05f, 3, true);
+    std::vector<float> dst(src.size());
+    DequantizeValues(q.data(), dst.data(), dst.size(), 0.05f, 3, true);
+    return dst;
+  }, ExpectSame);
+  for (const HalfType type : {HalfType::kFloat16, HalfType::kBFloat16}) {
+    ForEachIsa([&]() {
+      std::vector<uint16_t> half(src.size());
+      ConvertToHalf(src.data(), half.data(), src.size(), type);
+      std::vector<float> dst(src.size());
+      ConvertFromHalf(half.data(), dst.data(), dst.size(), type);
+      return dst;
+    }, ExpectSame);
+  }
+
+  sftensor tensor = std::make_shared<ftensor>(3, 37, 45);
+  tensor->Rand();
+  ForEachIsa([&]() { return tensor->values(true); }, ExpectSame);
+
+  std::vector<uint8_t> a(19 * 32);
+  std::vector<int8_t> b(21 * 30);
+  std::mt19937 engine(5);
+  for (auto &value : a) {
+    value = uint8_t(engine() % 256);
+  }
+  for (auto &value : b) {
+    value = int8_t(int(engine() % 256) - 128);
+  }
+  const PackedInt8Matrix &packed = PackInt8Matrix(b.data(), 21, 30);
+  ForEachIsa([&]() {
+    std::vector<int32_t> c(19 * 21);
+    GemmU8S8(a.data(), 32, 19, packed, c.data(), 19);
+    return c;
+  }, [](const std::vector<int32_t> &actual, const std::vector<int32_t> &expected, const char *isa) {
+    ASSERT_EQ(actual, expected) << isa;
+  });
+}
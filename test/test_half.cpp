@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include <limits>
+#include "data/half.hpp"
+#include "data/half_tensor.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/expression_layer.hpp"
+#include "layer/maxpooling_layer.hpp"
+#include "layer/relu_layer.hpp"
+#include "layer/sigmoid_layer.hpp"
+#include "ops/conv_op.hpp"
+#include "ops/expression_op.hpp"
+#include "ops/maxpooling_op.hpp"
+#include "ops/relu_op.hpp"
+#include "ops/sigmoid_op.hpp"
+#include "runtime/runtime_ir.hpp"
+
+using namespace kuiper_infer;
+
+// fp16 有 10 位尾数，bf16 只有 7 位
+static float Tolerance(HalfType type) {
+  return type == HalfType::kFloat16 ? 1e-3f : 8e-3f;
+}
+
+// 误差相对于 expected 的最大绝对值
+static void ExpectClose(const sftensor &actual, const sftensor &expected, float tolerance) {
+  ASSERT_EQ(actual->shape(), expected->shape());
+  float scale = 1.f;
+  for (uint32_t i = 0; i < expected->size(); ++i) {
+    scale = std::max(scale, std::fabs(expected->index(i)));
+  }
+  const TensorErrorStats &stats = TensorCompare(actual, expected);
+  ASSERT_LE(stats.max_abs, tolerance * scale);
+  ASSERT_LE(stats.mean_abs, stats.max_abs);
+}
+
+static sftensor RoundTrip(const sftensor &tensor, HalfType type) {
+  return HalfTensor::FromFloat(*tensor, type)->ToFloat();
+}
+
+TEST(test_half, scalar) {
+  // 可以精确表示的值
+  for (const float value : {0.f, -0.f, 1.f, -2.f, 0.5f, 1024.f, -0.125f}) {
+    ASSERT_EQ(Fp16ToFloat(FloatToFp16(value)), value);
+    ASSERT_EQ(Bf16ToFloat(FloatToBf16(value)), value);
+  }
+  ASSERT_EQ(Fp16ToFloat(FloatToFp16(65504.f)), 65504.f);
+  ASSERT_EQ(Bf16ToFloat(FloatToBf16(65536.f)), 65536.f);
+  ASSERT_EQ(FloatToFp16(1.f), 0x3c00);
+  ASSERT_EQ(FloatToBf16(1.f), 0x3f80);
+
+  // 就近舍入，正好在中间时取偶数
+  ASSERT_EQ(FloatToFp16(1.f + 1.f / 2048), 0x3c00);
+  ASSERT_EQ(FloatToFp16(1.f + 3.f / 2048), 0x3c02);
+  ASSERT_EQ(FloatToBf16(1.f + 1.f / 256), 0x3f80);
+  ASSERT_EQ(FloatToBf16(1.f + 3.f / 256), 0x3f82);
+
+  // 溢出、无穷和 nan
+  const float inf = std::numeric_limits<float>::infinity();
+  ASSERT_EQ(Fp16ToFloat(FloatToFp16(1e6f)), inf);
+  ASSERT_EQ(Fp16ToFloat(FloatToFp16(-inf)), -inf);
+  ASSERT_EQ(Bf16ToFloat(FloatToBf16(inf)), inf);
+  ASSERT_TRUE(std::isnan(Fp16ToFloat(FloatToFp16(std::nanf("")))));
+  ASSERT_TRUE(std::isnan(Bf16ToFloat(FloatToBf16(std::nanf("")))));
+
+  // fp16 的非规格化数
+  const float subnormal = std::ldexp(1.f, -20);
+  ASSERT_EQ(Fp16ToFloat(FloatToFp16(subnormal)), subnormal);
+  ASSERT_EQ(Fp16ToFloat(FloatToFp16(std::ldexp(1.f, -26))), 0.f);
+}
+
+TEST(test_half, vector) {
+  // 长度不是向量宽度的整数倍，覆盖尾部的标量路径
+  std::vector<float> values(1031);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values.at(i) = std::sin(float(i)) * 100.f;
+  }
+  values.at(7) = std::numeric_limits<float>::infinity();
+  values.at(9) = std::ldexp(1.f, -18);
+
+  for (const HalfType type : {HalfType::kFloat16, HalfType::kBFloat16}) {
+    std::vector<uint16_t> half(values.size());
+    std::vector<float> restored(values.size());
+    ConvertToHalf(values.data(), half.data(), values.size(), type);
+    ConvertFromHalf(half.data(), restored.data(), values.size(), type);
+    for (size_t i = 0; i < values.size(); ++i) {
+      const uint16_t expected = type == HalfType::kFloat16 ? FloatToFp16(values.at(i)) : FloatToBf16(values.at(i));
+      ASSERT_EQ(half.at(i), expected) << HalfTypeName(type) << " " << i;
+      const float expected_value = type == HalfType::kFloat16 ? Fp16ToFloat(expected) : Bf16ToFloat(expected);
+      ASSERT_EQ(restored.at(i), expected_value);
+    }
+  }
+}
+
+TEST(test_half, tensor) {
+  sftensor tensor = std::make_shared<ftensor>(3, 17, 9);
+  tensor->Rand();
+  for (const HalfType type : {HalfType::kFloat16, HalfType::kBFloat16}) {
+    const shtensor &half = HalfTensor::FromFloat(*tensor, type);
+    ASSERT_EQ(half->shape(), tensor->shape());
+    ASSERT_EQ(half->type(), type);
+    ExpectClose(half->ToFloat(), tensor, Tolerance(type));
+
+    // 部分读写
+    std::vector<float> values(20);
+    half->Load(100, values.size(), values.data());
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_NEAR(values.at(i), tensor->index(100 + i), Tolerance(type) * 4);
+      values.at(i) = float(i);
+    }
+    half->Store(100, values.size(), values.data());
+    const sftensor &restored = half->ToFloat();
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_EQ(restored->index(100 + i), float(i));
+    }
+  }
+}
+
+TEST(test_half, layers) {
+  for (const HalfType type : {HalfType::kFloat16, HalfType::kBFloat16}) {
+    std::vector<sftensor> inputs;
+    std::vector<shtensor> half_inputs;
+    for (uint32_t i = 0; i < 2; ++i) {
+      sftensor input = std::make_shared<ftensor>(3, 15, 13);
+      input->Rand();
+      // 以半精度输入的 fp32 结果作为参考，只比较层本身带来的误差
+      input = RoundTrip(input, type);
+      inputs.push_back(input);
+      half_inputs.push_back(HalfTensor::FromFloat(*input, type));
+    }
+
+    std::vector<std::shared_ptr<Layer>> layers;
+    layers.push_back(std::make_shared<ReLULayer>(std::make_shared<ReLUOperator>(0.f)));
+    layers.push_back(std::make_shared<SigmoidLayer>(std::make_shared<SigmoidOperator>()));
+    layers.push_back(std::make_shared<MaxPoolingLayer>(
+        std::make_shared<MaxPoolingOp>(Shape(3, 3), Shape(2, 2), Shape(1, 1))));
+    for (const auto &layer : layers) {
+      std::vector<sftensor> expected;
+      std::vector<shtensor> outputs;
+      layer->Forward(inputs, expected);
+      layer->ForwardHalf(half_inputs, outputs);
+      ASSERT_EQ(outputs.size(), expected.size());
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        ASSERT_EQ(outputs.at(i)->type(), type);
+        ExpectClose(outputs.at(i)->ToFloat(), expected.at(i), Tolerance(type));
+      }
+    }
+
+    // 表达式按块求值，batch 为 2
+    ExpressionLayer expression(std::make_shared<ExpressionOp>("add(mul(@0,@1),@0)"));
+    std::vector<sftensor> expected(2);
+    std::vector<shtensor> outputs(2);
+    expression.Forward({inputs.at(0), inputs.at(1), inputs.at(1), inputs.at(0)}, expected);
+    expression.ForwardHalf({half_inputs.at(0), half_inputs.at(1), half_inputs.at(1), half_inputs.at(0)}, outputs);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      ExpectClose(outputs.at(i)->ToFloat(), expected.at(i), Tolerance(type) * 2);
+    }
+  }
+}
+
+TEST(test_half, conv_weights) {
+  std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(1, 1), Shape(1, 1), true, 1);
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < 8; ++k) {
+    weights.push_back(std::make_shared<ftensor>(4, 3, 3));
+    weights.back()->Rand();
+    bias.push_back(std::make_shared<ftensor>(1, 1, 1));
+    bias.back()->Rand();
+  }
+  conv_op->set_weights(weights);
+  conv_op->set_bias(bias);
+  sftensor input = std::make_shared<ftensor>(4, 12, 10);
+  input->Rand();
+
+  std::vector<sftensor> expected;
+  ConvLayer(conv_op).Forward({input}, expected);
+
+  for (const HalfType type : {HalfType::kFloat16, HalfType::kBFloat16}) {
+    conv_op->set_weights(weights);
+    conv_op->CompressWeights(type);
+    ASSERT_TRUE(conv_op->weights_compressed());
+    ASSERT_TRUE(conv_op->get_weights().empty());
+    ASSERT_TRUE(conv_op->packed_weights().empty());
+    ASSERT_EQ(conv_op->kernel_count(), 8);
+    ASSERT_EQ(conv_op->kernel_shape(), std::vector<uint32_t>({4, 3, 3}));
+
+    std::vector<sftensor> outputs;
+    ConvLayer(conv_op).Forward({input}, outputs);
+    // 36 个乘积累加，误差随累加长度增长
+    ExpectClose(outputs.front(), expected.front(), Tolerance(type) * 4);
+  }
+
+  // 重新设置权重后恢复 fp32
+  conv_op->set_weights(weights);
+  ASSERT_FALSE(conv_op->weights_compressed());
+  std::vector<sftensor> outputs;
+  ConvLayer(conv_op).Forward({input}, outputs);
+  ASSERT_TRUE(TensorIsSame(outputs.front(), expected.front()));
+}
+
+TEST(test_half, graph_weight_type) {
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  RuntimeGraph reference(param_path, bin_path);
+  reference.Build("pnnx_input_0", "pnnx_output_0");
+
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+  const std::vector<sftensor> expected = reference.Forward(std::vector<sftensor>{input});
+
+  for (const auto &[weight_type, half_type] :
+       {std::make_pair(RuntimeDataType::kTypeFloat16, HalfType::kFloat16),
+        std::make_pair(RuntimeDataType::kTypeBFloat16, HalfType::kBFloat16)}) {
+    RuntimeGraph graph(param_path, bin_path);
+    graph.set_weight_type(weight_type);
+    ASSERT_EQ(graph.weight_type(), weight_type);
+    graph.Build("pnnx_input_0", "pnnx_output_0");
+
+    // 权重以半精度存储
+    for (const auto &op : graph.operators()) {
+      for (const auto &[name, attr] : op->attrs) {
+        ASSERT_EQ(attr->type, weight_type);
+      }
+    }
+
+    const std::vector<sftensor> outputs = graph.Forward(std::vector<sftensor>{input});
+    ASSERT_EQ(outputs.size(), expected.size());
+    const TensorErrorStats &stats = TensorCompare(outputs.front(), expected.front());
+    LOG(INFO) << HalfTypeName(half_type) << " weights: max abs " << stats.max_abs << ", mean abs "
+              << stats.mean_abs << ", max rel " << stats.max_rel;
+    ExpectClose(outputs.front(), expected.front(), Tolerance(half_type) * 8);
+  }
+}
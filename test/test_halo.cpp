@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <limits>
+#include "data/tensor_allocator.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/maxpooling_layer.hpp"
+#include "layer/relu_layer.hpp"
+#include "ops/conv_op.hpp"
+#include "ops/maxpooling_op.hpp"
+#include "ops/relu_op.hpp"
+#include "runtime/runtime_ir.hpp"
+#include "runtime/runtime_profiler.hpp"
+#include "test_model_file.hpp"
+
+using namespace kuiper_infer;
+
+static Halo MakeHalo(uint32_t h, uint32_t w, float value) {
+  Halo halo;
+  halo.h = h;
+  halo.w = w;
+  halo.value = value;
+  return halo;
+}
+
+// 带边框的张量内部和 expected 一致
+static void ExpectInterior(const sftensor &padded, const Halo &halo, const sftensor &expected) {
+  ASSERT_EQ(padded->channels(), expected->channels());
+  ASSERT_EQ(padded->rows(), expected->rows() + 2 * halo.h);
+  ASSERT_EQ(padded->cols(), expected->cols() + 2 * halo.w);
+  for (uint32_t c = 0; c < expected->channels(); ++c) {
+    for (uint32_t r = 0; r < padded->rows(); ++r) {
+      for (uint32_t col = 0; col < padded->cols(); ++col) {
+        const bool border = r < halo.h || r >= padded->rows() - halo.h || col < halo.w ||
+                            col >= padded->cols() - halo.w;
+        const float value = border ? halo.value : expected->at(c, r - halo.h, col - halo.w);
+        ASSERT_NEAR(padded->at(c, r, col), value, 1e-4);
+      }
+    }
+  }
+}
+
+static std::shared_ptr<ConvOp> RandConv(uint32_t in_channels, uint32_t out_channels, uint32_t padding) {
+  std::shared_ptr<ConvOp> conv_op =
+      std::make_shared<ConvOp>(Shape(1, 1), Shape(padding, padding), true, 1);
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < out_channels; ++k) {
+    weights.push_back(std::make_shared<ftensor>(in_channels, 3, 3));
+    weights.back()->Rand();
+    bias.push_back(std::make_shared<ftensor>(1, 1, 1));
+    bias.back()->Rand();
+  }
+  conv_op->set_weights(weights);
+  conv_op->set_bias(bias);
+  return conv_op;
+}
+
+TEST(test_halo, create) {
+  const Halo &halo = MakeHalo(2, 1, -1.f);
+  sftensor tensor = TensorCreate(3, 4, 5, halo);
+  ASSERT_EQ(tensor->shape(), std::vector<uint32_t>({3, 8, 7}));
+
+  // 边框和 TensorPadding 一致
+  sftensor interior = std::make_shared<ftensor>(3, 4, 5);
+  interior->Rand();
+  for (uint32_t c = 0; c < 3; ++c) {
+    for (uint32_t r = 0; r < 4; ++r) {
+      for (uint32_t col = 0; col < 5; ++col) {
+        tensor->at(c, r + 2, col + 1) = interior->at(c, r, col);
+      }
+    }
+  }
+  ASSERT_TRUE(TensorIsSame(tensor, TensorPadding(interior, {2, 2, 1, 1}, -1.f)));
+}
+
+TEST(test_halo, reuse_border) {
+  // 同样形状和边框的张量复用内存池里的内存时不再写边框
+  PoolAllocator::Instance()->Trim();
+  const Halo &halo = MakeHalo(1, 2, -1.f);
+  sftensor tensor = TensorCreate(2, 6, 5, halo);
+  const float *buffer = tensor->raw_ptr();
+  ASSERT_EQ(tensor->at(1, 0, 0), -1.f);
+  // 测试里故意改写边框，复用时仍然是改写后的值说明没有重新填充
+  tensor->at(1, 0, 0) = 5.f;
+  tensor.reset();
+  sftensor reused = TensorCreate(2, 6, 5, halo);
+  ASSERT_EQ(reused->raw_ptr(), buffer);
+  ASSERT_EQ(reused->at(1, 0, 0), 5.f);
+  reused.reset();
+
+  // 边框的值不同时重新填充
+  sftensor other = TensorCreate(2, 6, 5, MakeHalo(1, 2, 0.f));
+  ASSERT_EQ(other->raw_ptr(), buffer);
+  ASSERT_EQ(other->at(1, 0, 0), 0.f);
+  other.reset();
+
+  // 内存被普通张量用过之后标记失效，重新填充
+  sftensor plain = TensorCreate(2, 8, 9);
+  ASSERT_EQ(plain->raw_ptr(), buffer);
+  plain->Fill(3.f);
+  plain.reset();
+  sftensor refilled = TensorCreate(2, 6, 5, MakeHalo(1, 2, 0.f));
+  ASSERT_EQ(refilled->raw_ptr(), buffer);
+  ASSERT_EQ(refilled->at(1, 0, 0), 0.f);
+}
+
+TEST(test_halo, layers) {
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 2; ++i) {
+    inputs.push_back(std::make_shared<ftensor>(4, 9, 7));
+    inputs.back()->Rand();
+  }
+
+  // relu -> conv(padding 1)
+  ReLULayer relu(std::make_shared<ReLUOperator>(0.f));
+  ConvLayer conv(RandConv(4, 6, 1));
+  std::vector<sftensor> relu_outputs;
+  std::vector<sftensor> expected;
+  relu.Forward(inputs, relu_outputs);
+  conv.Forward(relu_outputs, expected);
+
+  const Halo &conv_halo = conv.InputPadding();
+  ASSERT_EQ(conv_halo, MakeHalo(1, 1, 0.f));
+  std::vector<sftensor> padded_outputs;
+  relu.set_output_halo(conv_halo);
+  relu.Forward(inputs, padded_outputs);
+  ExpectInterior(padded_outputs.at(1), conv_halo, relu_outputs.at(1));
+
+  std::vector<sftensor> outputs;
+  conv.set_input_halo(conv_halo);
+  conv.Forward(padded_outputs, outputs);
+  ASSERT_EQ(outputs.size(), 2);
+  ASSERT_TRUE(TensorIsSame(outputs.at(0), expected.at(0), 1e-4));
+  ASSERT_TRUE(TensorIsSame(outputs.at(1), expected.at(1), 1e-4));
+
+  // conv -> maxpool(padding 1)，边框是 float 的最小值
+  MaxPoolingLayer pooling(std::make_shared<MaxPoolingOp>(Shape(3, 3), Shape(2, 2), Shape(1, 1)));
+  const Halo &pooling_halo = pooling.InputPadding();
+  ASSERT_EQ(pooling_halo, MakeHalo(1, 1, std::numeric_limits<float>::lowest()));
+  std::vector<sftensor> pooling_expected;
+  pooling.Forward(expected, pooling_expected);
+
+  conv.set_output_halo(pooling_halo);
+  conv.Forward(padded_outputs, outputs);
+  ExpectInterior(outputs.at(0), pooling_halo, expected.at(0));
+
+  std::vector<sftensor> pooling_outputs;
+  pooling.set_input_halo(pooling_halo);
+  pooling.Forward(outputs, pooling_outputs);
+  ASSERT_TRUE(TensorIsSame(pooling_outputs.at(0), pooling_expected.at(0)));
+  ASSERT_TRUE(TensorIsSame(pooling_outputs.at(1), pooling_expected.at(1)));
+}
+
+TEST(test_halo, graph) {
+  // conv1 -> conv2 -> relu -> max，权重和 test.pnnx 的 conv1、conv2 一致
+  TempModelFile model("halo_test");
+  model.WriteParam("7767517\n6 5\n"
+                   "pnnx.Input pnnx_input_0 0 1 0 #0=(1,1,16,16)f32\n"
+                   "nn.Conv2d conv1 1 1 0 1 bias=False dilation=(1,1) groups=1 in_channels=1 kernel_size=(5,5) "
+                   "out_channels=1 padding=(2,2) padding_mode=zeros stride=(1,1) @weight=(1,1,5,5)f32 "
+                   "#0=(1,1,16,16)f32 #1=(1,1,16,16)f32\n"
+                   "nn.Conv2d conv2 1 1 1 2 bias=True dilation=(1,1) groups=1 in_channels=1 kernel_size=(5,5) "
+                   "out_channels=1 padding=(2,2) padding_mode=zeros stride=(1,1) @bias=(1)f32 @weight=(1,1,5,5)f32 "
+                   "#1=(1,1,16,16)f32 #2=(1,1,16,16)f32\n"
+                   "nn.ReLU relu 1 1 2 3 #2=(1,1,16,16)f32 #3=(1,1,16,16)f32\n"
+                   "nn.MaxPool2d max 1 1 3 4 ceil_mode=False dilation=(1,1) kernel_size=(3,3) padding=(1,1) "
+                   "return_indices=False stride=(2,2) #3=(1,1,16,16)f32 #4=(1,1,8,8)f32\n"
+                   "pnnx.Output pnnx_output_0 1 0 4 #4=(1,1,8,8)f32\n");
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+
+  RuntimeGraph graph(model.param_path(), bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  RuntimeGraph reference(model.param_path(), bin_path);
+  reference.set_reserve_halo(false);
+  reference.Build("pnnx_input_0", "pnnx_output_0");
+
+  for (const auto &op : graph.operators()) {
+    if (op->name == "conv1" || op->name == "relu") {
+      ASSERT_FALSE(op->layer->output_halo().empty()) << op->name;
+    } else if (op->layer != nullptr) {
+      // conv2 的消费者 relu 没有 padding，max 的输出给计算图输出
+      ASSERT_TRUE(op->layer->output_halo().empty()) << op->name;
+    }
+  }
+
+  // profiler 按内部统计形状、字节数和计算量，不包含边框
+  std::shared_ptr<RuntimeProfiler> profiler = std::make_shared<RuntimeProfiler>();
+  graph.set_profiler(profiler);
+  for (uint32_t iteration = 0; iteration < 2; ++iteration) {
+    sftensor input = std::make_shared<ftensor>(1, 16, 16);
+    input->Rand();
+    const std::vector<sftensor> &outputs = graph.Forward(std::vector<sftensor>{input});
+    const std::vector<sftensor> &expected = reference.Forward(std::vector<sftensor>{input});
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_TRUE(TensorIsSame(outputs.front(), expected.front(), 1e-4));
+  }
+  for (const ProfileRecord &record : profiler->records()) {
+    if (record.name == "conv1") {
+      ASSERT_EQ(record.output_shapes.at(0), std::vector<uint32_t>({1, 16, 16}));
+      ASSERT_EQ(record.bytes, 16 * 16 * sizeof(float));
+      ASSERT_EQ(record.flops, 2 * 16 * 16 * 25);
+    } else if (record.name == "conv2") {
+      ASSERT_EQ(record.input_shapes.at(0), std::vector<uint32_t>({1, 16, 16}));
+      ASSERT_EQ(record.flops, 2 * 16 * 16 * 25 + 16 * 16);
+    } else if (record.name == "relu") {
+      ASSERT_EQ(record.output_shapes.at(0), std::vector<uint32_t>({1, 16, 16}));
+    }
+  }
+}
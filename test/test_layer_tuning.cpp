@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <filesystem>
+#include <fstream>
+#include "data/tensor_util.hpp"
+#include "factory/layer_factory.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/direct_conv_layer.hpp"
+#include "runtime/runtime_ir.hpp"
+
+using namespace kuiper_infer;
+
+static std::shared_ptr<ConvOp> MakeConvOp(uint32_t in_channels, uint32_t out_channels, uint32_t groups,
+                                          uint32_t kernel_size, Shape stride, Shape padding) {
+  std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(stride, padding, true, groups);
+  std::vector<sftensor> weights;
+  std::vector<sftensor> bias;
+  for (uint32_t k = 0; k < out_channels; ++k) {
+    sftensor kernel = std::make_shared<ftensor>(in_channels / groups, kernel_size, kernel_size);
+    kernel->Rand();
+    weights.push_back(kernel);
+    sftensor bias_value = std::make_shared<ftensor>(1, 1, 1);
+    bias_value->index(0) = 0.1f * float(k);
+    bias.push_back(bias_value);
+  }
+  conv_op->set_weights(weights);
+  conv_op->set_bias(bias);
+  return conv_op;
+}
+
+TEST(test_layer_tuning, implementations) {
+  // depthwise 卷积有三个实现，默认实现在前；输入通道多的卷积没有直接卷积
+  const std::shared_ptr<ConvOp> &depthwise = MakeConvOp(8, 8, 8, 3, Shape(1, 1), Shape(1, 1));
+  ASSERT_EQ(LayerRegister::Implementations(depthwise),
+            std::vector<std::string>({"im2col_gemm", "implicit_gemm", "direct"}));
+  const std::shared_ptr<ConvOp> &dense = MakeConvOp(32, 8, 1, 3, Shape(1, 1), Shape(1, 1));
+  ASSERT_EQ(LayerRegister::Implementations(dense), std::vector<std::string>({"im2col_gemm", "implicit_gemm"}));
+  ASSERT_TRUE(LayerRegister::CreateLayer(dense, "direct") == nullptr);
+  ASSERT_TRUE(LayerRegister::CreateLayer(dense, "winograd") == nullptr);
+  ASSERT_TRUE(std::dynamic_pointer_cast<ConvLayer>(LayerRegister::CreateLayer(dense)) != nullptr);
+  ASSERT_TRUE(std::dynamic_pointer_cast<DirectConvLayer>(LayerRegister::CreateLayer(depthwise, "direct")) != nullptr);
+}
+
+TEST(test_layer_tuning, direct_conv) {
+  // 和 im2col-GEMM 的结果一致，覆盖分组、步长、padding 和输出边框
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 2; ++i) {
+    sftensor input = std::make_shared<ftensor>(6, 17, 14);
+    input->Rand();
+    inputs.push_back(input);
+  }
+  for (const uint32_t groups : {1u, 3u, 6u}) {
+    for (const uint32_t stride : {1u, 2u}) {
+      const std::shared_ptr<ConvOp> &conv_op = MakeConvOp(6, 12, groups, 3, Shape(stride, stride), Shape(1, 2));
+      std::vector<sftensor> expected;
+      ConvLayer(conv_op).Forward(inputs, expected);
+
+      DirectConvLayer layer(conv_op);
+      std::vector<sftensor> outputs;
+      layer.Forward(inputs, outputs);
+      ASSERT_EQ(outputs.size(), inputs.size());
+      for (uint32_t i = 0; i < outputs.size(); ++i) {
+        ASSERT_EQ(outputs.at(i)->shape(), expected.at(i)->shape());
+        ASSERT_LT(TensorCompare(outputs.at(i), expected.at(i)).max_abs, 1e-4f) << groups << " " << stride;
+      }
+
+      // 输入和输出都带边框，和计算图里 PlanHalos 之后一样
+      Halo output_halo;
+      output_halo.h = 1;
+      output_halo.w = 1;
+      layer.set_input_halo(layer.InputPadding());
+      layer.set_output_halo(output_halo);
+      std::vector<sftensor> padded_inputs;
+      for (const sftensor &input : inputs) {
+        padded_inputs.push_back(TensorPadding(input, {1, 1, 2, 2}, 0.f));
+      }
+      std::vector<sftensor> padded_outputs;
+      layer.Forward(padded_inputs, padded_outputs);
+      for (uint32_t i = 0; i < padded_outputs.size(); ++i) {
+        const sftensor &padded = padded_outputs.at(i);
+        for (uint32_t c = 0; c < padded->channels(); ++c) {
+          for (uint32_t r = 0; r < expected.at(i)->rows(); ++r) {
+            for (uint32_t col = 0; col < expected.at(i)->cols(); ++col) {
+              ASSERT_NEAR(padded->at(c, r + 1, col + 1), expected.at(i)->at(c, r, col), 1e-4f);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(test_layer_tuning, direct_conv_compressed) {
+  // 压缩存储的卷积核逐个转换，输入足够大时多个线程各自转换
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 2; ++i) {
+    sftensor input = std::make_shared<ftensor>(8, 40, 36);
+    input->Rand();
+    inputs.push_back(input);
+  }
+  for (const uint32_t bits : {16u, 8u, 4u}) {
+    const std::shared_ptr<ConvOp> &conv_op = MakeConvOp(8, 16, 8, 3, Shape(1, 1), Shape(1, 1));
+    if (bits == 16) {
+      conv_op->CompressWeights(HalfType::kFloat16);
+    } else {
+      conv_op->set_weight_bits(bits);
+    }
+    ASSERT_TRUE(DirectConvLayer::Applicable(conv_op));
+    std::vector<sftensor> expected;
+    ConvLayer(conv_op).Forward(inputs, expected);
+    std::vector<sftensor> outputs;
+    DirectConvLayer(conv_op).Forward(inputs, outputs);
+    ASSERT_EQ(outputs.size(), inputs.size());
+    for (uint32_t i = 0; i < outputs.size(); ++i) {
+      ASSERT_LT(TensorCompare(outputs.at(i), expected.at(i)).max_abs, 1e-4f) << bits;
+    }
+  }
+}
+
+TEST(test_layer_tuning, graph) {
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  const std::string &cache_path = "../tmp/test_layer_tuning.ktune";
+  std::filesystem::remove(cache_path);
+
+  RuntimeGraph reference(param_path, bin_path);
+  reference.Build("pnnx_input_0", "pnnx_output_0");
+  ASSERT_FALSE(reference.auto_tune());
+  ASSERT_EQ(reference.tuning_cache(), "../tmp/test.pnnx.ktune");
+  for (const auto &op : reference.topo_operators()) {
+    if (op->type == "nn.Conv2d") {
+      ASSERT_EQ(op->layer_impl, "im2col_gemm");
+    }
+  }
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+  const std::vector<sftensor> expected = reference.Forward(std::vector<sftensor>{input});
+
+  // 第一次构建时计时并写缓存，两个卷积各一条
+  RuntimeGraph graph(param_path, bin_path);
+  graph.set_auto_tune(true);
+  graph.set_tuning_cache(cache_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  TuningCache cache;
+  ASSERT_TRUE(cache.Load(cache_path));
+  ASSERT_EQ(cache.entries.size(), 2);
+  for (const auto &[key, name] : cache.entries) {
+    ASSERT_TRUE(name == "im2col_gemm" || name == "implicit_gemm" || name == "direct") << name;
+    ASSERT_EQ(key.find(' '), std::string::npos);
+  }
+  const std::vector<sftensor> outputs = graph.Forward(std::vector<sftensor>{input});
+  ASSERT_LT(TensorCompare(outputs.front(), expected.front()).max_abs, 1e-5f);
+
+  // 之后的构建直接使用缓存里的选择
+  for (auto &[key, name] : cache.entries) {
+    name = "direct";
+  }
+  ASSERT_TRUE(cache.Save(cache_path));
+  RuntimeGraph cached_graph(param_path, bin_path);
+  cached_graph.set_auto_tune(true);
+  cached_graph.set_tuning_cache(cache_path);
+  cached_graph.Build("pnnx_input_0", "pnnx_output_0");
+  for (const auto &op : cached_graph.topo_operators()) {
+    if (op->type == "nn.Conv2d") {
+      ASSERT_EQ(op->layer_impl, "direct");
+      ASSERT_TRUE(std::dynamic_pointer_cast<DirectConvLayer>(op->layer) != nullptr);
+    }
+  }
+  const std::vector<sftensor> cached_outputs = cached_graph.Forward(std::vector<sftensor>{input});
+  ASSERT_LT(TensorCompare(cached_outputs.front(), expected.front()).max_abs, 1e-5f);
+
+  // 损坏的缓存被忽略
+  std::ofstream(cache_path) << "kuiper_tuning_cache 1\nbroken\n";
+  ASSERT_FALSE(cache.Load(cache_path));
+  std::filesystem::remove(cache_path);
+}
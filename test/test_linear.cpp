@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include "data/tensor_util.hpp"
+#include "data/tensor_view.hpp"
+#include "layer/linear_layer.hpp"
+#include "runtime/runtime_ir.hpp"
+#include "test_model_file.hpp"
+
+using namespace kuiper_infer;
+
+static std::vector<float> RandValues(uint32_t count, float low, float high) {
+  std::vector<float> values(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    values.at(i) = low + (high - low) * float((i * 53 + 7) % 97) / 96.f;
+  }
+  return values;
+}
+
+// LinearOp 打包后不保留原始权重，参考实现使用这里的一份
+struct LinearParams {
+  std::vector<float> weights; // 行主序的 (out_features, in_features)
+  std::vector<float> bias;
+  SgemmActivation activation = SgemmActivation::kNone;
+};
+
+static LinearParams RandLinearParams(uint32_t in_features, uint32_t out_features, SgemmActivation activation) {
+  return {RandValues(in_features * out_features, -0.5f, 0.5f), RandValues(out_features, -1.f, 1.f), activation};
+}
+
+static std::shared_ptr<LinearOp> MakeLinearOp(const LinearParams &params,
+                                              const std::vector<uint32_t> &input_shape = {}) {
+  const uint32_t out_features = params.bias.size();
+  std::shared_ptr<LinearOp> op =
+      std::make_shared<LinearOp>(params.weights.size() / out_features, out_features, true);
+  op->set_weights(params.weights, input_shape);
+  op->set_bias(params.bias);
+  op->set_activation(params.activation);
+  return op;
+}
+
+// 按 pytorch 的展平顺序(行主序 CHW)计算
+static std::vector<float> ReferenceLinear(const sftensor &input, const LinearParams &params) {
+  const std::vector<float> &values = input->values(true);
+  const uint32_t out_features = params.bias.size();
+  const uint32_t in_features = values.size();
+  std::vector<float> output(out_features);
+  for (uint32_t j = 0; j < out_features; ++j) {
+    float sum = params.bias.at(j);
+    for (uint32_t p = 0; p < in_features; ++p) {
+      sum += params.weights.at(j * in_features + p) * values.at(p);
+    }
+    if (params.activation == SgemmActivation::kReLU) {
+      sum = std::max(sum, 0.f);
+    } else if (params.activation == SgemmActivation::kSigmoid) {
+      sum = 1.f / (1.f + std::exp(-sum));
+    }
+    output.at(j) = sum;
+  }
+  return output;
+}
+
+static void ExpectOutput(const sftensor &output, const std::vector<float> &expected) {
+  ASSERT_EQ(output->shape(), std::vector<uint32_t>({1, 1, uint32_t(expected.size())}));
+  for (uint32_t j = 0; j < expected.size(); ++j) {
+    ASSERT_NEAR(output->index(j), expected.at(j), 1e-4f) << j;
+  }
+}
+
+TEST(test_linear, flatten) {
+  // 一维输入和 (channels, rows, cols) 输入都按展平后的顺序计算，batch 为 1 时直接写到输出
+  // 列主序的输入使用加载时按输入形状打包的权重，没有打包时转置输入
+  for (const std::vector<uint32_t> &shape :
+       {std::vector<uint32_t>{1, 1, 300}, std::vector<uint32_t>{3, 10, 10}, std::vector<uint32_t>{12, 5, 5}}) {
+    const uint32_t in_features = shape.at(0) * shape.at(1) * shape.at(2);
+    for (const SgemmActivation activation :
+         {SgemmActivation::kNone, SgemmActivation::kReLU, SgemmActivation::kSigmoid}) {
+      const LinearParams &params = RandLinearParams(in_features, 37, activation);
+      for (const bool prepacked : {false, true}) {
+        const std::shared_ptr<LinearOp> &op = MakeLinearOp(params, prepacked ? shape : std::vector<uint32_t>());
+        ASSERT_EQ(op->column_major_weights().empty(), !prepacked || shape.at(1) == 1);
+        LinearLayer layer(op);
+        for (const uint32_t batch : {1u, 5u}) {
+          std::vector<sftensor> inputs;
+          for (uint32_t i = 0; i < batch; ++i) {
+            sftensor input = std::make_shared<ftensor>(shape.at(0), shape.at(1), shape.at(2));
+            input->Rand();
+            inputs.push_back(input);
+          }
+          std::vector<sftensor> outputs;
+          layer.Forward(inputs, outputs);
+          ASSERT_EQ(outputs.size(), batch);
+          for (uint32_t i = 0; i < batch; ++i) {
+            ExpectOutput(outputs.at(i), ReferenceLinear(inputs.at(i), params));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(test_linear, views) {
+  // 行主序的视图直接按内存顺序读取
+  const LinearParams &params = RandLinearParams(2 * 6 * 7, 20, SgemmActivation::kReLU);
+  const std::shared_ptr<LinearOp> &op = MakeLinearOp(params);
+  std::vector<sftensor> inputs;
+  std::vector<TensorView> views;
+  for (uint32_t i = 0; i < 3; ++i) {
+    sftensor input = std::make_shared<ftensor>(2, 6, 7);
+    input->Rand();
+    inputs.push_back(input);
+    auto values = std::make_shared<std::vector<float>>(input->values(true));
+    views.push_back(TensorView::RowMajor(values, values->data(), 2, 6, 7));
+  }
+  std::vector<sftensor> outputs;
+  LinearLayer(op).ForwardViews(views, outputs);
+  ASSERT_EQ(outputs.size(), 3);
+  for (uint32_t i = 0; i < 3; ++i) {
+    ExpectOutput(outputs.at(i), ReferenceLinear(inputs.at(i), params));
+  }
+
+  std::vector<sftensor> column_major_outputs;
+  LinearLayer(op).ForwardViews({TensorView(inputs.front())}, column_major_outputs);
+  ExpectOutput(column_major_outputs.front(), ReferenceLinear(inputs.front(), params));
+  std::vector<sftensor> prepacked_outputs;
+  LinearLayer(MakeLinearOp(params, {2, 6, 7})).ForwardViews({TensorView(inputs.front())}, prepacked_outputs);
+  ExpectOutput(prepacked_outputs.front(), ReferenceLinear(inputs.front(), params));
+}
+
+TEST(test_linear, last_dim) {
+  // 列数等于 in_features 时每一行分别计算
+  const LinearParams &params = RandLinearParams(24, 9, SgemmActivation::kNone);
+  const std::shared_ptr<LinearOp> &op = MakeLinearOp(params);
+  sftensor input = std::make_shared<ftensor>(2, 13, 24);
+  input->Rand();
+  std::vector<sftensor> outputs;
+  LinearLayer(op).Forward({input}, outputs);
+  ASSERT_EQ(outputs.front()->shape(), std::vector<uint32_t>({2, 13, 9}));
+  for (uint32_t c = 0; c < 2; ++c) {
+    for (uint32_t r = 0; r < 13; ++r) {
+      for (uint32_t j = 0; j < 9; ++j) {
+        float sum = params.bias.at(j);
+        for (uint32_t p = 0; p < 24; ++p) {
+          sum += params.weights.at(j * 24 + p) * input->at(c, r, p);
+        }
+        ASSERT_NEAR(outputs.front()->at(c, r, j), sum, 1e-4f);
+      }
+    }
+  }
+}
+
+TEST(test_linear, graph) {
+  // fc1 -> relu 融合为一个算子，fc2 -> sigmoid 融合，fc3 没有激活函数
+  // fc1 的输入是 (4, 4, 4) 的张量，加载时按列主序的输入打包权重
+  TempModelFile model("linear_test");
+  model.WriteParam("7767517\n7 6\n"
+                   "pnnx.Input pnnx_input_0 0 1 0 #0=(1,4,4,4)f32\n"
+                   "nn.Linear fc1 1 1 0 1 bias=True in_features=64 out_features=32 @bias=(32)f32 @weight=(32,64)f32 "
+                   "#0=(1,4,4,4)f32 #1=(1,32)f32\n"
+                   "nn.ReLU relu 1 1 1 2 #1=(1,32)f32 #2=(1,32)f32\n"
+                   "nn.Linear fc2 1 1 2 3 bias=True in_features=32 out_features=16 @bias=(16)f32 @weight=(16,32)f32 "
+                   "#2=(1,32)f32 #3=(1,16)f32\n"
+                   "F.sigmoid sigmoid 1 1 3 4 #3=(1,16)f32 #4=(1,16)f32\n"
+                   "nn.Linear fc3 1 1 4 5 bias=False in_features=16 out_features=10 @weight=(10,16)f32 "
+                   "#4=(1,16)f32 #5=(1,10)f32\n"
+                   "pnnx.Output pnnx_output_0 1 0 5 #5=(1,10)f32\n");
+  ASSERT_TRUE(model.WriteBin({{"fc1.weight", RandValues(32 * 64, -0.3f, 0.3f)},
+                              {"fc1.bias", RandValues(32, -0.2f, 0.2f)},
+                              {"fc2.weight", RandValues(16 * 32, -0.4f, 0.4f)},
+                              {"fc2.bias", RandValues(16, -0.1f, 0.1f)},
+                              {"fc3.weight", RandValues(10 * 16, -1.f, 1.f)}}));
+
+  RuntimeGraph graph(model.param_path(), model.bin_path());
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  std::vector<std::string> names;
+  for (const auto &op : graph.operators()) {
+    names.push_back(op->name);
+  }
+  ASSERT_EQ(names.size(), 5);
+  ASSERT_TRUE(std::find(names.begin(), names.end(), "relu") == names.end());
+  ASSERT_TRUE(std::find(names.begin(), names.end(), "sigmoid") == names.end());
+
+  // 逐层计算作为参考
+  const LinearParams fc1{RandValues(32 * 64, -0.3f, 0.3f), RandValues(32, -0.2f, 0.2f), SgemmActivation::kReLU};
+  const LinearParams fc2{RandValues(16 * 32, -0.4f, 0.4f), RandValues(16, -0.1f, 0.1f), SgemmActivation::kSigmoid};
+  const LinearParams fc3{RandValues(10 * 16, -1.f, 1.f), std::vector<float>(10, 0.f), SgemmActivation::kNone};
+
+  std::vector<sftensor> inputs;
+  for (uint32_t i = 0; i < 4; ++i) {
+    sftensor input = std::make_shared<ftensor>(4, 4, 4);
+    input->Rand();
+    inputs.push_back(input);
+  }
+  const std::vector<sftensor> &outputs = graph.Forward(inputs);
+  ASSERT_EQ(outputs.size(), 4);
+  for (uint32_t i = 0; i < 4; ++i) {
+    sftensor hidden = std::make_shared<ftensor>(1, 1, 32);
+    hidden->Fill(ReferenceLinear(inputs.at(i), fc1), true);
+    sftensor hidden2 = std::make_shared<ftensor>(1, 1, 16);
+    hidden2->Fill(ReferenceLinear(hidden, fc2), true);
+    ExpectOutput(outputs.at(i), ReferenceLinear(hidden2, fc3));
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef KUIPER_INFER_TEST_MODEL_FILE_HPP
+#define KUIPER_INFER_TEST_MODEL_FILE_HPP
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "runtime/storezip.hpp"
+
+// 测试里临时生成的 pnnx 模型，写到 ../tmp/<name>.pnnx.param 和 .bin，离开作用域时删除
+class TempModelFile {
+ public:
+  explicit TempModelFile(const std::string &name)
+      : param_path_("../tmp/" + name + ".pnnx.param"), bin_path_("../tmp/" + name + ".pnnx.bin") {}
+
+  ~TempModelFile() {
+    std::error_code error;
+    std::filesystem::remove(this->param_path_, error);
+    std::filesystem::remove(this->bin_path_, error);
+  }
+
+  TempModelFile(const TempModelFile &) = delete;
+
+  TempModelFile &operator=(const TempModelFile &) = delete;
+
+  void WriteParam(const std::string &param) const {
+    std::ofstream(this->param_path_) << param;
+  }
+
+  // 每个权重按名字写为 fp32，失败时返回 false
+  bool WriteBin(const std::vector<std::pair<std::string, std::vector<float>>> &weights) const {
+    pnnx::StoreZipWriter writer;
+    if (writer.open(this->bin_path_) != 0) {
+      return false;
+    }
+    for (const auto &[name, values] : weights) {
+      writer.write_file(name, (const char *)values.data(), values.size() * sizeof(float));
+    }
+    writer.close();
+    return true;
+  }
+
+  const std::string &param_path() const {
+    return this->param_path_;
+  }
+
+  const std::string &bin_path() const {
+    return this->bin_path_;
+  }
+
+ private:
+  std::string param_path_;
+  std::string bin_path_;
+};
+
+#endif
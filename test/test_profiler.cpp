@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "runtime/runtime_ir.hpp"
+#include "runtime/runtime_profiler.hpp"
+
+TEST(test_profiler, forward) {
+  using namespace kuiper_infer;
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  RuntimeGraph graph(param_path, bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+
+  // 没有设置 profiler 时不记录
+  graph.Forward({input});
+  std::shared_ptr<RuntimeProfiler> profiler = std::make_shared<RuntimeProfiler>();
+  ASSERT_TRUE(profiler->records().empty());
+
+  graph.set_profiler(profiler);
+  graph.Forward({input});
+  graph.Forward({input});
+
+  // conv1 conv2 expression maxpool，每次前向记录4个算子
+  const std::vector<ProfileRecord> &records = profiler->records();
+  ASSERT_EQ(records.size(), 8);
+  for (const auto &record : records) {
+    ASSERT_LE(record.start_ns, record.end_ns);
+    ASSERT_NE(record.thread_id, 0);
+    ASSERT_FALSE(record.output_shapes.empty());
+    if (record.name == "conv1") {
+      ASSERT_EQ(record.flops, 2 * 16 * 16 * 25);
+      ASSERT_EQ(record.bytes, 16 * 16 * sizeof(float));
+      ASSERT_EQ(record.input_shapes.at(0), std::vector<uint32_t>({1, 16, 16}));
+    } else if (record.name == "conv2") {
+      ASSERT_EQ(record.flops, 2 * 16 * 16 * 25 + 16 * 16);
+    } else if (record.name == "max") {
+      ASSERT_EQ(record.flops, 8 * 8 * 4);
+      ASSERT_EQ(record.output_shapes.at(0), std::vector<uint32_t>({1, 8, 8}));
+    } else if (record.name == "pnnx_expr_0") {
+      ASSERT_EQ(record.flops, 16 * 16);
+      ASSERT_EQ(record.input_shapes.size(), 2);
+    }
+  }
+
+  const std::string &summary = profiler->Summary();
+  LOG(INFO) << "\n" << summary;
+  ASSERT_NE(summary.find("conv1"), std::string::npos);
+
+  const std::string &trace = profiler->ChromeTrace();
+  ASSERT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  ASSERT_NE(trace.find("\"name\":\"conv2\""), std::string::npos);
+  ASSERT_NE(trace.find("\"ph\":\"X\""), std::string::npos);
+
+  profiler->Clear();
+  ASSERT_TRUE(profiler->records().empty());
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include <limits>
+#include "data/quantize.hpp"
+#include "data/tensor.hpp"
+#include "data/tensor_util.hpp"
+
+using namespace kuiper_infer;
+
+static QuantParams MakeParams(float scale, int32_t zero_point, bool is_signed) {
+  QuantParams params;
+  params.scales = {scale};
+  params.zero_points = {zero_point};
+  params.is_signed = is_signed;
+  return params;
+}
+
+TEST(test_quantize, choose_params) {
+  // 非对称量化，0 可以精确表示
+  auto [scale, zero_point] = ChooseQuantParams(-1.f, 3.f, false, false);
+  ASSERT_FLOAT_EQ(scale, 4.f / 255);
+  ASSERT_EQ(zero_point, 64);
+  // 范围总会包含 0
+  std::tie(scale, zero_point) = ChooseQuantParams(2.f, 4.f, true, false);
+  ASSERT_FLOAT_EQ(scale, 4.f / 255);
+  ASSERT_EQ(zero_point, -128);
+  // 对称量化
+  std::tie(scale, zero_point) = ChooseQuantParams(-2.f, 1.f, true, true);
+  ASSERT_FLOAT_EQ(scale, 2.f / 127);
+  ASSERT_EQ(zero_point, 0);
+  std::tie(scale, zero_point) = ChooseQuantParams(-2.f, 1.f, false, true);
+  ASSERT_EQ(zero_point, 128);
+  // 全 0
+  std::tie(scale, zero_point) = ChooseQuantParams(0.f, 0.f, false, false);
+  ASSERT_EQ(scale, 1.f);
+}
+
+TEST(test_quantize, values) {
+  // 长度不是 32 的整数倍，覆盖向量和标量两条路径，结果必须完全一致
+  std::vector<float> values(1000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values.at(i) = std::sin(float(i) * 0.37f) * 3.f;
+  }
+  values.at(3) = 1e20f;
+  values.at(4) = -1e20f;
+  values.at(5) = std::numeric_limits<float>::quiet_NaN();
+  // 正好在两个整数中间，舍入到偶数
+  values.at(6) = 0.5f * 0.1f;
+  values.at(7) = 1.5f * 0.1f;
+
+  for (const bool is_signed : {false, true}) {
+    const int32_t zero_point = is_signed ? 3 : 131;
+    const float scale = 0.1f;
+    std::vector<uint8_t> quantized(values.size());
+    std::vector<float> restored(values.size());
+    QuantizeValues(values.data(), quantized.data(), values.size(), scale, zero_point, is_signed);
+    DequantizeValues(quantized.data(), restored.data(), values.size(), scale, zero_point, is_signed);
+
+    const int32_t qmin = is_signed ? -128 : 0;
+    const int32_t qmax = is_signed ? 127 : 255;
+    for (size_t i = 0; i < values.size(); ++i) {
+      // 逐个走标量尾部路径得到参考结果
+      uint8_t expected = 0;
+      QuantizeValues(&values.at(i), &expected, 1, scale, zero_point, is_signed);
+      ASSERT_EQ(quantized.at(i), expected) << i;
+      const int32_t q = is_signed ? int32_t(int8_t(expected)) : int32_t(expected);
+      ASSERT_GE(q, qmin);
+      ASSERT_LE(q, qmax);
+      ASSERT_FLOAT_EQ(restored.at(i), float(q - zero_point) * scale);
+      if (i >= 10 && std::fabs(values.at(i)) < 3.f) {
+        ASSERT_NEAR(restored.at(i), values.at(i), scale / 2 + 1e-6f);
+      }
+    }
+    const auto value_of = [&](size_t i) {
+      return is_signed ? int32_t(int8_t(quantized.at(i))) : int32_t(quantized.at(i));
+    };
+    ASSERT_EQ(value_of(3), qmax);
+    ASSERT_EQ(value_of(4), qmin);
+    ASSERT_EQ(value_of(5), qmin);
+    ASSERT_EQ(value_of(6) - zero_point, 0);
+    ASSERT_EQ(value_of(7) - zero_point, 2);
+  }
+}
+
+TEST(test_quantize, tensor) {
+  sftensor tensor = std::make_shared<ftensor>(4, 13, 7);
+  tensor->Rand();
+  // 每个通道的范围不同
+  for (uint32_t c = 0; c < tensor->channels(); ++c) {
+    tensor->slice(c) *= float(c + 1);
+  }
+
+  for (const bool per_channel : {false, true}) {
+    for (const bool is_signed : {false, true}) {
+      const QuantParams &params = TensorQuantParams(tensor, per_channel, is_signed, is_signed);
+      ASSERT_EQ(params.per_channel(), per_channel);
+      ASSERT_EQ(params.scales.size(), per_channel ? 4 : 1);
+
+      const sqtensor &quantized = qtensor::Quantize(*tensor, params);
+      ASSERT_EQ(quantized->shape(), tensor->shape());
+      ASSERT_EQ(quantized->params(), params);
+      const sftensor &restored = quantized->Dequantize();
+      for (uint32_t c = 0; c < tensor->channels(); ++c) {
+        for (uint32_t r = 0; r < tensor->rows(); ++r) {
+          for (uint32_t col = 0; col < tensor->cols(); ++col) {
+            ASSERT_NEAR(restored->at(c, r, col), tensor->at(c, r, col), params.scale(c) / 2 + 1e-5f);
+            const float real = float(quantized->value(c, r, col) - params.zero_point(c)) * params.scale(c);
+            ASSERT_FLOAT_EQ(restored->at(c, r, col), real);
+          }
+        }
+      }
+
+      // 按通道量化的误差不超过按张量量化
+      if (per_channel) {
+        const QuantParams &tensor_params = TensorQuantParams(tensor, false, is_signed, is_signed);
+        const TensorErrorStats &channel_error = TensorCompare(restored, tensor);
+        const TensorErrorStats &tensor_error =
+            TensorCompare(qtensor::Quantize(*tensor, tensor_params)->Dequantize(), tensor);
+        ASSERT_LE(channel_error.mean_abs, tensor_error.mean_abs);
+      }
+    }
+  }
+}
+
+TEST(test_quantize, create_and_compare) {
+  const QuantParams &params = MakeParams(0.5f, 10, false);
+  sqtensor a = TensorCreate(2, 3, 4, params);
+  ASSERT_EQ(a->shape(), std::vector<uint32_t>({2, 3, 4}));
+  sqtensor b = TensorCreate(2, 3, 4, params);
+  for (uint32_t i = 0; i < a->size(); ++i) {
+    a->index(i) = i;
+    b->index(i) = i;
+  }
+  ASSERT_TRUE(TensorIsSame(a, b));
+  b->index(5) += 1;
+  ASSERT_FALSE(TensorIsSame(a, b));
+  ASSERT_TRUE(TensorIsSame(a, b, 1));
+
+  // 量化参数不同的张量不相同
+  sqtensor c = TensorCreate(2, 3, 4, MakeParams(0.25f, 10, false));
+  for (uint32_t i = 0; i < a->size(); ++i) {
+    c->index(i) = i;
+  }
+  ASSERT_FALSE(TensorIsSame(a, c));
+
+  // int8 按带符号的整数值比较
+  const QuantParams &signed_params = MakeParams(1.f, 0, true);
+  sqtensor d = TensorCreate(1, 1, 2, signed_params);
+  sqtensor e = TensorCreate(1, 1, 2, signed_params);
+  d->index(0) = uint8_t(int8_t(-1));
+  e->index(0) = 0;
+  d->index(1) = e->index(1) = 7;
+  ASSERT_EQ(d->value(0, 0, 0), -1);
+  ASSERT_TRUE(TensorIsSame(d, e, 1));
+  ASSERT_FALSE(TensorIsSame(d, e));
+}
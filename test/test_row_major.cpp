@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "data/tensor_view.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/conv_layer.hpp"
+#include "layer/relu_layer.hpp"
+#include "layer/sigmoid_layer.hpp"
+#include "ops/conv_op.hpp"
+#include "ops/relu_op.hpp"
+#include "ops/sigmoid_op.hpp"
+#include "runtime/runtime_ir.hpp"
+
+using namespace kuiper_infer;
+
+// 行主序 (channels, rows, cols) 的随机数据，和 Fill(values, true) 得到的张量对应
+static std::shared_ptr<std::vector<float>> RandRowMajor(uint32_t channels, uint32_t rows, uint32_t cols,
+                                                        sftensor &tensor) {
+  tensor = std::make_shared<ftensor>(channels, rows, cols);
+  tensor->Rand();
+  return std::make_shared<std::vector<float>>(tensor->values(true));
+}
+
+static void ExpectSame(const sftensor &a, const sftensor &b) {
+  ASSERT_EQ(a->shape(), b->shape());
+  for (uint32_t i = 0; i < a->size(); ++i) {
+    ASSERT_NEAR(a->index(i), b->index(i), 1e-4);
+  }
+}
+
+TEST(test_row_major, import) {
+  sftensor tensor;
+  const auto &values = RandRowMajor(3, 4, 5, tensor);
+  const TensorView &view = TensorView::RowMajor(values, values->data(), 3, 4, 5);
+  ASSERT_EQ(view.strides(), std::vector<uint32_t>({60, 20, 5, 1}));
+  ASSERT_TRUE(view.is_row_major());
+  ASSERT_FALSE(view.is_contiguous());
+  for (uint32_t c = 0; c < 3; ++c) {
+    for (uint32_t r = 0; r < 4; ++r) {
+      for (uint32_t col = 0; col < 5; ++col) {
+        ASSERT_EQ(view.at(c, r, col), tensor->at(c, r, col));
+      }
+    }
+  }
+
+  // 转换为列主序时才复制一次
+  ExpectSame(view.AsTensor(), tensor);
+
+  // 导出行主序和 values(true) 一致
+  std::vector<float> exported(tensor->size());
+  view.CopyTo(exported.data(), true);
+  ASSERT_EQ(exported, *values);
+  TensorView(tensor).CopyTo(exported.data(), true);
+  ASSERT_EQ(exported, *values);
+}
+
+TEST(test_row_major, reshape) {
+  sftensor tensor;
+  const auto &values = RandRowMajor(2, 3, 4, tensor);
+  const TensorView &view = TensorView::RowMajor(values, values->data(), 2, 3, 4);
+
+  // 行主序的 reshape 只改变步长，结果和 Tensor::Reshape(shape, true) 一致
+  const TensorView &reshaped = view.Reshape({4, 2, 3}, true);
+  ASSERT_EQ(reshaped.raw_ptr(), values->data());
+  sftensor expected = TensorClone(tensor);
+  expected->Reshape({4, 2, 3}, true);
+  ExpectSame(reshaped.AsTensor(), expected);
+
+  const TensorView &flatten = view.Flatten(true);
+  ASSERT_EQ(flatten.shape(), std::vector<uint32_t>({1, 1, 1, 24}));
+  ASSERT_EQ(flatten.raw_ptr(), values->data());
+  expected = TensorClone(tensor);
+  expected->Flatten(true);
+  ExpectSame(flatten.AsTensor(), expected);
+}
+
+TEST(test_row_major, layer_forward) {
+  sftensor tensor;
+  const auto &values = RandRowMajor(4, 9, 7, tensor);
+  const TensorView &view = TensorView::RowMajor(values, values->data(), 4, 9, 7);
+
+  ReLULayer relu(std::make_shared<ReLUOperator>(0.f));
+  ASSERT_TRUE(relu.AcceptsStridedViews());
+  std::vector<sftensor> expected;
+  std::vector<sftensor> outputs;
+  relu.Forward({tensor}, expected);
+  relu.ForwardViews({view}, outputs);
+  ASSERT_EQ(outputs.size(), 1);
+  ExpectSame(outputs.front(), expected.front());
+
+  SigmoidLayer sigmoid(std::make_shared<SigmoidOperator>());
+  expected.clear();
+  outputs.clear();
+  sigmoid.Forward({tensor}, expected);
+  sigmoid.ForwardViews({view}, outputs);
+  ExpectSame(outputs.front(), expected.front());
+
+  // 卷积在 im2col 时直接按步长读取，padding 的位置填 0
+  for (uint32_t groups : {1, 2}) {
+    std::shared_ptr<ConvOp> conv_op = std::make_shared<ConvOp>(Shape(2, 1), Shape(1, 2), true, groups);
+    std::vector<sftensor> weights;
+    std::vector<sftensor> bias;
+    for (uint32_t k = 0; k < 6; ++k) {
+      weights.push_back(std::make_shared<ftensor>(4 / groups, 3, 3));
+      weights.back()->Rand();
+      bias.push_back(std::make_shared<ftensor>(1, 1, 1));
+      bias.back()->Rand();
+    }
+    conv_op->set_weights(weights);
+    conv_op->set_bias(bias);
+    ConvLayer conv(conv_op);
+    ASSERT_TRUE(conv.AcceptsStridedViews());
+
+    expected.clear();
+    outputs.clear();
+    conv.Forward({tensor, tensor}, expected);
+    conv.ForwardViews({view, view}, outputs);
+    ASSERT_EQ(outputs.size(), 2);
+    ExpectSame(outputs.at(0), expected.at(0));
+    ExpectSame(outputs.at(1), expected.at(1));
+  }
+}
+
+TEST(test_row_major, graph_forward) {
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  RuntimeGraph graph(param_path, bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+
+  sftensor tensor;
+  const auto &values = RandRowMajor(1, 16, 16, tensor);
+  const std::vector<sftensor> expected = graph.Forward(std::vector<sftensor>{tensor});
+
+  // 两个卷积都直接读取行主序的输入
+  const std::vector<sftensor> &outputs =
+      graph.Forward(std::vector<TensorView>{TensorView::RowMajor(values, values->data(), 1, 16, 16)});
+  ASSERT_EQ(outputs.size(), 1);
+  ExpectSame(outputs.front(), expected.front());
+
+  // 列主序的视图直接作为张量使用
+  const std::vector<sftensor> &contiguous_outputs = graph.Forward(std::vector<TensorView>{TensorView(tensor)});
+  ExpectSame(contiguous_outputs.front(), expected.front());
+}
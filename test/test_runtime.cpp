@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 #include <glog/logging.h>
 #include "runtime/runtime_ir.hpp"
+#include "runtime/runtime_plan.hpp"
+#include "ops/conv_op.hpp"
+#include "data/tensor_util.hpp"
 
 TEST(test_runtime, runtime1) {
   using namespace kuiper_infer;
@@ -12,4 +15,154 @@ TEST(test_runtime, runtime1) {
   for (const auto &operator_ : operators) {
     LOG(INFO) << "type: " << operator_->type << " name: " << operator_->name;
   }
-}
\ No newline at end of file
+}
+
+// 直接按定义计算卷积，作为计算图输出的参考
+static void NaiveConv(const kuiper_infer::sftensor &input, const std::shared_ptr<kuiper_infer::RuntimeOperator> &op,
+                      kuiper_infer::sftensor &output) {
+  using namespace kuiper_infer;
+  // Build 之后卷积核只保存在 ConvOp 里
+  const std::shared_ptr<ConvOp> &conv_op = std::dynamic_pointer_cast<ConvOp>(op->layer_op);
+  ASSERT_TRUE(conv_op != nullptr);
+  ASSERT_TRUE(op->attrs.at("weight")->weight_data.empty());
+  const sftensor &kernel = conv_op->get_weights().at(0);
+  const int kernel_h = int(kernel->rows());
+  const int kernel_w = int(kernel->cols());
+  const int pad = 2;
+  float bias = 0.f;
+  if (conv_op->get_has_bias()) {
+    bias = conv_op->get_bias().at(0)->index(0);
+  }
+  output = std::make_shared<ftensor>(1, input->rows(), input->cols());
+  for (int r = 0; r < int(input->rows()); ++r) {
+    for (int c = 0; c < int(input->cols()); ++c) {
+      float sum = bias;
+      for (int kh = 0; kh < kernel_h; ++kh) {
+        for (int kw = 0; kw < kernel_w; ++kw) {
+          const int ir = r + kh - pad;
+          const int ic = c + kw - pad;
+          if (ir < 0 || ic < 0 || ir >= int(input->rows()) || ic >= int(input->cols())) {
+            continue;
+          }
+          sum += input->at(0, ir, ic) * kernel->at(0, kh, kw);
+        }
+      }
+      output->at(0, r, c) = sum;
+    }
+  }
+}
+
+TEST(test_runtime, forward1) {
+  using namespace kuiper_infer;
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  RuntimeGraph graph(param_path, bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  ASSERT_EQ(graph.topo_operators().size(), 6);
+  ASSERT_EQ(graph.topo_operators().front()->type, "pnnx.Input");
+  ASSERT_EQ(graph.topo_operators().back()->type, "pnnx.Output");
+
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+  const std::vector<sftensor> &outputs = graph.Forward({input});
+  ASSERT_EQ(outputs.size(), 1);
+  ASSERT_EQ(outputs.at(0)->shape(), std::vector<uint32_t>({1, 8, 8}));
+
+  std::shared_ptr<RuntimeOperator> conv1;
+  std::shared_ptr<RuntimeOperator> conv2;
+  for (const auto &op : graph.operators()) {
+    if (op->name == "conv1") conv1 = op;
+    if (op->name == "conv2") conv2 = op;
+  }
+  sftensor out1, out2;
+  NaiveConv(input, conv1, out1);
+  NaiveConv(input, conv2, out2);
+  for (uint32_t r = 0; r < 8; ++r) {
+    for (uint32_t c = 0; c < 8; ++c) {
+      float expected = std::numeric_limits<float>::lowest();
+      for (uint32_t i = 0; i < 2; ++i) {
+        for (uint32_t j = 0; j < 2; ++j) {
+          expected = std::max(expected, out1->at(0, r * 2 + i, c * 2 + j) + out2->at(0, r * 2 + i, c * 2 + j));
+        }
+      }
+      ASSERT_NEAR(outputs.at(0)->at(0, r, c), expected, 1e-4);
+    }
+  }
+}
+
+TEST(test_runtime, plan_cache) {
+  using namespace kuiper_infer;
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  const std::string &plan_path = RuntimePlan::PlanPath(param_path);
+  ASSERT_EQ(plan_path, "../tmp/test.pnnx.kplan");
+  std::remove(plan_path.c_str());
+
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+
+  RuntimeGraph graph1(param_path, bin_path);
+  graph1.set_plan_cache(true);
+  graph1.Build("pnnx_input_0", "pnnx_output_0");
+  ASSERT_FALSE(graph1.loaded_from_plan());
+  const std::vector<sftensor> outputs1 = graph1.Forward({input});
+
+  // 第二次启动直接从缓存恢复
+  RuntimeGraph graph2(param_path, bin_path);
+  graph2.set_plan_cache(true);
+  graph2.Build("pnnx_input_0", "pnnx_output_0");
+  ASSERT_TRUE(graph2.loaded_from_plan());
+  ASSERT_EQ(graph2.operators().size(), graph1.operators().size());
+  const std::vector<sftensor> outputs2 = graph2.Forward({input});
+  ASSERT_TRUE(TensorIsSame(outputs1.at(0), outputs2.at(0)));
+
+  // key 不一致的缓存会被拒绝
+  std::vector<std::shared_ptr<RuntimeOperator>> operators;
+  const uint64_t key = RuntimePlan::PlanKey(param_path, bin_path);
+  ASSERT_NE(key, 0);
+  ASSERT_TRUE(RuntimePlan::Load(plan_path, key, operators));
+  ASSERT_FALSE(RuntimePlan::Load(plan_path, key + 1, operators));
+  std::remove(plan_path.c_str());
+}
+
+TEST(test_runtime, share_weights) {
+  using namespace kuiper_infer;
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  ASSERT_EQ(WeightStore::model_count(), 0);
+  {
+    RuntimeGraph graph1(param_path, bin_path);
+    graph1.Build("pnnx_input_0", "pnnx_output_0");
+    RuntimeGraph graph2(param_path, bin_path);
+    graph2.Build("pnnx_input_0", "pnnx_output_0");
+    ASSERT_EQ(WeightStore::model_count(), 1);
+
+    // 两个计算图引用同一份权重
+    const auto operators1 = graph1.operators();
+    const auto operators2 = graph2.operators();
+    for (uint32_t i = 0; i < operators1.size(); ++i) {
+      const auto &op1 = operators1.at(i);
+      const auto &op2 = operators2.at(i);
+      ASSERT_EQ(op1->name, op2->name);
+      for (const auto &[name, attr] : op1->attrs) {
+        ASSERT_EQ(attr, op2->attrs.at(name));
+      }
+    }
+
+    // 激活值仍然各自独立
+    sftensor input1 = std::make_shared<ftensor>(1, 16, 16);
+    sftensor input2 = std::make_shared<ftensor>(1, 16, 16);
+    input1->Rand();
+    input2->Fill(1.f);
+    const std::vector<sftensor> outputs1 = graph1.Forward({input1});
+    const std::vector<sftensor> outputs2 = graph2.Forward({input2});
+    ASSERT_NE(outputs1.at(0), outputs2.at(0));
+
+    RuntimeGraph graph3(param_path, bin_path);
+    graph3.set_share_weights(false);
+    graph3.Build("pnnx_input_0", "pnnx_output_0");
+    ASSERT_TRUE(TensorIsSame(graph3.Forward({input1}).at(0), outputs1.at(0)));
+  }
+  // 所有计算图析构后权重释放
+  ASSERT_EQ(WeightStore::model_count(), 0);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cmath>
+#include <random>
+#include "data/cpu_isa.hpp"
+#include "data/sgemm.hpp"
+
+using namespace kuiper_infer;
+
+static std::vector<float> RandomValues(size_t count, uint32_t seed) {
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> values(count);
+  for (float &value : values) {
+    value = dist(engine);
+  }
+  return values;
+}
+
+// double 累加的参考实现，列主序
+static std::vector<float> ReferenceGemm(uint32_t m, uint32_t n, uint32_t k, const std::vector<float> &a, size_t lda,
+                                        const std::vector<float> &b, const std::vector<float> &bias) {
+  std::vector<float> c(size_t(m) * n);
+  for (uint32_t j = 0; j < n; ++j) {
+    for (uint32_t i = 0; i < m; ++i) {
+      double sum = bias.empty() ? 0. : bias.at(j);
+      for (uint32_t p = 0; p < k; ++p) {
+        sum += double(a.at(size_t(p) * lda + i)) * b.at(size_t(j) * k + p);
+      }
+      c.at(size_t(j) * m + i) = float(sum);
+    }
+  }
+  return c;
+}
+
+static void ExpectNear(const std::vector<float> &actual, const std::vector<float> &expected, uint32_t k,
+                       const std::string &label) {
+  ASSERT_EQ(actual.size(), expected.size());
+  const float tolerance = 1e-6f * k + 1e-5f;
+  for (size_t i = 0; i < actual.size(); ++i) {
+    ASSERT_NEAR(actual.at(i), expected.at(i), tolerance) << label << " " << i;
+  }
+}
+
+TEST(test_sgemm, shapes) {
+  // 覆盖不是 MR / NR 整数倍的边缘、多段 K、多个 M 块和全连接层的 m = 1
+  struct Shape {
+    uint32_t m, n, k;
+  };
+  const std::vector<Shape> shapes = {{1, 1, 1}, {7, 5, 3}, {33, 13, 17}, {64, 24, 300}, {1, 1000, 64},
+                                     {300, 40, 530}, {529, 12, 9}};
+  const CpuIsa active = ActiveCpuIsa();
+  for (const Shape &shape : shapes) {
+    const size_t lda = shape.m + 3;
+    const std::vector<float> a = RandomValues(lda * shape.k, 1);
+    const std::vector<float> b = RandomValues(size_t(shape.k) * shape.n, 2);
+    const std::vector<float> bias = RandomValues(shape.n, 3);
+    const std::vector<float> expected = ReferenceGemm(shape.m, shape.n, shape.k, a, lda, b, {});
+    const std::vector<float> expected_bias = ReferenceGemm(shape.m, shape.n, shape.k, a, lda, b, bias);
+    const PackedSgemmMatrix packed = PackSgemmMatrix(b.data(), shape.k, shape.k, shape.n);
+    for (uint32_t i = 0; i <= uint32_t(DetectCpuIsa()); ++i) {
+      SetActiveCpuIsa(CpuIsa(i));
+      const std::string label = std::string(CpuIsaName(CpuIsa(i))) + " " + std::to_string(shape.m) + "x" +
+                                std::to_string(shape.n) + "x" + std::to_string(shape.k);
+      std::vector<float> c(size_t(shape.m) * shape.n, NAN);
+      Sgemm(shape.m, shape.n, shape.k, a.data(), lda, b.data(), shape.k, c.data(), shape.m);
+      ExpectNear(c, expected, shape.k, label);
+
+      SgemmEpilogue epilogue;
+      epilogue.bias = bias.data();
+      std::fill(c.begin(), c.end(), NAN);
+      Sgemm(shape.m, a.data(), lda, packed, c.data(), shape.m, epilogue);
+      ExpectNear(c, expected_bias, shape.k, label + " packed");
+    }
+  }
+  SetActiveCpuIsa(active);
+}
+
+TEST(test_sgemm, output_stride) {
+  // C 的列距大于 m 时不写列之间的空隙
+  const uint32_t m = 45, n = 14, k = 20;
+  const size_t ldc = 50;
+  const std::vector<float> a = RandomValues(size_t(m) * k, 4);
+  const std::vector<float> b = RandomValues(size_t(k) * n, 5);
+  const std::vector<float> expected = ReferenceGemm(m, n, k, a, m, b, {});
+  std::vector<float> c(ldc * n, -7.f);
+  Sgemm(m, n, k, a.data(), m, b.data(), k, c.data(), ldc);
+  for (uint32_t j = 0; j < n; ++j) {
+    for (uint32_t i = 0; i < ldc; ++i) {
+      if (i < m) {
+        ASSERT_NEAR(c.at(j * ldc + i), expected.at(j * m + i), 1e-4f);
+      } else {
+        ASSERT_EQ(c.at(j * ldc + i), -7.f);
+      }
+    }
+  }
+}
+
+TEST(test_sgemm, activation) {
+  // 激活函数在加上 bias 之后计算，多段 K 时只在最后一段之后计算
+  const uint32_t m = 19, n = 30, k = 600;
+  const std::vector<float> a = RandomValues(size_t(m) * k, 6);
+  const std::vector<float> b = RandomValues(size_t(k) * n, 7);
+  const std::vector<float> bias = RandomValues(n, 8);
+  const std::vector<float> expected = ReferenceGemm(m, n, k, a, m, b, bias);
+  const PackedSgemmMatrix packed = PackSgemmMatrix(b.data(), k, k, n);
+  for (const SgemmActivation activation : {SgemmActivation::kReLU, SgemmActivation::kSigmoid}) {
+    SgemmEpilogue epilogue;
+    epilogue.bias = bias.data();
+    epilogue.activation = activation;
+    std::vector<float> c(size_t(m) * n);
+    Sgemm(m, a.data(), m, packed, c.data(), m, epilogue);
+    for (size_t i = 0; i < c.size(); ++i) {
+      const float value = expected.at(i);
+      const float reference = activation == SgemmActivation::kReLU ? std::max(value, 0.f)
+                                                                    : 1.f / (1.f + std::exp(-value));
+      ASSERT_NEAR(c.at(i), reference, 1e-4f) << int(activation) << " " << i;
+    }
+  }
+}
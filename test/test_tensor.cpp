@@ -264,4 +264,30 @@ TEST(test_tensor, add2) {
   for (int i = 0; i < f3->size(); ++i) {
     ASSERT_EQ(f3->index(i), 3.f);
   }
-}
\ No newline at end of file
+}
+TEST(test_tensor, fill_rowmajor_blocked) {
+  using namespace kuiper_infer;
+  // 尺寸不是 8 和分块大小的倍数，覆盖边角；最后一个足够大，会并行转置
+  const std::vector<std::vector<uint32_t>> shapes = {{1, 1, 1}, {2, 7, 13}, {3, 40, 33}, {3, 135, 240}};
+  for (const auto& shape : shapes) {
+    const uint32_t channels = shape.at(0);
+    const uint32_t rows = shape.at(1);
+    const uint32_t cols = shape.at(2);
+    std::vector<float> values(channels * rows * cols);
+    for (uint32_t i = 0; i < values.size(); ++i) {
+      values.at(i) = float(i);
+    }
+
+    Tensor<float> f1(channels, rows, cols);
+    f1.Fill(values, true);
+    uint32_t index = 0;
+    for (uint32_t c = 0; c < channels; ++c) {
+      for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t col = 0; col < cols; ++col) {
+          ASSERT_EQ(f1.at(c, r, col), values.at(index++));
+        }
+      }
+    }
+    ASSERT_EQ(f1.values(true), values);
+  }
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include "data/tensor_view.hpp"
+#include "data/tensor_util.hpp"
+#include "layer/relu_layer.hpp"
+#include "ops/relu_op.hpp"
+
+TEST(test_tensor_view, create) {
+  using namespace kuiper_infer;
+  sftensor tensor = std::make_shared<ftensor>(3, 4, 5);
+  tensor->Rand();
+  TensorView view(tensor);
+  ASSERT_EQ(view.shape(), std::vector<uint32_t>({1, 3, 4, 5}));
+  ASSERT_EQ(view.strides(), std::vector<uint32_t>({60, 20, 1, 4}));
+  ASSERT_EQ(view.size(), 60);
+  ASSERT_TRUE(view.is_contiguous());
+  ASSERT_EQ(view.raw_ptr(), tensor->raw_ptr());
+  for (uint32_t c = 0; c < 3; ++c) {
+    for (uint32_t r = 0; r < 4; ++r) {
+      for (uint32_t col = 0; col < 5; ++col) {
+        ASSERT_EQ(view.at(c, r, col), tensor->at(c, r, col));
+      }
+    }
+  }
+
+  // 通过视图修改会反映到原张量
+  view.at(2, 3, 4) = 42.f;
+  ASSERT_EQ(tensor->at(2, 3, 4), 42.f);
+}
+
+TEST(test_tensor_view, channels) {
+  using namespace kuiper_infer;
+  sftensor tensor = std::make_shared<ftensor>(4, 3, 3);
+  tensor->Rand();
+  const TensorView &view = TensorView(tensor).Channels(1, 2);
+  ASSERT_EQ(view.channels(), 2);
+  ASSERT_TRUE(view.is_contiguous());
+  ASSERT_EQ(view.raw_ptr(), tensor->slice(1).memptr());
+
+  // 连续的视图转换为张量时不复制
+  const sftensor &sliced = view.AsTensor();
+  ASSERT_EQ(sliced->shape(), std::vector<uint32_t>({2, 3, 3}));
+  ASSERT_EQ(sliced->raw_ptr(), tensor->slice(1).memptr());
+  ASSERT_TRUE(arma::approx_equal(sliced->slice(1), tensor->slice(2), "absdiff", 1e-6));
+
+  // 视图持有底层数据，原张量释放后仍然有效
+  const float value = tensor->at(2, 1, 1);
+  tensor.reset();
+  ASSERT_EQ(sliced->at(1, 1, 1), value);
+}
+
+TEST(test_tensor_view, flatten_reshape) {
+  using namespace kuiper_infer;
+  sftensor tensor = std::make_shared<ftensor>(2, 3, 4);
+  tensor->Rand();
+
+  const TensorView &flatten = TensorView(tensor).Flatten();
+  ASSERT_EQ(flatten.shape(), std::vector<uint32_t>({1, 1, 1, 24}));
+  ASSERT_EQ(flatten.raw_ptr(), tensor->raw_ptr());
+
+  // 和 Tensor::Flatten(false) 的结果一致
+  sftensor flatten_tensor = TensorClone(tensor);
+  flatten_tensor->Flatten(false);
+  ASSERT_TRUE(TensorIsSame(flatten.AsTensor(), flatten_tensor));
+
+  const TensorView &reshaped = TensorView(tensor).Reshape({4, 3, 2});
+  sftensor reshape_tensor = TensorClone(tensor);
+  reshape_tensor->Reshape({4, 3, 2}, false);
+  ASSERT_EQ(reshaped.raw_ptr(), tensor->raw_ptr());
+  ASSERT_TRUE(TensorIsSame(reshaped.AsTensor(), reshape_tensor));
+}
+
+TEST(test_tensor_view, batch_strided) {
+  using namespace kuiper_infer;
+  // 两个 (2, 2, 3) 的 batch 元素放在一块内存里
+  std::shared_ptr<std::vector<float>> buffer = std::make_shared<std::vector<float>>(24);
+  for (uint32_t i = 0; i < buffer->size(); ++i) {
+    buffer->at(i) = float(i);
+  }
+  TensorView view(buffer, buffer->data(), {2, 2, 2, 3}, {12, 6, 1, 2});
+  const TensorView &second = view.Batch(1);
+  ASSERT_EQ(second.batch(), 1);
+  ASSERT_EQ(second.at(0, 0, 0), 12.f);
+  ASSERT_EQ(second.AsTensor()->raw_ptr(), buffer->data() + 12);
+
+  // 行主序排布的视图不连续，转换时复制
+  TensorView row_major(buffer, buffer->data(), {1, 2, 3, 4}, {24, 12, 4, 1});
+  ASSERT_FALSE(row_major.is_contiguous());
+  const sftensor &copied = row_major.AsTensor();
+  ASSERT_NE(copied->raw_ptr(), buffer->data());
+  for (uint32_t c = 0; c < 2; ++c) {
+    for (uint32_t r = 0; r < 3; ++r) {
+      for (uint32_t col = 0; col < 4; ++col) {
+        ASSERT_EQ(copied->at(c, r, col), float(c * 12 + r * 4 + col));
+      }
+    }
+  }
+}
+
+TEST(test_tensor_view, layer_forward) {
+  using namespace kuiper_infer;
+  sftensor tensor = std::make_shared<ftensor>(4, 5, 5);
+  tensor->Rand();
+
+  std::shared_ptr<Operator> op = std::make_shared<ReLUOperator>(0.f);
+  std::shared_ptr<Layer> layer = std::make_shared<ReLULayer>(op);
+  std::vector<sftensor> outputs;
+  layer->ForwardViews({TensorView(tensor).Channels(2, 2)}, outputs);
+  ASSERT_EQ(outputs.size(), 1);
+  ASSERT_EQ(outputs.front()->channels(), 2);
+  for (uint32_t c = 0; c < 2; ++c) {
+    for (uint32_t i = 0; i < 25; ++i) {
+      const float input = tensor->slice(c + 2).at(i);
+      ASSERT_EQ(outputs.front()->slice(c).at(i), input > 0 ? input : 0.f);
+    }
+  }
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <filesystem>
+#include "trace.hpp"
+#include "data/load_data.hpp"
+#include "runtime/runtime_ir.hpp"
+
+static int CountCall(int &count) {
+  count += 1;
+  return count;
+}
+
+TEST(test_trace, compile_out) {
+  int count = 0;
+  KUIPER_TRACE(INFO) << CountCall(count);
+  KUIPER_TRACE_IF(INFO, true) << CountCall(count);
+#ifdef KUIPER_ENABLE_TRACE
+  ASSERT_EQ(count, 2);
+#else
+  // 关闭时参数不会被求值
+  ASSERT_EQ(count, 0);
+#endif
+}
+
+TEST(test_trace, save_csv) {
+  using namespace kuiper_infer;
+  arma::fmat data(3, 4);
+  data.randn();
+  const std::string &file_path = "../tmp/save_csv.csv";
+  ASSERT_TRUE(CSVDataLoader::SaveData(file_path, data));
+  const arma::fmat &loaded = CSVDataLoader::LoadData(file_path);
+  ASSERT_TRUE(arma::approx_equal(data, loaded, "absdiff", 1e-6));
+  std::filesystem::remove(file_path);
+}
+
+TEST(test_trace, dump_outputs) {
+  using namespace kuiper_infer;
+  const std::string &param_path = "../tmp/test.pnnx.param";
+  const std::string &bin_path = "../tmp/test.pnnx.bin";
+  const std::string &dump_dir = "../tmp/dump_test";
+  std::filesystem::remove_all(dump_dir);
+
+  RuntimeGraph graph(param_path, bin_path);
+  graph.Build("pnnx_input_0", "pnnx_output_0");
+  graph.set_dump_dir(dump_dir);
+  ASSERT_EQ(graph.dump_dir(), dump_dir);
+
+  sftensor input = std::make_shared<ftensor>(1, 16, 16);
+  input->Rand();
+  const auto &outputs = graph.Forward({input});
+  ASSERT_EQ(outputs.size(), 1);
+
+  for (const char *name : {"conv1", "conv2", "pnnx_expr_0", "max"}) {
+    ASSERT_TRUE(std::filesystem::exists(dump_dir + "/" + name + "_0.csv")) << name;
+  }
+
+  // 最后一个算子的输出就是计算图的输出
+  const arma::fmat &max_output = CSVDataLoader::LoadData(dump_dir + "/max_0.csv");
+  ASSERT_EQ(max_output.n_rows, 8);
+  ASSERT_EQ(max_output.n_cols, 8);
+  ASSERT_TRUE(arma::approx_equal(max_output, outputs.front()->slice(0), "absdiff", 1e-5));
+  std::filesystem::remove_all(dump_dir);
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <glog/logging.h>
+#include "runtime/calibrator.hpp"
+
+// 训练后 int8 量化的校准工具
+// 在样本目录上运行 fp32 模型统计激活值范围，生成量化表并保存量化后的模型，
+// 最后输出每一层的误差，用来决定哪些层保持 fp32
+//
+// ./calibrate --param=../tmp/test.pnnx.param --bin=../tmp/test.pnnx.bin --samples=./samples --method=entropy --out-param=test_int8.pnnx.param --out-bin=test_int8.pnnx.bin
+// 误差超过阈值的层自动保持 fp32
+// ./calibrate ... --max-drift=0.05
+
+using namespace kuiper_infer;
+
+struct CalibrateOptions {
+    std::string param_path;
+    std::string bin_path;
+    std::string samples_dir;
+    std::string input_name = "pnnx_input_0";
+    std::string output_name = "pnnx_output_0";
+    CalibrationMethod method = CalibrationMethod::kMinMax;
+    float percentile = 0.9999f;
+    uint32_t batch_size = 8; // 每次前向的样本数
+    std::string out_param_path;
+    std::string out_bin_path;
+    std::string table_path; // 为空时放在 out_param 旁边
+    std::set<std::string> keep_float; // 指定保持 fp32 的层
+    float max_drift = 0.f; // 单独量化的平均误差和 fp32 输出平均绝对值之比超过它的层保持 fp32，0 时关闭
+};
+
+static void PrintUsage() {
+    std::cout << "usage: calibrate --param=<file> --bin=<file> --samples=<dir> --out-param=<file> --out-bin=<file>\n"
+              << "  --input=<name>         input operator, default pnnx_input_0\n"
+              << "  --output=<name>        output operator, default pnnx_output_0\n"
+              << "  --method=<name>        minmax, percentile or entropy, default minmax\n"
+              << "  --percentile=<p>       percentile of |x| for the percentile method, default 99.99\n"
+              << "  --batch=<n>            samples per forward, default 8\n"
+              << "  --table=<file>         quant table path, default next to out-param\n"
+              << "  --keep-float=<a,b,..>  layers kept in fp32\n"
+              << "  --max-drift=<ratio>    keep layers in fp32 when isolated mean error / mean |output| exceeds it\n";
+}
+
+static bool ParseOptions(int argc, char *argv[], CalibrateOptions &options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t pos = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || pos == std::string::npos) {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return false;
+        }
+        const std::string key = arg.substr(2, pos - 2);
+        const std::string value = arg.substr(pos + 1);
+        if (key == "param") {
+            options.param_path = value;
+        } else if (key == "bin") {
+            options.bin_path = value;
+        } else if (key == "samples") {
+            options.samples_dir = value;
+        } else if (key == "input") {
+            options.input_name = value;
+        } else if (key == "output") {
+            options.output_name = value;
+        } else if (key == "method") {
+            if (!ParseCalibrationMethod(value, options.method)) {
+                std::cerr << "Unknown method: " << value << "\n";
+                return false;
+            }
+        } else if (key == "percentile") {
+            options.percentile = std::stof(value) / 100.f;
+        } else if (key == "batch") {
+            options.batch_size = std::stoul(value);
+        } else if (key == "out-param") {
+            options.out_param_path = value;
+        } else if (key == "out-bin") {
+            options.out_bin_path = value;
+        } else if (key == "table") {
+            options.table_path = value;
+        } else if (key == "keep-float") {
+            std::stringstream ss(value);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (!item.empty()) {
+                    options.keep_float.insert(item);
+                }
+            }
+        } else if (key == "max-drift") {
+            options.max_drift = std::stof(value);
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    if (options.table_path.empty()) {
+        options.table_path = QuantTable::TablePath(options.out_param_path);
+    }
+    return !options.param_path.empty() && !options.bin_path.empty() && !options.samples_dir.empty() &&
+           !options.out_param_path.empty() && !options.out_bin_path.empty() && options.batch_size != 0 &&
+           options.percentile > 0.f && options.percentile <= 1.f;
+}
+
+static void PrintDrift(const std::vector<LayerDrift> &drifts, const QuantTable &table) {
+    std::cout << std::left << std::setw(24) << "layer" << std::setw(20) << "type" << std::right << std::setw(16)
+              << "isolated mean" << std::setw(16) << "isolated max" << std::setw(16) << "total mean"
+              << std::setw(16) << "total max" << "\n";
+    for (const LayerDrift &drift : drifts) {
+        std::cout << std::left << std::setw(24) << drift.name << std::setw(20) << drift.type << std::right
+                  << std::scientific << std::setprecision(3) << std::setw(16) << drift.isolated.mean_abs
+                  << std::setw(16) << drift.isolated.max_abs << std::setw(16) << drift.cumulative.mean_abs
+                  << std::setw(16) << drift.cumulative.max_abs << std::defaultfloat
+                  << (table.float_layers.count(drift.name) ? "  fp32" : "") << "\n";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    CalibrateOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 2;
+    }
+
+    Calibrator calibrator(options.param_path, options.bin_path, options.input_name, options.output_name);
+    const std::vector<uint32_t> &shape = calibrator.input_shape();
+    const std::vector<sftensor> &samples =
+        Calibrator::LoadSamples(options.samples_dir, shape.at(0), shape.at(1), shape.at(2));
+    if (samples.empty()) {
+        std::cerr << "No samples in " << options.samples_dir << "\n";
+        return 2;
+    }
+    for (size_t begin = 0; begin < samples.size(); begin += options.batch_size) {
+        const size_t end = std::min(samples.size(), begin + options.batch_size);
+        calibrator.Observe(std::vector<sftensor>(samples.begin() + begin, samples.begin() + end));
+    }
+    std::cout << "calibrated " << samples.size() << " samples with " << CalibrationMethodName(options.method)
+              << "\n";
+
+    QuantTable table = calibrator.Compute(options.method, options.percentile);
+    table.float_layers = options.keep_float;
+    if (!calibrator.SaveQuantizedModel(table, options.out_param_path, options.out_bin_path, options.table_path)) {
+        return 2;
+    }
+    std::vector<LayerDrift> drifts =
+        calibrator.MeasureDrift(table, options.out_param_path, options.out_bin_path, samples);
+
+    // 单独量化误差太大的层保持 fp32，重新保存后再测一次
+    if (options.max_drift > 0.f) {
+        bool changed = false;
+        for (const LayerDrift &drift : drifts) {
+            const float relative_drift = drift.isolated.mean_abs / std::max(drift.magnitude, 1e-6f);
+            if (relative_drift > options.max_drift && !table.float_layers.count(drift.name)) {
+                table.float_layers.insert(drift.name);
+                changed = true;
+            }
+        }
+        if (changed) {
+            if (!calibrator.SaveQuantizedModel(table, options.out_param_path, options.out_bin_path,
+                                               options.table_path)) {
+                return 2;
+            }
+            drifts = calibrator.MeasureDrift(table, options.out_param_path, options.out_bin_path, samples);
+        }
+    }
+
+    PrintDrift(drifts, table);
+    std::cout << "quantized model: " << options.out_param_path << " " << options.out_bin_path << "\n"
+              << "quant table: " << options.table_path << "\n";
+    return 0;
+}